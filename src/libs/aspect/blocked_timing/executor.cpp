@@ -22,6 +22,9 @@
  */
 
 #include <aspect/blocked_timing/executor.h>
+#include <core/utils/metrics.h>
+
+#include <vector>
 
 namespace fawkes {
 
@@ -82,4 +85,32 @@ BlockedTimingExecutor::~BlockedTimingExecutor()
 {
 }
 
+/** Get run time histogram of a hook.
+ * Executors record the time from waking up the threads of a hook until
+ * all of them finished their loop. The histograms are part of the core
+ * metrics, cf. MetricSet::core(), labeled with the hook's syncpoint.
+ * @param hook hook to get the histogram for
+ * @return histogram of the hook's run time
+ */
+MetricHistogram *
+BlockedTimingExecutor::hook_runtime(BlockedTimingAspect::WakeupHook hook)
+{
+	static const std::vector<MetricHistogram *> histograms = []() {
+		const std::vector<double> upper_bounds = {
+		  0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0};
+		std::vector<MetricHistogram *> h;
+		for (const auto &hs : BlockedTimingAspect::hook_to_syncpoint) {
+			if ((size_t)hs.first >= h.size())
+				h.resize(hs.first + 1, NULL);
+			h[hs.first] = MetricSet::core().histogram("fawkes_hook_runtime_seconds",
+			                                          "Time until all threads of a main loop hook "
+			                                          "finished their loop",
+			                                          upper_bounds,
+			                                          {{"hook", hs.second}});
+		}
+		return h;
+	}();
+	return ((size_t)hook < histograms.size()) ? histograms[hook] : NULL;
+}
+
 } // end namespace fawkes
@@ -0,0 +1,250 @@
+
+/***************************************************************************
+ *  scheduling.cpp - CPU affinity and priorities for BlockedTimingAspect threads
+ *
+ *  Created: Sun Oct 18 10:12:43 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <aspect/blocked_timing/scheduling.h>
+#include <core/exception.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/thread.h>
+#include <logging/logger.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sched.h>
+
+namespace fawkes {
+
+/** Parse a list of CPUs.
+ * The list has the same format as used by the kernel, e.g., in
+ * /sys/devices/system/cpu/isolated, that is comma-separated CPU
+ * numbers or ranges, for example "0-2,5".
+ * @param cpus string to parse
+ * @return list of CPU numbers
+ * @exception Exception thrown if the string cannot be parsed
+ */
+std::vector<unsigned int>
+parse_cpu_list(const std::string &cpus)
+{
+	std::vector<unsigned int> rv;
+	std::string::size_type    pos = 0;
+	while (pos < cpus.length()) {
+		std::string::size_type end = cpus.find(',', pos);
+		if (end == std::string::npos)
+			end = cpus.length();
+		std::string item = cpus.substr(pos, end - pos);
+		pos              = end + 1;
+
+		char *        endp;
+		unsigned long first = strtoul(item.c_str(), &endp, 10);
+		unsigned long last  = first;
+		if (endp == item.c_str()) {
+			throw Exception("Invalid CPU list '%s'", cpus.c_str());
+		}
+		if (*endp == '-') {
+			const char *start = endp + 1;
+			last              = strtoul(start, &endp, 10);
+			if (endp == start || last < first) {
+				throw Exception("Invalid CPU range '%s' in list '%s'", item.c_str(), cpus.c_str());
+			}
+		}
+		if (*endp != 0) {
+			throw Exception("Invalid CPU list '%s'", cpus.c_str());
+		}
+		if (last >= CPU_SETSIZE) {
+			throw Exception("CPU %lu in list '%s' out of range", last, cpus.c_str());
+		}
+		for (unsigned long c = first; c <= last; ++c) {
+			rv.push_back(c);
+		}
+	}
+	return rv;
+}
+
+/** Set the CPU affinity of a thread.
+ * @param thread thread to restrict
+ * @param cpus CPUs the thread may run on
+ * @return true on success, false otherwise, errno is set accordingly
+ */
+bool
+set_cpu_affinity(pthread_t thread, const std::vector<unsigned int> &cpus)
+{
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	for (unsigned int c : cpus) {
+		CPU_SET(c, &cpuset);
+	}
+	int err = pthread_setaffinity_np(thread, sizeof(cpuset), &cpuset);
+	if (err != 0) {
+		errno = err;
+		return false;
+	}
+	return true;
+}
+
+/** @class BlockedTimingHookStatistics <aspect/blocked_timing/scheduling.h>
+ * Wakeup jitter statistics of a wakeup hook.
+ * The main loop wakes all threads of a hook once per iteration. Each
+ * thread reports the time passed since its previous wakeup, the
+ * deviation of these periods is the jitter caused by the threads before
+ * in the loop and by the scheduler. Mean, standard deviation, minimum,
+ * and maximum period of all threads of the hook are logged periodically
+ * and reset afterwards.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param hook name of the hook for log messages
+ * @param logger logger to print statistics to
+ * @param report_interval interval in seconds to print statistics
+ */
+BlockedTimingHookStatistics::BlockedTimingHookStatistics(const char *hook,
+                                                         Logger *    logger,
+                                                         float       report_interval)
+: hook_(hook), logger_(logger), report_interval_(report_interval)
+{
+	last_report_ = std::chrono::steady_clock::now();
+	count_       = 0;
+	mean_        = 0.;
+	m2_          = 0.;
+	min_         = 0.;
+	max_         = 0.;
+}
+
+/** Add a wakeup period.
+ * @param period time in seconds since the previous wakeup of a thread
+ */
+void
+BlockedTimingHookStatistics::add_period(double period)
+{
+	MutexLocker lock(&mutex_);
+
+	if (count_ == 0) {
+		min_ = max_ = period;
+	} else {
+		min_ = std::min(min_, period);
+		max_ = std::max(max_, period);
+	}
+	count_ += 1;
+	double delta = period - mean_;
+	mean_ += delta / count_;
+	m2_ += delta * (period - mean_);
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (std::chrono::duration<double>(now - last_report_).count() < report_interval_)
+		return;
+
+	double stddev = (count_ > 1) ? std::sqrt(m2_ / (count_ - 1)) : 0.;
+	logger_->log_info("BlockedTimingScheduling",
+	                  "%s: %u wakeups, period mean %.2f ms, "
+	                  "jitter %.3f ms (min %.2f ms, max %.2f ms)",
+	                  hook_.c_str(),
+	                  count_,
+	                  mean_ * 1000.,
+	                  stddev * 1000.,
+	                  min_ * 1000.,
+	                  max_ * 1000.);
+
+	last_report_ = now;
+	count_       = 0;
+	mean_        = 0.;
+	m2_          = 0.;
+}
+
+/** @class BlockedTimingSchedulingListener <aspect/blocked_timing/scheduling.h>
+ * Loop listener applying scheduling parameters to a BlockedTimingAspect thread.
+ * CPU affinity and real-time priority are set from within the thread
+ * right before its first loop. This avoids races with thread creation
+ * and works regardless of whether the thread has been started when the
+ * aspect is initialized. Afterwards, the listener records the wakeup
+ * periods for the jitter statistics of the thread's hook.
+ *
+ * The listener must be added after the SyncPointAspect's loop listener,
+ * such that pre_loop() is called after the thread has been woken up.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param logger logger for warnings, e.g., if the priority cannot be set
+ * @param cpus CPUs to restrict the thread to, empty to keep the inherited affinity
+ * @param priority SCHED_FIFO priority, 0 to keep the default policy
+ * @param statistics statistics to record wakeup periods in, may be NULL
+ */
+BlockedTimingSchedulingListener::BlockedTimingSchedulingListener(
+  Logger *                         logger,
+  const std::vector<unsigned int> &cpus,
+  int                              priority,
+  BlockedTimingHookStatistics *    statistics)
+: logger_(logger), cpus_(cpus), priority_(priority), statistics_(statistics)
+{
+	applied_          = false;
+	have_last_wakeup_ = false;
+}
+
+void
+BlockedTimingSchedulingListener::pre_loop(Thread *thread)
+{
+	if (!applied_) {
+		apply(thread);
+		applied_ = true;
+	}
+
+	if (statistics_) {
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (have_last_wakeup_) {
+			statistics_->add_period(std::chrono::duration<double>(now - last_wakeup_).count());
+		}
+		last_wakeup_      = now;
+		have_last_wakeup_ = true;
+	}
+}
+
+void
+BlockedTimingSchedulingListener::apply(Thread *thread)
+{
+	if (!cpus_.empty()) {
+		if (!set_cpu_affinity(pthread_self(), cpus_)) {
+			logger_->log_warn("BlockedTimingScheduling",
+			                  "Failed to set CPU affinity of %s: %s",
+			                  thread->name(),
+			                  strerror(errno));
+		}
+	}
+
+	if (priority_ > 0) {
+		sched_param param;
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = priority_;
+		int err              = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (err != 0) {
+			logger_->log_warn("BlockedTimingScheduling",
+			                  "Failed to set SCHED_FIFO priority %i for %s: %s",
+			                  priority_,
+			                  thread->name(),
+			                  strerror(err));
+		}
+	}
+}
+
+} // end namespace fawkes
@@ -0,0 +1,90 @@
+
+/***************************************************************************
+ *  scheduling.h - CPU affinity and priorities for BlockedTimingAspect threads
+ *
+ *  Created: Sun Oct 18 10:12:43 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _ASPECT_BLOCKED_TIMING_SCHEDULING_H_
+#define _ASPECT_BLOCKED_TIMING_SCHEDULING_H_
+
+#include <core/threading/mutex.h>
+#include <core/threading/thread_loop_listener.h>
+
+#include <chrono>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+
+class Logger;
+
+std::vector<unsigned int> parse_cpu_list(const std::string &cpus);
+bool                      set_cpu_affinity(pthread_t thread, const std::vector<unsigned int> &cpus);
+
+class BlockedTimingHookStatistics
+{
+public:
+	BlockedTimingHookStatistics(const char *hook, Logger *logger, float report_interval);
+
+	void add_period(double period);
+
+private:
+	Mutex       mutex_;
+	std::string hook_;
+	Logger *    logger_;
+	double      report_interval_;
+
+	std::chrono::steady_clock::time_point last_report_;
+
+	unsigned int count_;
+	double       mean_;
+	double       m2_;
+	double       min_;
+	double       max_;
+};
+
+class BlockedTimingSchedulingListener : public ThreadLoopListener
+{
+public:
+	BlockedTimingSchedulingListener(Logger *                         logger,
+	                                const std::vector<unsigned int> &cpus,
+	                                int                              priority,
+	                                BlockedTimingHookStatistics *    statistics);
+
+	virtual void pre_loop(Thread *thread);
+
+private:
+	void apply(Thread *thread);
+
+private:
+	Logger *                     logger_;
+	std::vector<unsigned int>    cpus_;
+	int                          priority_;
+	BlockedTimingHookStatistics *statistics_;
+
+	bool                                  applied_;
+	bool                                  have_last_wakeup_;
+	std::chrono::steady_clock::time_point last_wakeup_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -22,19 +22,55 @@
  */
 
 #include <aspect/blocked_timing.h>
+#include <aspect/blocked_timing/scheduling.h>
 #include <aspect/inifins/blocked_timing.h>
+#include <config/config.h>
 #include <core/macros.h>
+#include <core/threading/mutex_locker.h>
+#include <logging/logger.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 
 namespace fawkes {
 
 /** @class BlockedTimingAspectIniFin <aspect/inifins/blocked_timing.h>
  * Initializer/finalizer for the BlockedTimingAspect.
+ * Threads can be restricted to a set of CPUs and run with a real-time
+ * priority (SCHED_FIFO) to reduce the jitter of time-critical hooks like
+ * sensor acquisition and actuator execution. Settings are read from the
+ * configuration per hook at /fawkes/mainapp/scheduling/hooks/HOOK, where
+ * HOOK is the lower-case hook name without the WAKEUP_HOOK_ prefix,
+ * e.g., sensor_acquire, and can be overridden per thread at
+ * /fawkes/mainapp/scheduling/threads/THREAD_NAME. Each may contain
+ * "cpus", a CPU list like "2-3", and "priority", a SCHED_FIFO priority
+ * greater than zero. If /fawkes/mainapp/scheduling/jitter_report_interval
+ * is set to a positive value, the wakeup jitter of each hook is logged
+ * in that interval (in seconds).
  * @author Tim Niemueller
  */
 
-/** Constructor. */
-BlockedTimingAspectIniFin::BlockedTimingAspectIniFin() : AspectIniFin("BlockedTimingAspect")
+/** Constructor.
+ * @param config configuration to read scheduling settings from
+ * @param logger logger for scheduling warnings and jitter statistics
+ */
+BlockedTimingAspectIniFin::BlockedTimingAspectIniFin(Configuration *config, Logger *logger)
+: AspectIniFin("BlockedTimingAspect")
+{
+	config_ = config;
+	logger_ = logger;
+}
+
+/** Destructor. */
+BlockedTimingAspectIniFin::~BlockedTimingAspectIniFin()
 {
+	for (auto &l : listeners_) {
+		delete l.second;
+	}
+	for (auto &s : statistics_) {
+		delete s.second;
+	}
 }
 
 void
@@ -56,6 +92,40 @@ BlockedTimingAspectIniFin::init(Thread *thread)
 		                                      thread->name());
 	}
 
+	BlockedTimingAspect::WakeupHook hook = blocked_timing_thread->blockedTimingAspectHook();
+
+	std::string hook_name = BlockedTimingAspect::blocked_timing_hook_to_string(hook);
+	hook_name             = hook_name.substr(strlen("WAKEUP_HOOK_"));
+	std::transform(hook_name.begin(), hook_name.end(), hook_name.begin(), ::tolower);
+
+	const std::string prefix        = "/fawkes/mainapp/scheduling/";
+	const std::string hook_prefix   = prefix + "hooks/" + hook_name;
+	const std::string thread_prefix = prefix + "threads/" + thread->name();
+
+	std::string cpus = config_->get_string_or_default((hook_prefix + "/cpus").c_str(), "");
+	cpus             = config_->get_string_or_default((thread_prefix + "/cpus").c_str(), cpus);
+	int priority     = config_->get_int_or_default((hook_prefix + "/priority").c_str(), 0);
+	priority         = config_->get_int_or_default((thread_prefix + "/priority").c_str(), priority);
+
+	std::vector<unsigned int> cpu_list;
+	try {
+		cpu_list = parse_cpu_list(cpus);
+	} catch (Exception &e) {
+		throw CannotInitializeThreadException("Invalid CPUs for thread '%s': %s",
+		                                      thread->name(),
+		                                      e.what_no_backtrace());
+	}
+
+	BlockedTimingHookStatistics *statistics = hook_statistics(hook);
+
+	if (!cpu_list.empty() || priority > 0 || statistics) {
+		BlockedTimingSchedulingListener *listener =
+		  new BlockedTimingSchedulingListener(logger_, cpu_list, priority, statistics);
+		MutexLocker lock(&mutex_);
+		listeners_[thread] = listener;
+		thread->add_loop_listener(listener);
+	}
+
 	blocked_timing_thread->init_BlockedTimingAspect(thread);
 }
 
@@ -73,6 +143,37 @@ BlockedTimingAspectIniFin::finalize(Thread *thread)
 	}
 
 	blocked_timing_thread->finalize_BlockedTimingAspect(thread);
+
+	MutexLocker lock(&mutex_);
+	auto        l = listeners_.find(thread);
+	if (l != listeners_.end()) {
+		thread->remove_loop_listener(l->second);
+		delete l->second;
+		listeners_.erase(l);
+	}
+}
+
+/** Get jitter statistics for a hook.
+ * @param hook hook to get statistics for
+ * @return statistics shared by all threads of the hook, NULL if jitter
+ * reporting is disabled
+ */
+BlockedTimingHookStatistics *
+BlockedTimingAspectIniFin::hook_statistics(BlockedTimingAspect::WakeupHook hook)
+{
+	float interval =
+	  config_->get_float_or_default("/fawkes/mainapp/scheduling/jitter_report_interval", 0.);
+	if (interval <= 0.)
+		return NULL;
+
+	MutexLocker lock(&mutex_);
+	if (statistics_.find(hook) == statistics_.end()) {
+		statistics_[hook] =
+		  new BlockedTimingHookStatistics(BlockedTimingAspect::blocked_timing_hook_to_string(hook),
+		                                  logger_,
+		                                  interval);
+	}
+	return statistics_[hook];
 }
 
 } // end namespace fawkes
@@ -24,17 +24,38 @@
 #ifndef _ASPECT_INIFINS_BLOCKED_TIMING_H_
 #define _ASPECT_INIFINS_BLOCKED_TIMING_H_
 
+#include <aspect/blocked_timing.h>
 #include <aspect/inifins/inifin.h>
+#include <core/threading/mutex.h>
+
+#include <map>
 
 namespace fawkes {
 
+class BlockedTimingHookStatistics;
+class BlockedTimingSchedulingListener;
+class Configuration;
+class Logger;
+
 class BlockedTimingAspectIniFin : public AspectIniFin
 {
 public:
-	BlockedTimingAspectIniFin();
+	BlockedTimingAspectIniFin(Configuration *config, Logger *logger);
+	virtual ~BlockedTimingAspectIniFin();
 
 	virtual void init(Thread *thread);
 	virtual void finalize(Thread *thread);
+
+private:
+	BlockedTimingHookStatistics *hook_statistics(BlockedTimingAspect::WakeupHook hook);
+
+private:
+	Configuration *config_;
+	Logger *       logger_;
+	Mutex          mutex_;
+
+	std::map<Thread *, BlockedTimingSchedulingListener *>                    listeners_;
+	std::map<BlockedTimingAspect::WakeupHook, BlockedTimingHookStatistics *> statistics_;
 };
 
 } // end namespace fawkes
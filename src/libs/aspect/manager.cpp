@@ -245,7 +245,7 @@ AspectManager::register_default_inifins(BlackBoard *           blackboard,
 
 	AspectProviderAspectIniFin *prov_aif   = new AspectProviderAspectIniFin(this);
 	BlackBoardAspectIniFin *    bb_aif     = new BlackBoardAspectIniFin(blackboard);
-	BlockedTimingAspectIniFin * bt_aif     = new BlockedTimingAspectIniFin();
+	BlockedTimingAspectIniFin * bt_aif     = new BlockedTimingAspectIniFin(config, logger);
 	ClockAspectIniFin *         clock_aif  = new ClockAspectIniFin(clock);
 	ConfigurableAspectIniFin *  conf_aif   = new ConfigurableAspectIniFin(config);
 	FawkesNetworkAspectIniFin * fnet_aif   = new FawkesNetworkAspectIniFin(fnethub);
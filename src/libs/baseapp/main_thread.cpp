@@ -28,6 +28,7 @@
 #include <core/macros.h>
 #include <core/threading/interruptible_barrier.h>
 #include <core/threading/mutex_locker.h>
+#include <core/utils/metrics.h>
 #include <core/version.h>
 #include <plugin/loader.h>
 #include <plugin/manager.h>
@@ -227,6 +228,7 @@ FawkesMainThread::once()
 			syncpoints_start_hook_.back()->register_emitter("FawkesMainThread");
 			syncpoints_end_hook_.push_back(syncpoint_manager_->get_syncpoint(
 			  "FawkesMainThread", BlockedTimingAspect::blocked_timing_hook_to_end_syncpoint(*it)));
+			hook_runtimes_.push_back(BlockedTimingExecutor::hook_runtime(*it));
 		}
 	} catch (Exception &e) {
 		multi_logger_->log_error("FawkesMainThread", "Failed to acquire mainloop syncpoint");
@@ -344,6 +346,7 @@ FawkesMainThread::loop()
 				  "Hook syncpoints are not initialized properly, not waking up any threads!");
 			} else {
 				for (uint i = 0; i < num_hooks; i++) {
+					MetricHistogram::Timer timer(hook_runtimes_[i]);
 					syncpoints_start_hook_[i]->emit("FawkesMainThread");
 					syncpoints_end_hook_[i]->reltime_wait_for_all("FawkesMainThread",
 					                                              0,
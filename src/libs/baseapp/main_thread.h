@@ -54,6 +54,7 @@ class Mutex;
 class ThreadManager;
 class SyncPointManager;
 class FawkesNetworkManager;
+class MetricHistogram;
 
 class FawkesMainThread : public Thread, public MainLoopEmployer
 {
@@ -147,6 +148,7 @@ private:
 
 	std::vector<RefPtr<SyncPoint>> syncpoints_start_hook_;
 	std::vector<RefPtr<SyncPoint>> syncpoints_end_hook_;
+	std::vector<MetricHistogram *> hook_runtimes_;
 };
 
 } // end namespace fawkes
@@ -56,6 +56,7 @@
 #ifdef HAVE_PLUGIN_NETWORK_HANDLER
 #	include <plugin/net/handler.h>
 #endif
+#include <aspect/blocked_timing/scheduling.h>
 #include <aspect/manager.h>
 #include <syncpoint/syncpoint_manager.h>
 #ifdef HAVE_TF
@@ -66,6 +67,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -309,6 +311,25 @@ init(const InitOptions &options, int &retval)
 		} // ignored
 	}
 
+	// *** Restrict threads to default CPUs
+	// All threads created from here on inherit this affinity. Threads of
+	// time-critical hooks can be moved to other (isolated) CPUs with the
+	// per-hook settings applied by the BlockedTimingAspect.
+	if (config->exists("/fawkes/mainapp/scheduling/default_cpus")) {
+		try {
+			std::vector<unsigned int> cpus =
+			  parse_cpu_list(config->get_string("/fawkes/mainapp/scheduling/default_cpus"));
+			if (!cpus.empty() && !set_cpu_affinity(pthread_self(), cpus)) {
+				logger->log_warn("FawkesMainThread",
+				                 "Failed to restrict threads to default CPUs: %s",
+				                 strerror(errno));
+			}
+		} catch (Exception &e) {
+			logger->log_warn("FawkesMainThread", "Failed to read default CPUs, exception follows.");
+			logger->log_warn("FawkesMainThread", e);
+		}
+	}
+
 	// *** Determine network parameters
 	bool         enable_ipv4 = true;
 	bool         enable_ipv6 = true;
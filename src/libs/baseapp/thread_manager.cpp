@@ -30,6 +30,7 @@
 #include <core/threading/thread_finalizer.h>
 #include <core/threading/thread_initializer.h>
 #include <core/threading/wait_condition.h>
+#include <core/utils/metrics.h>
 
 namespace fawkes {
 
@@ -550,6 +551,7 @@ ThreadManager::wakeup_and_wait(BlockedTimingAspect::WakeupHook hook, unsigned in
 
 	// Note that the following lines might throw an exception, we just pass it on
 	if (threads_.find(hook) != threads_.end()) {
+		MetricHistogram::Timer timer(hook_runtime(hook));
 		threads_[hook].wakeup_and_wait(timeout_sec, timeout_usec * 1000);
 	}
 }
@@ -281,6 +281,25 @@ BlackBoard::format_identifier(const char *identifier_format, va_list arg)
 	}
 }
 
+/** Refresh interfaces and get those that have changed.
+ * Calls Interface::read_if_changed() on all given interfaces. The data of
+ * interfaces that have not changed since the last read is not copied.
+ * This is meant for components which read a larger set of interfaces
+ * once per cycle but only need to process those that changed.
+ * @param interfaces interfaces to refresh
+ * @return list of interfaces that changed since the last read
+ */
+std::list<Interface *>
+BlackBoard::read_changed(const std::list<Interface *> &interfaces)
+{
+	std::list<Interface *> rv;
+	for (Interface *i : interfaces) {
+		if (i->read_if_changed())
+			rv.push_back(i);
+	}
+	return rv;
+}
+
 /** Open interface for reading with identifier format string.
  * This will create a new interface instance of the given type. The result can be
  * casted to the appropriate type.
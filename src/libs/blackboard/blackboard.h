@@ -101,6 +101,8 @@ public:
 	virtual void register_observer(BlackBoardInterfaceObserver *observer);
 	virtual void unregister_observer(BlackBoardInterfaceObserver *observer);
 
+	std::list<Interface *> read_changed(const std::list<Interface *> &interfaces);
+
 	std::string demangle_fawkes_interface_name(const char *type);
 	std::string format_identifier(const char *identifier_format, va_list arg);
 
@@ -0,0 +1,197 @@
+
+/***************************************************************************
+ *  qa_bb_codec.cpp - BlackBoard interface codec QA
+ *
+ *  Created: Sun Oct 18 15:20:07 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <blackboard/bbconfig.h>
+#include <blackboard/local.h>
+#include <interface/codec.h>
+#include <interfaces/TestInterface.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+using namespace fawkes;
+
+#define NUM_ITERATIONS 100000
+
+int failures = 0;
+
+void
+check(bool cond, const char *what)
+{
+	cout << (cond ? "OK:     " : "FAILED: ") << what << endl;
+	if (!cond)
+		++failures;
+}
+
+bool
+same_values(TestInterface *a, TestInterface *b)
+{
+	return a->is_test_bool() == b->is_test_bool() && a->test_int() == b->test_int()
+	       && a->flags() == b->flags() && strcmp(a->test_string(), b->test_string()) == 0
+	       && a->result() == b->result() && a->test_uint() == b->test_uint();
+}
+
+void
+encode_iterator(TestInterface *iface, std::string &buffer)
+{
+	buffer.clear();
+	for (InterfaceFieldIterator f = iface->fields(); f != iface->fields_end(); ++f) {
+		buffer += f.get_name();
+		buffer += '=';
+		f.append_value_string(buffer);
+	}
+}
+
+void
+encode_json(TestInterface *iface, std::string &buffer)
+{
+	buffer.clear();
+	InterfaceCodec::encode_json(iface, buffer);
+}
+
+void
+decode_json(TestInterface *iface, std::string &buffer)
+{
+	InterfaceCodec::decode_json(iface, buffer);
+}
+
+void
+encode_binary(TestInterface *iface, std::string &buffer)
+{
+	buffer.clear();
+	InterfaceCodec::encode_binary(iface, buffer);
+}
+
+double
+benchmark(void (*f)(TestInterface *, std::string &), TestInterface *iface, std::string &buffer)
+{
+	std::string b = buffer;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < NUM_ITERATIONS; ++i) {
+		f(iface, b);
+	}
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()
+	       / NUM_ITERATIONS;
+}
+
+int
+main(int argc, char **argv)
+{
+	BlackBoard *bb = new LocalBlackBoard(BLACKBOARD_MEMSIZE);
+
+	TestInterface *ti_writer = bb->open_for_writing<TestInterface>("Writer");
+	TestInterface *ti_reader = bb->open_for_writing<TestInterface>("Decoded");
+
+	ti_writer->set_test_bool(true);
+	ti_writer->set_test_int(-4711);
+	ti_writer->set_flags(0xA5);
+	ti_writer->set_test_string("\"quoted\"\tand\\escaped");
+	ti_writer->set_result(123456);
+	ti_writer->set_test_uint(0xFFFFFFFF);
+	ti_writer->write();
+
+	std::string binary;
+	InterfaceCodec::encode_binary(ti_writer, binary);
+	check(binary.size() == InterfaceCodec::binary_size(ti_writer), "binary size");
+	InterfaceCodec::decode_binary(ti_reader, binary.data(), binary.size());
+	check(same_values(ti_writer, ti_reader), "binary round-trip");
+
+	std::string json;
+	InterfaceCodec::encode_json(ti_writer, json);
+	cout << "JSON: " << json << endl;
+	ti_reader->set_test_string("");
+	ti_reader->set_test_int(0);
+	InterfaceCodec::decode_json(ti_reader, json);
+	check(same_values(ti_writer, ti_reader), "JSON round-trip");
+
+	InterfaceCodec::decode_json(ti_reader, "{ \"unknown\": [1, {\"a\": null}], \"test_int\": 17 }");
+	check(ti_reader->test_int() == 17 && ti_reader->test_uint() == 0xFFFFFFFF, "JSON partial update");
+
+	try {
+		InterfaceCodec::decode_json(ti_reader, "{ \"test_int\": 42, \"test_uint\": -1 }");
+		check(false, "invalid JSON value rejected");
+	} catch (Exception &e) {
+		check(ti_reader->test_int() == 17, "invalid JSON value rejected, data unchanged");
+	}
+
+	try {
+		InterfaceCodec::decode_json(ti_reader, "{ \"unknown\": " + std::string(1000, '[') + " }");
+		check(false, "deeply nested JSON rejected");
+	} catch (Exception &e) {
+		check(true, "deeply nested JSON rejected");
+	}
+
+	std::string reference((const char *)ti_reader->datachunk(), ti_reader->datasize());
+	ti_reader->set_result(4711);
+	std::string delta;
+	InterfaceCodec::encode_json(ti_reader, reference.data(), delta);
+	check(delta == "{\"result\":4711}", "JSON delta");
+
+	try {
+		InterfaceCodec::decode_binary(ti_reader, binary.data(), binary.size() - 1);
+		check(false, "truncated binary data rejected");
+	} catch (Exception &e) {
+		check(true, "truncated binary data rejected");
+	}
+
+	TestInterface::CalculateMessage calc(-3, 42);
+	TestInterface::CalculateMessage calc_decoded;
+	std::string                     msg_binary;
+	InterfaceCodec::encode_binary(&calc, msg_binary);
+	try {
+		InterfaceCodec::decode_binary(ti_reader, msg_binary.data(), msg_binary.size());
+		check(false, "message data rejected for interface");
+	} catch (Exception &e) {
+		check(true, "message data rejected for interface");
+	}
+	InterfaceCodec::decode_binary(&calc_decoded, msg_binary.data(), msg_binary.size());
+	check(calc_decoded.summand() == -3 && calc_decoded.addend() == 42, "message round-trip");
+
+	double t_iterator = benchmark(encode_iterator, ti_writer, json);
+	double t_json     = benchmark(encode_json, ti_writer, json);
+	double t_decode   = benchmark(decode_json, ti_reader, json);
+	double t_binary   = benchmark(encode_binary, ti_writer, binary);
+
+	printf("Field iterator: %8.3f usec\n"
+	       "JSON encode:    %8.3f usec\n"
+	       "JSON decode:    %8.3f usec\n"
+	       "Binary encode:  %8.3f usec\n",
+	       t_iterator,
+	       t_json,
+	       t_decode,
+	       t_binary);
+
+	bb->close(ti_reader);
+	bb->close(ti_writer);
+	delete bb;
+
+	return failures > 0 ? 1 : 0;
+}
+
+/// @endcond
@@ -0,0 +1,403 @@
+/***************************************************************************
+ *  metrics.cpp - Lock-free counters, gauges and histograms
+ *
+ *  Created: Sun Oct 18 14:02:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <core/exception.h>
+#include <core/threading/mutex_locker.h>
+#include <core/utils/metrics.h>
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+namespace metrics {
+
+/* Threads are assigned shards round-robin on their first update. With
+ * no more threads updating a metric than there are shards, each thread
+ * owns its cache line and updates never contend.
+ */
+unsigned int
+shard_index()
+{
+	static std::atomic<unsigned int> next_shard(0);
+	static thread_local unsigned int shard =
+	  next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+	return shard;
+}
+
+} // namespace metrics
+/// @endcond
+
+/** @class MetricCounter <core/utils/metrics.h>
+ * Lock-free monotonic counter.
+ * The counter is split into per-thread shards, each on its own cache
+ * line. Incrementing is a single relaxed atomic add without contention,
+ * the shards are summed only when the value is retrieved.
+ * @author agent
+ */
+
+/** Constructor. */
+MetricCounter::MetricCounter()
+{
+	for (unsigned int i = 0; i < metrics::NUM_SHARDS; ++i) {
+		shards_[i].value.store(0, std::memory_order_relaxed);
+	}
+}
+
+/** Get current value.
+ * @return sum of all increments
+ */
+uint64_t
+MetricCounter::value() const
+{
+	uint64_t v = 0;
+	for (unsigned int i = 0; i < metrics::NUM_SHARDS; ++i) {
+		v += shards_[i].value.load(std::memory_order_relaxed);
+	}
+	return v;
+}
+
+/** @class MetricGauge <core/utils/metrics.h>
+ * Lock-free gauge.
+ * @author agent
+ */
+
+/** Constructor. */
+MetricGauge::MetricGauge() : value_(0.)
+{
+}
+
+/** Set value.
+ * @param value new value
+ */
+void
+MetricGauge::set(double value)
+{
+	value_.store(value, std::memory_order_relaxed);
+}
+
+/** Increment value.
+ * @param d value to add
+ */
+void
+MetricGauge::inc(double d)
+{
+	double v = value_.load(std::memory_order_relaxed);
+	while (!value_.compare_exchange_weak(v, v + d, std::memory_order_relaxed)) {
+	}
+}
+
+/** Decrement value.
+ * @param d value to subtract
+ */
+void
+MetricGauge::dec(double d)
+{
+	inc(-d);
+}
+
+/** Get current value.
+ * @return current value
+ */
+double
+MetricGauge::value() const
+{
+	return value_.load(std::memory_order_relaxed);
+}
+
+/** @class MetricHistogram <core/utils/metrics.h>
+ * Lock-free histogram with high dynamic range.
+ * Values are recorded as unsigned integers, e.g., nanoseconds, into
+ * internal buckets: each power of two is split into SUB_BUCKETS linear
+ * sub-buckets, values below SUB_BUCKETS are recorded exactly. The
+ * relative error therefore is at most 1/SUB_BUCKETS over the whole range
+ * up to 2^(MAX_MSB+1), larger values are all recorded in the last bucket.
+ * Finding the bucket takes a few instructions and recording is two relaxed
+ * atomic adds on the shard of the calling thread.
+ *
+ * On retrieval, the internal buckets are mapped to the configured bucket
+ * upper bounds of the exported histogram. An internal bucket is counted
+ * for an upper bound if all values it may contain are less than or equal
+ * to the bound.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param upper_bounds upper bounds of the exported buckets in the
+ * exported unit, e.g., seconds
+ * @param scale factor to convert recorded values to the exported unit,
+ * e.g., 1e-9 to record nanoseconds and export seconds
+ */
+MetricHistogram::MetricHistogram(const std::vector<double> &upper_bounds, double scale)
+: upper_bounds_(upper_bounds), scale_(scale)
+{
+	std::sort(upper_bounds_.begin(), upper_bounds_.end());
+	for (unsigned int s = 0; s < metrics::NUM_SHARDS; ++s) {
+		for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+			shards_[s].buckets[i].store(0, std::memory_order_relaxed);
+		}
+		shards_[s].sum.store(0, std::memory_order_relaxed);
+	}
+}
+
+/** Get upper bounds of exported buckets.
+ * @return sorted upper bounds in the exported unit
+ */
+const std::vector<double> &
+MetricHistogram::upper_bounds() const
+{
+	return upper_bounds_;
+}
+
+/** Get scale.
+ * @return factor to convert recorded values to the exported unit
+ */
+double
+MetricHistogram::scale() const
+{
+	return scale_;
+}
+
+/** Get number of recorded values.
+ * @return number of recorded values
+ */
+uint64_t
+MetricHistogram::count() const
+{
+	uint64_t c = 0;
+	for (unsigned int s = 0; s < metrics::NUM_SHARDS; ++s) {
+		for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+			c += shards_[s].buckets[i].load(std::memory_order_relaxed);
+		}
+	}
+	return c;
+}
+
+/** Get sum of recorded values.
+ * @return sum of recorded values in the exported unit
+ */
+double
+MetricHistogram::sum() const
+{
+	uint64_t sum = 0;
+	for (unsigned int s = 0; s < metrics::NUM_SHARDS; ++s) {
+		sum += shards_[s].sum.load(std::memory_order_relaxed);
+	}
+	return sum * scale_;
+}
+
+/** Get cumulative counts of exported buckets.
+ * @param counts upon return contains one cumulative count for each upper
+ * bound, followed by the total count
+ */
+void
+MetricHistogram::cumulative_counts(std::vector<uint64_t> &counts) const
+{
+	counts.assign(upper_bounds_.size() + 1, 0);
+	for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		uint64_t c = 0;
+		for (unsigned int s = 0; s < metrics::NUM_SHARDS; ++s) {
+			c += shards_[s].buckets[i].load(std::memory_order_relaxed);
+		}
+		if (c == 0)
+			continue;
+
+		double       max_value = bucket_max(i) * scale_;
+		unsigned int b         = 0;
+		while (b < upper_bounds_.size() && max_value > upper_bounds_[b])
+			++b;
+		for (; b < counts.size(); ++b)
+			counts[b] += c;
+	}
+}
+
+/** Get largest value of an internal bucket.
+ * @param bucket bucket index
+ * @return largest value recorded in the bucket
+ */
+uint64_t
+MetricHistogram::bucket_max(unsigned int bucket)
+{
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+	if (bucket >= NUM_BUCKETS - 1)
+		return std::numeric_limits<uint64_t>::max();
+	unsigned int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+	unsigned int sub   = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+	return ((uint64_t)(SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+/** @class MetricSet <core/utils/metrics.h>
+ * Set of lock-free metrics.
+ * Metrics are created once, e.g., during initialization, and then updated
+ * from hot paths without locking or memory allocation. The set does not
+ * export the metrics itself, the metrics plugin does that through a
+ * MetricsRegistry. Metrics are never removed, pointers returned remain
+ * valid for the lifetime of the set.
+ *
+ * The core libraries record their metrics, for example the run time of
+ * main loop hooks and blackboard operations, in the process-wide set
+ * returned by core().
+ * @author agent
+ */
+
+/** Constructor. */
+MetricSet::MetricSet()
+{
+}
+
+/** Destructor. */
+MetricSet::~MetricSet()
+{
+}
+
+/** Get process-wide set of core metrics.
+ * @return metric set shared by the core libraries
+ */
+MetricSet &
+MetricSet::core()
+{
+	static MetricSet core_set;
+	return core_set;
+}
+
+/** Get metric family, create if it does not exist.
+ * @param name name of the metric family
+ * @param help help string of the metric family
+ * @param type type of the metric family
+ * @return metric family
+ * @exception Exception thrown if a family of another type exists
+ */
+MetricSet::Family &
+MetricSet::family(const std::string &name, const std::string &help, Type type)
+{
+	auto f = families_.find(name);
+	if (f == families_.end()) {
+		Family &nf = families_[name];
+		nf.help    = help;
+		nf.type    = type;
+		return nf;
+	}
+	if (f->second.type != type) {
+		throw Exception("Metric family %s already exists with a different type", name.c_str());
+	}
+	return f->second;
+}
+
+/** Get counter.
+ * @param name name of the metric family
+ * @param help help string of the metric family
+ * @param labels labels of the counter
+ * @return counter, an existing one if name and labels match
+ * @exception Exception thrown if a non-counter metric of that name exists
+ */
+MetricCounter *
+MetricSet::counter(const std::string &name, const std::string &help, const Labels &labels)
+{
+	MutexLocker lock(&mutex_);
+	Family &    f = family(name, help, COUNTER);
+	for (auto &c : f.counters) {
+		if (c.first == labels)
+			return &c.second;
+	}
+	f.counters.emplace_back(std::piecewise_construct,
+	                        std::forward_as_tuple(labels),
+	                        std::forward_as_tuple());
+	return &f.counters.back().second;
+}
+
+/** Get gauge.
+ * @param name name of the metric family
+ * @param help help string of the metric family
+ * @param labels labels of the gauge
+ * @return gauge, an existing one if name and labels match
+ * @exception Exception thrown if a non-gauge metric of that name exists
+ */
+MetricGauge *
+MetricSet::gauge(const std::string &name, const std::string &help, const Labels &labels)
+{
+	MutexLocker lock(&mutex_);
+	Family &    f = family(name, help, GAUGE);
+	for (auto &g : f.gauges) {
+		if (g.first == labels)
+			return &g.second;
+	}
+	f.gauges.emplace_back(std::piecewise_construct,
+	                      std::forward_as_tuple(labels),
+	                      std::forward_as_tuple());
+	return &f.gauges.back().second;
+}
+
+/** Get histogram.
+ * @param name name of the metric family
+ * @param help help string of the metric family
+ * @param upper_bounds upper bounds of the exported buckets in the
+ * exported unit, ignored if the histogram exists
+ * @param labels labels of the histogram
+ * @param scale factor to convert recorded values to the exported unit,
+ * the default records nanoseconds and exports seconds
+ * @return histogram, an existing one if name and labels match
+ * @exception Exception thrown if a non-histogram metric of that name exists
+ */
+MetricHistogram *
+MetricSet::histogram(const std::string &        name,
+                     const std::string &        help,
+                     const std::vector<double> &upper_bounds,
+                     const Labels &             labels,
+                     double                     scale)
+{
+	MutexLocker lock(&mutex_);
+	Family &    f = family(name, help, HISTOGRAM);
+	for (auto &h : f.histograms) {
+		if (h.first == labels)
+			return &h.second;
+	}
+	f.histograms.emplace_back(std::piecewise_construct,
+	                          std::forward_as_tuple(labels),
+	                          std::forward_as_tuple(upper_bounds, scale));
+	return &f.histograms.back().second;
+}
+
+/** Get mutex.
+ * The mutex must be locked while accessing families().
+ * @return mutex protecting the metric families
+ */
+Mutex *
+MetricSet::mutex() const
+{
+	return &mutex_;
+}
+
+/** Get metric families.
+ * Lock mutex() while accessing the families. The values of the metrics
+ * may be read at any time.
+ * @return metric families by name
+ */
+const std::map<std::string, MetricSet::Family> &
+MetricSet::families() const
+{
+	return families_;
+}
+
+} // end namespace fawkes
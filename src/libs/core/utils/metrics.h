@@ -0,0 +1,240 @@
+/***************************************************************************
+ *  metrics.h - Lock-free counters, gauges and histograms
+ *
+ *  Created: Sun Oct 18 14:02:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _CORE_UTILS_METRICS_H_
+#define _CORE_UTILS_METRICS_H_
+
+#include <core/threading/mutex.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+namespace metrics {
+static const unsigned int NUM_SHARDS     = 8;
+static const unsigned int CACHELINE_SIZE = 64;
+
+unsigned int shard_index();
+} // namespace metrics
+/// @endcond
+
+class MetricCounter
+{
+public:
+	MetricCounter();
+
+	/** Increment counter.
+	 * @param n value to add
+	 */
+	void
+	inc(uint64_t n = 1)
+	{
+		shards_[metrics::shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	uint64_t value() const;
+
+private:
+	struct Shard
+	{
+		std::atomic<uint64_t> value;
+		char                  padding[metrics::CACHELINE_SIZE - sizeof(std::atomic<uint64_t>)];
+	};
+
+	Shard shards_[metrics::NUM_SHARDS];
+};
+
+class MetricGauge
+{
+public:
+	MetricGauge();
+
+	void   set(double value);
+	void   inc(double d = 1.);
+	void   dec(double d = 1.);
+	double value() const;
+
+private:
+	std::atomic<double> value_;
+};
+
+class MetricHistogram
+{
+public:
+	/** Number of bits to sub-divide each power of two with. */
+	static const unsigned int SUB_BUCKET_BITS = 3;
+	/** Number of linear sub-buckets per power of two. */
+	static const unsigned int SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+	/** Most significant bit of the largest value recorded precisely. */
+	static const unsigned int MAX_MSB = 40;
+	/** Total number of internal buckets, the last one collects values too large. */
+	static const unsigned int NUM_BUCKETS = SUB_BUCKETS * (MAX_MSB - SUB_BUCKET_BITS + 2) + 1;
+
+	MetricHistogram(const std::vector<double> &upper_bounds, double scale);
+
+	/** Record a value.
+	 * @param value value to record, in the unit of the histogram, i.e.,
+	 * nanoseconds for the default scale
+	 */
+	void
+	observe(uint64_t value)
+	{
+		Shard &s = shards_[metrics::shard_index()];
+		s.buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+		s.sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	/** Record a duration.
+	 * @param d duration to record, the histogram must have been created
+	 * with the default scale to export seconds.
+	 */
+	template <class Rep, class Period>
+	void
+	observe(const std::chrono::duration<Rep, Period> &d)
+	{
+		observe((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+	}
+
+	const std::vector<double> &upper_bounds() const;
+	double                     scale() const;
+
+	uint64_t count() const;
+	double   sum() const;
+	void     cumulative_counts(std::vector<uint64_t> &counts) const;
+
+	/** Get internal bucket of a value.
+	 * @param value value to get bucket for
+	 * @return bucket index
+	 */
+	static unsigned int
+	bucket(uint64_t value)
+	{
+		if (value < SUB_BUCKETS)
+			return (unsigned int)value;
+		unsigned int msb = 63 - __builtin_clzll(value);
+		if (msb > MAX_MSB)
+			return NUM_BUCKETS - 1;
+		unsigned int shift = msb - SUB_BUCKET_BITS;
+		return SUB_BUCKETS + shift * SUB_BUCKETS + (unsigned int)(value >> shift) - SUB_BUCKETS;
+	}
+
+	static uint64_t bucket_max(unsigned int bucket);
+
+	/** Scoped timer to record the lifetime of a block in a histogram. */
+	class Timer
+	{
+	public:
+		/** Constructor.
+		 * @param histogram histogram to record in, may be NULL to disable timing
+		 */
+		explicit Timer(MetricHistogram *histogram)
+		: histogram_(histogram), start_(std::chrono::steady_clock::now())
+		{
+		}
+
+		/** Destructor, records the time passed since construction. */
+		~Timer()
+		{
+			if (histogram_)
+				histogram_->observe(std::chrono::steady_clock::now() - start_);
+		}
+
+	private:
+		MetricHistogram *                     histogram_;
+		std::chrono::steady_clock::time_point start_;
+	};
+
+private:
+	struct Shard
+	{
+		std::atomic<uint64_t> buckets[NUM_BUCKETS];
+		std::atomic<uint64_t> sum;
+		char                  padding[metrics::CACHELINE_SIZE];
+	};
+
+	std::vector<double> upper_bounds_;
+	double              scale_;
+	Shard               shards_[metrics::NUM_SHARDS];
+};
+
+class MetricSet
+{
+public:
+	/** Label names mapped to values. */
+	typedef std::map<std::string, std::string> Labels;
+
+	/** Type of a metric family. */
+	typedef enum {
+		COUNTER,  ///< family of MetricCounter
+		GAUGE,    ///< family of MetricGauge
+		HISTOGRAM ///< family of MetricHistogram
+	} Type;
+
+	/** Metrics of the same name, distinguished by their labels. */
+	typedef struct
+	{
+		std::string                                   help;       ///< help string
+		Type                                          type;       ///< type of all metrics
+		std::list<std::pair<Labels, MetricCounter>>   counters;   ///< counters if type is COUNTER
+		std::list<std::pair<Labels, MetricGauge>>     gauges;     ///< gauges if type is GAUGE
+		std::list<std::pair<Labels, MetricHistogram>> histograms; ///< histograms if type is HISTOGRAM
+	} Family;
+
+	MetricSet();
+	~MetricSet();
+
+	MetricCounter *counter(const std::string &name,
+	                       const std::string &help,
+	                       const Labels &     labels = Labels());
+	MetricGauge *  gauge(const std::string &name,
+	                     const std::string &help,
+	                     const Labels &     labels = Labels());
+
+	MetricHistogram *histogram(const std::string &        name,
+	                           const std::string &        help,
+	                           const std::vector<double> &upper_bounds,
+	                           const Labels &             labels = Labels(),
+	                           double                     scale  = 1e-9);
+
+	Mutex *                              mutex() const;
+	const std::map<std::string, Family> &families() const;
+
+	static MetricSet &core();
+
+private:
+	Family &family(const std::string &name, const std::string &help, Type type);
+
+private:
+	mutable Mutex                 mutex_;
+	std::map<std::string, Family> families_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -0,0 +1,965 @@
+
+/***************************************************************************
+ *  codec.cpp - Binary and JSON encoding of interfaces and messages
+ *
+ *  Created: Sun Oct 18 14:02:51 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <core/exceptions/software.h>
+#include <interface/codec.h>
+#include <interface/interface.h>
+#include <interface/message.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+#if __cplusplus >= 201703L
+#	include <charconv>
+#endif
+
+namespace fawkes {
+
+/// @cond INTERNALS
+namespace {
+
+size_t
+element_size(interface_fieldtype_t type)
+{
+	switch (type) {
+	case IFT_BOOL: return sizeof(bool);
+	case IFT_INT8:
+	case IFT_UINT8:
+	case IFT_BYTE:
+	case IFT_STRING: return 1;
+	case IFT_INT16:
+	case IFT_UINT16: return 2;
+	case IFT_INT32:
+	case IFT_UINT32:
+	case IFT_ENUM: return 4;
+	case IFT_FLOAT: return sizeof(float);
+	case IFT_INT64:
+	case IFT_UINT64: return 8;
+	case IFT_DOUBLE: return sizeof(double);
+	}
+	return 0;
+}
+
+template <typename T>
+void
+append_integer(std::string &s, T v)
+{
+	char buf[24];
+#if __cplusplus >= 201703L
+	s.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+#else
+	if (std::numeric_limits<T>::is_signed) {
+		s.append(buf, snprintf(buf, sizeof(buf), "%lli", (long long)v));
+	} else {
+		s.append(buf, snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v));
+	}
+#endif
+}
+
+// Shortest representation that reads back to the same value, NaN and
+// infinity cannot be represented in JSON and are encoded as null.
+template <typename T>
+void
+append_floating(std::string &s, T v)
+{
+	if (!std::isfinite(v)) {
+		s += "null";
+		return;
+	}
+	char buf[32];
+#ifdef __cpp_lib_to_chars
+	s.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+#else
+	int digits = std::numeric_limits<T>::max_digits10;
+	s.append(buf, snprintf(buf, sizeof(buf), "%.*g", digits, (double)v));
+#endif
+}
+
+void
+append_json_string(std::string &s, const char *str, size_t len)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	s += '"';
+	const char *run = str;
+	for (const char *c = str; c != str + len; ++c) {
+		unsigned char ch = *c;
+		if (ch >= 0x20 && ch != '"' && ch != '\\')
+			continue;
+		s.append(run, c - run);
+		run = c + 1;
+		switch (ch) {
+		case '"': s += "\\\""; break;
+		case '\\': s += "\\\\"; break;
+		case '\n': s += "\\n"; break;
+		case '\r': s += "\\r"; break;
+		case '\t': s += "\\t"; break;
+		case '\b': s += "\\b"; break;
+		case '\f': s += "\\f"; break;
+		default:
+			s += "\\u00";
+			s += hex[ch >> 4];
+			s += hex[ch & 0x0f];
+		}
+	}
+	s.append(run, str + len - run);
+	s += '"';
+}
+
+void
+append_json_element(std::string &s, const interface_fieldinfo_t &f, const char *value, size_t i)
+{
+	switch (f.type) {
+	case IFT_BOOL: s += ((const bool *)value)[i] ? "true" : "false"; break;
+	case IFT_INT8: append_integer(s, ((const int8_t *)value)[i]); break;
+	case IFT_INT16: append_integer(s, ((const int16_t *)value)[i]); break;
+	case IFT_INT32: append_integer(s, ((const int32_t *)value)[i]); break;
+	case IFT_INT64: append_integer(s, ((const int64_t *)value)[i]); break;
+	case IFT_UINT8:
+	case IFT_BYTE: append_integer(s, ((const uint8_t *)value)[i]); break;
+	case IFT_UINT16: append_integer(s, ((const uint16_t *)value)[i]); break;
+	case IFT_UINT32: append_integer(s, ((const uint32_t *)value)[i]); break;
+	case IFT_UINT64: append_integer(s, ((const uint64_t *)value)[i]); break;
+	case IFT_FLOAT: append_floating(s, ((const float *)value)[i]); break;
+	case IFT_DOUBLE: append_floating(s, ((const double *)value)[i]); break;
+	case IFT_STRING:
+		// strings are not arrays, handled by caller
+		break;
+	case IFT_ENUM: {
+		int32_t v = ((const int32_t *)value)[i];
+		if (f.enum_map) {
+			interface_enum_map_t::const_iterator ev = f.enum_map->find(v);
+			if (ev != f.enum_map->end()) {
+				append_json_string(s, ev->second.data(), ev->second.length());
+				break;
+			}
+		}
+		// not a known value, keep the number to not lose information
+		append_integer(s, v);
+	} break;
+	}
+}
+
+// Size of the part of a data chunk covered by a field info table
+size_t
+data_extent(const interface_fieldinfo_t *fields, unsigned int num_fields)
+{
+	size_t extent = 0;
+	for (unsigned int i = 0; i < num_fields; ++i) {
+		extent = std::max(extent, fields[i].offset + fields[i].length * element_size(fields[i].type));
+	}
+	return extent;
+}
+
+/** Minimal reader for JSON objects as written by InterfaceCodec. */
+class JsonReader
+{
+public:
+	JsonReader(const char *json, size_t length) : begin_(json), p_(json), end_(json + length)
+	{
+	}
+
+	void
+	skip_ws()
+	{
+		while (p_ != end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r'))
+			++p_;
+	}
+
+	char
+	peek()
+	{
+		skip_ws();
+		return (p_ != end_) ? *p_ : 0;
+	}
+
+	bool
+	consume(char c)
+	{
+		if (peek() == c) {
+			++p_;
+			return true;
+		}
+		return false;
+	}
+
+	void
+	expect(char c)
+	{
+		if (!consume(c)) {
+			fail("expected '%c'", c);
+		}
+	}
+
+	bool
+	at_end()
+	{
+		skip_ws();
+		return p_ == end_;
+	}
+
+	bool
+	consume_literal(const char *lit)
+	{
+		size_t len = strlen(lit);
+		skip_ws();
+		if ((size_t)(end_ - p_) >= len && strncmp(p_, lit, len) == 0) {
+			p_ += len;
+			return true;
+		}
+		return false;
+	}
+
+	void
+	read_string(std::string &s)
+	{
+		expect('"');
+		s.clear();
+		const char *run = p_;
+		while (p_ != end_ && *p_ != '"') {
+			if ((unsigned char)*p_ < 0x20) {
+				fail("control character in string");
+			}
+			if (*p_ != '\\') {
+				++p_;
+				continue;
+			}
+			s.append(run, p_ - run);
+			if (++p_ == end_)
+				break;
+			switch (*p_++) {
+			case '"': s += '"'; break;
+			case '\\': s += '\\'; break;
+			case '/': s += '/'; break;
+			case 'b': s += '\b'; break;
+			case 'f': s += '\f'; break;
+			case 'n': s += '\n'; break;
+			case 'r': s += '\r'; break;
+			case 't': s += '\t'; break;
+			case 'u': append_utf8(s, read_codepoint()); break;
+			default: fail("invalid escape sequence");
+			}
+			run = p_;
+		}
+		if (p_ == end_) {
+			fail("unterminated string");
+		}
+		s.append(run, p_ - run);
+		++p_;
+	}
+
+	/** Get the next number token, i.e., all characters that may be part of a number. */
+	void
+	read_number(char *buf, size_t bufsize)
+	{
+		skip_ws();
+		size_t n = 0;
+		while (p_ != end_ && n < bufsize - 1
+		       && ((*p_ >= '0' && *p_ <= '9') || *p_ == '-' || *p_ == '+' || *p_ == '.' || *p_ == 'e'
+		           || *p_ == 'E')) {
+			buf[n++] = *p_++;
+		}
+		buf[n] = 0;
+		if (n == 0) {
+			fail("expected number");
+		}
+	}
+
+	/** Maximum nesting depth of skipped values. */
+	static const unsigned int MAX_DEPTH = 64;
+
+	void
+	skip_value(unsigned int depth = 0)
+	{
+		if (depth > MAX_DEPTH) {
+			fail("nesting too deep");
+		}
+		char c = peek();
+		if (c == '"') {
+			std::string dummy;
+			read_string(dummy);
+		} else if (c == '{' || c == '[') {
+			char close = (c == '{') ? '}' : ']';
+			++p_;
+			if (consume(close))
+				return;
+			do {
+				if (c == '{') {
+					std::string dummy;
+					read_string(dummy);
+					expect(':');
+				}
+				skip_value(depth + 1);
+			} while (consume(','));
+			expect(close);
+		} else if (!consume_literal("true") && !consume_literal("false") && !consume_literal("null")) {
+			char buf[64];
+			read_number(buf, sizeof(buf));
+		}
+	}
+
+	void
+	fail(const char *what, char c = 0)
+	{
+		char msg[64];
+		snprintf(msg, sizeof(msg), what, c);
+		throw SyntaxErrorException("Invalid JSON at offset %zu: %s", (size_t)(p_ - begin_), msg);
+	}
+
+private:
+	unsigned int
+	read_hex4()
+	{
+		if (end_ - p_ < 4) {
+			fail("truncated unicode escape");
+		}
+		unsigned int v = 0;
+		for (int i = 0; i < 4; ++i, ++p_) {
+			char c = *p_;
+			v <<= 4;
+			if (c >= '0' && c <= '9')
+				v |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				v |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				v |= c - 'A' + 10;
+			else
+				fail("invalid unicode escape");
+		}
+		return v;
+	}
+
+	unsigned int
+	read_codepoint()
+	{
+		unsigned int cp = read_hex4();
+		if (cp >= 0xD800 && cp < 0xDC00 && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+			p_ += 2;
+			unsigned int low = read_hex4();
+			if (low < 0xDC00 || low > 0xDFFF) {
+				fail("invalid surrogate pair");
+			}
+			cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+		}
+		return cp;
+	}
+
+	static void
+	append_utf8(std::string &s, unsigned int cp)
+	{
+		if (cp < 0x80) {
+			s += (char)cp;
+		} else if (cp < 0x800) {
+			s += (char)(0xC0 | (cp >> 6));
+			s += (char)(0x80 | (cp & 0x3F));
+		} else if (cp < 0x10000) {
+			s += (char)(0xE0 | (cp >> 12));
+			s += (char)(0x80 | ((cp >> 6) & 0x3F));
+			s += (char)(0x80 | (cp & 0x3F));
+		} else {
+			s += (char)(0xF0 | (cp >> 18));
+			s += (char)(0x80 | ((cp >> 12) & 0x3F));
+			s += (char)(0x80 | ((cp >> 6) & 0x3F));
+			s += (char)(0x80 | (cp & 0x3F));
+		}
+	}
+
+private:
+	const char *begin_;
+	const char *p_;
+	const char *end_;
+};
+
+template <typename T>
+void
+read_signed(JsonReader &r, const interface_fieldinfo_t &f, T *v)
+{
+	char buf[64];
+	r.read_number(buf, sizeof(buf));
+	char *endp;
+	errno            = 0;
+	long long parsed = strtoll(buf, &endp, 10);
+	if (*endp != 0 || errno == ERANGE || parsed < std::numeric_limits<T>::min()
+	    || parsed > std::numeric_limits<T>::max()) {
+		throw IllegalArgumentException("Invalid value '%s' for integer field %s", buf, f.name);
+	}
+	*v = (T)parsed;
+}
+
+template <typename T>
+void
+read_unsigned(JsonReader &r, const interface_fieldinfo_t &f, T *v)
+{
+	char buf[64];
+	r.read_number(buf, sizeof(buf));
+	char *endp;
+	errno                     = 0;
+	unsigned long long parsed = strtoull(buf, &endp, 10);
+	if (*endp != 0 || buf[0] == '-' || errno == ERANGE || parsed > std::numeric_limits<T>::max()) {
+		throw IllegalArgumentException("Invalid value '%s' for unsigned field %s", buf, f.name);
+	}
+	*v = (T)parsed;
+}
+
+template <typename T>
+void
+read_floating(JsonReader &r, const interface_fieldinfo_t &f, T *v)
+{
+	if (r.consume_literal("null")) {
+		*v = std::numeric_limits<T>::quiet_NaN();
+		return;
+	}
+	char buf[64];
+	r.read_number(buf, sizeof(buf));
+	char *endp;
+	T     parsed = (sizeof(T) == sizeof(float)) ? strtof(buf, &endp) : strtod(buf, &endp);
+	if (*endp != 0) {
+		throw IllegalArgumentException("Invalid value '%s' for field %s", buf, f.name);
+	}
+	*v = parsed;
+}
+
+void
+read_json_element(JsonReader &r, const interface_fieldinfo_t &f, char *value, size_t i)
+{
+	switch (f.type) {
+	case IFT_BOOL:
+		if (r.consume_literal("true")) {
+			((bool *)value)[i] = true;
+		} else if (r.consume_literal("false")) {
+			((bool *)value)[i] = false;
+		} else {
+			throw TypeMismatchException("Field %s expects a boolean value", f.name);
+		}
+		break;
+	case IFT_INT8: read_signed(r, f, &((int8_t *)value)[i]); break;
+	case IFT_INT16: read_signed(r, f, &((int16_t *)value)[i]); break;
+	case IFT_INT32: read_signed(r, f, &((int32_t *)value)[i]); break;
+	case IFT_INT64: read_signed(r, f, &((int64_t *)value)[i]); break;
+	case IFT_UINT8:
+	case IFT_BYTE: read_unsigned(r, f, &((uint8_t *)value)[i]); break;
+	case IFT_UINT16: read_unsigned(r, f, &((uint16_t *)value)[i]); break;
+	case IFT_UINT32: read_unsigned(r, f, &((uint32_t *)value)[i]); break;
+	case IFT_UINT64: read_unsigned(r, f, &((uint64_t *)value)[i]); break;
+	case IFT_FLOAT: read_floating(r, f, &((float *)value)[i]); break;
+	case IFT_DOUBLE: read_floating(r, f, &((double *)value)[i]); break;
+	case IFT_STRING:
+		// strings are not arrays, handled by caller
+		break;
+	case IFT_ENUM:
+		if (r.peek() == '"') {
+			std::string name;
+			r.read_string(name);
+			if (f.enum_map) {
+				for (const auto &ev : *f.enum_map) {
+					if (ev.second == name) {
+						((int32_t *)value)[i] = ev.first;
+						return;
+					}
+				}
+			}
+			throw IllegalArgumentException("Invalid value '%s' for enum field %s of type %s",
+			                               name.c_str(),
+			                               f.name,
+			                               f.enumtype);
+		} else {
+			read_signed(r, f, &((int32_t *)value)[i]);
+		}
+		break;
+	}
+}
+
+} // namespace
+/// @endcond
+
+/** @class InterfaceCodec <interface/codec.h>
+ * Encoding of interfaces and messages as compact binary data or JSON.
+ * The codec is driven by the static field info tables which the interface
+ * generator emits for each interface and message type from the XML
+ * definition. Field values are read and written directly at their offset
+ * in the data chunk, there are no type name comparisons or string
+ * conversions through InterfaceFieldIterator. This is meant as a common
+ * fast path for components which convert interfaces to external formats.
+ *
+ * The binary encoding is a 32 bit layout hash (see layout_hash()) followed
+ * by the fields in the order of the definition. Numbers, booleans, and
+ * enums are stored in host byte order with their natural size, strings as
+ * a 32 bit length followed by the characters without padding. It is meant
+ * for storage and transport between hosts of the same architecture.
+ *
+ * The JSON encoding is an object mapping field names to values. Arrays
+ * are encoded as JSON arrays, enums by their name, and float values
+ * in the shortest representation that reads back to the same value. NaN
+ * and infinity are encoded as null and read back as NaN. Unknown names are
+ * ignored when decoding, fields which are not mentioned keep their value.
+ *
+ * Neither encoding contains the timestamp, it is set on write() of the
+ * interface or on enqueuing a message.
+ * @author agent
+ */
+
+/** Compute hash of a field layout.
+ * This hash identifies the binary layout of a data chunk, it covers the
+ * name, type, and length of all fields. It is used to reject binary data
+ * of a different interface type or version.
+ * @param fields field info table
+ * @param num_fields number of entries in @p fields
+ * @return 32 bit FNV-1a hash of the layout
+ */
+uint32_t
+InterfaceCodec::layout_hash(const interface_fieldinfo_t *fields, unsigned int num_fields)
+{
+	uint32_t h = 2166136261u;
+	for (unsigned int i = 0; i < num_fields; ++i) {
+		for (const char *c = fields[i].name; *c; ++c) {
+			h = (h ^ (unsigned char)*c) * 16777619u;
+		}
+		uint32_t desc[2] = {(uint32_t)fields[i].type, (uint32_t)fields[i].length};
+		for (size_t b = 0; b < sizeof(desc); ++b) {
+			h = (h ^ ((const unsigned char *)desc)[b]) * 16777619u;
+		}
+	}
+	return h;
+}
+
+/** Encode data chunk in binary format.
+ * @param fields field info table
+ * @param num_fields number of entries in @p fields
+ * @param data data chunk described by @p fields
+ * @param buffer buffer to append the encoded data to
+ */
+void
+InterfaceCodec::encode_binary(const interface_fieldinfo_t *fields,
+                              unsigned int                 num_fields,
+                              const void *                 data,
+                              std::string &                buffer)
+{
+	uint32_t hash = layout_hash(fields, num_fields);
+	buffer.append((const char *)&hash, sizeof(hash));
+
+	for (unsigned int i = 0; i < num_fields; ++i) {
+		const char *value = (const char *)data + fields[i].offset;
+		if (fields[i].type == IFT_STRING) {
+			uint32_t len = strnlen(value, fields[i].length);
+			buffer.append((const char *)&len, sizeof(len));
+			buffer.append(value, len);
+		} else {
+			buffer.append(value, fields[i].length * element_size(fields[i].type));
+		}
+	}
+}
+
+/** Decode binary data into a data chunk.
+ * The data chunk is only modified if the whole buffer has been decoded
+ * successfully.
+ * @param fields field info table
+ * @param num_fields number of entries in @p fields
+ * @param data data chunk described by @p fields to write values to
+ * @param buffer encoded data
+ * @param size size in bytes of @p buffer
+ * @exception TypeMismatchException the layout hash does not match @p fields
+ * @exception OutOfBoundsException the buffer is truncated or has excess data
+ */
+void
+InterfaceCodec::decode_binary(const interface_fieldinfo_t *fields,
+                              unsigned int                 num_fields,
+                              void *                       data,
+                              const void *                 buffer,
+                              size_t                       size)
+{
+	const char *p   = (const char *)buffer;
+	const char *end = p + size;
+
+	uint32_t hash;
+	if (size < sizeof(hash)) {
+		throw OutOfBoundsException("Binary interface data truncated");
+	}
+	memcpy(&hash, p, sizeof(hash));
+	p += sizeof(hash);
+	if (hash != layout_hash(fields, num_fields)) {
+		throw TypeMismatchException("Binary interface data has a different field layout");
+	}
+
+	// decode into a copy, such that the data is left untouched on error
+	size_t            extent = data_extent(fields, num_fields);
+	std::vector<char> chunk((const char *)data, (const char *)data + extent);
+
+	for (unsigned int i = 0; i < num_fields; ++i) {
+		const interface_fieldinfo_t &f     = fields[i];
+		char *                       value = chunk.data() + f.offset;
+		if (f.type == IFT_STRING) {
+			uint32_t len;
+			if ((size_t)(end - p) < sizeof(len)) {
+				throw OutOfBoundsException("Binary interface data truncated");
+			}
+			memcpy(&len, p, sizeof(len));
+			p += sizeof(len);
+			if (len > f.length || (size_t)(end - p) < len) {
+				throw OutOfBoundsException("Invalid string length in binary data", len, 0, f.length);
+			}
+			memcpy(value, p, len);
+			memset(value + len, 0, f.length - len);
+			p += len;
+		} else {
+			size_t n = f.length * element_size(f.type);
+			if ((size_t)(end - p) < n) {
+				throw OutOfBoundsException("Binary interface data truncated");
+			}
+			if (f.type == IFT_BOOL) {
+				// normalize, any byte other than zero is true
+				for (size_t b = 0; b < f.length; ++b) {
+					((bool *)value)[b] = (p[b] != 0);
+				}
+			} else {
+				memcpy(value, p, n);
+			}
+			p += n;
+		}
+	}
+
+	if (p != end) {
+		throw OutOfBoundsException("Excess data after binary interface data");
+	}
+
+	memcpy(data, chunk.data(), extent);
+}
+
+/** Encode data chunk as JSON object.
+ * @param fields field info table
+ * @param num_fields number of entries in @p fields
+ * @param data data chunk described by @p fields
+ * @param json string to append the JSON object to
+ * @param reference data chunk described by @p fields to compare to, only
+ * fields whose value differs from the reference are encoded. If NULL,
+ * all fields are encoded.
+ */
+void
+InterfaceCodec::encode_json(const interface_fieldinfo_t *fields,
+                            unsigned int                 num_fields,
+                            const void *                 data,
+                            std::string &                json,
+                            const void *                 reference)
+{
+	bool first = true;
+	json += '{';
+	for (unsigned int i = 0; i < num_fields; ++i) {
+		const interface_fieldinfo_t &f     = fields[i];
+		const char *                 value = (const char *)data + f.offset;
+		if (reference
+		    && memcmp(value, (const char *)reference + f.offset, f.length * element_size(f.type))
+		         == 0) {
+			continue;
+		}
+		if (!first)
+			json += ',';
+		first = false;
+		json += '"';
+		json += f.name;
+		json += "\":";
+		if (f.type == IFT_STRING) {
+			append_json_string(json, value, strnlen(value, f.length));
+		} else if (f.length == 1) {
+			append_json_element(json, f, value, 0);
+		} else {
+			json += '[';
+			for (size_t e = 0; e < f.length; ++e) {
+				if (e > 0)
+					json += ',';
+				append_json_element(json, f, value, e);
+			}
+			json += ']';
+		}
+	}
+	json += '}';
+}
+
+/** Decode JSON object into a data chunk.
+ * The data chunk is only modified if the whole object has been decoded
+ * successfully.
+ * @param fields field info table
+ * @param num_fields number of entries in @p fields
+ * @param data data chunk described by @p fields to write values to
+ * @param json JSON object, need not be null-terminated
+ * @param length length of @p json
+ * @exception SyntaxErrorException the JSON cannot be parsed
+ * @exception TypeMismatchException a value does not match the field type
+ * @exception IllegalArgumentException a value is out of range of the field
+ * type or an invalid enum value
+ */
+void
+InterfaceCodec::decode_json(const interface_fieldinfo_t *fields,
+                            unsigned int                 num_fields,
+                            void *                       data,
+                            const char *                 json,
+                            size_t                       length)
+{
+	JsonReader  r(json, length);
+	std::string key;
+	std::string str;
+
+	// decode into a copy, such that the data is left untouched on error
+	size_t            extent = data_extent(fields, num_fields);
+	std::vector<char> chunk((const char *)data, (const char *)data + extent);
+
+	// expected index of the next field, it matches if the input has
+	// been written by encode_json()
+	unsigned int next = 0;
+
+	r.expect('{');
+	if (!r.consume('}')) {
+		do {
+			r.read_string(key);
+			r.expect(':');
+
+			const interface_fieldinfo_t *f = NULL;
+			if (next < num_fields && key == fields[next].name) {
+				f = &fields[next];
+			} else {
+				for (unsigned int i = 0; i < num_fields; ++i) {
+					if (key == fields[i].name) {
+						f = &fields[i];
+						break;
+					}
+				}
+			}
+			if (!f) {
+				r.skip_value();
+				continue;
+			}
+			next = (f - fields) + 1;
+
+			char *value = chunk.data() + f->offset;
+			if (f->type == IFT_STRING) {
+				if (r.peek() != '"') {
+					throw TypeMismatchException("Field %s expects a string value", f->name);
+				}
+				r.read_string(str);
+				// same as the generated setters, always leave room for termination
+				size_t n = std::min(str.length(), f->length - 1);
+				memcpy(value, str.data(), n);
+				memset(value + n, 0, f->length - n);
+			} else if (r.consume('[')) {
+				size_t e = 0;
+				if (!r.consume(']')) {
+					do {
+						if (e >= f->length) {
+							throw OutOfBoundsException("Too many array elements", e, 0, f->length);
+						}
+						read_json_element(r, *f, value, e++);
+					} while (r.consume(','));
+					r.expect(']');
+				}
+				if (e != f->length) {
+					throw OutOfBoundsException("Too few array elements", e, f->length, f->length);
+				}
+			} else if (f->length == 1) {
+				read_json_element(r, *f, value, 0);
+			} else {
+				throw TypeMismatchException("Field %s expects an array", f->name);
+			}
+		} while (r.consume(','));
+		r.expect('}');
+	}
+	if (!r.at_end()) {
+		r.fail("trailing data");
+	}
+
+	memcpy(data, chunk.data(), extent);
+}
+
+/** Get size of binary encoding.
+ * @param interface interface to get the size for with its current values
+ * @return number of bytes encode_binary() appends
+ */
+size_t
+InterfaceCodec::binary_size(const Interface *interface)
+{
+	size_t size = sizeof(uint32_t);
+	for (unsigned int i = 0; i < interface->num_fields_; ++i) {
+		const interface_fieldinfo_t &f = interface->fieldinfo_list_[i];
+		if (f.type == IFT_STRING) {
+			size += sizeof(uint32_t) + strnlen((const char *)interface->data_ptr + f.offset, f.length);
+		} else {
+			size += f.length * element_size(f.type);
+		}
+	}
+	return size;
+}
+
+/** Get size of binary encoding.
+ * @param message message to get the size for with its current values
+ * @return number of bytes encode_binary() appends
+ */
+size_t
+InterfaceCodec::binary_size(const Message *message)
+{
+	size_t size = sizeof(uint32_t);
+	for (unsigned int i = 0; i < message->num_fields_; ++i) {
+		const interface_fieldinfo_t &f = message->fieldinfo_list_[i];
+		if (f.type == IFT_STRING) {
+			size += sizeof(uint32_t) + strnlen((const char *)message->data_ptr + f.offset, f.length);
+		} else {
+			size += f.length * element_size(f.type);
+		}
+	}
+	return size;
+}
+
+/** Encode interface in binary format.
+ * The local copy of the interface data is encoded, call read() before
+ * if the current blackboard values are needed.
+ * @param interface interface to encode
+ * @param buffer buffer to append the encoded data to
+ */
+void
+InterfaceCodec::encode_binary(const Interface *interface, std::string &buffer)
+{
+	encode_binary(interface->fieldinfo_list_, interface->num_fields_, interface->data_ptr, buffer);
+}
+
+/** Encode message in binary format.
+ * @param message message to encode
+ * @param buffer buffer to append the encoded data to
+ */
+void
+InterfaceCodec::encode_binary(const Message *message, std::string &buffer)
+{
+	encode_binary(message->fieldinfo_list_, message->num_fields_, message->data_ptr, buffer);
+}
+
+/** Decode binary data into interface.
+ * The values are written to the local copy of the interface and the
+ * interface is marked as changed. Call write() to publish them.
+ * @param interface interface to decode into
+ * @param buffer encoded data
+ * @param size size in bytes of @p buffer
+ * @exception TypeMismatchException the data is of a different interface type
+ * @exception OutOfBoundsException the buffer is truncated or has excess data
+ */
+void
+InterfaceCodec::decode_binary(Interface *interface, const void *buffer, size_t size)
+{
+	decode_binary(interface->fieldinfo_list_,
+	              interface->num_fields_,
+	              interface->data_ptr,
+	              buffer,
+	              size);
+	interface->data_changed = true;
+}
+
+/** Decode binary data into message.
+ * @param message message to decode into
+ * @param buffer encoded data
+ * @param size size in bytes of @p buffer
+ * @exception TypeMismatchException the data is of a different message type
+ * @exception OutOfBoundsException the buffer is truncated or has excess data
+ */
+void
+InterfaceCodec::decode_binary(Message *message, const void *buffer, size_t size)
+{
+	decode_binary(message->fieldinfo_list_, message->num_fields_, message->data_ptr, buffer, size);
+}
+
+/** Encode interface as JSON object.
+ * The local copy of the interface data is encoded, call read() before
+ * if the current blackboard values are needed.
+ * @param interface interface to encode
+ * @param json string to append the JSON object to
+ */
+void
+InterfaceCodec::encode_json(const Interface *interface, std::string &json)
+{
+	encode_json(interface->fieldinfo_list_, interface->num_fields_, interface->data_ptr, json);
+}
+
+/** Encode changed fields of interface as JSON object.
+ * Only fields whose value differs from the given reference are encoded,
+ * e.g., to send deltas to a client which knows earlier values.
+ * @param interface interface to encode
+ * @param reference copy of the data chunk of @p interface to compare to,
+ * it must have been taken from an interface of the same type and have
+ * a size of at least Interface::datasize().
+ * @param json string to append the JSON object to
+ */
+void
+InterfaceCodec::encode_json(const Interface *interface, const void *reference, std::string &json)
+{
+	encode_json(
+	  interface->fieldinfo_list_, interface->num_fields_, interface->data_ptr, json, reference);
+}
+
+/** Encode message as JSON object.
+ * @param message message to encode
+ * @param json string to append the JSON object to
+ */
+void
+InterfaceCodec::encode_json(const Message *message, std::string &json)
+{
+	encode_json(message->fieldinfo_list_, message->num_fields_, message->data_ptr, json);
+}
+
+/** Decode JSON object into interface.
+ * The values are written to the local copy of the interface and the
+ * interface is marked as changed. Call write() to publish them.
+ * @param interface interface to decode into
+ * @param json JSON object
+ * @exception SyntaxErrorException the JSON cannot be parsed
+ * @exception TypeMismatchException a value does not match the field type
+ * @exception IllegalArgumentException a value is out of range of the field
+ * type or an invalid enum value
+ */
+void
+InterfaceCodec::decode_json(Interface *interface, const std::string &json)
+{
+	decode_json(interface->fieldinfo_list_,
+	            interface->num_fields_,
+	            interface->data_ptr,
+	            json.data(),
+	            json.length());
+	interface->data_changed = true;
+}
+
+/** Decode JSON object into message.
+ * @param message message to decode into
+ * @param json JSON object
+ * @exception SyntaxErrorException the JSON cannot be parsed
+ * @exception TypeMismatchException a value does not match the field type
+ * @exception IllegalArgumentException a value is out of range of the field
+ * type or an invalid enum value
+ */
+void
+InterfaceCodec::decode_json(Message *message, const std::string &json)
+{
+	decode_json(message->fieldinfo_list_,
+	            message->num_fields_,
+	            message->data_ptr,
+	            json.data(),
+	            json.length());
+}
+
+} // end namespace fawkes
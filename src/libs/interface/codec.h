@@ -0,0 +1,80 @@
+
+/***************************************************************************
+ *  codec.h - Binary and JSON encoding of interfaces and messages
+ *
+ *  Created: Sun Oct 18 14:02:51 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _INTERFACE_CODEC_H_
+#define _INTERFACE_CODEC_H_
+
+#include <interface/types.h>
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+namespace fawkes {
+
+class Interface;
+class Message;
+
+class InterfaceCodec
+{
+public:
+	static uint32_t layout_hash(const interface_fieldinfo_t *fields, unsigned int num_fields);
+
+	static size_t binary_size(const Interface *interface);
+	static size_t binary_size(const Message *message);
+
+	static void encode_binary(const Interface *interface, std::string &buffer);
+	static void encode_binary(const Message *message, std::string &buffer);
+	static void decode_binary(Interface *interface, const void *buffer, size_t size);
+	static void decode_binary(Message *message, const void *buffer, size_t size);
+
+	static void encode_json(const Interface *interface, std::string &json);
+	static void encode_json(const Interface *interface, const void *reference, std::string &json);
+	static void encode_json(const Message *message, std::string &json);
+	static void decode_json(Interface *interface, const std::string &json);
+	static void decode_json(Message *message, const std::string &json);
+
+	static void encode_binary(const interface_fieldinfo_t *fields,
+	                          unsigned int                 num_fields,
+	                          const void *                 data,
+	                          std::string &                buffer);
+	static void decode_binary(const interface_fieldinfo_t *fields,
+	                          unsigned int                 num_fields,
+	                          void *                       data,
+	                          const void *                 buffer,
+	                          size_t                       size);
+	static void encode_json(const interface_fieldinfo_t *fields,
+	                        unsigned int                 num_fields,
+	                        const void *                 data,
+	                        std::string &                json,
+	                        const void *                 reference = NULL);
+	static void decode_json(const interface_fieldinfo_t *fields,
+	                        unsigned int                 num_fields,
+	                        void *                       data,
+	                        const char *                 json,
+	                        size_t                       length);
+};
+
+} // end namespace fawkes
+
+#endif
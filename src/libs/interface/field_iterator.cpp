@@ -30,6 +30,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#if __cplusplus >= 201703L
+#	include <charconv>
+#endif
 
 namespace fawkes {
 
@@ -46,22 +49,30 @@ namespace fawkes {
  */
 InterfaceFieldIterator::InterfaceFieldIterator()
 {
-	interface_    = NULL;
-	infol_        = NULL;
-	value_string_ = NULL;
+	interface_         = NULL;
+	infol_             = NULL;
+	infol_end_         = NULL;
+	data_              = NULL;
+	have_value_string_ = false;
 }
 
 /** Constructor.
  * This creates an iterator pointing to the given entry of the info list.
  * @param interface interface this field iterator is assigned to
  * @param info_list pointer to info list entry to start from
+ * @param num_fields number of entries in the info list
+ * @param data data chunk the field values are located in
  */
 InterfaceFieldIterator::InterfaceFieldIterator(Interface *                  interface,
-                                               const interface_fieldinfo_t *info_list)
+                                               const interface_fieldinfo_t *info_list,
+                                               unsigned int                 num_fields,
+                                               void *                       data)
 {
-	interface_    = interface;
-	infol_        = info_list;
-	value_string_ = NULL;
+	interface_         = interface;
+	infol_             = (num_fields > 0) ? info_list : NULL;
+	infol_end_         = info_list + num_fields;
+	data_              = (char *)data;
+	have_value_string_ = false;
 }
 
 /** Copy constructor.
@@ -69,20 +80,17 @@ InterfaceFieldIterator::InterfaceFieldIterator(Interface *                  inte
  */
 InterfaceFieldIterator::InterfaceFieldIterator(const InterfaceFieldIterator &fit)
 {
-	interface_ = fit.interface_;
-	infol_     = fit.infol_;
-	if (fit.value_string_) {
-		value_string_ = strdup(fit.value_string_);
-	} else {
-		value_string_ = NULL;
-	}
+	interface_         = fit.interface_;
+	infol_             = fit.infol_;
+	infol_end_         = fit.infol_end_;
+	data_              = fit.data_;
+	value_string_      = fit.value_string_;
+	have_value_string_ = fit.have_value_string_;
 }
 
 /** Destructor. */
 InterfaceFieldIterator::~InterfaceFieldIterator()
 {
-	if (value_string_)
-		free(value_string_);
 }
 
 /** Prefix increment.
@@ -92,10 +100,10 @@ InterfaceFieldIterator &
 InterfaceFieldIterator::operator++()
 {
 	if (infol_ != NULL) {
-		infol_ = infol_->next;
-		if (value_string_)
-			free(value_string_);
-		value_string_ = NULL;
+		if (++infol_ == infol_end_) {
+			infol_ = NULL;
+		}
+		have_value_string_ = false;
 	}
 
 	return *this;
@@ -146,7 +154,7 @@ InterfaceFieldIterator::operator+=(unsigned int i)
 bool
 InterfaceFieldIterator::operator==(const InterfaceFieldIterator &fi) const
 {
-	return (infol_ == fi.infol_);
+	return (infol_ == fi.infol_) && (infol_ == NULL || data_ == fi.data_);
 }
 
 /** Check iterators for inequality.
@@ -167,7 +175,7 @@ const void *InterfaceFieldIterator::operator*() const
 	if (infol_ == NULL) {
 		throw NullPointerException("Cannot get value of end element");
 	} else {
-		return infol_->value;
+		return field_value();
 	}
 }
 
@@ -178,8 +186,11 @@ const void *InterfaceFieldIterator::operator*() const
 InterfaceFieldIterator &
 InterfaceFieldIterator::operator=(const InterfaceFieldIterator &fi)
 {
-	interface_ = fi.interface_;
-	infol_     = fi.infol_;
+	interface_         = fi.interface_;
+	infol_             = fi.infol_;
+	infol_end_         = fi.infol_end_;
+	data_              = fi.data_;
+	have_value_string_ = false;
 
 	return *this;
 }
@@ -275,7 +286,7 @@ InterfaceFieldIterator::get_value() const
 	if (infol_ == NULL) {
 		throw NullPointerException("Cannot get value of end element");
 	} else {
-		return infol_->value;
+		return field_value();
 	}
 }
 
@@ -292,108 +303,156 @@ InterfaceFieldIterator::get_length() const
 	}
 }
 
+/// @cond INTERNALS
+namespace {
+
+void
+append_signed(std::string &s, long long v)
+{
+	char buf[24];
+#if __cplusplus >= 201703L
+	s.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+#else
+	s.append(buf, snprintf(buf, sizeof(buf), "%lli", v));
+#endif
+}
+
+void
+append_unsigned(std::string &s, unsigned long long v)
+{
+	char buf[24];
+#if __cplusplus >= 201703L
+	s.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+#else
+	s.append(buf, snprintf(buf, sizeof(buf), "%llu", v));
+#endif
+}
+
+void
+append_floating(std::string &s, double v)
+{
+	// large enough for any double in fixed notation, like printf's %f
+	char buf[512];
+#ifdef __cpp_lib_to_chars
+	s.append(buf, std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, 6).ptr - buf);
+#else
+	s.append(buf, snprintf(buf, sizeof(buf), "%f", v));
+#endif
+}
+
+template <typename T>
+bool field_type_matches(interface_fieldtype_t type);
+
+#define FIELD_TYPE_MATCHES(T, expr)                      \
+	template <>                                            \
+	bool field_type_matches<T>(interface_fieldtype_t type) \
+	{                                                      \
+		return expr;                                         \
+	}
+
+FIELD_TYPE_MATCHES(bool, type == IFT_BOOL)
+FIELD_TYPE_MATCHES(int8_t, type == IFT_INT8)
+FIELD_TYPE_MATCHES(uint8_t, type == IFT_UINT8 || type == IFT_BYTE)
+FIELD_TYPE_MATCHES(int16_t, type == IFT_INT16)
+FIELD_TYPE_MATCHES(uint16_t, type == IFT_UINT16)
+FIELD_TYPE_MATCHES(int32_t, type == IFT_INT32 || type == IFT_ENUM)
+FIELD_TYPE_MATCHES(uint32_t, type == IFT_UINT32)
+FIELD_TYPE_MATCHES(int64_t, type == IFT_INT64)
+FIELD_TYPE_MATCHES(uint64_t, type == IFT_UINT64)
+FIELD_TYPE_MATCHES(float, type == IFT_FLOAT)
+FIELD_TYPE_MATCHES(double, type == IFT_DOUBLE)
+FIELD_TYPE_MATCHES(char, type == IFT_STRING)
+
+#undef FIELD_TYPE_MATCHES
+
+} // namespace
+/// @endcond
+
 /** Get value of current field as string.
+ * The string is created on the first call and kept until the iterator is
+ * advanced. Use append_value_string() to avoid the copy or to format multiple
+ * fields into one buffer.
  * @param array_sep in the case that the field is an array the given string is
  * used to split the individual elements in the array string representation
  * @return field value as string
  */
 const char *
 InterfaceFieldIterator::get_value_string(const char *array_sep)
+{
+	if (!have_value_string_) {
+		value_string_.clear();
+		append_value_string(value_string_, array_sep);
+		have_value_string_ = true;
+	}
+	return value_string_.c_str();
+}
+
+/** Append value of current field as string.
+ * Formats the value in the same way as get_value_string(), but writes it
+ * to the end of the given string. The required capacity is reserved once,
+ * hence the time is linear in the number of array elements and no
+ * allocation is needed if the string already has sufficient capacity.
+ * @param s string to append the value to
+ * @param array_sep in the case that the field is an array the given string is
+ * used to split the individual elements in the array string representation
+ * @exception NullPointerException invalid iterator, possibly end iterator
+ */
+void
+InterfaceFieldIterator::append_value_string(std::string &s, const char *array_sep) const
 {
 	if (infol_ == NULL) {
 		throw NullPointerException("Cannot get value of end element");
-	} else {
-		if (value_string_ == NULL) {
-			if (infol_->length == 0)
-				throw OutOfBoundsException("Field length out of bounds",
-				                           infol_->length,
-				                           1,
-				                           (unsigned int)0xFFFFFFFF);
-
-			char *tmp1 = strdup("");
-			char *tmp2;
-
-			if (infol_->type != IFT_STRING) {
-				for (size_t i = 0; i < infol_->length; ++i) {
-					int rv = 0;
-					switch (infol_->type) {
-					case IFT_BOOL:
-						rv = asprintf(&tmp2, "%s%s", tmp1, (((bool *)infol_->value)[i]) ? "true" : "false");
-						break;
-					case IFT_INT8: rv = asprintf(&tmp2, "%s%i", tmp1, ((int8_t *)infol_->value)[i]); break;
-					case IFT_INT16: rv = asprintf(&tmp2, "%s%i", tmp1, ((int16_t *)infol_->value)[i]); break;
-					case IFT_INT32: rv = asprintf(&tmp2, "%s%i", tmp1, ((int32_t *)infol_->value)[i]); break;
-					case IFT_INT64:
-#if (defined(__WORDSIZE) && __WORDSIZE == 64) || (defined(LONG_BIT) && LONG_BIT == 64) \
-  || defined(__x86_64__)
-						rv = asprintf(&tmp2, "%s%li", tmp1, ((int64_t *)infol_->value)[i]);
-#else
-						rv = asprintf(&tmp2, "%s%lli", tmp1, ((int64_t *)infol_->value)[i]);
-#endif
-						break;
-					case IFT_UINT8: rv = asprintf(&tmp2, "%s%u", tmp1, ((uint8_t *)infol_->value)[i]); break;
-					case IFT_UINT16:
-						rv = asprintf(&tmp2, "%s%u", tmp1, ((uint16_t *)infol_->value)[i]);
-						break;
-					case IFT_UINT32:
-						rv = asprintf(&tmp2, "%s%u", tmp1, ((uint32_t *)infol_->value)[i]);
-						break;
-					case IFT_UINT64:
-#if (defined(__WORDSIZE) && __WORDSIZE == 64) || (defined(LONG_BIT) && LONG_BIT == 64) \
-  || defined(__x86_64__)
-						rv = asprintf(&tmp2, "%s%lu", tmp1, ((uint64_t *)infol_->value)[i]);
-#else
-						rv = asprintf(&tmp2, "%s%llu", tmp1, ((uint64_t *)infol_->value)[i]);
-#endif
-						break;
-					case IFT_FLOAT: rv = asprintf(&tmp2, "%s%f", tmp1, ((float *)infol_->value)[i]); break;
-					case IFT_DOUBLE: rv = asprintf(&tmp2, "%s%f", tmp1, ((double *)infol_->value)[i]); break;
-					case IFT_BYTE: rv = asprintf(&tmp2, "%s%u", tmp1, ((uint8_t *)infol_->value)[i]); break;
-					case IFT_STRING:
-						// cannot happen, caught with surrounding if statement
-
-					case IFT_ENUM:
-						rv = asprintf(&tmp2,
-						              "%s%s",
-						              tmp1,
-						              interface_->enum_tostring(infol_->enumtype, ((int *)infol_->value)[i]));
-						break;
-					}
-
-					if (rv == -1) {
-						throw OutOfMemoryException(
-						  "InterfaceFieldIterator::get_value_string(): asprintf() failed (1)");
-					}
-
-					free(tmp1);
-					tmp1 = tmp2;
-					if ((infol_->length > 1) && (i < infol_->length - 1)) {
-						if (asprintf(&tmp2, "%s%s", tmp1, array_sep) == -1) {
-							throw OutOfMemoryException(
-							  "InterfaceFieldIterator::get_value_string(): asprintf() failed (2)");
-						}
-						free(tmp1);
-						tmp1 = tmp2;
-					}
-				}
+	}
+	if (infol_->length == 0) {
+		throw OutOfBoundsException("Field length out of bounds",
+		                           infol_->length,
+		                           1,
+		                           (unsigned int)0xFFFFFFFF);
+	}
 
-				value_string_ = tmp1;
-			} else {
-				// it's a string, or a small number
-				if (infol_->length > 1) {
-					if (asprintf(&value_string_, "%s", (const char *)infol_->value) == -1) {
-						throw OutOfMemoryException(
-						  "InterfaceFieldIterator::get_value_string(): asprintf() failed (3)");
-					}
+	if (infol_->type == IFT_STRING) {
+		// it's a string, or a single character
+		const char *str = (const char *)field_value();
+		s.append(str, strnlen(str, infol_->length));
+		return;
+	}
+
+	const size_t sep_len = strlen(array_sep);
+	s.reserve(s.size() + infol_->length * (12 + sep_len));
+
+	for (size_t i = 0; i < infol_->length; ++i) {
+		if (i > 0) {
+			s.append(array_sep, sep_len);
+		}
+		switch (infol_->type) {
+		case IFT_BOOL: s += ((bool *)field_value())[i] ? "true" : "false"; break;
+		case IFT_INT8: append_signed(s, ((int8_t *)field_value())[i]); break;
+		case IFT_INT16: append_signed(s, ((int16_t *)field_value())[i]); break;
+		case IFT_INT32: append_signed(s, ((int32_t *)field_value())[i]); break;
+		case IFT_INT64: append_signed(s, ((int64_t *)field_value())[i]); break;
+		case IFT_UINT8: append_unsigned(s, ((uint8_t *)field_value())[i]); break;
+		case IFT_UINT16: append_unsigned(s, ((uint16_t *)field_value())[i]); break;
+		case IFT_UINT32: append_unsigned(s, ((uint32_t *)field_value())[i]); break;
+		case IFT_UINT64: append_unsigned(s, ((uint64_t *)field_value())[i]); break;
+		case IFT_FLOAT: append_floating(s, ((float *)field_value())[i]); break;
+		case IFT_DOUBLE: append_floating(s, ((double *)field_value())[i]); break;
+		case IFT_BYTE: append_unsigned(s, ((uint8_t *)field_value())[i]); break;
+		case IFT_STRING:
+			// cannot happen, handled above
+			break;
+		case IFT_ENUM:
+			if (infol_->enum_map) {
+				interface_enum_map_t::const_iterator ev = infol_->enum_map->find(((int *)field_value())[i]);
+				if (ev != infol_->enum_map->end()) {
+					s += ev->second;
 				} else {
-					if (asprintf(&value_string_, "%c", *((const char *)infol_->value)) == -1) {
-						throw OutOfMemoryException(
-						  "InterfaceFieldIterator::get_value_string(): asprintf() failed (4)");
-					}
+					s += "UNKNOWN";
 				}
+			} else {
+				s += interface_->enum_tostring(infol_->enumtype, ((int *)field_value())[i]);
 			}
+			break;
 		}
-		return value_string_;
 	}
 }
 
@@ -414,7 +473,7 @@ InterfaceFieldIterator::get_bool(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((bool *)infol_->value)[index];
+		return ((bool *)field_value())[index];
 	}
 }
 
@@ -435,7 +494,7 @@ InterfaceFieldIterator::get_int8(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((int8_t *)infol_->value)[index];
+		return ((int8_t *)field_value())[index];
 	}
 }
 
@@ -456,7 +515,7 @@ InterfaceFieldIterator::get_uint8(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((uint8_t *)infol_->value)[index];
+		return ((uint8_t *)field_value())[index];
 	}
 }
 
@@ -477,7 +536,7 @@ InterfaceFieldIterator::get_int16(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((int16_t *)infol_->value)[index];
+		return ((int16_t *)field_value())[index];
 	}
 }
 
@@ -498,7 +557,7 @@ InterfaceFieldIterator::get_uint16(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((uint16_t *)infol_->value)[index];
+		return ((uint16_t *)field_value())[index];
 	}
 }
 
@@ -519,7 +578,7 @@ InterfaceFieldIterator::get_int32(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((int32_t *)infol_->value)[index];
+		return ((int32_t *)field_value())[index];
 	}
 }
 
@@ -540,7 +599,7 @@ InterfaceFieldIterator::get_uint32(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((uint32_t *)infol_->value)[index];
+		return ((uint32_t *)field_value())[index];
 	}
 }
 
@@ -561,7 +620,7 @@ InterfaceFieldIterator::get_int64(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((int64_t *)infol_->value)[index];
+		return ((int64_t *)field_value())[index];
 	}
 }
 
@@ -582,7 +641,7 @@ InterfaceFieldIterator::get_uint64(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((uint64_t *)infol_->value)[index];
+		return ((uint64_t *)field_value())[index];
 	}
 }
 
@@ -603,7 +662,7 @@ InterfaceFieldIterator::get_float(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((float *)infol_->value)[index];
+		return ((float *)field_value())[index];
 	}
 }
 
@@ -624,7 +683,7 @@ InterfaceFieldIterator::get_double(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((double *)infol_->value)[index];
+		return ((double *)field_value())[index];
 	}
 }
 
@@ -645,7 +704,7 @@ InterfaceFieldIterator::get_byte(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((uint8_t *)infol_->value)[index];
+		return ((uint8_t *)field_value())[index];
 	}
 }
 
@@ -666,7 +725,7 @@ InterfaceFieldIterator::get_enum(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		return ((int32_t *)infol_->value)[index];
+		return ((int32_t *)field_value())[index];
 	}
 }
 
@@ -689,7 +748,7 @@ InterfaceFieldIterator::get_enum_string(unsigned int index) const
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		int32_t                              int_val = ((int32_t *)infol_->value)[index];
+		int32_t                              int_val = ((int32_t *)field_value())[index];
 		interface_enum_map_t::const_iterator ev      = infol_->enum_map->find(int_val);
 		if (ev == infol_->enum_map->end()) {
 			throw IllegalArgumentException("Integer value is not a canonical enum value");
@@ -714,7 +773,7 @@ InterfaceFieldIterator::get_bools() const
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		return (bool *)infol_->value;
+		return (bool *)field_value();
 	}
 }
 
@@ -732,7 +791,7 @@ InterfaceFieldIterator::get_int8s() const
 	} else if (infol_->type != IFT_INT8) {
 		throw TypeMismatchException("Requested value is not of type int");
 	} else {
-		return (int8_t *)infol_->value;
+		return (int8_t *)field_value();
 	}
 }
 
@@ -750,7 +809,7 @@ InterfaceFieldIterator::get_uint8s() const
 	} else if (infol_->type != IFT_UINT8) {
 		throw TypeMismatchException("Requested value is not of type unsigned int");
 	} else {
-		return (uint8_t *)infol_->value;
+		return (uint8_t *)field_value();
 	}
 }
 
@@ -768,7 +827,7 @@ InterfaceFieldIterator::get_int16s() const
 	} else if (infol_->type != IFT_INT16) {
 		throw TypeMismatchException("Requested value is not of type int");
 	} else {
-		return (int16_t *)infol_->value;
+		return (int16_t *)field_value();
 	}
 }
 
@@ -786,7 +845,7 @@ InterfaceFieldIterator::get_uint16s() const
 	} else if (infol_->type != IFT_UINT16) {
 		throw TypeMismatchException("Requested value is not of type unsigned int");
 	} else {
-		return (uint16_t *)infol_->value;
+		return (uint16_t *)field_value();
 	}
 }
 
@@ -804,7 +863,7 @@ InterfaceFieldIterator::get_int32s() const
 	} else if (infol_->type != IFT_INT32) {
 		throw TypeMismatchException("Requested value is not of type int");
 	} else {
-		return (int32_t *)infol_->value;
+		return (int32_t *)field_value();
 	}
 }
 
@@ -822,7 +881,7 @@ InterfaceFieldIterator::get_uint32s() const
 	} else if (infol_->type != IFT_UINT32) {
 		throw TypeMismatchException("Requested value is not of type unsigned int");
 	} else {
-		return (uint32_t *)infol_->value;
+		return (uint32_t *)field_value();
 	}
 }
 
@@ -840,7 +899,7 @@ InterfaceFieldIterator::get_int64s() const
 	} else if (infol_->type != IFT_INT64) {
 		throw TypeMismatchException("Requested value is not of type int");
 	} else {
-		return (int64_t *)infol_->value;
+		return (int64_t *)field_value();
 	}
 }
 
@@ -858,7 +917,7 @@ InterfaceFieldIterator::get_uint64s() const
 	} else if (infol_->type != IFT_UINT64) {
 		throw TypeMismatchException("Requested value is not of type unsigned int");
 	} else {
-		return (uint64_t *)infol_->value;
+		return (uint64_t *)field_value();
 	}
 }
 
@@ -876,7 +935,7 @@ InterfaceFieldIterator::get_floats() const
 	} else if (infol_->type != IFT_FLOAT) {
 		throw TypeMismatchException("Requested value is not of type float");
 	} else {
-		return (float *)infol_->value;
+		return (float *)field_value();
 	}
 }
 
@@ -894,7 +953,7 @@ InterfaceFieldIterator::get_doubles() const
 	} else if (infol_->type != IFT_DOUBLE) {
 		throw TypeMismatchException("Requested value is not of type double");
 	} else {
-		return (double *)infol_->value;
+		return (double *)field_value();
 	}
 }
 
@@ -912,7 +971,7 @@ InterfaceFieldIterator::get_bytes() const
 	} else if (infol_->type != IFT_BYTE) {
 		throw TypeMismatchException("Requested value is not of type byte");
 	} else {
-		return (uint8_t *)infol_->value;
+		return (uint8_t *)field_value();
 	}
 }
 
@@ -930,7 +989,7 @@ InterfaceFieldIterator::get_enums() const
 	} else if (infol_->type != IFT_ENUM) {
 		throw TypeMismatchException("Requested value is not of type enum");
 	} else {
-		return (int32_t *)infol_->value;
+		return (int32_t *)field_value();
 	}
 }
 
@@ -947,10 +1006,46 @@ InterfaceFieldIterator::get_string() const
 	} else if (infol_->type != IFT_STRING) {
 		throw TypeMismatchException("Requested value is not of type string");
 	} else {
-		return (const char *)infol_->value;
+		return (const char *)field_value();
 	}
 }
 
+/** Get view on the values of the current field.
+ * This allows to access all values of an array field without copying or
+ * formatting them, e.g., get_values<float>() for a float array. For enums
+ * use int32_t, for byte fields uint8_t, and for strings char.
+ * @return view on the field's values
+ * @exception NullPointerException invalid iterator, possibly end iterator
+ * @exception TypeMismatchException thrown if the field is not of type T
+ */
+template <typename T>
+InterfaceFieldValues<T>
+InterfaceFieldIterator::get_values() const
+{
+	if (infol_ == NULL) {
+		throw NullPointerException("Cannot get value of end element");
+	} else if (!field_type_matches<T>(infol_->type)) {
+		throw TypeMismatchException("Requested values do not match field type %s", get_typename());
+	} else {
+		return InterfaceFieldValues<T>((const T *)field_value(), infol_->length);
+	}
+}
+
+/// @cond INTERNALS
+template InterfaceFieldValues<bool>     InterfaceFieldIterator::get_values<bool>() const;
+template InterfaceFieldValues<int8_t>   InterfaceFieldIterator::get_values<int8_t>() const;
+template InterfaceFieldValues<uint8_t>  InterfaceFieldIterator::get_values<uint8_t>() const;
+template InterfaceFieldValues<int16_t>  InterfaceFieldIterator::get_values<int16_t>() const;
+template InterfaceFieldValues<uint16_t> InterfaceFieldIterator::get_values<uint16_t>() const;
+template InterfaceFieldValues<int32_t>  InterfaceFieldIterator::get_values<int32_t>() const;
+template InterfaceFieldValues<uint32_t> InterfaceFieldIterator::get_values<uint32_t>() const;
+template InterfaceFieldValues<int64_t>  InterfaceFieldIterator::get_values<int64_t>() const;
+template InterfaceFieldValues<uint64_t> InterfaceFieldIterator::get_values<uint64_t>() const;
+template InterfaceFieldValues<float>    InterfaceFieldIterator::get_values<float>() const;
+template InterfaceFieldValues<double>   InterfaceFieldIterator::get_values<double>() const;
+template InterfaceFieldValues<char>     InterfaceFieldIterator::get_values<char>() const;
+/// @endcond
+
 /** Set value of current field as bool.
  * @param v the new value
  * @param index array index (only use if field is an array)
@@ -968,7 +1063,7 @@ InterfaceFieldIterator::set_bool(bool v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(bool);
+		char *dst = (char *)field_value() + index * sizeof(bool);
 		memcpy((void *)dst, &v, sizeof(bool));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -992,7 +1087,7 @@ InterfaceFieldIterator::set_int8(int8_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(int8_t);
+		char *dst = (char *)field_value() + index * sizeof(int8_t);
 		memcpy((void *)dst, &v, sizeof(int8_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1016,7 +1111,7 @@ InterfaceFieldIterator::set_uint8(uint8_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(uint8_t);
+		char *dst = (char *)field_value() + index * sizeof(uint8_t);
 		memcpy((void *)dst, &v, sizeof(uint8_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1040,7 +1135,7 @@ InterfaceFieldIterator::set_int16(int16_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(int16_t);
+		char *dst = (char *)field_value() + index * sizeof(int16_t);
 		memcpy((void *)dst, &v, sizeof(int16_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1064,7 +1159,7 @@ InterfaceFieldIterator::set_uint16(uint16_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(uint16_t);
+		char *dst = (char *)field_value() + index * sizeof(uint16_t);
 		memcpy((void *)dst, &v, sizeof(uint16_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1088,7 +1183,7 @@ InterfaceFieldIterator::set_int32(int32_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(int32_t);
+		char *dst = (char *)field_value() + index * sizeof(int32_t);
 		memcpy((void *)dst, &v, sizeof(int32_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1112,7 +1207,7 @@ InterfaceFieldIterator::set_uint32(uint32_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(uint32_t);
+		char *dst = (char *)field_value() + index * sizeof(uint32_t);
 		memcpy((void *)dst, &v, sizeof(uint32_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1136,7 +1231,7 @@ InterfaceFieldIterator::set_int64(int64_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(int64_t);
+		char *dst = (char *)field_value() + index * sizeof(int64_t);
 		memcpy((void *)dst, &v, sizeof(int64_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1160,7 +1255,7 @@ InterfaceFieldIterator::set_uint64(uint64_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(uint64_t);
+		char *dst = (char *)field_value() + index * sizeof(uint64_t);
 		memcpy((void *)dst, &v, sizeof(uint64_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1184,7 +1279,7 @@ InterfaceFieldIterator::set_float(float v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(float);
+		char *dst = (char *)field_value() + index * sizeof(float);
 		memcpy((void *)dst, &v, sizeof(float));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1208,7 +1303,7 @@ InterfaceFieldIterator::set_double(double v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(double);
+		char *dst = (char *)field_value() + index * sizeof(double);
 		memcpy((void *)dst, &v, sizeof(double));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1232,7 +1327,7 @@ InterfaceFieldIterator::set_byte(uint8_t v, unsigned int index)
 	} else if (index >= infol_->length) {
 		throw OutOfBoundsException("Field index out of bounds", index, 0, infol_->length);
 	} else {
-		char *dst = (char *)infol_->value + index * sizeof(uint8_t);
+		char *dst = (char *)field_value() + index * sizeof(uint8_t);
 		memcpy((void *)dst, &v, sizeof(uint8_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1260,7 +1355,7 @@ InterfaceFieldIterator::set_enum(int32_t e, unsigned int index)
 		if (ev == infol_->enum_map->end()) {
 			throw IllegalArgumentException("Integer value is not a canonical enum value");
 		}
-		char *dst = (char *)infol_->value + index * sizeof(int32_t);
+		char *dst = (char *)field_value() + index * sizeof(int32_t);
 		memcpy((void *)dst, &e, sizeof(int32_t));
 		if (interface_)
 			interface_->mark_data_changed();
@@ -1287,7 +1382,7 @@ InterfaceFieldIterator::set_enum_string(const char *e, unsigned int index)
 		interface_enum_map_t::const_iterator ev;
 		for (ev = infol_->enum_map->begin(); ev != infol_->enum_map->end(); ++ev) {
 			if (ev->second == e) {
-				char *dst = (char *)infol_->value + index * sizeof(int32_t);
+				char *dst = (char *)field_value() + index * sizeof(int32_t);
 				memcpy((void *)dst, &ev->first, sizeof(int32_t));
 				if (interface_)
 					interface_->mark_data_changed();
@@ -1315,7 +1410,7 @@ InterfaceFieldIterator::set_bools(bool *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(bool));
+		memcpy(field_value(), v, infol_->length * sizeof(bool));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1337,7 +1432,7 @@ InterfaceFieldIterator::set_int8s(int8_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(int8_t));
+		memcpy(field_value(), v, infol_->length * sizeof(int8_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1359,7 +1454,7 @@ InterfaceFieldIterator::set_uint8s(uint8_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(uint8_t));
+		memcpy(field_value(), v, infol_->length * sizeof(uint8_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1381,7 +1476,7 @@ InterfaceFieldIterator::set_int16s(int16_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(int16_t));
+		memcpy(field_value(), v, infol_->length * sizeof(int16_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1403,7 +1498,7 @@ InterfaceFieldIterator::set_uint16s(uint16_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(uint16_t));
+		memcpy(field_value(), v, infol_->length * sizeof(uint16_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1425,7 +1520,7 @@ InterfaceFieldIterator::set_int32s(int32_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(int32_t));
+		memcpy(field_value(), v, infol_->length * sizeof(int32_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1447,7 +1542,7 @@ InterfaceFieldIterator::set_uint32s(uint32_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(uint32_t));
+		memcpy(field_value(), v, infol_->length * sizeof(uint32_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1469,7 +1564,7 @@ InterfaceFieldIterator::set_int64s(int64_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(int64_t));
+		memcpy(field_value(), v, infol_->length * sizeof(int64_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1491,7 +1586,7 @@ InterfaceFieldIterator::set_uint64s(uint64_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(uint64_t));
+		memcpy(field_value(), v, infol_->length * sizeof(uint64_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1513,7 +1608,7 @@ InterfaceFieldIterator::set_floats(float *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(float));
+		memcpy(field_value(), v, infol_->length * sizeof(float));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1535,7 +1630,7 @@ InterfaceFieldIterator::set_doubles(double *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(double));
+		memcpy(field_value(), v, infol_->length * sizeof(double));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1557,7 +1652,7 @@ InterfaceFieldIterator::set_bytes(uint8_t *v)
 	} else if (infol_->length == 1) {
 		throw TypeMismatchException("Field %s is not an array", infol_->name);
 	} else {
-		memcpy(infol_->value, v, infol_->length * sizeof(uint8_t));
+		memcpy(field_value(), v, infol_->length * sizeof(uint8_t));
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -1576,7 +1671,7 @@ InterfaceFieldIterator::set_string(const char *v)
 	} else if (infol_->type != IFT_STRING) {
 		throw TypeMismatchException("Field to be written is not of type string");
 	} else {
-		strncpy((char *)infol_->value, v, infol_->length);
+		strncpy((char *)field_value(), v, infol_->length);
 		if (interface_)
 			interface_->mark_data_changed();
 	}
@@ -28,13 +28,79 @@
 #include <interface/types.h>
 
 #define __STD_LIMIT_MACROS
+#include <cstddef>
 #include <list>
 #include <stdint.h>
+#include <string>
 
 namespace fawkes {
 class Interface;
 class Message;
 
+/** Read-only view on the values of an interface field.
+ * The view refers to the interface's data and remains valid as long as the
+ * interface exists. It can be used to access array fields without copying
+ * or formatting them.
+ * @author agent
+ */
+template <typename T>
+class InterfaceFieldValues
+{
+public:
+	/** Constructor.
+	 * @param data pointer to first value
+	 * @param size number of values
+	 */
+	InterfaceFieldValues(const T *data, size_t size) : data_(data), size_(size)
+	{
+	}
+
+	/** Get pointer to first value.
+	 * @return pointer to first value */
+	const T *
+	data() const
+	{
+		return data_;
+	}
+
+	/** Get number of values.
+	 * @return number of values */
+	size_t
+	size() const
+	{
+		return size_;
+	}
+
+	/** Get iterator to first value.
+	 * @return iterator to first value */
+	const T *
+	begin() const
+	{
+		return data_;
+	}
+
+	/** Get iterator past the last value.
+	 * @return iterator past the last value */
+	const T *
+	end() const
+	{
+		return data_ + size_;
+	}
+
+	/** Access value, the index is not checked.
+	 * @param i index of value
+	 * @return value at index i */
+	const T &
+	operator[](size_t i) const
+	{
+		return data_[i];
+	}
+
+private:
+	const T *data_;
+	size_t   size_;
+};
+
 class InterfaceFieldIterator
 {
 	friend Interface;
@@ -60,6 +126,7 @@ public:
 	const char *            get_name() const;
 	const void *            get_value() const;
 	const char *            get_value_string(const char *array_sep = ", ");
+	void                    append_value_string(std::string &s, const char *array_sep = ", ") const;
 	size_t                  get_length() const;
 	bool                    get_bool(unsigned int index = 0) const;
 	int8_t                  get_int8(unsigned int index = 0) const;
@@ -90,6 +157,9 @@ public:
 	int32_t *               get_enums() const;
 	const char *            get_string() const;
 
+	template <typename T>
+	InterfaceFieldValues<T> get_values() const;
+
 	void set_bool(bool b, unsigned int index = 0);
 	void set_int8(int8_t i, unsigned int index = 0);
 	void set_uint8(uint8_t i, unsigned int index = 0);
@@ -119,11 +189,26 @@ public:
 	void set_string(const char *s);
 
 protected:
-	InterfaceFieldIterator(Interface *interface, const interface_fieldinfo_t *info_list);
+	InterfaceFieldIterator(Interface *                  interface,
+	                       const interface_fieldinfo_t *info_list,
+	                       unsigned int                 num_fields,
+	                       void *                       data);
+
+private:
+	/** Get pointer to value of current field.
+	 * @return pointer to value in data chunk */
+	void *
+	field_value() const
+	{
+		return data_ + infol_->offset;
+	}
 
 private:
 	const interface_fieldinfo_t *infol_;
-	char *                       value_string_;
+	const interface_fieldinfo_t *infol_end_;
+	char *                       data_;
+	std::string                  value_string_;
+	bool                         have_value_string_;
 	Interface *                  interface_;
 };
 
@@ -24,6 +24,7 @@
 #include <core/threading/mutex.h>
 #include <core/threading/mutex_locker.h>
 #include <core/threading/refc_rwlock.h>
+#include <core/utils/metrics.h>
 #include <interface/interface.h>
 #include <interface/mediators/interface_mediator.h>
 #include <interface/mediators/message_mediator.h>
@@ -31,7 +32,9 @@
 #include <utils/time/clock.h>
 #include <utils/time/time.h>
 
+#include <atomic>
 #include <cerrno>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -115,6 +118,53 @@ InterfaceInvalidException::InterfaceInvalidException(const Interface *interface,
 {
 }
 
+/// @cond INTERNALS
+/* Process-wide statistics about waiting for interface data locks. They
+ * are only updated if a lock could not be acquired immediately, the
+ * uncontended path costs no more than before.
+ */
+static std::atomic<uint64_t> lock_contentions_(0);
+static std::atomic<uint64_t> lock_wait_nsec_(0);
+
+static void
+account_lock_wait(const std::chrono::steady_clock::time_point &start)
+{
+	std::chrono::nanoseconds wait = std::chrono::steady_clock::now() - start;
+	lock_contentions_.fetch_add(1, std::memory_order_relaxed);
+	lock_wait_nsec_.fetch_add(wait.count(), std::memory_order_relaxed);
+}
+
+static inline void
+lock_for_read(RefCountRWLock *rwlock)
+{
+	if (!rwlock->try_lock_for_read()) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		rwlock->lock_for_read();
+		account_lock_wait(start);
+	}
+}
+
+static inline void
+lock_for_write(RefCountRWLock *rwlock)
+{
+	if (!rwlock->try_lock_for_write()) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		rwlock->lock_for_write();
+		account_lock_wait(start);
+	}
+}
+
+/* Runtime of blackboard operations, exported with the core metrics. */
+static MetricHistogram *
+operation_runtime(const char *op)
+{
+	return MetricSet::core().histogram("fawkes_blackboard_operation_seconds",
+	                                   "Time spent in blackboard interface operations",
+	                                   {1e-6, 5e-6, 1e-5, 5e-5, 1e-4, 5e-4, 1e-3, 5e-3, 1e-2},
+	                                   {{"op", op}});
+}
+/// @endcond
+
 /** @class Interface <interface/interface.h>
  * Base class for all Fawkes BlackBoard interfaces.
  *
@@ -267,13 +317,6 @@ Interface::~Interface()
 	delete message_queue_;
 	if (buffers_)
 		free(buffers_);
-	// free fieldinfo list
-	interface_fieldinfo_t *finfol = fieldinfo_list_;
-	while (finfol) {
-		fieldinfo_list_ = fieldinfo_list_->next;
-		free(finfol);
-		finfol = fieldinfo_list_;
-	}
 	// free messageinfo list
 	interface_messageinfo_t *minfol = messageinfo_list_;
 	while (minfol) {
@@ -321,48 +364,19 @@ Interface::set_hash(unsigned char *ihash)
 	}
 }
 
-/** Add an entry to the field info list.
- * Never use directly, use the interface generator instead. The info list
+/** Set the field info table.
+ * Never use directly, use the interface generator instead. The field info
  * is used for introspection purposes to allow for iterating over all fields
- * of an interface.
- * @param type field type
- * @param name name of the field, this is referenced, not copied
- * @param length length of the field
- * @param value pointer to the value in the data struct
- * @param enumtype name of the enum type, valid only if type == IFT_ENUM.
- * @param enum_map enum value map
+ * of an interface. The table is referenced, not copied, and is shared among
+ * all instances of an interface type.
+ * @param fieldinfo field info table
+ * @param num_fields number of entries in the table
  */
 void
-Interface::add_fieldinfo(interface_fieldtype_t       type,
-                         const char *                name,
-                         size_t                      length,
-                         void *                      value,
-                         const char *                enumtype,
-                         const interface_enum_map_t *enum_map)
-{
-	interface_fieldinfo_t *infol   = fieldinfo_list_;
-	interface_fieldinfo_t *newinfo = (interface_fieldinfo_t *)malloc(sizeof(interface_fieldinfo_t));
-
-	newinfo->type     = type;
-	newinfo->enumtype = enumtype;
-	newinfo->name     = name;
-	newinfo->length   = length;
-	newinfo->value    = value;
-	newinfo->enum_map = enum_map;
-	newinfo->next     = NULL;
-
-	if (infol == NULL) {
-		// first entry
-		fieldinfo_list_ = newinfo;
-	} else {
-		// append to list
-		while (infol->next != NULL) {
-			infol = infol->next;
-		}
-		infol->next = newinfo;
-	}
-
-	++num_fields_;
+Interface::set_fieldinfo(const interface_fieldinfo_t *fieldinfo, unsigned int num_fields)
+{
+	fieldinfo_list_ = fieldinfo;
+	num_fields_     = num_fields;
 }
 
 /** Add an entry to the message info list.
@@ -471,7 +485,10 @@ Interface::is_valid() const
 void
 Interface::read()
 {
-	rwlock_->lock_for_read();
+	static MetricHistogram *runtime = operation_runtime("read");
+	MetricHistogram::Timer  timer(runtime);
+
+	lock_for_read(rwlock_);
 	data_mutex_->lock();
 	if (valid_) {
 		memcpy(data_ptr, mem_data_ptr_, data_size);
@@ -486,6 +503,49 @@ Interface::read()
 	rwlock_->unlock();
 }
 
+/** Read from BlackBoard into local copy if the data has changed.
+ * This compares the timestamp of the data in the BlackBoard to the
+ * timestamp of the local copy and only copies the data if they differ.
+ * Afterwards changed() returns the same result as after read(). Note
+ * that, unlike read(), local modifications of the data are not reverted
+ * if the data in the BlackBoard has not changed. Writing instances
+ * always read the data.
+ * @return true if the data has changed since the last read, false otherwise
+ * @exception InterfaceInvalidException thrown if the interface has
+ * been marked invalid
+ */
+bool
+Interface::read_if_changed()
+{
+	if (write_access_) {
+		read();
+		return true;
+	}
+
+	static MetricHistogram *runtime = operation_runtime("read");
+	MetricHistogram::Timer  timer(runtime);
+
+	lock_for_read(rwlock_);
+	data_mutex_->lock();
+	if (!valid_) {
+		data_mutex_->unlock();
+		rwlock_->unlock();
+		throw InterfaceInvalidException(this, "read_if_changed()");
+	}
+	const interface_data_ts_t *mem_ts = (const interface_data_ts_t *)mem_data_ptr_;
+
+	bool changed = (mem_ts->timestamp_sec != data_ts->timestamp_sec)
+	               || (mem_ts->timestamp_usec != data_ts->timestamp_usec);
+	if (changed) {
+		memcpy(data_ptr, mem_data_ptr_, data_size);
+	}
+	*local_read_timestamp_ = *timestamp_;
+	timestamp_->set_time(data_ts->timestamp_sec, data_ts->timestamp_usec);
+	data_mutex_->unlock();
+	rwlock_->unlock();
+	return changed;
+}
+
 /** Write from local copy into BlackBoard memory.
  * @exception InterfaceInvalidException thrown if the interface has
  * been marked invalid
@@ -493,11 +553,14 @@ Interface::read()
 void
 Interface::write()
 {
+	static MetricHistogram *runtime = operation_runtime("write");
+	MetricHistogram::Timer  timer(runtime);
+
 	if (!write_access_) {
 		throw InterfaceWriteDeniedException(type_, id_, "Cannot write.");
 	}
 
-	rwlock_->lock_for_write();
+	lock_for_write(rwlock_);
 	data_mutex_->lock();
 	if (valid_) {
 		if (data_changed) {
@@ -878,6 +941,9 @@ Interface::readers() const
 unsigned int
 Interface::msgq_enqueue(Message *message)
 {
+	static MetricHistogram *runtime = operation_runtime("msgq_enqueue");
+	MetricHistogram::Timer  timer(runtime);
+
 	if (write_access_) {
 		throw InterfaceMessageEnqueueException(type_, id_);
 	}
@@ -916,6 +982,9 @@ Interface::msgq_enqueue(Message *message)
 unsigned int
 Interface::msgq_enqueue_copy(Message *message)
 {
+	static MetricHistogram *runtime = operation_runtime("msgq_enqueue");
+	MetricHistogram::Timer  timer(runtime);
+
 	if (write_access_) {
 		throw InterfaceMessageEnqueueException(type_, id_);
 	}
@@ -1194,7 +1263,7 @@ Interface::msgq_pop()
 InterfaceFieldIterator
 Interface::fields()
 {
-	return InterfaceFieldIterator(this, fieldinfo_list_);
+	return InterfaceFieldIterator(this, fieldinfo_list_, num_fields_, data_ptr);
 }
 
 /** Invalid iterator.
@@ -1410,4 +1479,27 @@ Interface::parse_uid(const char *uid, std::string &type, std::string &id)
 	regfree(&re);
 }
 
+/** Get number of contended interface data locks.
+ * This counts, for all interfaces of this process, how often read() or
+ * write() had to wait for the interface data lock because it was held
+ * by another instance.
+ * @return number of times a lock had to be waited for
+ */
+uint64_t
+Interface::lock_contentions()
+{
+	return lock_contentions_.load(std::memory_order_relaxed);
+}
+
+/** Get time spent waiting for interface data locks.
+ * @return total time in seconds read() and write() calls of all
+ * interfaces of this process waited for interface data locks
+ * @see lock_contentions()
+ */
+double
+Interface::lock_wait_time()
+{
+	return lock_wait_nsec_.load(std::memory_order_relaxed) / 1e9;
+}
+
 } // end namespace fawkes
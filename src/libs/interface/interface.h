@@ -50,6 +50,7 @@ class BlackBoardInterfaceManager;
 class BlackBoardInstanceFactory;
 class BlackBoardMessageManager;
 class BlackBoardInterfaceProxy;
+class InterfaceCodec;
 
 class InterfaceWriteDeniedException : public Exception
 {
@@ -81,6 +82,7 @@ class Interface
 	friend BlackBoardInstanceFactory;
 	friend BlackBoardMessageManager;
 	friend BlackBoardInterfaceProxy;
+	friend InterfaceCodec;
 
 public:
 	virtual ~Interface();
@@ -118,6 +120,7 @@ public:
 	void         buffer_timestamp(unsigned int buffer, Time *timestamp);
 
 	void read();
+	bool read_if_changed();
 	void write();
 
 	bool                   has_writer() const;
@@ -208,17 +211,16 @@ public:
 	/* Convenience */
 	static void parse_uid(const char *uid, std::string &type, std::string &id);
 
+	/* Statistics */
+	static uint64_t lock_contentions();
+	static double   lock_wait_time();
+
 protected:
 	Interface();
 	virtual bool message_valid(const Message *message) const = 0;
 
 	void set_hash(unsigned char *ihash);
-	void add_fieldinfo(interface_fieldtype_t       type,
-	                   const char *                name,
-	                   size_t                      length,
-	                   void *                      value,
-	                   const char *                enumtype = 0,
-	                   const interface_enum_map_t *enum_map = 0);
+	void set_fieldinfo(const interface_fieldinfo_t *fieldinfo, unsigned int num_fields);
 	void add_messageinfo(const char *name);
 
 	void *       data_ptr;
@@ -267,8 +269,8 @@ private:
 	MessageQueue *     message_queue_;
 	unsigned short     next_message_id_;
 
-	interface_fieldinfo_t *  fieldinfo_list_;
-	interface_messageinfo_t *messageinfo_list_;
+	const interface_fieldinfo_t *fieldinfo_list_;
+	interface_messageinfo_t *    messageinfo_list_;
 
 	unsigned int num_fields_;
 
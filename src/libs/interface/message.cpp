@@ -101,25 +101,13 @@ Message::Message(const Message &mesg)
 	_sender_thread_name = strdup(mesg.sender_thread_name());
 	_type               = strdup(mesg._type);
 	time_enqueued_      = new Time(mesg.time_enqueued_);
-	fieldinfo_list_     = NULL;
+	fieldinfo_list_     = mesg.fieldinfo_list_;
 
 	_transmit_via_iface              = NULL;
 	sender_interface_instance_serial = 0;
 	recipient_interface_mem_serial   = 0;
 
 	memcpy(data_ptr, mesg.data_ptr, data_size);
-
-	interface_fieldinfo_t * info_src  = mesg.fieldinfo_list_;
-	interface_fieldinfo_t **info_dest = &fieldinfo_list_;
-	while (info_src) {
-		interface_fieldinfo_t *new_info =
-		  (interface_fieldinfo_t *)malloc(sizeof(interface_fieldinfo_t));
-		memcpy(new_info, info_src, sizeof(interface_fieldinfo_t));
-		*info_dest = new_info;
-
-		info_dest = &((*info_dest)->next);
-		info_src  = info_src->next;
-	}
 }
 
 /** Copy constructor.
@@ -141,21 +129,9 @@ Message::Message(const Message *mesg)
 	sender_interface_instance_serial = 0;
 	recipient_interface_mem_serial   = 0;
 	time_enqueued_                   = new Time(mesg->time_enqueued_);
-	fieldinfo_list_                  = NULL;
+	fieldinfo_list_                  = mesg->fieldinfo_list_;
 
 	memcpy(data_ptr, mesg->data_ptr, data_size);
-
-	interface_fieldinfo_t * info_src  = mesg->fieldinfo_list_;
-	interface_fieldinfo_t **info_dest = &fieldinfo_list_;
-	while (info_src) {
-		interface_fieldinfo_t *new_info =
-		  (interface_fieldinfo_t *)malloc(sizeof(interface_fieldinfo_t));
-		memcpy(new_info, info_src, sizeof(interface_fieldinfo_t));
-		*info_dest = new_info;
-
-		info_dest = &((*info_dest)->next);
-		info_src  = info_src->next;
-	}
 }
 
 /** Destructor. */
@@ -164,13 +140,6 @@ Message::~Message()
 	free(_sender_thread_name);
 	free(_type);
 	delete time_enqueued_;
-
-	interface_fieldinfo_t *infol = fieldinfo_list_;
-	while (infol) {
-		fieldinfo_list_ = fieldinfo_list_->next;
-		free(infol);
-		infol = fieldinfo_list_;
-	}
 }
 
 /** Get message ID.
@@ -354,7 +323,7 @@ Message::type() const
 InterfaceFieldIterator
 Message::fields()
 {
-	return InterfaceFieldIterator(_transmit_via_iface, fieldinfo_list_);
+	return InterfaceFieldIterator(_transmit_via_iface, fieldinfo_list_, num_fields_, data_ptr);
 }
 
 /** Invalid iterator.
@@ -385,48 +354,19 @@ Message::clone() const
 	return new Message(this);
 }
 
-/** Add an entry to the info list.
- * Never use directly, use the interface generator instead. The info list
+/** Set the field info table.
+ * Never use directly, use the interface generator instead. The field info
  * is used for introspection purposes to allow for iterating over all fields
- * of an interface.
- * @param type field type
- * @param name name of the field, this is referenced, not copied
- * @param length length of the field
- * @param value pointer to the value in the data struct
- * @param enumtype in case the type parameter is enum the name of the enum type
- * @param enum_map enum value map
+ * of a message. The table is referenced, not copied, and is shared among
+ * all instances of a message type.
+ * @param fieldinfo field info table
+ * @param num_fields number of entries in the table
  */
 void
-Message::add_fieldinfo(interface_fieldtype_t       type,
-                       const char *                name,
-                       size_t                      length,
-                       void *                      value,
-                       const char *                enumtype,
-                       const interface_enum_map_t *enum_map)
+Message::set_fieldinfo(const interface_fieldinfo_t *fieldinfo, unsigned int num_fields)
 {
-	interface_fieldinfo_t *infol   = fieldinfo_list_;
-	interface_fieldinfo_t *newinfo = (interface_fieldinfo_t *)malloc(sizeof(interface_fieldinfo_t));
-
-	newinfo->type     = type;
-	newinfo->enumtype = enumtype;
-	newinfo->name     = name;
-	newinfo->length   = length;
-	newinfo->value    = value;
-	newinfo->enum_map = enum_map;
-	newinfo->next     = NULL;
-
-	if (infol == NULL) {
-		// first entry
-		fieldinfo_list_ = newinfo;
-	} else {
-		// append to list
-		while (infol->next != NULL) {
-			infol = infol->next;
-		}
-		infol->next = newinfo;
-	}
-
-	++num_fields_;
+	fieldinfo_list_ = fieldinfo;
+	num_fields_     = num_fields;
 }
 
 } // end namespace fawkes
@@ -29,6 +29,9 @@
 #include <interface/field_iterator.h>
 #include <interface/types.h>
 
+#include <cstddef>
+#include <stdint.h>
+
 #define INTERFACE_MESSAGE_TYPE_SIZE_ 64
 
 namespace fawkes {
@@ -36,11 +39,13 @@ namespace fawkes {
 class Mutex;
 class Interface;
 class InterfaceFieldIterator;
+class InterfaceCodec;
 class Time;
 
 class Message : public RefCount
 {
 	friend Interface;
+	friend InterfaceCodec;
 
 public:
 	Message(const char *type);
@@ -78,6 +83,24 @@ public:
 
 	virtual Message *clone() const;
 
+	/** Hash a message type name.
+	 * Computes the FNV-1a hash of the name, considering at most
+	 * INTERFACE_MESSAGE_TYPE_SIZE_ - 1 characters like the type comparisons.
+	 * Being a constant expression, generated interfaces use it to dispatch
+	 * on the message type with a switch statement.
+	 * @param type message type name
+	 * @param n maximum number of characters to consider
+	 * @param h hash of the preceding characters
+	 * @return hash of the type name
+	 */
+	static constexpr uint32_t
+	type_hash(const char *type, size_t n = INTERFACE_MESSAGE_TYPE_SIZE_ - 1, uint32_t h = 2166136261u)
+	{
+		return (n == 0 || *type == 0)
+		         ? h
+		         : type_hash(type + 1, n - 1, (h ^ (unsigned char)*type) * 16777619u);
+	}
+
 	/** Check if message has desired type.
    * @return true, if message has desired type, false otherwise
    */
@@ -107,7 +130,7 @@ private: // fields
 
 	Interface *_transmit_via_iface;
 
-	interface_fieldinfo_t *fieldinfo_list_;
+	const interface_fieldinfo_t *fieldinfo_list_;
 
 	unsigned int num_fields_;
 
@@ -115,12 +138,7 @@ private: // methods
 	void set_interface(Interface *iface);
 
 protected:
-	void add_fieldinfo(interface_fieldtype_t       type,
-	                   const char *                name,
-	                   size_t                      length,
-	                   void *                      value,
-	                   const char *                enumtype = 0,
-	                   const interface_enum_map_t *enum_map = 0);
+	void set_fieldinfo(const interface_fieldinfo_t *fieldinfo, unsigned int num_fields);
 
 	void *       data_ptr;
 	unsigned int data_size;
@@ -53,16 +53,20 @@ typedef enum {
 /** Map of enum integer to string values. */
 typedef std::map<int, std::string> interface_enum_map_t;
 
-/** Interface field info list */
+/** Interface field info.
+ * Describes a field of an interface or message. The interface generator
+ * emits a static table of field infos per interface and message type, the
+ * value of a field is located at the given offset in the data chunk of an
+ * instance.
+ */
 struct interface_fieldinfo_t
 {
 	interface_fieldtype_t       type;     /**< type of this field */
 	const char *                enumtype; /**< text representation of enum type */
 	const char *                name;     /**< Name of this field */
 	size_t                      length;   /**< Length of field (array, string) */
-	void *                      value;    /**< Current value of this field */
+	size_t                      offset;   /**< Offset of the value in the data chunk */
 	const interface_enum_map_t *enum_map; /**< Map of possible enum values */
-	interface_fieldinfo_t *     next;     /**< next field, NULL if last */
 };
 
 } // namespace fawkes
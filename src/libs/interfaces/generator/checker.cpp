@@ -219,7 +219,7 @@ reserved_names_interface()
 	        "parse_uid",
 	        "reserved_names",
 	        "message_valid",
-	        "add_fieldinfo",
+	        "fieldinfo",
 	        "add_messageinfo",
 	        "data_ptr",
 	        "data_size",
@@ -254,5 +254,7 @@ reserved_names_message()
 	        "recipient",
 	        "clone",
 	        "of_type",
-	        "as_type"};
+	        "as_type",
+	        "fieldinfo",
+	        "type_hash"};
 };
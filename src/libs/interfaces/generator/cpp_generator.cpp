@@ -160,7 +160,22 @@ CppInterfaceGenerator::write_enum_maps_h(FILE *f)
 	for (vector<InterfaceEnumConstant>::iterator i = enum_constants.begin();
 	     i != enum_constants.end();
 	     ++i) {
-		fprintf(f, "  interface_enum_map_t enum_map_%s;\n", i->get_name().c_str());
+		fprintf(f, "  static const interface_enum_map_t enum_map_%s;\n", i->get_name().c_str());
+	}
+}
+
+/** Write field info table declaration to header.
+ * @param f file to write to
+ * @param is indentation space
+ * @param has_fields true if the class has fields, no table is written otherwise
+ */
+void
+CppInterfaceGenerator::write_fieldinfo_h(FILE *                         f,
+                                         std::string /* indent space */ is,
+                                         bool                           has_fields)
+{
+	if (has_fields) {
+		fprintf(f, "%sstatic const interface_fieldinfo_t fieldinfo_[];\n\n", is.c_str());
 	}
 }
 
@@ -224,6 +239,7 @@ CppInterfaceGenerator::write_cpp(FILE *f)
 	        "#include <core/exceptions/software.h>\n\n"
 	        "#include <map>\n"
 	        "#include <string>\n"
+	        "#include <cstddef>\n"
 	        "#include <cstring>\n"
 	        "#include <cstdlib>\n\n"
 	        "namespace fawkes {\n\n"
@@ -238,6 +254,8 @@ CppInterfaceGenerator::write_cpp(FILE *f)
 	        class_name.c_str(),
 	        data_comment.c_str());
 	write_constants_cpp(f);
+	write_enum_maps_cpp(f);
+	write_fieldinfo_cpp(f, class_name, data_fields);
 	write_ctor_dtor_cpp(f, class_name, "Interface", "", data_fields, messages);
 	write_enum_constants_tostring_cpp(f);
 	write_methods_cpp(f, class_name, class_name, data_fields, pseudo_maps, "");
@@ -379,7 +397,7 @@ CppInterfaceGenerator::write_messages_h(FILE *f)
 		write_struct(f, (*i).getName() + "_data_t", "    ", (*i).getFields());
 		fprintf(f, "    %s_data_t *data;\n\n", (*i).getName().c_str());
 
-		write_enum_maps_h(f);
+		write_fieldinfo_h(f, "    ", !(*i).getFields().empty());
 
 		fprintf(f, "   public:\n");
 		write_message_ctor_dtor_h(f, "    ", (*i).getName(), (*i).getFields());
@@ -409,7 +427,9 @@ CppInterfaceGenerator::write_messages_cpp(FILE *f)
 		        (*i).getName().c_str(),
 		        (*i).getComment().c_str());
 
-		write_message_ctor_dtor_cpp(f, (*i).getName(), "Message", class_name + "::", (*i).getFields());
+		std::vector<InterfaceField> fields = (*i).getFields();
+		write_fieldinfo_cpp(f, class_name + "::" + (*i).getName(), fields);
+		write_message_ctor_dtor_cpp(f, (*i).getName(), "Message", class_name + "::", fields);
 		write_methods_cpp(f, class_name, (*i).getName(), (*i).getFields(), class_name + "::", false);
 		write_message_clone_method_cpp(f, (class_name + "::" + (*i).getName()).c_str());
 	}
@@ -422,18 +442,19 @@ CppInterfaceGenerator::write_messages_cpp(FILE *f)
 	        "%s::message_valid(const Message *message) const\n"
 	        "{\n",
 	        class_name.c_str());
-	unsigned int n = 0;
-	for (vector<InterfaceMessage>::iterator i = messages.begin(); i != messages.end(); ++i) {
+	if (!messages.empty()) {
+		fprintf(f, "  switch (Message::type_hash(message->type())) {\n");
+		for (vector<InterfaceMessage>::iterator i = messages.begin(); i != messages.end(); ++i) {
+			fprintf(f,
+			        "  case Message::type_hash(\"%s\"):\n"
+			        "    return dynamic_cast<const %s *>(message) != NULL;\n",
+			        (*i).getName().c_str(),
+			        (*i).getName().c_str());
+		}
 		fprintf(f,
-		        "  const %s *m%u = dynamic_cast<const %s *>(message);\n"
-		        "  if ( m%u != NULL ) {\n"
-		        "    return true;\n"
-		        "  }\n",
-		        (*i).getName().c_str(),
-		        n,
-		        (*i).getName().c_str(),
-		        n);
-		++n;
+		        "  default:\n"
+		        "    break;\n"
+		        "  }\n");
 	}
 	fprintf(f,
 	        "  return false;\n"
@@ -453,29 +474,28 @@ CppInterfaceGenerator::write_create_message_method_cpp(FILE *f)
 	        "{\n",
 	        class_name.c_str());
 
-	bool first = true;
-	for (vector<InterfaceMessage>::iterator i = messages.begin(); i != messages.end(); ++i) {
-		fprintf(f,
-		        "  %sif ( strncmp(\"%s\", type, INTERFACE_MESSAGE_TYPE_SIZE_ - 1) == 0 ) {\n"
-		        "    return new %s();\n",
-		        first ? "" : "} else ",
-		        i->getName().c_str(),
-		        i->getName().c_str());
-		first = false;
-	}
-	if (first) {
-		fprintf(f,
-		        "  throw UnknownTypeException(\"The given type '%%s' does not match any known \"\n"
-		        "                             \"message type for this interface type.\", type);\n"
-		        "}\n\n\n");
-	} else {
+	if (!messages.empty()) {
+		fprintf(f, "  switch (Message::type_hash(type)) {\n");
+		for (vector<InterfaceMessage>::iterator i = messages.begin(); i != messages.end(); ++i) {
+			fprintf(f,
+			        "  case Message::type_hash(\"%s\"):\n"
+			        "    if (strncmp(\"%s\", type, INTERFACE_MESSAGE_TYPE_SIZE_ - 1) == 0) {\n"
+			        "      return new %s();\n"
+			        "    }\n"
+			        "    break;\n",
+			        i->getName().c_str(),
+			        i->getName().c_str(),
+			        i->getName().c_str());
+		}
 		fprintf(f,
-		        "  } else {\n"
-		        "    throw UnknownTypeException(\"The given type '%%s' does not match any known \"\n"
-		        "                               \"message type for this interface type.\", type);\n"
-		        "  }\n"
-		        "}\n\n\n");
+		        "  default:\n"
+		        "    break;\n"
+		        "  }\n");
 	}
+	fprintf(f,
+	        "  throw UnknownTypeException(\"The given type '%%s' does not match any known \"\n"
+	        "                             \"message type for this interface type.\", type);\n"
+	        "}\n\n\n");
 }
 
 /** Write copy_value() method to CPP file.
@@ -628,38 +648,63 @@ CppInterfaceGenerator::write_message_clone_method_cpp(FILE *f, std::string class
 }
 
 /** Write enum maps.
+ * The maps are static members of the interface class, shared by all
+ * instances and referenced by the field info tables.
  * @param f file to write to
  */
 void
-CppInterfaceGenerator::write_enum_map_population(FILE *f)
+CppInterfaceGenerator::write_enum_maps_cpp(FILE *f)
 {
 	for (vector<InterfaceEnumConstant>::iterator i = enum_constants.begin();
 	     i != enum_constants.end();
 	     ++i) {
 		const std::vector<InterfaceEnumConstant::EnumItem> &enum_values = i->get_items();
 
+		fprintf(f,
+		        "/** Map of %s values to their names. */\n"
+		        "const interface_enum_map_t %s::enum_map_%s = {\n",
+		        i->get_name().c_str(),
+		        class_name.c_str(),
+		        i->get_name().c_str());
 		std::vector<InterfaceEnumConstant::EnumItem>::const_iterator ef;
 		for (ef = enum_values.begin(); ef != enum_values.end(); ++ef) {
-			fprintf(f,
-			        "  enum_map_%s[(int)%s] = \"%s\";\n",
-			        i->get_name().c_str(),
-			        ef->name.c_str(),
-			        ef->name.c_str());
+			fprintf(f, "  {(int)%s, \"%s\"},\n", ef->name.c_str(), ef->name.c_str());
 		}
+		fprintf(f, "};\n\n");
 	}
 }
 
-/** Write the add_fieldinfo() calls.
+/** Write the field info table.
+ * The table describes type, name, length, and location of each field in
+ * the data struct. It is static and shared by all instances.
  * @param f file to write to
+ * @param classname fully qualified name of class to write table for
  * @param fields fields to write field info for
  */
 void
-CppInterfaceGenerator::write_add_fieldinfo_calls(FILE *f, std::vector<InterfaceField> &fields)
+CppInterfaceGenerator::write_fieldinfo_cpp(FILE *                       f,
+                                           std::string                  classname,
+                                           std::vector<InterfaceField> &fields)
 {
+	if (fields.empty())
+		return;
+
+	// the data struct is named after the unqualified class name
+	std::string::size_type pos       = classname.rfind("::");
+	std::string            data_type = classname;
+	if (pos != std::string::npos) {
+		data_type = classname.substr(pos + 2);
+	}
+
+	fprintf(f,
+	        "/** Field info table of %s. */\n"
+	        "const interface_fieldinfo_t %s::fieldinfo_[] = {\n",
+	        classname.c_str(),
+	        classname.c_str());
+
 	std::vector<InterfaceField>::iterator i;
 	for (i = fields.begin(); i != fields.end(); ++i) {
-		const char *type    = "";
-		const char *dataptr = "&";
+		const char *type = "";
 		std::string enumtype;
 
 		if (i->getType() == "bool") {
@@ -687,26 +732,37 @@ CppInterfaceGenerator::write_add_fieldinfo_calls(FILE *f, std::vector<InterfaceF
 		} else if (i->getType() == "double") {
 			type = "DOUBLE";
 		} else if (i->getType() == "string") {
-			type    = "STRING";
-			dataptr = "";
+			type = "STRING";
 		} else {
 			type     = "ENUM";
 			enumtype = i->getType();
 		}
 
 		fprintf(f,
-		        "  add_fieldinfo(IFT_%s, \"%s\", %u, %sdata->%s%s%s%s%s%s%s);\n",
+		        "  {IFT_%s, %s%s%s, \"%s\", %u, offsetof(%s_data_t, %s), %s%s},\n",
 		        type,
+		        enumtype.empty() ? "NULL" : "\"",
+		        enumtype.c_str(),
+		        enumtype.empty() ? "" : "\"",
 		        i->getName().c_str(),
 		        (i->getLengthValue() > 0) ? i->getLengthValue() : 1,
-		        dataptr,
+		        data_type.c_str(),
 		        i->getName().c_str(),
-		        enumtype.empty() ? "" : ", \"",
-		        enumtype.empty() ? "" : enumtype.c_str(),
-		        enumtype.empty() ? "" : "\"",
-		        enumtype.empty() ? "" : ", ",
-		        enumtype.empty() ? "" : "&enum_map_",
-		        enumtype.empty() ? "" : enumtype.c_str());
+		        enumtype.empty() ? "NULL" : "&enum_map_",
+		        enumtype.c_str());
+	}
+	fprintf(f, "};\n\n");
+}
+
+/** Write the set_fieldinfo() call.
+ * @param f file to write to
+ * @param fields fields of the class
+ */
+void
+CppInterfaceGenerator::write_set_fieldinfo_call(FILE *f, std::vector<InterfaceField> &fields)
+{
+	if (!fields.empty()) {
+		fprintf(f, "  set_fieldinfo(fieldinfo_, %zu);\n", fields.size());
 	}
 }
 
@@ -744,8 +800,7 @@ CppInterfaceGenerator::write_ctor_dtor_cpp(FILE *                        f,
 	        classname.c_str(),
 	        classname.c_str());
 
-	write_enum_map_population(f);
-	write_add_fieldinfo_calls(f, fields);
+	write_set_fieldinfo_call(f, fields);
 
 	for (vector<InterfaceMessage>::iterator i = messages.begin(); i != messages.end(); ++i) {
 		fprintf(f, "  add_messageinfo(\"%s\");\n", i->getName().c_str());
@@ -848,8 +903,7 @@ CppInterfaceGenerator::write_message_ctor_dtor_cpp(FILE *                      f
 			}
 		}
 
-		write_enum_map_population(f);
-		write_add_fieldinfo_calls(f, fields);
+		write_set_fieldinfo_call(f, fields);
 
 		fprintf(f, "}\n");
 	}
@@ -873,8 +927,7 @@ CppInterfaceGenerator::write_message_ctor_dtor_cpp(FILE *                      f
 	        classname.c_str(),
 	        classname.c_str());
 
-	write_enum_map_population(f);
-	write_add_fieldinfo_calls(f, fields);
+	write_set_fieldinfo_call(f, fields);
 
 	fprintf(f,
 	        "}\n\n"
@@ -899,10 +952,8 @@ CppInterfaceGenerator::write_message_ctor_dtor_cpp(FILE *                      f
 	        classname.c_str(),
 	        super_class.c_str());
 
+	// data has already been copied by the Message copy constructor
 	fprintf(f,
-	        "  data_size = m->data_size;\n"
-	        "  data_ptr  = malloc(data_size);\n"
-	        "  memcpy(data_ptr, m->data_ptr, data_size);\n"
 	        "  data      = (%s_data_t *)data_ptr;\n"
 	        "  data_ts   = (message_data_ts_t *)data_ptr;\n",
 	        classname.c_str());
@@ -1288,6 +1339,7 @@ CppInterfaceGenerator::write_h(FILE *f)
 	fprintf(f, "  %s_data_t *data;\n\n", class_name.c_str());
 
 	write_enum_maps_h(f);
+	write_fieldinfo_h(f, "  ", !data_fields.empty());
 
 	fprintf(f, " public:\n");
 
@@ -109,8 +109,10 @@ public:
 
 	void write_management_funcs_cpp(FILE *f);
 
-	void write_enum_map_population(FILE *f);
-	void write_add_fieldinfo_calls(FILE *f, std::vector<InterfaceField> &fields);
+	void write_enum_maps_cpp(FILE *f);
+	void write_fieldinfo_cpp(FILE *f, std::string classname, std::vector<InterfaceField> &fields);
+	void write_fieldinfo_h(FILE *f, std::string /* indent space */ is, bool has_fields);
+	void write_set_fieldinfo_call(FILE *f, std::vector<InterfaceField> &fields);
 
 	void write_struct(FILE *                         f,
 	                  std::string                    name,
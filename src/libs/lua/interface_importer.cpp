@@ -286,7 +286,11 @@ LuaInterfaceImporter::writing_interfaces()
 	return writing_ifs_;
 }
 
-/** Read from all reading interfaces. */
+/** Read from all reading interfaces.
+ * Every interface is read completely. Interface::read_if_changed() is not
+ * used, it misses updates of writers which disable automatic timestamping
+ * and would keep local modifications a script made to a reading interface.
+ */
 void
 LuaInterfaceImporter::read()
 {
@@ -20,7 +20,12 @@
  *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
  */
 
+#include <core/threading/wait_condition.h>
 #include <pcl_utils/pointcloud_manager.h>
+#include <pcl_utils/shm_pointcloud.h>
+
+#include <ctime>
+#include <memory>
 
 namespace fawkes {
 
@@ -28,6 +33,25 @@ namespace fawkes {
  * Point Cloud manager.
  * This class manages a number of points clouds and acts as a hub to
  * distribute them.
+ *
+ * Point clouds can additionally be shared with other processes. After
+ * calling share_pointcloud() the producer calls publish_pointcloud()
+ * whenever the cloud has been updated, which copies the current data into
+ * a SharedMemoryPointCloudBuffer ring. Readers in other processes access
+ * the data without further copies, e.g. using SharedMemoryStorageAdapter.
+ *
+ * Producers which modify the registered cloud in place race with
+ * consumers reading it. To avoid this a producer gets a buffer to fill
+ * with writable_pointcloud() and makes it available with
+ * publish_pointcloud(). Consumers get the latest published cloud with
+ * acquire_pointcloud(), which the producer will not touch while it is
+ * referenced, and can block on wait_pointcloud() until a new one has
+ * been published. The registered cloud is only updated, by copying the
+ * published cloud, while consumers hold references to it in addition to
+ * those held at registration, e.g., obtained with get_pointcloud() or by
+ * cloning the adapter returned by get_storage_adapter(). The copy is
+ * made without holding the lock of the manager, publishing one cloud
+ * does not block access to the other clouds.
  * @author Tim Niemueller
  *
  * @fn void PointCloudManager::add_pointcloud(const char *id, RefPtr<pcl::PointCloud<PointT> > cloud)
@@ -46,6 +70,7 @@ namespace fawkes {
 /** Constructor. */
 PointCloudManager::PointCloudManager()
 {
+	publish_waitcond_ = new WaitCondition(*clouds_.mutex());
 }
 
 /** Destructor. */
@@ -57,6 +82,22 @@ PointCloudManager::~PointCloudManager()
 	}
 
 	clouds_.clear();
+
+	LockMap<std::string, pcl_utils::SharedMemoryPointCloudBuffer *>::iterator s;
+	for (s = shm_buffers_.begin(); s != shm_buffers_.end(); ++s) {
+		delete s->second;
+	}
+	shm_buffers_.clear();
+
+	std::map<std::string, Publication>::iterator p;
+	for (p = publications_.begin(); p != publications_.end(); ++p) {
+		for (pcl_utils::StorageAdapter *b : p->second.buffers) {
+			delete b;
+		}
+	}
+	publications_.clear();
+
+	delete publish_waitcond_;
 }
 
 /** Remove the point cloud.
@@ -71,6 +112,21 @@ PointCloudManager::remove_pointcloud(const char *id)
 		delete clouds_[id];
 		clouds_.erase(id);
 	}
+
+	std::map<std::string, Publication>::iterator p = publications_.find(id);
+	if (p != publications_.end()) {
+		for (pcl_utils::StorageAdapter *b : p->second.buffers) {
+			delete b;
+		}
+		publications_.erase(p);
+		publish_waitcond_->wake_all();
+	}
+
+	MutexLocker shm_lock(shm_buffers_.mutex());
+	if (shm_buffers_.find(id) != shm_buffers_.end()) {
+		delete shm_buffers_[id];
+		shm_buffers_.erase(id);
+	}
 }
 
 /** Check if point cloud exists
@@ -117,7 +173,9 @@ PointCloudManager::get_pointclouds() const
 /** Get a storage adapter.
  * Use with care. Do not use in ROS-enabled plugins unless you are aware
  * of sensor_msgs and std_msgs incompatibilities between standalone PCL
- * and ROS!
+ * and ROS! To keep reading the cloud published by a producer using
+ * writable_pointcloud(), keep a clone of the adapter, rather than the
+ * returned pointer, such that the cloud is known to be referenced.
  * @param id ID of point clouds whose storage adapter to retrieve
  * @return storage adapter for given ID
  * @exception Exception thrown if ID is unknown
@@ -133,4 +191,182 @@ PointCloudManager::get_storage_adapter(const char *id)
 	return clouds_[id];
 }
 
+/** Share point cloud with other processes.
+ * Creates a shared memory ring buffer for the point cloud. The cloud is
+ * only written to shared memory when calling publish_pointcloud(). If the
+ * point cloud is already shared with sufficient capacity this is a no-op,
+ * otherwise the buffer is re-created. Readers of a re-created buffer must
+ * re-attach.
+ * @param id ID of point cloud to share
+ * @param max_points maximum number of points of the cloud
+ * @param num_slots number of slots of the ring buffer, i.e., the number of
+ * publications a reader can lag behind before its data is overwritten
+ * @exception Exception thrown if ID is unknown or the shared memory segment
+ * cannot be created
+ */
+void
+PointCloudManager::share_pointcloud(const char *id, unsigned int max_points, unsigned int num_slots)
+{
+	MutexLocker lock(clouds_.mutex());
+
+	if (clouds_.find(id) == clouds_.end()) {
+		throw Exception("PointCloud '%s' unknown", id);
+	}
+
+	MutexLocker shm_lock(shm_buffers_.mutex());
+	if (shm_buffers_.find(id) != shm_buffers_.end()) {
+		pcl_utils::SharedMemoryPointCloudBuffer *b = shm_buffers_[id];
+		if (b->max_points() >= max_points && b->num_slots() >= num_slots)
+			return;
+		delete b;
+		shm_buffers_.erase(id);
+	}
+
+	pcl_utils::StorageAdapter *sa = clouds_[id];
+	shm_buffers_[id] = new pcl_utils::SharedMemoryPointCloudBuffer(
+	  id, sa->get_typename(), sa->point_size(), max_points, num_slots);
+}
+
+/** Stop sharing point cloud.
+ * @param id ID of point cloud to stop sharing
+ */
+void
+PointCloudManager::unshare_pointcloud(const char *id)
+{
+	MutexLocker lock(shm_buffers_.mutex());
+
+	if (shm_buffers_.find(id) != shm_buffers_.end()) {
+		delete shm_buffers_[id];
+		shm_buffers_.erase(id);
+	}
+}
+
+/** Check if point cloud is shared.
+ * @param id ID of point cloud to check
+ * @return true if the point cloud is shared with other processes
+ */
+bool
+PointCloudManager::is_shared_pointcloud(const char *id)
+{
+	MutexLocker lock(shm_buffers_.mutex());
+
+	return (shm_buffers_.find(id) != shm_buffers_.end());
+}
+
+/** Publish point cloud.
+ * Call this after the producer has updated the point cloud. If the
+ * producer filled a buffer retrieved with writable_pointcloud() it
+ * becomes the cloud returned by acquire_pointcloud() and, as long as
+ * consumers reference the registered cloud, e.g., obtained through
+ * get_pointcloud() or a clone of get_storage_adapter(), it is copied to
+ * the registered cloud. Once they release it, no copies are made
+ * anymore. The copy is made without
+ * holding the manager lock, therefore a point cloud must only be
+ * published by a single producer thread. The sequence number of the
+ * point cloud is incremented and waiting consumers are woken up. If the
+ * cloud is shared its data is copied to the next slot of the shared
+ * memory buffer.
+ * @param id ID of point cloud to publish
+ * @exception OutOfBoundsException thrown if the point cloud has more
+ * points than the shared memory buffer can hold
+ */
+void
+PointCloudManager::publish_pointcloud(const char *id)
+{
+	MutexLocker lock(clouds_.mutex());
+
+	if (clouds_.find(id) == clouds_.end()) {
+		return;
+	}
+
+	// The copies below run without the lock held. The cloned adapters
+	// reference the clouds, the published buffer is therefore not recycled
+	// and neither cloud is freed by remove_pointcloud() while copying.
+	std::unique_ptr<pcl_utils::StorageAdapter> src;
+	std::unique_ptr<pcl_utils::StorageAdapter> dest;
+	Publication &                              p    = publications_[id];
+	CopyFunc                                   copy = p.copy;
+	if (p.back >= 0) {
+		p.front = p.back;
+		p.back  = -1;
+		src.reset(p.buffers[p.front]->clone());
+		if (p.refs(clouds_[id]) > p.registered_refs) {
+			dest.reset(clouds_[id]->clone());
+		}
+	} else {
+		src.reset(clouds_[id]->clone());
+	}
+	p.seq += 1;
+	publish_waitcond_->wake_all();
+	lock.unlock();
+
+	if (dest) {
+		copy(dest.get(), src.get());
+	}
+
+	MutexLocker shm_lock(shm_buffers_.mutex());
+	if (shm_buffers_.find(id) != shm_buffers_.end()) {
+		fawkes::Time time;
+		src->get_time(time);
+		shm_buffers_[id]->publish(
+		  src->width(), src->height(), src->data_ptr(), src->num_points(), time, src->frame_id());
+	}
+}
+
+/** Get sequence number of point cloud.
+ * @param id ID of point cloud
+ * @return number of times the point cloud has been published, zero if it
+ * has never been published or does not exist
+ */
+uint64_t
+PointCloudManager::published_seq(const char *id)
+{
+	MutexLocker lock(clouds_.mutex());
+
+	std::map<std::string, Publication>::iterator p = publications_.find(id);
+	return (p != publications_.end()) ? p->second.seq : 0;
+}
+
+/** Wait for a new point cloud.
+ * Blocks until the point cloud has been published after the given
+ * sequence number.
+ * @param id ID of point cloud to wait for
+ * @param seq sequence number of the last point cloud processed, e.g., as
+ * returned by acquire_pointcloud()
+ * @param timeout_ms maximum time to wait in milliseconds, zero to wait
+ * indefinitely
+ * @return true if a newer point cloud is available, false on timeout or
+ * if the point cloud has been removed
+ */
+bool
+PointCloudManager::wait_pointcloud(const char *id, uint64_t seq, unsigned int timeout_ms)
+{
+	MutexLocker lock(clouds_.mutex());
+
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (long int)(timeout_ms % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_sec += 1;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	while (true) {
+		if (clouds_.find(id) == clouds_.end())
+			return false;
+
+		std::map<std::string, Publication>::iterator p = publications_.find(id);
+		if (p != publications_.end() && p->second.seq > seq)
+			return true;
+
+		if (timeout_ms == 0) {
+			publish_waitcond_->wait();
+		} else {
+			if (!publish_waitcond_->abstimed_wait(deadline.tv_sec, deadline.tv_nsec))
+				return false;
+		}
+	}
+}
+
 } // end namespace fawkes
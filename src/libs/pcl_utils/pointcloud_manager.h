@@ -31,6 +31,7 @@
 #include <utils/time/time.h>
 
 #include <cstring>
+#include <map>
 #include <stdint.h>
 #include <string>
 #include <typeinfo>
@@ -43,6 +44,12 @@ class PointCloud;
 
 namespace fawkes {
 
+class WaitCondition;
+
+namespace pcl_utils {
+class SharedMemoryPointCloudBuffer;
+}
+
 class PointCloudManager
 {
 public:
@@ -69,8 +76,54 @@ public:
 	const fawkes::LockMap<std::string, pcl_utils::StorageAdapter *> &get_pointclouds() const;
 	const pcl_utils::StorageAdapter *get_storage_adapter(const char *id);
 
+	void share_pointcloud(const char *id, unsigned int max_points, unsigned int num_slots = 4);
+	void unshare_pointcloud(const char *id);
+	bool is_shared_pointcloud(const char *id);
+	void publish_pointcloud(const char *id);
+
+	template <typename PointT>
+	RefPtr<pcl::PointCloud<PointT>> writable_pointcloud(const char *id);
+
+	template <typename PointT>
+	const RefPtr<const pcl::PointCloud<PointT>> acquire_pointcloud(const char *id,
+	                                                               uint64_t *  seq = NULL);
+	uint64_t published_seq(const char *id);
+	bool     wait_pointcloud(const char *id, uint64_t seq, unsigned int timeout_ms = 0);
+
 private:
-	fawkes::LockMap<std::string, pcl_utils::StorageAdapter *> clouds_;
+	template <typename PointT>
+	pcl_utils::PointCloudStorageAdapter<PointT> *typed_adapter(pcl_utils::StorageAdapter *sa);
+
+	/// @cond INTERNALS
+	typedef void (*CopyFunc)(pcl_utils::StorageAdapter *to, const pcl_utils::StorageAdapter *from);
+	typedef long (*RefsFunc)(const pcl_utils::StorageAdapter *sa);
+
+	struct Publication
+	{
+		Publication() : seq(0), front(-1), back(-1), registered_refs(0), copy(NULL), refs(NULL)
+		{
+		}
+
+		uint64_t                                 seq;
+		std::vector<pcl_utils::StorageAdapter *> buffers;
+		int                                      front;
+		int                                      back;
+		long                                     registered_refs;
+		CopyFunc                                 copy;
+		RefsFunc                                 refs;
+	};
+	/// @endcond
+
+	template <typename PointT>
+	static void copy_cloud(pcl_utils::StorageAdapter *to, const pcl_utils::StorageAdapter *from);
+	template <typename PointT>
+	static long cloud_refs(const pcl_utils::StorageAdapter *sa);
+
+private:
+	fawkes::LockMap<std::string, pcl_utils::StorageAdapter *>               clouds_;
+	fawkes::LockMap<std::string, pcl_utils::SharedMemoryPointCloudBuffer *> shm_buffers_;
+	std::map<std::string, Publication>                                      publications_;
+	fawkes::WaitCondition *                                                 publish_waitcond_;
 };
 
 template <typename PointT>
@@ -81,11 +134,53 @@ PointCloudManager::add_pointcloud(const char *id, RefPtr<pcl::PointCloud<PointT>
 
 	if (clouds_.find(id) == clouds_.end()) {
 		clouds_[id] = new pcl_utils::PointCloudStorageAdapter<PointT>(cloud);
+
+		// References held by the producer and the adapter, but not the one
+		// of the by-value parameter. More references are held by consumers
+		// of the registered cloud, see publish_pointcloud().
+		Publication &p    = publications_[id];
+		p.copy            = copy_cloud<PointT>;
+		p.refs            = cloud_refs<PointT>;
+		p.registered_refs = cloud.use_count() - 1;
 	} else {
 		throw Exception("Cloud %s already registered", id);
 	}
 }
 
+template <typename PointT>
+pcl_utils::PointCloudStorageAdapter<PointT> *
+PointCloudManager::typed_adapter(pcl_utils::StorageAdapter *sa)
+{
+	pcl_utils::PointCloudStorageAdapter<PointT> *pa =
+	  dynamic_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(sa);
+
+	if (!pa) {
+		// workaround for older compilers
+		if (strcmp(sa->get_typename(), typeid(pcl_utils::PointCloudStorageAdapter<PointT> *).name())
+		    == 0) {
+			return static_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(sa);
+		}
+
+		throw Exception("The desired point cloud is of a different type");
+	}
+	return pa;
+}
+
+template <typename PointT>
+void
+PointCloudManager::copy_cloud(pcl_utils::StorageAdapter *to, const pcl_utils::StorageAdapter *from)
+{
+	**static_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(to)->cloud =
+	  **static_cast<const pcl_utils::PointCloudStorageAdapter<PointT> *>(from)->cloud;
+}
+
+template <typename PointT>
+long
+PointCloudManager::cloud_refs(const pcl_utils::StorageAdapter *sa)
+{
+	return static_cast<const pcl_utils::PointCloudStorageAdapter<PointT> *>(sa)->cloud.use_count();
+}
+
 template <typename PointT>
 const RefPtr<const pcl::PointCloud<PointT>>
 PointCloudManager::get_pointcloud(const char *id)
@@ -93,22 +188,101 @@ PointCloudManager::get_pointcloud(const char *id)
 	fawkes::MutexLocker lock(clouds_.mutex());
 
 	if (clouds_.find(id) != clouds_.end()) {
-		pcl_utils::PointCloudStorageAdapter<PointT> *pa =
-		  dynamic_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(clouds_[id]);
-
-		if (!pa) {
-			// workaround for older compilers
-			if (strcmp(clouds_[id]->get_typename(),
-			           typeid(pcl_utils::PointCloudStorageAdapter<PointT> *).name())
-			    == 0) {
-				return static_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(clouds_[id])->cloud;
-			}
+		pcl_utils::PointCloudStorageAdapter<PointT> *pa = typed_adapter<PointT>(clouds_[id]);
+		return pa->cloud;
+	} else {
+		throw Exception("No point cloud with ID '%s' registered", id);
+	}
+}
+
+/** Get writable point cloud buffer.
+ * Producers use this to update a point cloud without modifying the cloud
+ * that consumers currently process. The returned buffer is not visible to
+ * consumers until publish_pointcloud() is called. Calling this again
+ * before publishing returns the same buffer.
+ *
+ * Buffers are recycled once no consumer holds a reference to them
+ * anymore, typically this results in triple buffering. A recycled buffer
+ * contains an older frame, the producer must set all points and the
+ * header. A new buffer is allocated as a copy of the registered cloud if
+ * all other buffers are still in use.
+ * @param id ID of point cloud to update
+ * @return point cloud to fill
+ * @exception Exception thrown if the point cloud does not exist or is of
+ * a different type
+ */
+template <typename PointT>
+RefPtr<pcl::PointCloud<PointT>>
+PointCloudManager::writable_pointcloud(const char *id)
+{
+	fawkes::MutexLocker lock(clouds_.mutex());
 
-			throw Exception("The desired point cloud is of a different type");
+	if (clouds_.find(id) == clouds_.end()) {
+		throw Exception("No point cloud with ID '%s' registered", id);
+	}
+	pcl_utils::PointCloudStorageAdapter<PointT> *pa = typed_adapter<PointT>(clouds_[id]);
+
+	Publication &p = publications_[id];
+
+	if (p.back < 0) {
+		for (size_t i = 0; i < p.buffers.size(); ++i) {
+			if ((int)i != p.front
+			    && static_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(p.buffers[i])
+			           ->cloud.use_count()
+			         == 1) {
+				p.back = i;
+				break;
+			}
 		}
+	}
+	if (p.back < 0) {
+		RefPtr<pcl::PointCloud<PointT>> cloud(new pcl::PointCloud<PointT>(**pa->cloud));
+		p.buffers.push_back(new pcl_utils::PointCloudStorageAdapter<PointT>(cloud));
+		p.back = p.buffers.size() - 1;
+	}
+
+	return static_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(p.buffers[p.back])->cloud;
+}
+
+/** Acquire latest published point cloud.
+ * The returned point cloud is not modified by the producer as long as a
+ * reference to it is held. Release the reference as soon as possible,
+ * otherwise the producer has to allocate more buffers. If the producer
+ * does not use writable_pointcloud() this returns the registered cloud
+ * which may be modified at any time.
+ * @param id ID of point cloud to acquire
+ * @param seq upon return contains the sequence number of the point
+ * cloud, i.e., the number of times it has been published, if not NULL
+ * @return latest published point cloud
+ * @exception Exception thrown if the point cloud does not exist or is of
+ * a different type
+ */
+template <typename PointT>
+const RefPtr<const pcl::PointCloud<PointT>>
+PointCloudManager::acquire_pointcloud(const char *id, uint64_t *seq)
+{
+	fawkes::MutexLocker lock(clouds_.mutex());
+
+	if (clouds_.find(id) == clouds_.end()) {
+		throw Exception("No point cloud with ID '%s' registered", id);
+	}
+	pcl_utils::PointCloudStorageAdapter<PointT> *pa = typed_adapter<PointT>(clouds_[id]);
+
+	std::map<std::string, Publication>::iterator p = publications_.find(id);
+	if (p == publications_.end()) {
+		if (seq)
+			*seq = 0;
 		return pa->cloud;
+	}
+
+	if (seq)
+		*seq = p->second.seq;
+	if (p->second.front >= 0) {
+		return static_cast<pcl_utils::PointCloudStorageAdapter<PointT> *>(
+		         p->second.buffers[p->second.front])
+		  ->cloud;
 	} else {
-		throw Exception("No point cloud with ID '%s' registered", id);
+		return pa->cloud;
 	}
 }
 
@@ -116,8 +290,12 @@ template <typename PointT>
 bool
 PointCloudManager::exists_pointcloud(const char *id)
 {
+	fawkes::MutexLocker lock(clouds_.mutex());
+
+	if (clouds_.find(id) == clouds_.end())
+		return false;
 	try {
-		const RefPtr<const pcl::PointCloud<PointT>> p = get_pointcloud<PointT>(id);
+		typed_adapter<PointT>(clouds_[id]);
 		return true;
 	} catch (Exception &e) {
 		return false;
@@ -0,0 +1,669 @@
+
+/***************************************************************************
+ *  shm_pointcloud.cpp - Point clouds in shared memory
+ *
+ *  Created: Sat Oct 17 18:47:12 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <core/exception.h>
+#include <core/exceptions/software.h>
+#include <pcl_utils/shm_pointcloud.h>
+#include <utils/ipc/shm_lister.h>
+
+#include <cstring>
+
+namespace fawkes {
+namespace pcl_utils {
+
+/** @class SharedMemoryPointCloudBuffer <pcl_utils/shm_pointcloud.h>
+ * Point cloud ring buffer in shared memory.
+ * The buffer allows to share point clouds with other processes. The writer
+ * publishes point clouds into a ring of a fixed number of slots, each
+ * large enough for the configured maximum number of points. Readers map
+ * the segment and access the data in place without copying.
+ *
+ * Publishing never blocks on readers. Each slot carries the sequence
+ * number of the cloud stored in it, which is reset to zero while the slot
+ * is written. A reader gets the latest sequence number with latest_seq(),
+ * accesses the data with get() and then verifies with is_valid() that the
+ * slot has not been overwritten in the meantime. With N slots a reader
+ * has the time of N-1 publications to process a cloud.
+ * @author agent
+ */
+
+/** Write constructor.
+ * Creates a new shared memory segment, or attaches to an existing one of
+ * the same ID and layout.
+ * @param pointcloud_id ID of the point cloud
+ * @param point_type name of the point type, readers use it to check
+ * compatibility
+ * @param point_size size in bytes of a single point
+ * @param max_points maximum number of points of a cloud
+ * @param num_slots number of slots in the ring, at least two
+ */
+SharedMemoryPointCloudBuffer::SharedMemoryPointCloudBuffer(const char * pointcloud_id,
+                                                           const char * point_type,
+                                                           size_t       point_size,
+                                                           unsigned int max_points,
+                                                           unsigned int num_slots)
+: SharedMemory(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN,
+               /* read-only */ false,
+               /* create */ true,
+               /* destroy on delete */ true)
+{
+	if (num_slots < 2) {
+		throw Exception("Point cloud ring requires at least two slots");
+	}
+	if (strlen(pointcloud_id) >= POINTCLOUD_ID_MAX_LENGTH) {
+		throw Exception("Point cloud ID '%s' too long", pointcloud_id);
+	}
+
+	priv_header_ = new SharedMemoryPointCloudBufferHeader(
+	  pointcloud_id, point_type, point_size, max_points, num_slots);
+	_header = priv_header_;
+	try {
+		attach();
+		raw_header_ = priv_header_->raw_header();
+	} catch (Exception &e) {
+		e.append("SharedMemoryPointCloudBuffer: could not attach to '%s'", pointcloud_id);
+		delete priv_header_;
+		throw;
+	}
+	next_seq_ = __atomic_load_n(&raw_header_->latest_seq, __ATOMIC_ACQUIRE) + 1;
+}
+
+/** Read constructor.
+ * Attaches read-only to an existing point cloud buffer.
+ * @param pointcloud_id ID of the point cloud
+ */
+SharedMemoryPointCloudBuffer::SharedMemoryPointCloudBuffer(const char *pointcloud_id)
+: SharedMemory(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN,
+               /* read-only */ true,
+               /* create */ false,
+               /* destroy on delete */ false)
+{
+	priv_header_ = new SharedMemoryPointCloudBufferHeader(pointcloud_id, NULL, 0, 0, 0);
+	_header      = priv_header_;
+	try {
+		attach();
+		raw_header_ = priv_header_->raw_header();
+	} catch (Exception &e) {
+		e.append("SharedMemoryPointCloudBuffer: could not attach to '%s'", pointcloud_id);
+		delete priv_header_;
+		throw;
+	}
+	next_seq_ = 0;
+}
+
+/** Destructor. */
+SharedMemoryPointCloudBuffer::~SharedMemoryPointCloudBuffer()
+{
+	delete priv_header_;
+}
+
+/** Get point cloud ID.
+ * @return point cloud ID
+ */
+const char *
+SharedMemoryPointCloudBuffer::pointcloud_id() const
+{
+	return priv_header_->pointcloud_id();
+}
+
+/** Get point type name.
+ * @return point type name
+ */
+const char *
+SharedMemoryPointCloudBuffer::point_type() const
+{
+	return priv_header_->point_type();
+}
+
+/** Get point size.
+ * @return size in bytes of a single point
+ */
+size_t
+SharedMemoryPointCloudBuffer::point_size() const
+{
+	return priv_header_->point_size();
+}
+
+/** Get maximum number of points.
+ * @return maximum number of points per cloud
+ */
+unsigned int
+SharedMemoryPointCloudBuffer::max_points() const
+{
+	return priv_header_->max_points();
+}
+
+/** Get number of slots.
+ * @return number of slots in the ring
+ */
+unsigned int
+SharedMemoryPointCloudBuffer::num_slots() const
+{
+	return priv_header_->num_slots();
+}
+
+SharedMemoryPointCloudBuffer_slot_t *
+SharedMemoryPointCloudBuffer::slot(uint64_t seq) const
+{
+	return (SharedMemoryPointCloudBuffer_slot_t *)_memptr + (seq % raw_header_->num_slots);
+}
+
+char *
+SharedMemoryPointCloudBuffer::slot_data(uint64_t seq) const
+{
+	size_t slot_size = (size_t)raw_header_->max_points * raw_header_->point_size;
+	return (char *)_memptr + sizeof(SharedMemoryPointCloudBuffer_slot_t) * raw_header_->num_slots
+	       + slot_size * (seq % raw_header_->num_slots);
+}
+
+/** Publish a point cloud.
+ * Copies the points into the next slot and makes it the latest cloud.
+ * @param width width of the point cloud
+ * @param height height of the point cloud
+ * @param points pointer to the points
+ * @param num_points number of points
+ * @param time capture time
+ * @param frame_id coordinate frame ID
+ * @return sequence number of the published cloud
+ * @exception Exception thrown if the buffer is read-only or the cloud
+ * exceeds the maximum number of points
+ */
+uint64_t
+SharedMemoryPointCloudBuffer::publish(unsigned int        width,
+                                      unsigned int        height,
+                                      const void *        points,
+                                      size_t              num_points,
+                                      const fawkes::Time &time,
+                                      const std::string & frame_id)
+{
+	if (_is_read_only) {
+		throw Exception("Cannot publish to read-only point cloud buffer '%s'", pointcloud_id());
+	}
+	if (num_points > raw_header_->max_points) {
+		throw OutOfBoundsException("Point cloud too large", num_points, 0, raw_header_->max_points);
+	}
+
+	uint64_t                             seq = next_seq_++;
+	SharedMemoryPointCloudBuffer_slot_t *s   = slot(seq);
+
+	// invalidate slot for readers while writing
+	__atomic_store_n(&s->seq, 0, __ATOMIC_RELEASE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	memcpy(slot_data(seq), points, num_points * raw_header_->point_size);
+	s->width      = width;
+	s->height     = height;
+	s->num_points = num_points;
+	s->time_sec   = time.get_sec();
+	s->time_usec  = time.get_usec();
+	strncpy(s->frame_id, frame_id.c_str(), POINTCLOUD_FRAME_ID_MAX_LENGTH - 1);
+	s->frame_id[POINTCLOUD_FRAME_ID_MAX_LENGTH - 1] = 0;
+
+	__atomic_store_n(&s->seq, seq, __ATOMIC_RELEASE);
+	__atomic_store_n(&raw_header_->latest_seq, seq, __ATOMIC_RELEASE);
+
+	return seq;
+}
+
+/** Get sequence number of latest point cloud.
+ * @return sequence number of the latest published cloud, zero if no
+ * cloud has been published, yet
+ */
+uint64_t
+SharedMemoryPointCloudBuffer::latest_seq() const
+{
+	return __atomic_load_n(&raw_header_->latest_seq, __ATOMIC_ACQUIRE);
+}
+
+/** Access point cloud.
+ * The returned data remains in shared memory and can be overwritten by
+ * the writer at any time. Check is_valid() after processing the data.
+ * @param seq sequence number of the cloud, usually from latest_seq()
+ * @param meta upon successful return contains the cloud's meta data
+ * @return pointer to the points, NULL if the cloud is no longer available
+ */
+const void *
+SharedMemoryPointCloudBuffer::get(uint64_t seq, MetaData &meta) const
+{
+	if (seq == 0)
+		return NULL;
+
+	const SharedMemoryPointCloudBuffer_slot_t *s = slot(seq);
+	if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != seq)
+		return NULL;
+
+	meta.seq        = seq;
+	meta.width      = s->width;
+	meta.height     = s->height;
+	meta.num_points = s->num_points;
+	meta.time.set_time(s->time_sec, s->time_usec);
+	meta.frame_id = std::string(s->frame_id, strnlen(s->frame_id, POINTCLOUD_FRAME_ID_MAX_LENGTH));
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (!is_valid(seq))
+		return NULL;
+
+	return slot_data(seq);
+}
+
+/** Check if a point cloud is still available.
+ * @param seq sequence number of the cloud
+ * @return true if the slot still holds the cloud with the given sequence
+ * number, false if it has been or is being overwritten
+ */
+bool
+SharedMemoryPointCloudBuffer::is_valid(uint64_t seq) const
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return (seq != 0 && __atomic_load_n(&slot(seq)->seq, __ATOMIC_ACQUIRE) == seq);
+}
+
+/// @cond INTERNALS
+class SharedMemoryPointCloudBufferIdCollector : public SharedMemoryLister
+{
+public:
+	virtual void
+	print_header()
+	{
+	}
+	virtual void
+	print_footer()
+	{
+	}
+	virtual void
+	print_no_segments()
+	{
+	}
+	virtual void
+	print_no_orphaned_segments()
+	{
+	}
+	virtual void
+	print_info(const SharedMemoryHeader *header,
+	           int                       shm_id,
+	           int                       semaphore,
+	           unsigned int              mem_size,
+	           const void *              memptr)
+	{
+		const SharedMemoryPointCloudBufferHeader *h =
+		  dynamic_cast<const SharedMemoryPointCloudBufferHeader *>(header);
+		if (h)
+			ids.push_back(h->pointcloud_id());
+	}
+
+	std::list<std::string> ids;
+};
+/// @endcond
+
+/** Get IDs of available point clouds.
+ * @return list of IDs of point clouds in shared memory
+ */
+std::list<std::string>
+SharedMemoryPointCloudBuffer::list()
+{
+	SharedMemoryPointCloudBufferIdCollector collector;
+	SharedMemoryPointCloudBufferHeader      h;
+	SharedMemory::list(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h, &collector);
+	return collector.ids;
+}
+
+/** Check if point cloud exists in shared memory.
+ * @param pointcloud_id ID of the point cloud
+ * @return true if a segment for the point cloud exists, false otherwise
+ */
+bool
+SharedMemoryPointCloudBuffer::exists(const char *pointcloud_id)
+{
+	SharedMemoryPointCloudBufferHeader h(pointcloud_id, NULL, 0, 0, 0);
+	return SharedMemory::exists(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h);
+}
+
+/** @class SharedMemoryPointCloudBufferHeader <pcl_utils/shm_pointcloud.h>
+ * Shared memory point cloud buffer header.
+ * @author agent
+ */
+
+/** Constructor. */
+SharedMemoryPointCloudBufferHeader::SharedMemoryPointCloudBufferHeader()
+: point_size_(0), max_points_(0), num_slots_(0), header_(NULL)
+{
+}
+
+/** Constructor.
+ * @param pointcloud_id point cloud ID
+ * @param point_type point type name, NULL to match any
+ * @param point_size size in bytes of a single point
+ * @param max_points maximum number of points per slot
+ * @param num_slots number of slots
+ */
+SharedMemoryPointCloudBufferHeader::SharedMemoryPointCloudBufferHeader(const char * pointcloud_id,
+                                                                       const char * point_type,
+                                                                       size_t       point_size,
+                                                                       unsigned int max_points,
+                                                                       unsigned int num_slots)
+: pointcloud_id_(pointcloud_id),
+  point_type_(point_type ? point_type : ""),
+  point_size_(point_size),
+  max_points_(max_points),
+  num_slots_(num_slots),
+  header_(NULL)
+{
+}
+
+/** Copy constructor.
+ * @param h header to copy
+ */
+SharedMemoryPointCloudBufferHeader::SharedMemoryPointCloudBufferHeader(
+  const SharedMemoryPointCloudBufferHeader *h)
+: pointcloud_id_(h->pointcloud_id_),
+  point_type_(h->point_type_),
+  point_size_(h->point_size_),
+  max_points_(h->max_points_),
+  num_slots_(h->num_slots_),
+  header_(h->header_)
+{
+}
+
+/** Destructor. */
+SharedMemoryPointCloudBufferHeader::~SharedMemoryPointCloudBufferHeader()
+{
+}
+
+SharedMemoryHeader *
+SharedMemoryPointCloudBufferHeader::clone() const
+{
+	return new SharedMemoryPointCloudBufferHeader(this);
+}
+
+bool
+SharedMemoryPointCloudBufferHeader::matches(void *memptr)
+{
+	SharedMemoryPointCloudBuffer_header_t *h = (SharedMemoryPointCloudBuffer_header_t *)memptr;
+
+	if (pointcloud_id_.empty())
+		return true;
+
+	if (strncmp(h->pointcloud_id, pointcloud_id_.c_str(), POINTCLOUD_ID_MAX_LENGTH) != 0)
+		return false;
+
+	if (!point_type_.empty()
+	    && (strncmp(h->point_type, point_type_.c_str(), POINTCLOUD_POINT_TYPE_MAX_LENGTH) != 0
+	        || h->point_size != point_size_ || h->max_points != max_points_
+	        || h->num_slots != num_slots_)) {
+		throw Exception("Inconsistent point cloud '%s' found in memory", pointcloud_id_.c_str());
+	}
+	return true;
+}
+
+size_t
+SharedMemoryPointCloudBufferHeader::size()
+{
+	return sizeof(SharedMemoryPointCloudBuffer_header_t);
+}
+
+void
+SharedMemoryPointCloudBufferHeader::initialize(void *memptr)
+{
+	SharedMemoryPointCloudBuffer_header_t *header = (SharedMemoryPointCloudBuffer_header_t *)memptr;
+	memset(memptr, 0, sizeof(SharedMemoryPointCloudBuffer_header_t));
+
+	strncpy(header->pointcloud_id, pointcloud_id_.c_str(), POINTCLOUD_ID_MAX_LENGTH - 1);
+	strncpy(header->point_type, point_type_.c_str(), POINTCLOUD_POINT_TYPE_MAX_LENGTH - 1);
+	header->point_size = point_size_;
+	header->max_points = max_points_;
+	header->num_slots  = num_slots_;
+	header->latest_seq = 0;
+
+	// slot meta data follows the header, mark all slots empty
+	memset((char *)memptr + sizeof(SharedMemoryPointCloudBuffer_header_t),
+	       0,
+	       sizeof(SharedMemoryPointCloudBuffer_slot_t) * num_slots_);
+
+	header_ = header;
+}
+
+void
+SharedMemoryPointCloudBufferHeader::set(void *memptr)
+{
+	header_ = (SharedMemoryPointCloudBuffer_header_t *)memptr;
+
+	pointcloud_id_ =
+	  std::string(header_->pointcloud_id, strnlen(header_->pointcloud_id, POINTCLOUD_ID_MAX_LENGTH));
+	point_type_ = std::string(header_->point_type,
+	                          strnlen(header_->point_type, POINTCLOUD_POINT_TYPE_MAX_LENGTH));
+	point_size_ = header_->point_size;
+	max_points_ = header_->max_points;
+	num_slots_  = header_->num_slots;
+}
+
+void
+SharedMemoryPointCloudBufferHeader::reset()
+{
+	header_ = NULL;
+}
+
+size_t
+SharedMemoryPointCloudBufferHeader::data_size()
+{
+	size_t point_size = header_ ? header_->point_size : point_size_;
+	size_t max_points = header_ ? header_->max_points : max_points_;
+	size_t num_slots  = header_ ? header_->num_slots : num_slots_;
+	return num_slots * (sizeof(SharedMemoryPointCloudBuffer_slot_t) + max_points * point_size);
+}
+
+bool
+SharedMemoryPointCloudBufferHeader::operator==(const SharedMemoryHeader &s) const
+{
+	const SharedMemoryPointCloudBufferHeader *h =
+	  dynamic_cast<const SharedMemoryPointCloudBufferHeader *>(&s);
+	return (h && pointcloud_id_ == h->pointcloud_id_ && point_type_ == h->point_type_
+	        && point_size_ == h->point_size_ && max_points_ == h->max_points_
+	        && num_slots_ == h->num_slots_);
+}
+
+/** Get point cloud ID.
+ * @return point cloud ID
+ */
+const char *
+SharedMemoryPointCloudBufferHeader::pointcloud_id() const
+{
+	return pointcloud_id_.c_str();
+}
+
+/** Get point type name.
+ * @return point type name
+ */
+const char *
+SharedMemoryPointCloudBufferHeader::point_type() const
+{
+	return point_type_.c_str();
+}
+
+/** Get point size.
+ * @return size in bytes of a single point
+ */
+size_t
+SharedMemoryPointCloudBufferHeader::point_size() const
+{
+	return point_size_;
+}
+
+/** Get maximum number of points.
+ * @return maximum number of points per slot
+ */
+unsigned int
+SharedMemoryPointCloudBufferHeader::max_points() const
+{
+	return max_points_;
+}
+
+/** Get number of slots.
+ * @return number of slots
+ */
+unsigned int
+SharedMemoryPointCloudBufferHeader::num_slots() const
+{
+	return num_slots_;
+}
+
+/** Get raw header.
+ * @return raw header in shared memory
+ */
+SharedMemoryPointCloudBuffer_header_t *
+SharedMemoryPointCloudBufferHeader::raw_header()
+{
+	return header_;
+}
+
+/** @class SharedMemoryStorageAdapter <pcl_utils/shm_pointcloud.h>
+ * Storage adapter for point clouds in shared memory.
+ * The adapter provides the generic storage adapter interface for a point
+ * cloud published by another process. It refers to a snapshot of the
+ * latest cloud taken by update(), data_ptr() points directly into shared
+ * memory. Use is_valid() after processing to check that the data has not
+ * been overwritten. The point type is only known by name, therefore the
+ * adapter cannot be converted to a typed PointCloudStorageAdapter and
+ * does not support transformation.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param pointcloud_id ID of the point cloud in shared memory
+ */
+SharedMemoryStorageAdapter::SharedMemoryStorageAdapter(const char *pointcloud_id) : data_(NULL)
+{
+	buffer_   = new SharedMemoryPointCloudBuffer(pointcloud_id);
+	meta_.seq = 0;
+	update();
+}
+
+/** Destructor. */
+SharedMemoryStorageAdapter::~SharedMemoryStorageAdapter()
+{
+	delete buffer_;
+}
+
+/** Update to latest point cloud.
+ * @return true if a new point cloud is available, false otherwise
+ */
+bool
+SharedMemoryStorageAdapter::update()
+{
+	uint64_t seq = buffer_->latest_seq();
+	if (seq == 0 || seq == meta_.seq)
+		return false;
+
+	SharedMemoryPointCloudBuffer::MetaData meta;
+	const void *                           data = buffer_->get(seq, meta);
+	if (!data)
+		return false;
+
+	meta_ = meta;
+	data_ = data;
+	return true;
+}
+
+/** Check if the current snapshot is still valid.
+ * @return true if the data of the snapshot has not been overwritten
+ */
+bool
+SharedMemoryStorageAdapter::is_valid() const
+{
+	return data_ && buffer_->is_valid(meta_.seq);
+}
+
+void
+SharedMemoryStorageAdapter::transform(const std::string &    target_frame,
+                                      const tf::Transformer &transformer)
+{
+	throw Exception("Shared memory point clouds cannot be transformed");
+}
+
+void
+SharedMemoryStorageAdapter::transform(const std::string &    target_frame,
+                                      const Time &           target_time,
+                                      const std::string &    fixed_frame,
+                                      const tf::Transformer &transformer)
+{
+	throw Exception("Shared memory point clouds cannot be transformed");
+}
+
+const char *
+SharedMemoryStorageAdapter::get_typename()
+{
+	return buffer_->point_type();
+}
+
+StorageAdapter *
+SharedMemoryStorageAdapter::clone() const
+{
+	return new SharedMemoryStorageAdapter(buffer_->pointcloud_id());
+}
+
+size_t
+SharedMemoryStorageAdapter::point_size() const
+{
+	return buffer_->point_size();
+}
+
+unsigned int
+SharedMemoryStorageAdapter::width() const
+{
+	return data_ ? meta_.width : 0;
+}
+
+unsigned int
+SharedMemoryStorageAdapter::height() const
+{
+	return data_ ? meta_.height : 0;
+}
+
+size_t
+SharedMemoryStorageAdapter::num_points() const
+{
+	return data_ ? meta_.num_points : 0;
+}
+
+void *
+SharedMemoryStorageAdapter::data_ptr() const
+{
+	return (void *)data_;
+}
+
+std::string
+SharedMemoryStorageAdapter::frame_id() const
+{
+	return data_ ? meta_.frame_id : "";
+}
+
+void
+SharedMemoryStorageAdapter::get_time(fawkes::Time &time) const
+{
+	if (data_) {
+		time = meta_.time;
+	} else {
+		time.set_time(0, 0);
+	}
+}
+
+} // end namespace pcl_utils
+} // end namespace fawkes
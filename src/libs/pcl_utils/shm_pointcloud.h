@@ -0,0 +1,204 @@
+
+/***************************************************************************
+ *  shm_pointcloud.h - Point clouds in shared memory
+ *
+ *  Created: Sat Oct 17 18:47:12 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _LIBS_PCL_UTILS_SHM_POINTCLOUD_H_
+#define _LIBS_PCL_UTILS_SHM_POINTCLOUD_H_
+
+#include <pcl_utils/storage_adapter.h>
+#include <utils/ipc/shm.h>
+#include <utils/time/time.h>
+
+#include <list>
+#include <stdint.h>
+#include <string>
+
+/** Magic token to identify Fawkes shared memory point clouds */
+#define FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN "FawkesPointCloud"
+
+/** Maximum length of point cloud ID (including null-termination) */
+#define POINTCLOUD_ID_MAX_LENGTH 64
+/** Maximum length of point type name (including null-termination) */
+#define POINTCLOUD_POINT_TYPE_MAX_LENGTH 128
+/** Maximum length of coordinate frame ID (including null-termination) */
+#define POINTCLOUD_FRAME_ID_MAX_LENGTH 64
+
+namespace fawkes {
+namespace pcl_utils {
+
+/** Shared memory header struct for point clouds. */
+typedef struct
+{
+	char     pointcloud_id[POINTCLOUD_ID_MAX_LENGTH];       /**< point cloud ID */
+	char     point_type[POINTCLOUD_POINT_TYPE_MAX_LENGTH]; /**< point type name */
+	uint32_t point_size;                                   /**< size of a point in bytes */
+	uint32_t max_points;                                   /**< maximum points per slot */
+	uint32_t num_slots;                                    /**< number of ring slots */
+	uint32_t reserved;                                     /**< reserved, for alignment */
+	uint64_t latest_seq; /**< sequence number of latest complete cloud, 0 if none */
+} SharedMemoryPointCloudBuffer_header_t;
+
+/** Meta data of a single slot of the point cloud ring. */
+typedef struct
+{
+	uint64_t seq;        /**< sequence number of cloud in slot, 0 while written */
+	uint32_t width;      /**< width of the point cloud */
+	uint32_t height;     /**< height of the point cloud */
+	uint64_t num_points; /**< number of points in the slot */
+	int64_t  time_sec;   /**< capture time, seconds */
+	int64_t  time_usec;  /**< capture time, microseconds */
+	char     frame_id[POINTCLOUD_FRAME_ID_MAX_LENGTH]; /**< coordinate frame ID */
+} SharedMemoryPointCloudBuffer_slot_t;
+
+class SharedMemoryPointCloudBufferHeader : public SharedMemoryHeader
+{
+public:
+	SharedMemoryPointCloudBufferHeader();
+	SharedMemoryPointCloudBufferHeader(const char * pointcloud_id,
+	                                   const char * point_type,
+	                                   size_t       point_size,
+	                                   unsigned int max_points,
+	                                   unsigned int num_slots);
+	SharedMemoryPointCloudBufferHeader(const SharedMemoryPointCloudBufferHeader *h);
+	virtual ~SharedMemoryPointCloudBufferHeader();
+
+	virtual SharedMemoryHeader *clone() const;
+	virtual bool                matches(void *memptr);
+	virtual size_t              size();
+	virtual void                initialize(void *memptr);
+	virtual void                set(void *memptr);
+	virtual void                reset();
+	virtual size_t              data_size();
+	virtual bool                operator==(const SharedMemoryHeader &s) const;
+
+	const char * pointcloud_id() const;
+	const char * point_type() const;
+	size_t       point_size() const;
+	unsigned int max_points() const;
+	unsigned int num_slots() const;
+
+	SharedMemoryPointCloudBuffer_header_t *raw_header();
+
+private:
+	std::string  pointcloud_id_;
+	std::string  point_type_;
+	size_t       point_size_;
+	unsigned int max_points_;
+	unsigned int num_slots_;
+
+	SharedMemoryPointCloudBuffer_header_t *header_;
+};
+
+class SharedMemoryPointCloudBuffer : public SharedMemory
+{
+public:
+	/** Meta data of a point cloud in the ring. */
+	typedef struct
+	{
+		uint64_t     seq;        ///< sequence number
+		unsigned int width;      ///< width of the point cloud
+		unsigned int height;     ///< height of the point cloud
+		size_t       num_points; ///< number of points
+		fawkes::Time time;       ///< capture time
+		std::string  frame_id;   ///< coordinate frame ID
+	} MetaData;
+
+	SharedMemoryPointCloudBuffer(const char * pointcloud_id,
+	                             const char * point_type,
+	                             size_t       point_size,
+	                             unsigned int max_points,
+	                             unsigned int num_slots);
+	explicit SharedMemoryPointCloudBuffer(const char *pointcloud_id);
+	virtual ~SharedMemoryPointCloudBuffer();
+
+	const char * pointcloud_id() const;
+	const char * point_type() const;
+	size_t       point_size() const;
+	unsigned int max_points() const;
+	unsigned int num_slots() const;
+
+	uint64_t publish(unsigned int        width,
+	                 unsigned int        height,
+	                 const void *        points,
+	                 size_t              num_points,
+	                 const fawkes::Time &time,
+	                 const std::string & frame_id);
+
+	uint64_t    latest_seq() const;
+	const void *get(uint64_t seq, MetaData &meta) const;
+	bool        is_valid(uint64_t seq) const;
+
+	static std::list<std::string> list();
+	static bool                   exists(const char *pointcloud_id);
+
+private:
+	SharedMemoryPointCloudBuffer_slot_t *slot(uint64_t seq) const;
+	char *                               slot_data(uint64_t seq) const;
+
+private:
+	SharedMemoryPointCloudBufferHeader *   priv_header_;
+	SharedMemoryPointCloudBuffer_header_t *raw_header_;
+	uint64_t                               next_seq_;
+};
+
+class SharedMemoryStorageAdapter : public StorageAdapter
+{
+public:
+	explicit SharedMemoryStorageAdapter(const char *pointcloud_id);
+	virtual ~SharedMemoryStorageAdapter();
+
+	bool update();
+	bool is_valid() const;
+
+	/** Get shared memory buffer.
+	 * @return shared memory buffer */
+	SharedMemoryPointCloudBuffer *
+	buffer() const
+	{
+		return buffer_;
+	}
+
+	virtual void transform(const std::string &target_frame, const tf::Transformer &transformer);
+	virtual void transform(const std::string &    target_frame,
+	                       const Time &           target_time,
+	                       const std::string &    fixed_frame,
+	                       const tf::Transformer &transformer);
+
+	virtual const char *    get_typename();
+	virtual StorageAdapter *clone() const;
+	virtual size_t          point_size() const;
+	virtual unsigned int    width() const;
+	virtual unsigned int    height() const;
+	virtual size_t          num_points() const;
+	virtual void *          data_ptr() const;
+	virtual std::string     frame_id() const;
+	virtual void            get_time(fawkes::Time &time) const;
+
+private:
+	SharedMemoryPointCloudBuffer *         buffer_;
+	SharedMemoryPointCloudBuffer::MetaData meta_;
+	const void *                           data_;
+};
+
+} // end namespace pcl_utils
+} // end namespace fawkes
+
+#endif
@@ -120,6 +120,13 @@ ProtobufStreamClient::~ProtobufStreamClient()
 	asio_thread_.join();
 	free(in_data_);
 	free(in_frame_header_);
+	for (QueueEntry *e : outbound_inflight_) {
+		delete e;
+	}
+	while (!outbound_queue_.empty()) {
+		delete outbound_queue_.front();
+		outbound_queue_.pop();
+	}
 	if (own_message_register_) {
 		delete message_register_;
 	}
@@ -317,29 +324,49 @@ ProtobufStreamClient::handle_read_message(const boost::system::error_code &error
 	}
 }
 
+/** Write queued messages.
+ * Gathers up to PB_MAX_GATHER_ENTRIES queued messages into a single
+ * write operation. Must be called with the outbound mutex locked.
+ */
+void
+ProtobufStreamClient::start_write()
+{
+	outbound_buffers_.clear();
+	while (!outbound_queue_.empty() && outbound_inflight_.size() < PB_MAX_GATHER_ENTRIES) {
+		QueueEntry *entry = outbound_queue_.front();
+		outbound_queue_.pop();
+		outbound_inflight_.push_back(entry);
+		outbound_buffers_.insert(outbound_buffers_.end(),
+		                         entry->buffers.begin(),
+		                         entry->buffers.end());
+	}
+
+	boost::asio::async_write(socket_,
+	                         outbound_buffers_,
+	                         boost::bind(&ProtobufStreamClient::handle_write,
+	                                     this,
+	                                     boost::asio::placeholders::error,
+	                                     boost::asio::placeholders::bytes_transferred));
+}
+
 void
 ProtobufStreamClient::handle_write(const boost::system::error_code &error,
-                                   size_t /*bytes_transferred*/,
-                                   QueueEntry *entry)
+                                   size_t /*bytes_transferred*/)
 {
-	delete entry;
+	std::unique_lock<std::mutex> lock(outbound_mutex_);
+	for (QueueEntry *e : outbound_inflight_) {
+		outbound_pool_.release(e);
+	}
+	outbound_inflight_.clear();
 
 	if (!error) {
-		std::lock_guard<std::mutex> lock(outbound_mutex_);
 		if (!outbound_queue_.empty()) {
-			QueueEntry *front_entry = outbound_queue_.front();
-			outbound_queue_.pop();
-			boost::asio::async_write(socket_,
-			                         front_entry->buffers,
-			                         boost::bind(&ProtobufStreamClient::handle_write,
-			                                     this,
-			                                     boost::asio::placeholders::error,
-			                                     boost::asio::placeholders::bytes_transferred,
-			                                     front_entry));
+			start_write();
 		} else {
 			outbound_active_ = false;
 		}
 	} else {
+		lock.unlock();
 		disconnect_nosig();
 		sig_disconnected_(error);
 	}
@@ -357,7 +384,7 @@ ProtobufStreamClient::send(uint16_t component_id, uint16_t msg_type, google::pro
 		throw std::runtime_error("Cannot send while not connected");
 	}
 
-	QueueEntry *entry = new QueueEntry();
+	QueueEntry *entry = outbound_pool_.acquire();
 	message_register_->serialize(component_id,
 	                             msg_type,
 	                             m,
@@ -380,17 +407,10 @@ ProtobufStreamClient::send(uint16_t component_id, uint16_t msg_type, google::pro
 	entry->buffers[2] = boost::asio::buffer(entry->serialized_message);
 
 	std::lock_guard<std::mutex> lock(outbound_mutex_);
-	if (outbound_active_) {
-		outbound_queue_.push(entry);
-	} else {
+	outbound_queue_.push(entry);
+	if (!outbound_active_) {
 		outbound_active_ = true;
-		boost::asio::async_write(socket_,
-		                         entry->buffers,
-		                         boost::bind(&ProtobufStreamClient::handle_write,
-		                                     this,
-		                                     boost::asio::placeholders::error,
-		                                     boost::asio::placeholders::bytes_transferred,
-		                                     entry));
+		start_write();
 	}
 }
 
@@ -49,6 +49,7 @@
 #include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace protobuf_comm {
 
@@ -129,9 +130,8 @@ private: // methods
 	void handle_resolve(const boost::system::error_code &        err,
 	                    boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
 	void handle_connect(const boost::system::error_code &err);
-	void handle_write(const boost::system::error_code &error,
-	                  size_t /*bytes_transferred*/,
-	                  QueueEntry *entry);
+	void start_write();
+	void handle_write(const boost::system::error_code &error, size_t /*bytes_transferred*/);
 	void start_recv();
 	void handle_read_header(const boost::system::error_code &error);
 	void handle_read_message(const boost::system::error_code &error);
@@ -152,9 +152,12 @@ private: // members
 
 	std::thread asio_thread_;
 
-	std::queue<QueueEntry *> outbound_queue_;
-	std::mutex               outbound_mutex_;
-	bool                     outbound_active_;
+	std::queue<QueueEntry *>               outbound_queue_;
+	std::vector<QueueEntry *>              outbound_inflight_;
+	std::vector<boost::asio::const_buffer> outbound_buffers_;
+	QueueEntryPool                         outbound_pool_;
+	std::mutex                             outbound_mutex_;
+	bool                                   outbound_active_;
 
 	void * in_frame_header_;
 	size_t in_frame_header_size_;
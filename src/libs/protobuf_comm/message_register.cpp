@@ -34,12 +34,14 @@
  * OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <google/protobuf/arena.h>
 #include <google/protobuf/compiler/importer.h>
 #include <google/protobuf/dynamic_message.h>
 #include <netinet/in.h>
 #include <protobuf_comm/message_register.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <dirent.h>
 #include <fnmatch.h>
 
@@ -50,11 +52,15 @@ namespace protobuf_comm {
  * The register is used to automatically parse incoming messages to the
  * appropriate type. In your application, you need to register any
  * message you want to read. All unknown messages are silently dropped.
+ *
+ * Looking up registered types, e.g., when deserializing incoming messages,
+ * does not lock and may run concurrently from multiple threads. Incoming
+ * messages are allocated in an arena owned by the returned pointer.
  * @author Tim Niemueller
  */
 
 /** Constructor. */
-MessageRegister::MessageRegister()
+MessageRegister::MessageRegister() : maps_(new TypeMaps())
 {
 	pb_srctree_  = NULL;
 	pb_importer_ = NULL;
@@ -67,6 +73,7 @@ MessageRegister::MessageRegister()
  * message creation.
  */
 MessageRegister::MessageRegister(const std::vector<std::string> &proto_path)
+: maps_(new TypeMaps())
 {
 	pb_srctree_ = new google::protobuf::compiler::DiskSourceTree();
 	for (size_t i = 0; i < proto_path.size(); ++i) {
@@ -106,9 +113,12 @@ MessageRegister::MessageRegister(const std::vector<std::string> &proto_path)
 /** Destructor. */
 MessageRegister::~MessageRegister()
 {
-	TypeMap::iterator m;
-	for (m = message_by_comp_type_.begin(); m != message_by_comp_type_.end(); ++m) {
-		delete m->second;
+	delete maps_.load();
+	for (const TypeMaps *m : retired_maps_) {
+		delete m;
+	}
+	for (google::protobuf::Message *m : prototypes_) {
+		delete m;
 	}
 	delete pb_factory_;
 	delete pb_importer_;
@@ -149,26 +159,48 @@ MessageRegister::add_message_type(std::string msg_type)
 {
 	google::protobuf::Message *m = create_msg(msg_type);
 	if (m) {
-		KeyType                     key = key_from_desc(m->GetDescriptor());
-		std::lock_guard<std::mutex> lock(maps_mutex_);
-		if (message_by_comp_type_.find(key) != message_by_comp_type_.end()) {
-#if defined(__GNUC__) && (__GNUC__ < 4 || (__GNUC__ == 4 && __GNUC_MINOR__ < 6))
-			std::string msg = "Message type " + std::to_string((long long)key.first) + ":"
-			                  + std::to_string((long long)key.second) + " already registered";
-#else
-			std::string msg = "Message type " + std::to_string(key.first) + ":"
-			                  + std::to_string(key.second) + " already registered";
-#endif
-			throw std::runtime_error(msg);
-		}
-		//printf("Registering %s (%u:%u)\n", msg_type.c_str(), key.first, key.second);
-		message_by_comp_type_[key]             = m;
-		message_by_typename_[m->GetTypeName()] = m;
+		register_type(key_from_desc(m->GetDescriptor()), m);
 	} else {
 		throw std::runtime_error("Unknown message type");
 	}
 }
 
+/** Register a message type.
+ * @param key component ID and message type
+ * @param m prototype message, the register takes ownership, also in the
+ * case of an error
+ * @exception std::runtime_error thrown if the type has already been registered
+ */
+void
+MessageRegister::register_type(KeyType key, google::protobuf::Message *m)
+{
+	std::lock_guard<std::mutex> lock(maps_mutex_);
+	const TypeMaps *            maps = maps_.load(std::memory_order_relaxed);
+	if (maps->by_comp_type.find(key) != maps->by_comp_type.end()) {
+		delete m;
+		std::string msg = "Message type " + std::to_string(key.first) + ":"
+		                  + std::to_string(key.second) + " already registered";
+		throw std::runtime_error(msg);
+	}
+	prototypes_.push_back(m);
+
+	TypeMaps *new_maps                                     = new TypeMaps(*maps);
+	new_maps->by_comp_type[key]                            = m;
+	new_maps->by_typename[m->GetDescriptor()->full_name()] = m;
+	publish_maps(new_maps);
+}
+
+/** Replace the current type maps.
+ * Must be called with maps_mutex_ locked.
+ * @param maps new type maps
+ */
+void
+MessageRegister::publish_maps(TypeMaps *maps)
+{
+	retired_maps_.push_back(maps_.load(std::memory_order_relaxed));
+	maps_.store(maps, std::memory_order_release);
+}
+
 /** Remove the given message type.
  * @param component_id ID of component this message type belongs to
  * @param msg_type message type
@@ -178,9 +210,13 @@ MessageRegister::remove_message_type(uint16_t component_id, uint16_t msg_type)
 {
 	KeyType                     key(component_id, msg_type);
 	std::lock_guard<std::mutex> lock(maps_mutex_);
-	if (message_by_comp_type_.find(key) != message_by_comp_type_.end()) {
-		message_by_typename_.erase(message_by_comp_type_[key]->GetDescriptor()->full_name());
-		message_by_comp_type_.erase(key);
+	const TypeMaps *            maps = maps_.load(std::memory_order_relaxed);
+	TypeMap::const_iterator     t    = maps->by_comp_type.find(key);
+	if (t != maps->by_comp_type.end()) {
+		TypeMaps *new_maps = new TypeMaps(*maps);
+		new_maps->by_typename.erase(t->second->GetDescriptor()->full_name());
+		new_maps->by_comp_type.erase(key);
+		publish_maps(new_maps);
 	}
 }
 
@@ -216,22 +252,27 @@ MessageRegister::key_from_desc(const google::protobuf::Descriptor *desc)
 std::shared_ptr<google::protobuf::Message>
 MessageRegister::new_message_for(uint16_t component_id, uint16_t msg_type)
 {
-	KeyType key(component_id, msg_type);
+	return std::shared_ptr<google::protobuf::Message>(prototype_for(component_id, msg_type)->New());
+}
 
-	std::lock_guard<std::mutex> lock(maps_mutex_);
-	if (message_by_comp_type_.find(key) == message_by_comp_type_.end()) {
-#if defined(__GNUC__) && (__GNUC__ < 4 || (__GNUC__ == 4 && __GNUC_MINOR__ < 6))
-		std::string msg = "Message type " + std::to_string((long long)component_id) + ":"
-		                  + std::to_string((long long)msg_type) + " not registered";
-#else
+/** Get prototype for message type.
+ * @param component_id ID of component this message type belongs to
+ * @param msg_type message type
+ * @return registered prototype message, it remains valid until the register
+ * is destroyed
+ * @exception std::runtime_error thrown if the type has not been registered
+ */
+google::protobuf::Message *
+MessageRegister::prototype_for(uint16_t component_id, uint16_t msg_type)
+{
+	const TypeMaps *        maps = maps_.load(std::memory_order_acquire);
+	TypeMap::const_iterator t    = maps->by_comp_type.find(KeyType(component_id, msg_type));
+	if (t == maps->by_comp_type.end()) {
 		std::string msg = "Message type " + std::to_string(component_id) + ":"
 		                  + std::to_string(msg_type) + " not registered";
-#endif
 		throw std::runtime_error(msg);
 	}
-
-	google::protobuf::Message *m = message_by_comp_type_[key]->New();
-	return std::shared_ptr<google::protobuf::Message>(m);
+	return t->second;
 }
 
 /** Create a new message instance.
@@ -243,17 +284,19 @@ MessageRegister::new_message_for(uint16_t component_id, uint16_t msg_type)
 std::shared_ptr<google::protobuf::Message>
 MessageRegister::new_message_for(const std::string &full_name)
 {
+	const TypeMaps *            maps = maps_.load(std::memory_order_acquire);
+	TypeNameMap::const_iterator t    = maps->by_typename.find(full_name);
+	if (t != maps->by_typename.end()) {
+		return std::shared_ptr<google::protobuf::Message>(t->second->New());
+	}
+
+	// not registered, the importer is not thread-safe
 	std::lock_guard<std::mutex> lock(maps_mutex_);
-	if (message_by_typename_.find(full_name) == message_by_typename_.end()) {
-		google::protobuf::Message *m = create_msg(full_name);
-		if (m) {
-			return std::shared_ptr<google::protobuf::Message>(m);
-		} else {
-			throw std::runtime_error("Message type not registered");
-		}
-	} else {
-		google::protobuf::Message *m = message_by_typename_[full_name]->New();
+	google::protobuf::Message * m = create_msg(full_name);
+	if (m) {
 		return std::shared_ptr<google::protobuf::Message>(m);
+	} else {
+		throw std::runtime_error("Message type not registered");
 	}
 }
 
@@ -316,7 +359,22 @@ MessageRegister::deserialize(frame_header_t &  frame_header,
 	uint16_t msg_type  = ntohs(message_header.msg_type);
 	size_t   data_size = ntohl(frame_header.payload_size) - sizeof(message_header);
 
-	std::shared_ptr<google::protobuf::Message> m = new_message_for(comp_id, msg_type);
+	google::protobuf::Message *prototype = prototype_for(comp_id, msg_type);
+
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+	// Allocate the message and all its sub-messages and strings in a single
+	// arena block sized after the payload, instead of one allocation each.
+	// The arena is owned by the returned pointer and freed with the message.
+	google::protobuf::ArenaOptions arena_options;
+	arena_options.start_block_size = std::max<size_t>(256, 2 * data_size);
+	arena_options.max_block_size   = std::max<size_t>(arena_options.max_block_size, 2 * data_size);
+	std::shared_ptr<google::protobuf::Arena> arena =
+	  std::make_shared<google::protobuf::Arena>(arena_options);
+
+	std::shared_ptr<google::protobuf::Message> m(arena, prototype->New(arena.get()));
+#else
+	std::shared_ptr<google::protobuf::Message> m(prototype->New());
+#endif
 	if (!m->ParseFromArray(data, data_size)) {
 		throw std::runtime_error("Failed to parse message");
 	}
@@ -43,6 +43,7 @@
 
 #include <boost/thread/mutex.hpp>
 #include <boost/utility.hpp>
+#include <atomic>
 #include <cstdint>
 #include <limits>
 #include <map>
@@ -50,6 +51,7 @@
 #include <mutex>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 namespace google {
 namespace protobuf {
@@ -81,20 +83,7 @@ public:
 	typename std::enable_if<std::is_base_of<google::protobuf::Message, MT>::value, void>::type
 	add_message_type(uint16_t component_id, uint16_t msg_type)
 	{
-		KeyType key(component_id, msg_type);
-		if (message_by_comp_type_.find(key) != message_by_comp_type_.end()) {
-#if defined(__GNUC__) && (__GNUC__ < 4 || (__GNUC__ == 4 && __GNUC_MINOR__ < 6))
-			std::string msg = "Message type " + std::to_string((long long)component_id) + ":"
-			                  + std::to_string((long long)msg_type) + " already registered";
-#else
-			std::string msg = "Message type " + std::to_string(component_id) + ":"
-			                  + std::to_string(msg_type) + " already registered";
-#endif
-			throw std::runtime_error(msg);
-		}
-		MT *m                                                 = new MT();
-		message_by_comp_type_[key]                            = m;
-		message_by_typename_[m->GetDescriptor()->full_name()] = m;
+		register_type(KeyType(component_id, msg_type), new MT());
 	}
 
 	/** Add a new message type.
@@ -105,22 +94,7 @@ public:
 	typename std::enable_if<std::is_base_of<google::protobuf::Message, MT>::value, void>::type
 	add_message_type()
 	{
-		MT                                  m;
-		const google::protobuf::Descriptor *desc = m.GetDescriptor();
-		KeyType                             key  = key_from_desc(desc);
-		if (message_by_comp_type_.find(key) != message_by_comp_type_.end()) {
-#if defined(__GNUC__) && (__GNUC__ < 4 || (__GNUC__ == 4 && __GNUC_MINOR__ < 6))
-			std::string msg = "Message type " + std::to_string((long long int)key.first) + ":"
-			                  + std::to_string((long long int)key.second) + " already registered";
-#else
-			std::string msg = "Message type " + std::to_string(key.first) + ":"
-			                  + std::to_string(key.second) + " already registered";
-#endif
-			throw std::runtime_error(msg);
-		}
-		MT *new_m                                  = new MT();
-		message_by_comp_type_[key]                 = new_m;
-		message_by_typename_[new_m->GetTypeName()] = new_m;
+		register_type(key_from_desc(MT::descriptor()), new MT());
 	}
 
 	void remove_message_type(uint16_t component_id, uint16_t msg_type);
@@ -158,12 +132,29 @@ private: // members
 	typedef std::map<KeyType, google::protobuf::Message *>     TypeMap;
 	typedef std::map<std::string, google::protobuf::Message *> TypeNameMap;
 
+	/// @cond INTERNALS
+	struct TypeMaps
+	{
+		TypeMap     by_comp_type;
+		TypeNameMap by_typename;
+	};
+	/// @endcond
+
 	KeyType                    key_from_desc(const google::protobuf::Descriptor *desc);
 	google::protobuf::Message *create_msg(const std::string &msg_type);
-
-	std::mutex  maps_mutex_;
-	TypeMap     message_by_comp_type_;
-	TypeNameMap message_by_typename_;
+	void                       register_type(KeyType key, google::protobuf::Message *m);
+	void                       publish_maps(TypeMaps *maps);
+	google::protobuf::Message *prototype_for(uint16_t component_id, uint16_t msg_type);
+
+	// Lookups read the current maps without locking. The maps are never
+	// modified once published, (un)registering a type publishes a modified
+	// copy. Previous maps and prototypes are kept until destruction, as
+	// readers might still use them. Types are usually registered once
+	// during initialization, hence the overhead is negligible.
+	std::mutex                               maps_mutex_;
+	std::atomic<const TypeMaps *>            maps_;
+	std::vector<const TypeMaps *>            retired_maps_;
+	std::vector<google::protobuf::Message *> prototypes_;
 
 	google::protobuf::compiler::DiskSourceTree *pb_srctree_;
 	google::protobuf::compiler::Importer *      pb_importer_;
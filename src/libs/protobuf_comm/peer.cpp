@@ -552,7 +552,7 @@ ProtobufBroadcastPeer::handle_sent(const boost::system::error_code &error,
                                    size_t                           bytes_transferred,
                                    QueueEntry *                     entry)
 {
-	delete entry;
+	outbound_pool_.release(entry);
 
 	{
 		std::lock_guard<std::mutex> lock(outbound_mutex_);
@@ -574,7 +574,7 @@ ProtobufBroadcastPeer::handle_sent(const boost::system::error_code &error,
 void
 ProtobufBroadcastPeer::send(uint16_t component_id, uint16_t msg_type, google::protobuf::Message &m)
 {
-	QueueEntry *entry = new QueueEntry();
+	QueueEntry *entry = outbound_pool_.acquire();
 	message_register_->serialize(component_id,
 	                             msg_type,
 	                             m,
@@ -618,9 +618,9 @@ ProtobufBroadcastPeer::send_raw(const frame_header_t &frame_header,
                                 const void *          data,
                                 size_t                data_size)
 {
-	QueueEntry *entry         = new QueueEntry();
-	entry->frame_header       = frame_header;
-	entry->serialized_message = std::string(reinterpret_cast<const char *>(data), data_size);
+	QueueEntry *entry   = outbound_pool_.acquire();
+	entry->frame_header = frame_header;
+	entry->serialized_message.assign(reinterpret_cast<const char *>(data), data_size);
 
 	entry->buffers[0] = boost::asio::buffer(&entry->frame_header, sizeof(frame_header_t));
 	entry->buffers[1] = boost::asio::const_buffer();
@@ -211,6 +211,7 @@ private: // members
 	unsigned int send_to_port_;
 
 	std::queue<QueueEntry *> outbound_queue_;
+	QueueEntryPool           outbound_pool_;
 	std::mutex               outbound_mutex_;
 	bool                     outbound_active_;
 	bool                     outbound_ready_;
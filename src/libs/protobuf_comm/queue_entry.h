@@ -37,21 +37,40 @@
 #ifndef _PROTOBUF_COMM_QUEUE_ENTRY_H_
 #define _PROTOBUF_COMM_QUEUE_ENTRY_H_
 
+#include <protobuf_comm/frame_header.h>
+
 #include <array>
 #include <boost/asio.hpp>
+#include <boost/utility.hpp>
+#include <mutex>
+#include <vector>
 
 namespace protobuf_comm {
 
+/** Maximum number of queue entries written with a single gathered write. */
+static const size_t PB_MAX_GATHER_ENTRIES = 16;
+
 /** Outgoing queue entry. */
 struct QueueEntry
 {
 public:
 	/** Constructor. */
 	QueueEntry()
+	{
+		reset();
+	};
+
+	/** Reset entry for reuse.
+	 * Clears the messages but keeps their memory allocated. */
+	void
+	reset()
 	{
 		frame_header.header_version = PB_FRAME_V2;
 		frame_header.cipher         = PB_ENCRYPTION_NONE;
-	};
+		serialized_message.clear();
+		encrypted_message.clear();
+	}
+
 	std::string       serialized_message; ///< serialized protobuf message
 	frame_header_t    frame_header;       ///< Frame header (network byte order), never encrypted
 	frame_header_v1_t frame_header_v1;    ///< Frame header (network byte order), never encrypted
@@ -60,6 +79,73 @@ public:
 	std::string encrypted_message;                    ///< encrypted buffer if encryption is used
 };
 
+/** Pool of outgoing queue entries.
+ * Entries returned to the pool keep their buffers, such that serializing
+ * further messages of similar size does not allocate memory.
+ */
+class QueueEntryPool : boost::noncopyable
+{
+public:
+	/** Constructor.
+	 * @param max_free maximum number of unused entries to keep
+	 * @param max_entry_size entries with buffers larger than this many bytes
+	 * are freed instead of being kept, e.g., after sending a large map
+	 */
+	explicit QueueEntryPool(size_t max_free = 32, size_t max_entry_size = 65536)
+	: max_free_(max_free), max_entry_size_(max_entry_size)
+	{
+	}
+
+	/** Destructor. */
+	~QueueEntryPool()
+	{
+		for (QueueEntry *e : free_) {
+			delete e;
+		}
+	}
+
+	/** Get an entry.
+	 * @return unused entry, must be returned with release()
+	 */
+	QueueEntry *
+	acquire()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!free_.empty()) {
+				QueueEntry *e = free_.back();
+				free_.pop_back();
+				return e;
+			}
+		}
+		return new QueueEntry();
+	}
+
+	/** Return an entry to the pool.
+	 * @param entry entry acquired from this pool
+	 */
+	void
+	release(QueueEntry *entry)
+	{
+		if (entry->serialized_message.capacity() + entry->encrypted_message.capacity()
+		    <= max_entry_size_) {
+			entry->reset();
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (free_.size() < max_free_) {
+				free_.push_back(entry);
+				return;
+			}
+		}
+		delete entry;
+	}
+
+private:
+	std::mutex                mutex_;
+	std::vector<QueueEntry *> free_;
+	size_t                    max_free_;
+	size_t                    max_entry_size_;
+};
+
 } // end namespace protobuf_comm
 
 #endif
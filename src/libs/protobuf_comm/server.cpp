@@ -75,6 +75,13 @@ ProtobufStreamServer::Session::~Session()
 		socket_.close();
 	}
 	free(in_data_);
+	for (QueueEntry *e : outbound_inflight_) {
+		delete e;
+	}
+	while (!outbound_queue_.empty()) {
+		delete outbound_queue_.front();
+		outbound_queue_.pop();
+	}
 }
 
 /** Do processing required to start a session.
@@ -109,7 +116,7 @@ ProtobufStreamServer::Session::send(uint16_t                   component_id,
                                     uint16_t                   msg_type,
                                     google::protobuf::Message &m)
 {
-	QueueEntry *entry = new QueueEntry();
+	QueueEntry *entry = outbound_pool_.acquire();
 	parent_->message_register().serialize(component_id,
 	                                      msg_type,
 	                                      m,
@@ -122,20 +129,38 @@ ProtobufStreamServer::Session::send(uint16_t                   component_id,
 	entry->buffers[2] = boost::asio::buffer(entry->serialized_message);
 
 	std::lock_guard<std::mutex> lock(outbound_mutex_);
-	if (outbound_active_) {
-		outbound_queue_.push(entry);
-	} else {
+	outbound_queue_.push(entry);
+	if (!outbound_active_) {
 		outbound_active_ = true;
-		boost::asio::async_write(socket_,
-		                         entry->buffers,
-		                         boost::bind(&ProtobufStreamServer::Session::handle_write,
-		                                     shared_from_this(),
-		                                     boost::asio::placeholders::error,
-		                                     boost::asio::placeholders::bytes_transferred,
-		                                     entry));
+		start_write();
 	}
 }
 
+/** Write queued messages.
+ * Gathers up to PB_MAX_GATHER_ENTRIES queued messages into a single
+ * write operation. Must be called with the outbound mutex locked.
+ */
+void
+ProtobufStreamServer::Session::start_write()
+{
+	outbound_buffers_.clear();
+	while (!outbound_queue_.empty() && outbound_inflight_.size() < PB_MAX_GATHER_ENTRIES) {
+		QueueEntry *entry = outbound_queue_.front();
+		outbound_queue_.pop();
+		outbound_inflight_.push_back(entry);
+		outbound_buffers_.insert(outbound_buffers_.end(),
+		                         entry->buffers.begin(),
+		                         entry->buffers.end());
+	}
+
+	boost::asio::async_write(socket_,
+	                         outbound_buffers_,
+	                         boost::bind(&ProtobufStreamServer::Session::handle_write,
+	                                     shared_from_this(),
+	                                     boost::asio::placeholders::error,
+	                                     boost::asio::placeholders::bytes_transferred));
+}
+
 /** Disconnect from client. */
 void
 ProtobufStreamServer::Session::disconnect()
@@ -150,27 +175,22 @@ ProtobufStreamServer::Session::disconnect()
 /** Write completion handler. */
 void
 ProtobufStreamServer::Session::handle_write(const boost::system::error_code &error,
-                                            size_t /*bytes_transferred*/,
-                                            QueueEntry *entry)
+                                            size_t /*bytes_transferred*/)
 {
-	delete entry;
+	std::unique_lock<std::mutex> lock(outbound_mutex_);
+	for (QueueEntry *e : outbound_inflight_) {
+		outbound_pool_.release(e);
+	}
+	outbound_inflight_.clear();
 
 	if (!error) {
-		std::lock_guard<std::mutex> lock(outbound_mutex_);
 		if (!outbound_queue_.empty()) {
-			QueueEntry *front_entry = outbound_queue_.front();
-			outbound_queue_.pop();
-			boost::asio::async_write(socket_,
-			                         front_entry->buffers,
-			                         boost::bind(&ProtobufStreamServer::Session::handle_write,
-			                                     shared_from_this(),
-			                                     boost::asio::placeholders::error,
-			                                     boost::asio::placeholders::bytes_transferred,
-			                                     front_entry));
+			start_write();
 		} else {
 			outbound_active_ = false;
 		}
 	} else {
+		lock.unlock();
 		parent_->disconnected(shared_from_this(), error);
 	}
 }
@@ -52,6 +52,7 @@
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 #if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
 #	include <atomic>
 #endif
@@ -174,9 +175,8 @@ private:
 	private:
 		void handle_read_message(const boost::system::error_code &error);
 		void handle_read_header(const boost::system::error_code &error);
-		void handle_write(const boost::system::error_code &error,
-		                  size_t /*bytes_transferred*/,
-		                  QueueEntry *entry);
+		void start_write();
+		void handle_write(const boost::system::error_code &error, size_t /*bytes_transferred*/);
 
 	private:
 		ClientID                       id_;
@@ -188,9 +188,12 @@ private:
 		size_t         in_data_size_;
 		void *         in_data_;
 
-		std::queue<QueueEntry *> outbound_queue_;
-		std::mutex               outbound_mutex_;
-		bool                     outbound_active_;
+		std::queue<QueueEntry *>               outbound_queue_;
+		std::vector<QueueEntry *>              outbound_inflight_;
+		std::vector<boost::asio::const_buffer> outbound_buffers_;
+		QueueEntryPool                         outbound_pool_;
+		std::mutex                             outbound_mutex_;
+		bool                                   outbound_active_;
 	};
 
 private: // methods
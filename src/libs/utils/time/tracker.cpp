@@ -23,18 +23,44 @@
 
 #include <core/exceptions/software.h>
 #include <core/exceptions/system.h>
+#include <core/threading/mutex_locker.h>
 #include <utils/time/tracker.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <ctime>
 #include <iostream>
 
 using namespace std;
 
 namespace fawkes {
 
+/// @cond INTERNALS
+namespace {
+
+inline int64_t
+monotonic_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Only the tracking thread writes the statistics, a plain load and store
+// is sufficient and avoids locked read-modify-write instructions.
+template <typename T>
+inline void
+add_relaxed(std::atomic<T> &a, T v)
+{
+	a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+} // namespace
+/// @endcond
+
 /** @class TimeTracker <utils/time/tracker.h>
  * Time tracking utility.
  * This class provides means to track time of different tasks in a process.
@@ -53,6 +79,21 @@ namespace fawkes {
  * a specific point in time and then stop it after the sub-task is done to measure
  * only this very task. This can be done by using pingStart() and pingEnd().
  *
+ * Class durations are taken from the monotonic clock with nanosecond
+ * resolution and do not allocate memory per measurement. By default all
+ * durations since the last reset are kept. For long-running profiling
+ * limit the samples per class with set_max_samples(), the tracker then
+ * keeps the most recent durations in a preallocated ring buffer. Averages
+ * and deviations printed are computed over the kept samples. Additionally,
+ * count, sum, extrema, and a histogram of all durations since the last
+ * reset are updated on each measurement. They provide summary() and
+ * quantile() in constant memory and may be read from other threads, e.g.,
+ * to export them as metrics. Give the tracker a name with set_name() to
+ * have it exported by the metrics plugin.
+ *
+ * Classless pings record the wall clock time, the most recent pings are
+ * kept, up to the maximum number of samples or 10000 if not limited.
+ *
  * @author Tim Niemueller
  */
 
@@ -66,10 +107,10 @@ TimeTracker::TimeTracker(bool add_default_class)
 {
 	timelog_     = NULL;
 	write_cycle_ = 0;
+	max_samples_ = 0;
 	reset();
 	if (add_default_class) {
-		class_times_.push_back(vector<struct timeval *>());
-		class_names_.push_back("Default");
+		add_class("Default");
 	}
 }
 
@@ -80,10 +121,10 @@ TimeTracker::TimeTracker(bool add_default_class)
 TimeTracker::TimeTracker(const char *filename, bool add_default_class)
 {
 	write_cycle_ = 0;
+	max_samples_ = 0;
 	reset();
 	if (add_default_class) {
-		class_times_.push_back(vector<struct timeval *>());
-		class_names_.push_back("Default");
+		add_class("Default");
 	}
 	timelog_ = fopen(filename, "w");
 	if (!timelog_) {
@@ -94,12 +135,75 @@ TimeTracker::TimeTracker(const char *filename, bool add_default_class)
 /** Destructor. */
 TimeTracker::~TimeTracker()
 {
+	set_name("");
 	if (timelog_) {
 		fclose(timelog_);
 	}
-	reset();
-	class_times_.clear();
-	class_names_.clear();
+	for (ClassData *cd : classes_) {
+		delete cd;
+	}
+	classes_.clear();
+}
+
+/** Limit number of samples kept per class.
+ * The memory for the samples is allocated immediately for all existing
+ * classes, and when adding a class for later ones. Once the limit has been
+ * reached, each new duration replaces the oldest. The summary statistics
+ * are not affected by the limit. Changing the limit discards the samples
+ * kept so far.
+ * @param max_samples maximum number of samples per class, zero to keep all
+ * samples since the last reset
+ */
+void
+TimeTracker::set_max_samples(size_t max_samples)
+{
+	max_samples_ = max_samples;
+	for (ClassData *cd : classes_) {
+		cd->samples.clear();
+		cd->samples.shrink_to_fit();
+		cd->samples.reserve(max_samples_);
+		cd->next_sample = 0;
+	}
+}
+
+/** Get maximum number of samples kept per class.
+ * @return maximum number of samples per class, zero if unlimited
+ */
+size_t
+TimeTracker::max_samples() const
+{
+	return max_samples_;
+}
+
+/** Set name of tracker.
+ * A tracker with a name is listed in named_trackers() until it is
+ * destroyed or its name is cleared, e.g., for the metrics plugin to
+ * export its classes.
+ * @param name name of the tracker, must be unique among all trackers in
+ * the process, empty to remove the tracker from the list
+ */
+void
+TimeTracker::set_name(const std::string &name)
+{
+	LockMap<TimeTracker *, std::string> &trackers = named_trackers();
+	MutexLocker                          lock(trackers.mutex());
+	if (name.empty()) {
+		trackers.erase(this);
+	} else {
+		trackers[this] = name;
+	}
+}
+
+/** Get all trackers with a name.
+ * Lock the map while accessing the trackers. A tracker removes itself
+ * from the map when it is destroyed.
+ * @return map from trackers to their names
+ */
+LockMap<TimeTracker *, std::string> &
+TimeTracker::named_trackers()
+{
+	static LockMap<TimeTracker *, std::string> trackers;
+	return trackers;
 }
 
 /** Reset times.
@@ -110,32 +214,52 @@ void
 TimeTracker::reset(std::string comment)
 {
 	tracker_comment_ = comment;
-	for (vector<vector<struct timeval *>>::iterator i = class_times_.begin(); i != class_times_.end();
-	     ++i) {
-		for (vector<struct timeval *>::iterator j = i->begin(); j != i->end(); ++j) {
-			free(*j);
-		}
-		i->clear();
+	for (ClassData *cd : classes_) {
+		clear(cd);
 	}
 	times_.clear();
+	times_dropped_ = 0;
 	comments_.clear();
 	gettimeofday(&start_time, NULL);
-	gettimeofday(&last_time, NULL);
+	last_time_ns_ = monotonic_ns();
+}
+
+void
+TimeTracker::clear(ClassData *cd)
+{
+	cd->samples.clear();
+	cd->next_sample = 0;
+	cd->started     = false;
+	cd->count.store(0, std::memory_order_relaxed);
+	cd->sum_ns.store(0, std::memory_order_relaxed);
+	cd->sum_sq.store(0., std::memory_order_relaxed);
+	cd->min_ns.store(UINT64_MAX, std::memory_order_relaxed);
+	cd->max_ns.store(0, std::memory_order_relaxed);
+	for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		cd->buckets[i].store(0, std::memory_order_relaxed);
+	}
 }
 
 /** Ping classless.
- * This takes the time difference between now and the last ping and adds this
- * to classless tracking.
+ * This records the current wall clock time for classless tracking. If
+ * the maximum number of pings is reached, the oldest one is dropped.
  * @param comment optional ping comment.
  */
 void
 TimeTracker::ping(std::string comment)
 {
-	timeval *t = (timeval *)malloc(sizeof(timeval));
-	gettimeofday(t, NULL);
+	size_t max_pings = max_samples_ > 0 ? max_samples_ : DEFAULT_MAX_PINGS;
+	while (times_.size() >= max_pings) {
+		last_dropped_time_ = times_.front();
+		times_.pop_front();
+		comments_.erase(times_dropped_++);
+	}
+
+	timeval t;
+	gettimeofday(&t, NULL);
 	times_.push_back(t);
 	if (!comment.empty()) {
-		comments_[times_.size() - 1] = comment;
+		comments_[times_dropped_ + times_.size() - 1] = comment;
 	}
 }
 
@@ -151,9 +275,14 @@ TimeTracker::add_class(std::string name)
 	if (name == "") {
 		throw Exception("TimeTracker::add_class(): Class name may not be empty");
 	}
-	class_times_.push_back(vector<struct timeval *>());
-	class_names_.push_back(name);
-	return class_times_.size() - 1;
+	ClassData *cd = new ClassData();
+	cd->name      = name;
+	cd->samples.reserve(max_samples_);
+	clear(cd);
+
+	MutexLocker lock(&classes_mutex_);
+	classes_.push_back(cd);
+	return classes_.size() - 1;
 }
 
 /** Remove a class.
@@ -165,17 +294,56 @@ TimeTracker::add_class(std::string name)
 void
 TimeTracker::remove_class(unsigned int cls)
 {
-	if (cls < class_names_.size()) {
-		class_names_[cls] = "";
+	MutexLocker lock(&classes_mutex_);
+	if (cls < classes_.size()) {
+		classes_[cls]->name = "";
+		classes_[cls]->samples.clear();
+		classes_[cls]->samples.shrink_to_fit();
 	} else {
-		if (class_times_.size() == 0) {
+		if (classes_.size() == 0) {
 			throw Exception("No classes have been added, cannot delete class %u", cls);
 		} else {
-			throw OutOfBoundsException("Invalid class given", cls, 0, class_times_.size() - 1);
+			throw OutOfBoundsException("Invalid class given", cls, 0, classes_.size() - 1);
 		}
 	}
 }
 
+TimeTracker::ClassData *
+TimeTracker::class_data(unsigned int cls)
+{
+	if (cls < classes_.size()) {
+		return classes_[cls];
+	} else if (classes_.size() == 0) {
+		throw Exception("No classes have been added, cannot track times");
+	} else {
+		throw OutOfBoundsException("Invalid class given", cls, 0, classes_.size() - 1);
+	}
+}
+
+void
+TimeTracker::record(ClassData *cd, int64_t duration_ns)
+{
+	if (cd->name.empty())
+		return;
+
+	if (max_samples_ == 0 || cd->samples.size() < max_samples_) {
+		cd->samples.push_back(duration_ns);
+	} else {
+		cd->samples[cd->next_sample] = duration_ns;
+		cd->next_sample              = (cd->next_sample + 1) % max_samples_;
+	}
+
+	uint64_t d = (duration_ns > 0) ? duration_ns : 0;
+	add_relaxed(cd->count, (uint64_t)1);
+	add_relaxed(cd->sum_ns, d);
+	add_relaxed(cd->sum_sq, (double)d * (double)d);
+	if (d < cd->min_ns.load(std::memory_order_relaxed))
+		cd->min_ns.store(d, std::memory_order_relaxed);
+	if (d > cd->max_ns.load(std::memory_order_relaxed))
+		cd->max_ns.store(d, std::memory_order_relaxed);
+	add_relaxed(cd->buckets[bucket(d)], (uint64_t)1);
+}
+
 /** Ping class.
  * This takes the time difference between now and the last ping and adds this
  * to class cls.
@@ -184,30 +352,11 @@ TimeTracker::remove_class(unsigned int cls)
 void
 TimeTracker::ping(unsigned int cls)
 {
-	timeval *t = (timeval *)malloc(sizeof(timeval));
-	gettimeofday(t, NULL);
-
-	long sec  = t->tv_sec - last_time.tv_sec;
-	long usec = t->tv_usec - last_time.tv_usec;
-	if (usec < 0) {
-		sec -= 1;
-		usec += 1000000;
-	}
-	last_time.tv_sec  = t->tv_sec;
-	last_time.tv_usec = t->tv_usec;
+	int64_t now      = monotonic_ns();
+	int64_t duration = now - last_time_ns_;
+	last_time_ns_    = now;
 
-	t->tv_sec  = sec;
-	t->tv_usec = usec;
-
-	if (cls < class_times_.size()) {
-		class_times_[cls].push_back(t);
-	} else {
-		if (class_times_.size() == 0) {
-			throw Exception("No classes have been added, cannot track times");
-		} else {
-			throw OutOfBoundsException("Invalid class given", cls, 0, class_times_.size() - 1);
-		}
-	}
+	record(class_data(cls), duration);
 }
 
 /** Start of given class task.
@@ -217,21 +366,11 @@ TimeTracker::ping(unsigned int cls)
 void
 TimeTracker::ping_start(unsigned int cls)
 {
-	if (cls >= class_times_.size())
+	if (cls >= classes_.size())
 		return;
 
-	timeval *t = (timeval *)malloc(sizeof(timeval));
-	gettimeofday(t, NULL);
-
-	if (cls < class_times_.size()) {
-		class_times_[cls].push_back(t);
-	} else {
-		if (class_times_.size() == 0) {
-			throw Exception("No classes have been added, cannot track times");
-		} else {
-			throw OutOfBoundsException("Invalid class given", cls, 0, class_times_.size() - 1);
-		}
-	}
+	classes_[cls]->start_ns = monotonic_ns();
+	classes_[cls]->started  = true;
 }
 
 /** End of given class task.
@@ -242,24 +381,16 @@ TimeTracker::ping_start(unsigned int cls)
 void
 TimeTracker::ping_end(unsigned int cls)
 {
-	if (cls >= class_times_.size())
+	if (cls >= classes_.size())
 		return;
 
-	timeval t2;
-	gettimeofday(&t2, NULL);
-
-	timeval *t1 = class_times_[cls].back();
-
-	long sec  = t2.tv_sec - t1->tv_sec;
-	long usec = t2.tv_usec - t1->tv_usec;
-
-	if (usec < 0) {
-		sec -= 1;
-		usec += 1000000;
-	}
+	int64_t    now = monotonic_ns();
+	ClassData *cd  = classes_[cls];
+	if (!cd->started)
+		return;
 
-	t1->tv_sec  = sec;
-	t1->tv_usec = usec;
+	cd->started = false;
+	record(cd, now - cd->start_ns);
 }
 
 /** End of given class task without recording.
@@ -269,32 +400,142 @@ TimeTracker::ping_end(unsigned int cls)
 void
 TimeTracker::ping_abort(unsigned int cls)
 {
-	if (cls >= class_times_.size())
+	if (cls >= classes_.size())
 		return;
 
-	free(class_times_[cls].back());
-	class_times_[cls].pop_back();
+	classes_[cls]->started = false;
 }
 
-void
-TimeTracker::average_and_deviation(vector<struct timeval *> &values,
-                                   double &                  average_sec,
-                                   double &                  average_ms,
-                                   double &                  deviation_sec,
-                                   double &                  deviation_ms)
+/** Get number of classes.
+ * @return number of classes, including removed ones
+ */
+unsigned int
+TimeTracker::num_classes()
+{
+	MutexLocker lock(&classes_mutex_);
+	return classes_.size();
+}
+
+/** Get name of a class.
+ * @param cls class ID
+ * @return name of the class, empty if the class has been removed
+ */
+std::string
+TimeTracker::class_name(unsigned int cls)
+{
+	MutexLocker lock(&classes_mutex_);
+	return class_data(cls)->name;
+}
+
+/** Get summary of a class.
+ * The summary covers all durations recorded since the last reset,
+ * regardless of the maximum number of samples. It may be called
+ * from a thread other than the tracking one. In that case, values
+ * may stem from slightly different points in time.
+ * @param cls class ID
+ * @param summary upon return contains the summary
+ * @return true if at least one duration has been recorded, false otherwise
+ */
+bool
+TimeTracker::summary(unsigned int cls, Summary &summary)
+{
+	MutexLocker lock(&classes_mutex_);
+	ClassData * cd = class_data(cls);
+
+	summary.count = cd->count.load(std::memory_order_relaxed);
+	if (summary.count == 0) {
+		summary.sum = summary.min = summary.max = summary.mean = summary.stddev = 0.;
+		return false;
+	}
+	summary.sum  = cd->sum_ns.load(std::memory_order_relaxed) / 1e9;
+	summary.min  = cd->min_ns.load(std::memory_order_relaxed) / 1e9;
+	summary.max  = cd->max_ns.load(std::memory_order_relaxed) / 1e9;
+	summary.mean = summary.sum / summary.count;
+	double var   = cd->sum_sq.load(std::memory_order_relaxed) / 1e18 / summary.count
+	             - summary.mean * summary.mean;
+	summary.stddev = (var > 0.) ? std::sqrt(var) : 0.;
+	return true;
+}
+
+/** Get quantile of a class.
+ * The quantile is estimated from a histogram of all durations recorded
+ * since the last reset, the relative error is less than 1/16 for
+ * durations up to about 18 minutes.
+ * @param cls class ID
+ * @param q quantile in the range [0, 1], e.g., 0.99 for the 99th percentile
+ * @return estimated quantile in seconds, zero if no durations have been recorded
+ */
+double
+TimeTracker::quantile(unsigned int cls, double q)
 {
-	vector<struct timeval *>::iterator tit;
+	MutexLocker lock(&classes_mutex_);
+	ClassData * cd = class_data(cls);
 
+	uint64_t count = 0;
+	for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		count += cd->buckets[i].load(std::memory_order_relaxed);
+	}
+	if (count == 0)
+		return 0.;
+
+	uint64_t rank = (uint64_t)std::ceil(std::min(std::max(q, 0.), 1.) * count);
+	if (rank == 0)
+		rank = 1;
+
+	uint64_t     cumulative = 0;
+	unsigned int b          = 0;
+	for (; b < NUM_BUCKETS - 1; ++b) {
+		cumulative += cd->buckets[b].load(std::memory_order_relaxed);
+		if (cumulative >= rank)
+			break;
+	}
+
+	uint64_t v   = bucket_mid(b);
+	uint64_t min = cd->min_ns.load(std::memory_order_relaxed);
+	uint64_t max = cd->max_ns.load(std::memory_order_relaxed);
+	return std::min(std::max(v, min), max) / 1e9;
+}
+
+unsigned int
+TimeTracker::bucket(uint64_t value)
+{
+	if (value < SUB_BUCKETS)
+		return (unsigned int)value;
+	unsigned int msb = 63 - __builtin_clzll(value);
+	if (msb > MAX_MSB)
+		return NUM_BUCKETS - 1;
+	unsigned int shift = msb - SUB_BUCKET_BITS;
+	return shift * SUB_BUCKETS + (unsigned int)(value >> shift);
+}
+
+uint64_t
+TimeTracker::bucket_mid(unsigned int bucket)
+{
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+	if (bucket >= NUM_BUCKETS - 1)
+		return UINT64_MAX;
+	unsigned int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+	uint64_t     top   = (bucket - SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+	return (top << shift) + ((1ull << shift) >> 1);
+}
+
+void
+TimeTracker::average_and_deviation(const vector<int64_t> &values,
+                                   double &               average_sec,
+                                   double &               average_ms,
+                                   double &               deviation_sec,
+                                   double &               deviation_ms)
+{
 	average_sec = average_ms = deviation_sec = deviation_ms = 0.f;
 
-	for (tit = values.begin(); tit != values.end(); ++tit) {
-		average_sec += float((*tit)->tv_sec);
-		average_sec += (*tit)->tv_usec / 1000000.f;
+	for (int64_t v : values) {
+		average_sec += v / 1e9;
 	}
 	average_sec /= values.size();
 
-	for (tit = values.begin(); tit != values.end(); ++tit) {
-		deviation_sec += fabs((*tit)->tv_sec + ((*tit)->tv_usec / 1000000.f) - average_sec);
+	for (int64_t v : values) {
+		deviation_sec += fabs(v / 1e9 - average_sec);
 	}
 	deviation_sec /= values.size();
 
@@ -307,17 +548,18 @@ void
 TimeTracker::print_to_stdout()
 {
 	if (!times_.empty()) {
-		unsigned int i               = 0;
-		unsigned int j               = 0;
-		long         diff_sec_start  = 0;
-		long         diff_usec_start = 0;
-		long         diff_sec_last   = 0;
-		long         diff_usec_last  = 0;
-		float        diff_msec_start = 0.0;
-		float        diff_msec_last  = 0.0;
-		time_t       last_sec        = start_time.tv_sec;
-		suseconds_t  last_usec       = start_time.tv_usec;
-		char         time_string[26];
+		unsigned long int i               = times_dropped_;
+		unsigned int      j               = 0;
+		long              diff_sec_start  = 0;
+		long              diff_usec_start = 0;
+		long              diff_sec_last   = 0;
+		long              diff_usec_last  = 0;
+		float             diff_msec_start = 0.0;
+		float             diff_msec_last  = 0.0;
+		const timeval &   last            = times_dropped_ > 0 ? last_dropped_time_ : start_time;
+		time_t            last_sec        = last.tv_sec;
+		suseconds_t       last_usec       = last.tv_usec;
+		char              time_string[26];
 
 		ctime_r(&(start_time.tv_sec), time_string);
 		for (j = 26; j > 0; --j) {
@@ -336,42 +578,42 @@ TimeTracker::print_to_stdout()
 		     << "Initialized: " << time_string << " (" << start_time.tv_sec << ")" << endl
 		     << endl;
 
-		for (time_it_ = times_.begin(); time_it_ != times_.end(); ++time_it_) {
-			char tmp[10];
-			sprintf(tmp, "%3u.", i + 1);
+		for (const timeval &t : times_) {
+			char tmp[24];
+			sprintf(tmp, "%3lu.", i + 1);
 			cout << tmp;
 			if (comments_.count(i) > 0) {
 				cout << "  (" << comments_[i] << ")";
 			}
 			cout << endl;
 
-			diff_sec_start  = (*time_it_)->tv_sec - start_time.tv_sec;
-			diff_usec_start = (*time_it_)->tv_usec - start_time.tv_usec;
+			diff_sec_start  = t.tv_sec - start_time.tv_sec;
+			diff_usec_start = t.tv_usec - start_time.tv_usec;
 			if (diff_usec_start < 0) {
 				diff_sec_start -= 1;
 				diff_usec_start = 1000000 + diff_usec_start;
 			}
 			diff_msec_start = diff_usec_start / 1000.f;
 
-			diff_sec_last  = (*time_it_)->tv_sec - last_sec;
-			diff_usec_last = (*time_it_)->tv_usec - last_usec;
+			diff_sec_last  = t.tv_sec - last_sec;
+			diff_usec_last = t.tv_usec - last_usec;
 			if (diff_usec_last < 0) {
 				diff_sec_last -= 1;
 				diff_usec_last = 1000000 + diff_usec_last;
 			}
 			diff_msec_last = diff_usec_last / 1000.f;
 
-			last_sec  = (*time_it_)->tv_sec;
-			last_usec = (*time_it_)->tv_usec;
+			last_sec  = t.tv_sec;
+			last_usec = t.tv_usec;
 
-			ctime_r(&(*time_it_)->tv_sec, time_string);
+			ctime_r(&t.tv_sec, time_string);
 			for (j = 26; j > 0; --j) {
 				if (time_string[j] == '\n') {
 					time_string[j] = 0;
 					break;
 				}
 			}
-			cout << time_string << " (" << (*time_it_)->tv_sec << ")" << endl;
+			cout << time_string << " (" << t.tv_sec << ")" << endl;
 			cout << "Diff to start: " << diff_sec_start << " sec and " << diff_usec_start
 			     << " usec  (which are " << diff_msec_start << " msec)" << endl;
 			cout << "Diff to last:  " << diff_sec_last << " sec and " << diff_usec_last
@@ -388,27 +630,32 @@ TimeTracker::print_to_stdout()
 	}
 	cout << endl << "==================================================================" << endl;
 
-	vector<vector<struct timeval *>>::iterator it  = class_times_.begin();
-	vector<string>::iterator                   sit = class_names_.begin();
-
 	double deviation    = 0.f;
 	double average      = 0.f;
 	double average_ms   = 0.f;
 	double deviation_ms = 0.f;
 
-	for (; (it != class_times_.end()) && (sit != class_names_.end()); ++it, ++sit) {
-		if (sit->empty())
+	for (unsigned int c = 0; c < classes_.size(); ++c) {
+		ClassData *cd = classes_[c];
+		if (cd->name.empty())
 			continue;
 
-		if (it->size() > 0) {
-			average_and_deviation(*it, average, average_ms, deviation, deviation_ms);
+		if (cd->samples.size() > 0) {
+			average_and_deviation(cd->samples, average, average_ms, deviation, deviation_ms);
 
-			cout << "Class '" << *sit << "'" << endl
+			cout << "Class '" << cd->name << "'" << endl
 			     << "  avg=" << average << " (" << average_ms << " ms)" << endl
 			     << "  dev=" << deviation << " (" << deviation_ms << " ms)" << endl
-			     << "  res=" << it->size() << " results" << endl;
+			     << "  res=" << cd->samples.size() << " results";
+			if (cd->samples.size() < cd->count.load(std::memory_order_relaxed)) {
+				cout << " (most recent of " << cd->count.load(std::memory_order_relaxed) << ")";
+			}
+			cout << endl
+			     << "  p50=" << quantile(c, 0.5) * 1000. << " ms  p90=" << quantile(c, 0.9) * 1000.
+			     << " ms  p99=" << quantile(c, 0.99) * 1000.
+			     << " ms  max=" << cd->max_ns.load(std::memory_order_relaxed) / 1e6 << " ms" << endl;
 		} else {
-			cout << "Class '" << *sit << "' has no results." << endl;
+			cout << "Class '" << cd->name << "' has no results." << endl;
 		}
 	}
 
@@ -428,9 +675,6 @@ TimeTracker::print_to_file()
 	if (!timelog_)
 		throw Exception("Time log not opened, use other ctor");
 
-	vector<vector<struct timeval *>>::iterator it  = class_times_.begin();
-	vector<string>::iterator                   sit = class_names_.begin();
-
 	double deviation    = 0.f;
 	double average      = 0.f;
 	double average_ms   = 0.f;
@@ -438,11 +682,11 @@ TimeTracker::print_to_file()
 	double avgsum       = 0.f;
 
 	fprintf(timelog_, "%u ", ++write_cycle_);
-	for (; (it != class_times_.end()) && (sit != class_names_.end()); ++it, ++sit) {
-		if (sit->empty())
+	for (ClassData *cd : classes_) {
+		if (cd->name.empty())
 			continue;
 
-		average_and_deviation(*it, average, average_ms, deviation, deviation_ms);
+		average_and_deviation(cd->samples, average, average_ms, deviation, deviation_ms);
 
 		avgsum += average;
 		fprintf(timelog_, "%lf %lf %lf %lf %lf ", average, average_ms, avgsum, deviation, deviation_ms);
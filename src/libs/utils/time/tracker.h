@@ -24,10 +24,15 @@
 #ifndef _UTILS_TIME_TRACKER_H_
 #define _UTILS_TIME_TRACKER_H_
 
+#include <core/threading/mutex.h>
+#include <core/utils/lock_map.h>
 #include <sys/time.h>
 
+#include <atomic>
 #include <cstdio>
+#include <deque>
 #include <map>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -38,10 +43,28 @@ class TimeTracker
 public:
 	static const unsigned int DEFAULT_CLASS;
 
+	/** Summary of the durations of a class. */
+	typedef struct
+	{
+		uint64_t count;  /**< number of durations recorded since the last reset */
+		double   sum;    /**< sum of all durations in seconds */
+		double   min;    /**< minimum duration in seconds */
+		double   max;    /**< maximum duration in seconds */
+		double   mean;   /**< mean duration in seconds */
+		double   stddev; /**< standard deviation of the durations in seconds */
+	} Summary;
+
 	TimeTracker(const char *filename, bool add_default_class = false);
 	TimeTracker(bool add_default_class = false);
 	~TimeTracker();
 
+	void   set_max_samples(size_t max_samples);
+	size_t max_samples() const;
+
+	void set_name(const std::string &name);
+
+	static LockMap<TimeTracker *, std::string> &named_trackers();
+
 	unsigned int add_class(std::string name);
 	void         remove_class(unsigned int cls);
 
@@ -56,23 +79,66 @@ public:
 
 	void print_to_file();
 
+	unsigned int num_classes();
+	std::string  class_name(unsigned int cls);
+	bool         summary(unsigned int cls, Summary &summary);
+	double       quantile(unsigned int cls, double q);
+
 private:
-	void average_and_deviation(std::vector<struct timeval *> &values,
-	                           double &                       average_sec,
-	                           double &                       average_ms,
-	                           double &                       deviation_sec,
-	                           double &                       deviation_ms);
+	/// @cond INTERNALS
+	// Streaming histogram of durations in nanoseconds. Each power of two
+	// is divided into SUB_BUCKETS linear buckets, the relative error of
+	// quantiles therefore is less than 1/SUB_BUCKETS.
+	static const unsigned int SUB_BUCKET_BITS = 4;
+	static const unsigned int SUB_BUCKETS     = 1u << SUB_BUCKET_BITS;
+	static const unsigned int MAX_MSB         = 40;
+	static const unsigned int NUM_BUCKETS     = SUB_BUCKETS * (MAX_MSB - SUB_BUCKET_BITS + 2) + 1;
+
+	// classless pings kept if the number of samples is not limited
+	static const size_t DEFAULT_MAX_PINGS = 10000;
+
+	struct ClassData
+	{
+		std::string          name;
+		std::vector<int64_t> samples;
+		size_t               next_sample;
+		bool                 started;
+		int64_t              start_ns;
+
+		// only written by the tracking thread, atomic for concurrent summaries
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum_ns;
+		std::atomic<double>   sum_sq;
+		std::atomic<uint64_t> min_ns;
+		std::atomic<uint64_t> max_ns;
+		std::atomic<uint64_t> buckets[NUM_BUCKETS];
+	};
+	/// @endcond
+
+	ClassData *class_data(unsigned int cls);
+	void       record(ClassData *cd, int64_t duration_ns);
+	void       clear(ClassData *cd);
+
+	static unsigned int bucket(uint64_t value);
+	static uint64_t     bucket_mid(unsigned int bucket);
+
+	void average_and_deviation(const std::vector<int64_t> &values,
+	                           double &                    average_sec,
+	                           double &                    average_ms,
+	                           double &                    deviation_sec,
+	                           double &                    deviation_ms);
 
 private:
-	timeval                                       start_time;
-	timeval                                       last_time;
-	std::vector<std::vector<struct timeval *>>    class_times_;
-	std::vector<std::string>                      class_names_;
-	std::vector<struct timeval *>                 times_;
-	std::map<unsigned int, std::string>           comments_;
-	std::vector<struct timeval *>::iterator       time_it_;
-	std::map<unsigned int, std::string>::iterator comment_it_;
-	std::string                                   tracker_comment_;
+	timeval                                  start_time;
+	int64_t                                  last_time_ns_;
+	std::vector<ClassData *>                 classes_;
+	Mutex                                    classes_mutex_;
+	size_t                                   max_samples_;
+	std::deque<timeval>                      times_;
+	unsigned long int                        times_dropped_;
+	timeval                                  last_dropped_time_;
+	std::map<unsigned long int, std::string> comments_;
+	std::string                              tracker_comment_;
 
 	unsigned int write_cycle_;
 	FILE *       timelog_;
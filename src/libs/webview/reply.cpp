@@ -23,6 +23,8 @@
 #include <core/exception.h>
 #include <webview/reply.h>
 
+#include <microhttpd.h>
+
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -207,7 +209,7 @@ WebReply::pack_caching()
  * @param buffer buffer to store data in
  * @param buf_max_size maximum size in bytes of data that can be put into buffer
  * @return number of bytes written to buffer, or -1 to immediately stop the
- * transfer.
+ * transfer. Zero may only be returned after calling suspend().
  */
 
 /** Constructor.
@@ -215,6 +217,45 @@ WebReply::pack_caching()
  */
 DynamicWebReply::DynamicWebReply(Code code) : WebReply(code)
 {
+	connection_ = NULL;
+}
+
+/** Set connection the reply is sent on.
+ * This is called by the request dispatcher when queuing the reply.
+ * @param connection libmicrohttpd connection
+ */
+void
+DynamicWebReply::set_connection(MHD_Connection *connection)
+{
+	connection_ = connection;
+}
+
+/** Suspend the connection.
+ * Call this from next_chunk() if no data is available right now and then
+ * return zero. The web server will not call next_chunk() again until
+ * resume() has been called, other connections are processed meanwhile.
+ * Never block in next_chunk() instead.
+ */
+void
+DynamicWebReply::suspend()
+{
+	if (!connection_) {
+		throw Exception("Cannot suspend reply without connection");
+	}
+	MHD_suspend_connection(connection_);
+}
+
+/** Resume a suspended connection.
+ * May be called from any thread, but only once after each suspend().
+ * The web server will then call next_chunk() again.
+ */
+void
+DynamicWebReply::resume()
+{
+	if (!connection_) {
+		throw Exception("Cannot resume reply without connection");
+	}
+	MHD_resume_connection(connection_);
 }
 
 /** Chunksize.
@@ -26,6 +26,8 @@
 #include <map>
 #include <string>
 
+struct MHD_Connection;
+
 namespace fawkes {
 
 class WebRequest;
@@ -130,6 +132,15 @@ public:
 	virtual size_t chunk_size();
 	virtual size_t size()                                                    = 0;
 	virtual size_t next_chunk(size_t pos, char *buffer, size_t buf_max_size) = 0;
+
+	void set_connection(MHD_Connection *connection);
+
+protected:
+	void suspend();
+	void resume();
+
+private:
+	MHD_Connection *connection_;
 };
 
 class StaticWebReply : public WebReply
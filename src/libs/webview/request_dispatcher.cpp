@@ -273,6 +273,7 @@ WebRequestDispatcher::queue_dynamic_reply(struct MHD_Connection *connection,
                                           DynamicWebReply *      dreply)
 {
 	dreply->set_request(request);
+	dreply->set_connection(connection);
 	dreply->pack_caching();
 	request->set_reply_code(dreply->code());
 
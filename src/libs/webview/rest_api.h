@@ -34,6 +34,7 @@
 #include <memory>
 #include <regex>
 #include <string>
+#include <strings.h>
 #include <vector>
 
 namespace fawkes {
@@ -176,6 +177,22 @@ public:
 		return (query_args_.find(what) != query_args_.end());
 	}
 
+	/** Get a request header value.
+	 * Header names are compared case-insensitive.
+	 * @param what name of the header, e.g., "If-None-Match"
+	 * @return header value or empty string if not set
+	 */
+	std::string
+	header(const std::string &what)
+	{
+		for (const auto &h : headers_) {
+			if (strcasecmp(h.first.c_str(), what.c_str()) == 0) {
+				return h.second;
+			}
+		}
+		return "";
+	}
+
 	/** Is pretty-printed JSON enabled?
 	 * @return true true to request enabling pretty mode
 	 */
@@ -209,10 +226,17 @@ private:
 		query_args_ = args;
 	}
 
+	void
+	set_headers(const std::map<std::string, std::string> &headers)
+	{
+		headers_ = headers;
+	}
+
 private:
 	bool                               pretty_json_;
 	std::map<std::string, std::string> path_args_;
 	std::map<std::string, std::string> query_args_;
+	std::map<std::string, std::string> headers_;
 };
 
 class Logger;
@@ -153,6 +153,13 @@ WebServer::start()
 		flags |= MHD_USE_SSL;
 	}
 
+	// allow dynamic replies to wait for data without blocking a thread
+#if MHD_VERSION >= 0x00095900
+	flags |= MHD_ALLOW_SUSPEND_RESUME;
+#else
+	flags |= MHD_USE_SUSPEND_RESUME;
+#endif
+
 	dispatcher_->setup_cors(cors_allow_all_, std::move(cors_origins_), cors_max_age_);
 
 	if (num_threads_ > 1) {
@@ -38,6 +38,9 @@
 #include <core/threading/mutex.h>
 #include <core/threading/mutex_locker.h>
 #include <utils/math/angle.h>
+#ifdef USE_TIMETRACKER
+#	include <utils/time/tracker.h>
+#endif
 
 #include <cstdio>
 #include <cstdlib>
@@ -92,12 +95,23 @@ AmclThread::AmclThread()
 #ifdef HAVE_ROS
 	rt_ = ros_thread;
 #endif
+#ifdef USE_TIMETRACKER
+	tt_ = new TimeTracker();
+	tt_->set_name("amcl");
+	tt_->set_max_samples(1000);
+	ttc_odom_update_  = tt_->add_class("Odometry Update");
+	ttc_laser_update_ = tt_->add_class("Laser Update");
+	ttc_resample_     = tt_->add_class("Resample");
+#endif
 }
 
 /** Destructor. */
 AmclThread::~AmclThread()
 {
 	delete conf_mutex_;
+#ifdef USE_TIMETRACKER
+	delete tt_;
+#endif
 }
 
 void
@@ -576,7 +590,13 @@ AmclThread::loop()
 
 		// Use the action data to update the filter
 		//logger->log_debug(name(), "Updating Odometry");
+#ifdef USE_TIMETRACKER
+		tt_->ping_start(ttc_odom_update_);
+#endif
 		odom_->UpdateAction(pf_, (::amcl::AMCLSensorData *)&odata);
+#ifdef USE_TIMETRACKER
+		tt_->ping_end(ttc_odom_update_);
+#endif
 
 		// Pose at last filter update
 		//this->pf_odom_pose = pose;
@@ -645,6 +665,9 @@ AmclThread::loop()
 			ldata.ranges[i][1] = fmod(angle_min_ + (i * angle_increment), 2 * M_PI);
 		}
 
+#ifdef USE_TIMETRACKER
+		tt_->ping_start(ttc_laser_update_);
+#endif
 		try {
 			laser_->UpdateSensor(pf_, (::amcl::AMCLSensorData *)&ldata);
 		} catch (Exception &e) {
@@ -653,6 +676,9 @@ AmclThread::loop()
 			                 "exception follows");
 			logger->log_warn(name(), e);
 		}
+#ifdef USE_TIMETRACKER
+		tt_->ping_end(ttc_laser_update_);
+#endif
 
 		laser_update_ = false;
 
@@ -661,7 +687,13 @@ AmclThread::loop()
 		// Resample the particles
 		if (!(++resample_count_ % resample_interval_)) {
 			//logger->log_info(name(), "Resample!");
+#ifdef USE_TIMETRACKER
+			tt_->ping_start(ttc_resample_);
+#endif
 			pf_update_resample(pf_);
+#ifdef USE_TIMETRACKER
+			tt_->ping_end(ttc_resample_);
+#endif
 			resampled = true;
 		}
 
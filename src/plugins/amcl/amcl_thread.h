@@ -59,6 +59,9 @@ typedef struct
 
 namespace fawkes {
 class Mutex;
+#ifdef USE_TIMETRACKER
+class TimeTracker;
+#endif
 }
 
 #ifdef HAVE_ROS
@@ -214,6 +217,13 @@ private:
 #ifdef HAVE_ROS
 	AmclROSThread *rt_;
 #endif
+
+#ifdef USE_TIMETRACKER
+	fawkes::TimeTracker *tt_;
+	unsigned int         ttc_odom_update_;
+	unsigned int         ttc_laser_update_;
+	unsigned int         ttc_resample_;
+#endif
 };
 
 #endif
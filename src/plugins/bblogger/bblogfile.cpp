@@ -48,6 +48,13 @@ using namespace fawkes;
 /** @class BBLogFile "bblogfile.h"
  * Class to easily access bblogger log files.
  * This class provides an easy way to interact with bblogger log files.
+ *
+ * By default entries are read with stdio into an internal buffer. After
+ * calling map() the file is memory-mapped instead. Then entries are
+ * accessed in-place, which makes random access, for example by using
+ * seek() to jump to a particular time offset, cheap even for very large
+ * files, and entry_data() returns pointers into the mapping rather than
+ * copies of the data.
  * @author Tim Niemueller
  */
 
@@ -114,8 +121,16 @@ BBLogFile::ctor(const char *filename, bool do_sanity_check)
 		throw CouldNotOpenFileException(filename, errno);
 	}
 
-	filename_ = strdup(filename);
-	header_   = (bblog_file_header *)malloc(sizeof(bblog_file_header));
+	filename_       = strdup(filename);
+	header_         = (bblog_file_header *)malloc(sizeof(bblog_file_header));
+	scenario_       = NULL;
+	interface_type_ = NULL;
+	interface_id_   = NULL;
+	map_            = NULL;
+	map_size_       = 0;
+	map_reserved_   = 0;
+	map_pos_        = 0;
+	entry_data_     = NULL;
 
 	try {
 		read_file_header();
@@ -126,6 +141,7 @@ BBLogFile::ctor(const char *filename, bool do_sanity_check)
 		free(scenario_);
 		free(interface_type_);
 		free(interface_id_);
+		free(header_);
 		fclose(f_);
 		throw;
 	}
@@ -141,6 +157,7 @@ BBLogFile::~BBLogFile()
 		instance_factory_.reset();
 	}
 
+	unmap();
 	fclose(f_);
 
 	free(filename_);
@@ -165,6 +182,10 @@ BBLogFile::read_file_header()
 			if (fread(header_, sizeof(bblog_file_header), 1, f_) != 1) {
 				throw FileReadException(filename_, errno, "Failed to read file header");
 			}
+		} else if (ntohl(magic) == BBLOGGER_CONTAINER_MAGIC) {
+			Exception e("File %s is a multi-interface container, use BBLogContainerFile", filename_);
+			e.set_type_id("bblogfile-container");
+			throw e;
 		} else {
 			throw Exception("File magic/version %X/%u does not match (expected %X/%u)",
 			                ntohl(magic),
@@ -231,16 +252,27 @@ BBLogFile::sanity_check()
 	}
 }
 
+/** Get file offset of an entry.
+ * @param index index of entry, 0-based
+ * @return offset of the entry header from the start of the file
+ */
+long
+BBLogFile::entry_file_offset(unsigned int index) const
+{
+	return sizeof(bblog_file_header) + (sizeof(bblog_entry_header) + header_->data_size) * index;
+}
+
 /** Read entry at particular index.
  * @param index index of entry, 0-based
  */
 void
 BBLogFile::read_index(unsigned int index)
 {
-	long offset =
-	  sizeof(bblog_file_header) + (sizeof(bblog_entry_header) + header_->data_size) * index;
+	long offset = entry_file_offset(index);
 
-	if (fseek(f_, offset, SEEK_SET) != 0) {
+	if (map_) {
+		map_pos_ = offset;
+	} else if (fseek(f_, offset, SEEK_SET) != 0) {
 		throw Exception(errno, "Cannot seek to index %u", index);
 	}
 
@@ -253,7 +285,9 @@ BBLogFile::read_index(unsigned int index)
 void
 BBLogFile::rewind()
 {
-	if (fseek(f_, sizeof(bblog_file_header), SEEK_SET) != 0) {
+	if (map_) {
+		map_pos_ = sizeof(bblog_file_header);
+	} else if (fseek(f_, sizeof(bblog_file_header), SEEK_SET) != 0) {
 		throw Exception(errno, "Cannot reset file");
 	}
 	entry_offset_.set_time(0, 0);
@@ -266,6 +300,14 @@ bool
 BBLogFile::has_next()
 {
 	// we always re-test to support continuous file watching
+	if (map_) {
+		size_t entry_size = sizeof(bblog_entry_header) + header_->data_size;
+		if (map_pos_ + entry_size > map_size_) {
+			remap();
+		}
+		return (map_pos_ + entry_size <= map_size_);
+	}
+
 	clearerr(f_);
 	if (getc(f_) == EOF) {
 		return false;
@@ -282,17 +324,270 @@ BBLogFile::has_next()
 void
 BBLogFile::read_next()
 {
+	if (map_) {
+		size_t entry_size = sizeof(bblog_entry_header) + header_->data_size;
+		if ((map_pos_ + entry_size > map_size_) && (!remap() || (map_pos_ + entry_size > map_size_))) {
+			throw Exception("Cannot read interface data");
+		}
+		const bblog_entry_header *entryh = (const bblog_entry_header *)&map_[map_pos_];
+		entry_offset_.set_time(entryh->rel_time_sec, entryh->rel_time_usec);
+		entry_data_ = &map_[map_pos_ + sizeof(bblog_entry_header)];
+		map_pos_ += entry_size;
+		if (interface_)
+			interface_->set_from_chunk(const_cast<void *>(entry_data_));
+		return;
+	}
+
 	bblog_entry_header entryh;
 
 	if ((fread(&entryh, sizeof(bblog_entry_header), 1, f_) == 1)
 	    && (fread(ifdata_, header_->data_size, 1, f_) == 1)) {
 		entry_offset_.set_time(entryh.rel_time_sec, entryh.rel_time_usec);
+		entry_data_ = ifdata_;
 		interface_->set_from_chunk(ifdata_);
 	} else {
 		throw Exception("Cannot read interface data");
 	}
 }
 
+/** Memory-map file.
+ * After calling this method all read operations access the file through
+ * a read-only memory mapping. The current read position is retained.
+ * Calling this multiple times is safe.
+ * @exception Exception thrown if the file cannot be mapped
+ */
+void
+BBLogFile::map()
+{
+#if _POSIX_MAPPED_FILES
+	if (map_)
+		return;
+
+	long pos = ftell(f_);
+	if (!remap()) {
+		throw Exception(errno, "Failed to mmap log %s", filename_);
+	}
+	map_pos_ = (pos < (long)sizeof(bblog_file_header)) ? sizeof(bblog_file_header) : pos;
+#else
+	throw Exception("Cannot map file, mmap not available.");
+#endif
+}
+
+/** Check if file is memory-mapped.
+ * @return true if map() has been called successfully, false otherwise
+ */
+bool
+BBLogFile::is_mapped() const
+{
+	return (map_ != NULL);
+}
+
+/** Update mapping to current file size.
+ * This is called initially and whenever the file has grown, e.g. because
+ * it is still written while we read it. Address space for twice the file
+ * size is reserved up front and the file mapping is extended in place
+ * within that range, such that pointers handed out earlier remain valid.
+ * Only if the file outgrows the reservation a new, again doubled range is
+ * reserved. The previous range is kept until the file is closed, hence the
+ * number of mappings only grows logarithmically with the file size.
+ * @return true if the mapping is valid, false otherwise
+ */
+bool
+BBLogFile::remap()
+{
+#if _POSIX_MAPPED_FILES
+	size_t fsize = file_size();
+	if (map_ && (fsize == map_size_))
+		return true;
+
+	char * base     = map_;
+	size_t reserved = map_reserved_;
+	if (!map_ || (fsize > map_reserved_)) {
+		size_t page = sysconf(_SC_PAGESIZE);
+		reserved    = ((2 * fsize + page - 1) / page) * page;
+		void *r =
+		  mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (r == MAP_FAILED) {
+			return false;
+		}
+		base = (char *)r;
+	}
+
+	// replaces the previous file mapping or the reserved range at the same
+	// address, the content of the shared file mapping remains unchanged
+	void *m = mmap(base, fsize, PROT_READ, MAP_SHARED | MAP_FIXED, fileno(f_), 0);
+	if (m == MAP_FAILED) {
+		if (base != map_) {
+			munmap(base, reserved);
+		}
+		return false;
+	}
+	if (map_ && (base != map_)) {
+		retired_maps_.push_back(std::make_pair(map_, map_reserved_));
+	}
+	map_          = base;
+	map_size_     = fsize;
+	map_reserved_ = reserved;
+	return true;
+#else
+	return false;
+#endif
+}
+
+/** Remove mappings, if any. */
+void
+BBLogFile::unmap()
+{
+#if _POSIX_MAPPED_FILES
+	if (map_) {
+		munmap(map_, map_reserved_);
+		map_          = NULL;
+		map_size_     = 0;
+		map_reserved_ = 0;
+	}
+	for (const auto &m : retired_maps_) {
+		munmap(m.first, m.second);
+	}
+	retired_maps_.clear();
+#endif
+}
+
+/** Get data of current entry.
+ * If the file is memory-mapped the returned pointer points into the
+ * mapping and no data is copied. Otherwise it points to an internal buffer
+ * which is overwritten by the next read operation.
+ * @return data of last read entry, NULL if no entry has been read
+ */
+const void *
+BBLogFile::entry_data() const
+{
+	return entry_data_;
+}
+
+/** Get data of an arbitrary entry.
+ * This does neither change the current read position nor the data of the
+ * interface. If the file is memory-mapped the returned pointer points into
+ * the mapping and remains valid as long as the file is open. Otherwise it
+ * points to an internal buffer which is overwritten by the next read
+ * operation.
+ * @param index index of entry, 0-based
+ * @param offset if not NULL, the offset of the entry is stored here
+ * @return pointer to data of entry
+ * @exception OutOfBoundsException thrown if index is out of range
+ */
+const void *
+BBLogFile::entry_data(unsigned int index, fawkes::Time *offset)
+{
+	long   eoff       = entry_file_offset(index);
+	size_t entry_size = sizeof(bblog_entry_header) + header_->data_size;
+
+	if (map_) {
+		if ((eoff + entry_size > map_size_) && (!remap() || (eoff + entry_size > map_size_))) {
+			throw OutOfBoundsException("Entry index out of bounds", index, 0, num_entries());
+		}
+		if (offset) {
+			const bblog_entry_header *entryh = (const bblog_entry_header *)&map_[eoff];
+			offset->set_time(entryh->rel_time_sec, entryh->rel_time_usec);
+		}
+		return &map_[eoff + sizeof(bblog_entry_header)];
+	}
+
+	bblog_entry_header entryh;
+	if ((pread(fileno(f_), &entryh, sizeof(entryh), eoff) != sizeof(entryh))
+	    || (pread(fileno(f_), ifdata_, header_->data_size, eoff + sizeof(entryh))
+	        != (ssize_t)header_->data_size)) {
+		throw OutOfBoundsException("Entry index out of bounds", index, 0, num_entries());
+	}
+	if (offset)
+		offset->set_time(entryh.rel_time_sec, entryh.rel_time_usec);
+	return ifdata_;
+}
+
+/** Get time offset of an entry without reading its data.
+ * @param index index of entry, 0-based
+ * @param offset upon return contains the offset of the entry
+ * @exception OutOfBoundsException thrown if index is out of range
+ */
+void
+BBLogFile::entry_time(unsigned int index, fawkes::Time &offset)
+{
+	long eoff = entry_file_offset(index);
+	if (map_) {
+		size_t entry_size = sizeof(bblog_entry_header) + header_->data_size;
+		if ((eoff + entry_size > map_size_) && (!remap() || (eoff + entry_size > map_size_))) {
+			throw OutOfBoundsException("Entry index out of bounds", index, 0, num_entries());
+		}
+		const bblog_entry_header *entryh = (const bblog_entry_header *)&map_[eoff];
+		offset.set_time(entryh->rel_time_sec, entryh->rel_time_usec);
+	} else {
+		bblog_entry_header entryh;
+		if (pread(fileno(f_), &entryh, sizeof(entryh), eoff) != sizeof(entryh)) {
+			throw Exception(errno, "Cannot read entry %u of %s", index, filename_);
+		}
+		offset.set_time(entryh.rel_time_sec, entryh.rel_time_usec);
+	}
+}
+
+/** Get number of complete entries in file.
+ * This is determined from the file size, not the header, and therefore also
+ * works for files which are still being written.
+ * @return number of entries
+ */
+unsigned int
+BBLogFile::num_entries()
+{
+	size_t entry_size = sizeof(bblog_entry_header) + header_->data_size;
+	size_t fsize;
+	if (map_) {
+		remap();
+		fsize = map_size_;
+	} else {
+		fsize = file_size();
+	}
+	if (fsize < sizeof(bblog_file_header))
+		return 0;
+	return (fsize - sizeof(bblog_file_header)) / entry_size;
+}
+
+/** Find entry by time offset.
+ * Performs a binary search over the entries, which are sorted by time.
+ * @param offset offset relative to the start time
+ * @return index of the first entry with an offset equal to or greater than
+ * the given offset, num_entries() if there is no such entry
+ */
+unsigned int
+BBLogFile::find_index(const fawkes::Time &offset)
+{
+	unsigned int lo = 0, hi = num_entries();
+	Time         t;
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2;
+		entry_time(mid, t);
+		if (t < offset) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/** Seek to time offset.
+ * Positions the file such that the next call to read_next() reads the
+ * first entry which has an offset equal to or greater than the given offset.
+ * @param offset offset relative to the start time
+ */
+void
+BBLogFile::seek(const fawkes::Time &offset)
+{
+	long foff = entry_file_offset(find_index(offset));
+	if (map_) {
+		map_pos_ = foff;
+	} else if (fseek(f_, foff, SEEK_SET) != 0) {
+		throw Exception(errno, "Cannot seek to offset %f", offset.in_sec());
+	}
+}
+
 /** Set number of entries.
  * Set the number of entries in the file. Attention, this is only to be used
  * by the repair() method.
@@ -606,7 +901,7 @@ BBLogFile::remaining_entries()
 {
 	// we make this so "complicated" to be able to use it from a FAM handler
 	size_t  entry_size = sizeof(bblog_entry_header) + header_->data_size;
-	long    curpos     = ftell(f_);
+	long    curpos     = map_ ? (long)map_pos_ : ftell(f_);
 	size_t  fsize      = file_size();
 	ssize_t sizediff   = fsize - curpos;
 
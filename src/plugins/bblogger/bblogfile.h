@@ -30,6 +30,8 @@
 
 #include <cstdio>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace fawkes {
 class Interface;
@@ -47,10 +49,18 @@ public:
 	void                read_next();
 	void                read_index(unsigned int index);
 	const fawkes::Time &entry_offset() const;
+	const void *        entry_data() const;
 	void                print_entry(FILE *outf = stdout);
 
 	void rewind();
 
+	void         map();
+	bool         is_mapped() const;
+	unsigned int num_entries();
+	unsigned int find_index(const fawkes::Time &offset);
+	void         seek(const fawkes::Time &offset);
+	const void * entry_data(unsigned int index, fawkes::Time *offset = NULL);
+
 	void set_num_entries(size_t num_entries);
 	void print_info(const char *line_prefix = "", FILE *outf = stdout);
 
@@ -96,6 +106,10 @@ private: // methods
 	void read_file_header();
 	void sanity_check();
 	void repair();
+	void unmap();
+	bool remap();
+	long entry_file_offset(unsigned int index) const;
+	void entry_time(unsigned int index, fawkes::Time &offset);
 
 private: // members
 	FILE *             f_;
@@ -103,6 +117,15 @@ private: // members
 
 	void *ifdata_;
 
+	char * map_;
+	size_t map_size_;
+	size_t map_reserved_;
+	size_t map_pos_;
+
+	std::vector<std::pair<char *, size_t>> retired_maps_;
+
+	const void *entry_data_;
+
 	char *filename_;
 	char *scenario_;
 	char *interface_type_;
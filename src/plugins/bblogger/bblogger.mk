@@ -0,0 +1,29 @@
+#*****************************************************************************
+#     Makefile Build System for Fawkes: BlackBoard Logger Plugin Config
+#                            -------------------
+#   Created on Sat Oct 17 11:48:12 2026
+#   Copyright (C) 2026 by agent
+#
+#*****************************************************************************
+#
+#   This program is free software; you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation; either version 2 of the License, or
+#   (at your option) any later version.
+#
+#*****************************************************************************
+
+# Optional chunk compression for container log files
+ifneq ($(PKGCONFIG),)
+  HAVE_LZ4  = $(if $(shell $(PKGCONFIG) --exists 'liblz4'; echo $${?/1/}),1,0)
+  HAVE_ZSTD = $(if $(shell $(PKGCONFIG) --exists 'libzstd'; echo $${?/1/}),1,0)
+endif
+
+ifeq ($(HAVE_LZ4),1)
+  CFLAGS_BBLOG_COMPRESSION  += -DHAVE_LZ4 $(shell $(PKGCONFIG) --cflags 'liblz4')
+  LDFLAGS_BBLOG_COMPRESSION += $(shell $(PKGCONFIG) --libs 'liblz4')
+endif
+ifeq ($(HAVE_ZSTD),1)
+  CFLAGS_BBLOG_COMPRESSION  += -DHAVE_ZSTD $(shell $(PKGCONFIG) --cflags 'libzstd')
+  LDFLAGS_BBLOG_COMPRESSION += $(shell $(PKGCONFIG) --libs 'libzstd')
+endif
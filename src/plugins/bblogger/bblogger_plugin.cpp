@@ -22,7 +22,9 @@
 
 #include "bblogger_plugin.h"
 
+#include "container_writer.h"
 #include "log_thread.h"
+#include "writer_thread.h"
 
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -38,7 +40,9 @@ using namespace fawkes;
 /** @class BlackBoardLoggerPlugin "bblogger_plugin.h"
  * BlackBoard logger plugin.
  * This plugin logs one or more (or even all) interfaces to data files
- * for later replay or analyzing.
+ * for later replay or analyzing. Depending on the configured format,
+ * either one file per interface or a single container file for all
+ * interfaces is written.
  *
  * @author Tim Niemueller
  */
@@ -48,6 +52,8 @@ using namespace fawkes;
  */
 BlackBoardLoggerPlugin::BlackBoardLoggerPlugin(Configuration *config) : Plugin(config)
 {
+	container_ = NULL;
+
 	std::set<std::string> ifaces;
 
 	std::string prefix        = "/fawkes/bblogger/";
@@ -86,6 +92,49 @@ BlackBoardLoggerPlugin::BlackBoardLoggerPlugin(Configuration *config) : Plugin(c
 		flushing = config->get_bool((scenario_prefix + "flushing").c_str());
 	} catch (Exception &e) { /* ignored, use default set above */
 	}
+	std::string  format      = "file";
+	std::string  compression = "none";
+	unsigned int chunk_size  = 256 * 1024;
+	try {
+		format = config->get_string((scenario_prefix + "format").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		compression = config->get_string((scenario_prefix + "compression").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		chunk_size = config->get_uint((scenario_prefix + "chunk_size").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	bool         io_thread          = false;
+	unsigned int io_ring_size       = 1024;
+	unsigned int io_slot_size       = 16384;
+	float        io_commit_interval = 0.05;
+	float        io_fsync_interval  = 1.0;
+	try {
+		io_thread = config->get_bool((scenario_prefix + "io_thread").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		io_ring_size = config->get_uint((scenario_prefix + "io_ring_size").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		io_slot_size = config->get_uint((scenario_prefix + "io_slot_size").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		io_commit_interval = config->get_float((scenario_prefix + "io_commit_interval").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		io_fsync_interval = config->get_float((scenario_prefix + "io_fsync_interval").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	if ((format != "file") && (format != "container")) {
+		throw Exception("Invalid log format '%s', must be file or container", format.c_str());
+	}
 
 	struct stat s;
 	int         err = stat(logdir.c_str(), &s);
@@ -110,29 +159,75 @@ BlackBoardLoggerPlugin::BlackBoardLoggerPlugin(Configuration *config) : Plugin(c
 	strftime(date, 21, "%F-%H-%M-%S", tmp);
 	std::string replay_cfg_prefix = replay_prefix + scenario + "-" + date + "/logs/";
 
-	Configuration::ValueIterator *i = config->search(ifaces_prefix.c_str());
-	while (i->next()) {
-		std::string iface_name = std::string(i->path()).substr(ifaces_prefix.length());
-		iface_name             = iface_name.substr(0, iface_name.find("/"));
+	if (format == "container") {
+		uint16_t    comp     = BBLogContainerWriter::parse_compression(compression.c_str());
+		std::string basename = scenario + "-" + date + ".bblog";
+		std::string filename = logdir + "/" + basename;
 
-		//printf("Adding sync thread for peer %s\n", peer.c_str());
-		BBLoggerThread *log_thread = new BBLoggerThread(
-		  i->get_string().c_str(), logdir.c_str(), buffering, flushing, scenario.c_str(), &start);
+		container_ = new BBLogContainerWriter(
+		  filename.c_str(), scenario.c_str(), start, chunk_size, comp, flushing);
+		config->set_string((replay_cfg_prefix + scenario + "/file").c_str(), basename);
+	}
 
-		std::string filename = log_thread->get_filename();
-		config->set_string((replay_cfg_prefix + iface_name + "/file").c_str(), filename);
+	BBLogWriterThread *writer = NULL;
+	if (io_thread) {
+		writer =
+		  new BBLogWriterThread(io_ring_size, io_slot_size, io_commit_interval, io_fsync_interval);
+	}
 
-		thread_list.push_back(log_thread);
+	Configuration::ValueIterator *i = config->search(ifaces_prefix.c_str());
+	try {
+		while (i->next()) {
+			std::string iface_name = std::string(i->path()).substr(ifaces_prefix.length());
+			iface_name             = iface_name.substr(0, iface_name.find("/"));
+
+			//printf("Adding sync thread for peer %s\n", peer.c_str());
+			BBLoggerThread *log_thread = new BBLoggerThread(i->get_string().c_str(),
+			                                                logdir.c_str(),
+			                                                buffering,
+			                                                flushing,
+			                                                scenario.c_str(),
+			                                                &start,
+			                                                container_,
+			                                                writer);
+			thread_list.push_back(log_thread);
+
+			if (!container_) {
+				std::string filename = log_thread->get_filename();
+				config->set_string((replay_cfg_prefix + iface_name + "/file").c_str(), filename);
+			}
+		}
+	} catch (Exception &e) {
+		// logger threads are deleted by the Plugin destructor, they do not
+		// access the container or writer on deletion
+		delete i;
+		delete writer;
+		delete container_;
+		throw;
 	}
 	delete i;
 
 	if (thread_list.empty()) {
+		delete writer;
+		delete container_;
 		throw Exception("No interfaces configured for logging, aborting");
 	}
 
+	// the writer goes last, the first thread in the list must be a logger thread
+	if (writer) {
+		thread_list.push_back(writer);
+	}
+
 	BBLoggerThread *bblt = dynamic_cast<BBLoggerThread *>(thread_list.front());
 	bblt->set_threadlist(thread_list);
 }
 
+/** Destructor. */
+BlackBoardLoggerPlugin::~BlackBoardLoggerPlugin()
+{
+	// threads have been finalized at this point, write index and close file
+	delete container_;
+}
+
 PLUGIN_DESCRIPTION("Write BlackBoard interface data to files")
 EXPORT_PLUGIN(BlackBoardLoggerPlugin)
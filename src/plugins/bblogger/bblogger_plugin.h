@@ -25,10 +25,16 @@
 
 #include <core/plugin.h>
 
+class BBLogContainerWriter;
+
 class BlackBoardLoggerPlugin : public fawkes::Plugin
 {
 public:
 	explicit BlackBoardLoggerPlugin(fawkes::Configuration *config);
+	virtual ~BlackBoardLoggerPlugin();
+
+private:
+	BBLogContainerWriter *container_;
 };
 
 #endif
@@ -83,6 +83,8 @@ BlackBoardLogReplayPlugin::BlackBoardLogReplayPlugin(Configuration *config) : Pl
 	bool  scenario_loop_replay  = false;
 	bool  scenario_non_blocking = false;
 	float scenario_grace_period = 0.001;
+	float scenario_speed        = 1.0;
+	bool  scenario_mmap         = true;
 	try {
 		scenario_loop_replay = config->get_bool((prefix + "loop").c_str());
 	} catch (Exception &e) {
@@ -107,6 +109,22 @@ BlackBoardLogReplayPlugin::BlackBoardLogReplayPlugin(Configuration *config) : Pl
 		scenario_grace_period = config->get_float((scenario_prefix + "grace_period").c_str());
 	} catch (Exception &e) {
 	} // ignored, assume enabled
+	try {
+		scenario_speed = config->get_float((prefix + "speed").c_str());
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		scenario_speed = config->get_float((scenario_prefix + "speed").c_str());
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		scenario_mmap = config->get_bool((prefix + "mmap").c_str());
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		scenario_mmap = config->get_bool((scenario_prefix + "mmap").c_str());
+	} catch (Exception &e) {
+	} // ignored, use default
 
 #if __cplusplus >= 201103L
 	std::unique_ptr<Configuration::ValueIterator> i(config->search(logs_prefix.c_str()));
@@ -125,6 +143,9 @@ BlackBoardLogReplayPlugin::BlackBoardLogReplayPlugin(Configuration *config) : Pl
 			bool        loop_replay  = scenario_loop_replay;
 			bool        non_blocking = scenario_non_blocking;
 			float       grace_period = scenario_grace_period;
+			float       speed        = scenario_speed;
+			float       start_offset = 0.;
+			bool        use_mmap     = scenario_mmap;
 			std::string hook_str;
 
 			try {
@@ -143,6 +164,18 @@ BlackBoardLogReplayPlugin::BlackBoardLogReplayPlugin(Configuration *config) : Pl
 				grace_period = config->get_float((log_prefix + "grace_period").c_str());
 			} catch (Exception &e) {
 			} // ignored, assume enabled
+			try {
+				speed = config->get_float((log_prefix + "speed").c_str());
+			} catch (Exception &e) {
+			} // ignored, use default
+			try {
+				start_offset = config->get_float((log_prefix + "start_offset").c_str());
+			} catch (Exception &e) {
+			} // ignored, use default
+			try {
+				use_mmap = config->get_bool((log_prefix + "mmap").c_str());
+			} catch (Exception &e) {
+			} // ignored, use default
 
 			if (hook_str != "") {
 				BlockedTimingAspect::WakeupHook hook;
@@ -180,10 +213,12 @@ BlackBoardLogReplayPlugin::BlackBoardLogReplayPlugin(Configuration *config) : Pl
 				                                                 grace_period,
 				                                                 loop_replay,
 				                                                 non_blocking);
+				lrbt_thread->set_replay_options(speed, start_offset, use_mmap);
 				thread_list.push_back(lrbt_thread);
 			} else {
 				BBLogReplayThread *lr_thread = new BBLogReplayThread(
 				  i->get_string().c_str(), logdir.c_str(), scenario.c_str(), grace_period, loop_replay);
+				lr_thread->set_replay_options(speed, start_offset, use_mmap);
 				thread_list.push_back(lr_thread);
 			}
 
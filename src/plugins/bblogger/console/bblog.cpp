@@ -21,6 +21,7 @@
  */
 
 #include "../bblogfile.h"
+#include "../container_file.h"
 
 #include <arpa/inet.h>
 #include <blackboard/internal/instance_factory.h>
@@ -73,8 +74,13 @@ int
 print_info(std::string &filename)
 {
 	try {
-		BBLogFile bf(filename.c_str());
-		bf.print_info();
+		if (BBLogContainerFile::is_container(filename.c_str())) {
+			BBLogContainerFile cf(filename.c_str());
+			cf.print_info();
+		} else {
+			BBLogFile bf(filename.c_str());
+			bf.print_info();
+		}
 		return 0;
 	} catch (Exception &e) {
 		printf("Failed to print info, exception follows\n");
@@ -108,6 +114,7 @@ print_indexes(std::string &filename, std::vector<unsigned int> &indexes)
 {
 	try {
 		BBLogFile bf(filename.c_str());
+		bf.map();
 		for (unsigned int i = 0; i < indexes.size(); ++i) {
 			bf.read_index(indexes[i]);
 			bf.print_entry();
@@ -122,9 +129,44 @@ print_indexes(std::string &filename, std::vector<unsigned int> &indexes)
 	return 0;
 }
 
+int
+replay_container(std::string &filename)
+{
+	try {
+		BBLogContainerFile cf(filename.c_str());
+
+		if (!cf.has_next()) {
+			printf("File does not have any entries, aborting.\n");
+			return -1;
+		}
+
+		cf.read_next();
+		cf.print_entry();
+		Time last_offset = cf.entry_offset();
+
+		Time diff;
+		while (cf.has_next()) {
+			cf.read_next();
+			diff = cf.entry_offset() - last_offset;
+			diff.wait();
+			last_offset = cf.entry_offset();
+			cf.print_entry();
+		}
+		return 0;
+	} catch (Exception &e) {
+		printf("Failed to replay container, exception follows\n");
+		e.print_trace();
+		return -1;
+	}
+}
+
 int
 replay_file(std::string &filename)
 {
+	if (BBLogContainerFile::is_container(filename.c_str())) {
+		return replay_container(filename);
+	}
+
 	try {
 		BBLogFile bf(filename.c_str());
 
@@ -267,15 +309,18 @@ convert_file_csv(BBLogFile &bf, FILE *outf)
 	}
 	fprintf(outf, "\n");
 
+	std::string line;
 	while (bf.has_next()) {
 		bf.read_next();
 		fprintf(outf, "%f", bf.entry_offset().in_sec());
 
+		line.clear();
 		InterfaceFieldIterator i;
 		for (i = iface->fields(); i != iface->fields_end(); ++i) {
-			fprintf(outf, ";%s", i.get_value_string());
+			line += ';';
+			i.append_value_string(line);
 		}
-		fprintf(outf, "\n");
+		fprintf(outf, "%s\n", line.c_str());
 	}
 }
 
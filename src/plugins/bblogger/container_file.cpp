@@ -0,0 +1,719 @@
+
+/***************************************************************************
+ *  container_file.cpp - BlackBoard log container file access class
+ *
+ *  Created: Sat Oct 17 11:15:20 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "container_file.h"
+
+#include <blackboard/internal/instance_factory.h>
+#include <core/exceptions/software.h>
+#include <core/exceptions/system.h>
+#include <interface/interface.h>
+#include <utils/misc/strndup.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#ifdef __FreeBSD__
+#	include <sys/endian.h>
+#elif defined(__MACH__) && defined(__APPLE__)
+#	include <sys/_endian.h>
+#else
+#	include <endian.h>
+#endif
+#include <arpa/inet.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef HAVE_LZ4
+#	include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD
+#	include <zstd.h>
+#endif
+
+using namespace fawkes;
+
+/// @cond INTERNAL
+static bool
+index_entry_ends_before(const bblog_index_entry &ie, const Time &offset)
+{
+	Time last(ie.last_rel_time_sec, ie.last_rel_time_usec);
+	return last < offset;
+}
+
+// strings in files may not be terminated if the file is corrupted
+static void
+terminate_strings(bblog_container_interface &desc)
+{
+	desc.interface_type[BBLOG_INTERFACE_TYPE_SIZE - 1] = 0;
+	desc.interface_id[BBLOG_INTERFACE_ID_SIZE - 1]     = 0;
+}
+/// @endcond
+
+/** @class BBLogContainerFile "container_file.h"
+ * Class to access bblogger container files.
+ * A container file stores the data of many interfaces in a single file,
+ * cf. BBLogContainerWriter. Entries are read in the order in which they
+ * were logged, for each entry the data is stored in the interface instance
+ * of the respective interface. The seek index allows to quickly position
+ * the file to a particular time offset.
+ * @author agent
+ */
+
+/** Constructor.
+ * Opens the given file, reads the interface table and the seek index. If
+ * the file does not contain an index, e.g. because the logger has not
+ * finished writing it, the index is rebuilt by scanning the file. For each
+ * logged interface an instance is created that is not tied to a
+ * blackboard, use set_interface() to replace it.
+ * @param filename log file to open
+ * @exception CouldNotOpenFileException thrown if file cannot be opened
+ * @exception FileReadException some error occured while reading data from
+ */
+BBLogContainerFile::BBLogContainerFile(const char *filename)
+{
+	f_ = fopen(filename, "r");
+	if (!f_) {
+		throw CouldNotOpenFileException(filename, errno);
+	}
+
+	filename_  = strdup(filename);
+	scenario_  = NULL;
+	has_index_ = false;
+
+	try {
+		read_header();
+		if (header_.index_offset != 0) {
+			read_index();
+		} else {
+			scan_chunks();
+		}
+
+		instance_factory_.reset(new BlackBoardInstanceFactory());
+		for (unsigned int i = 0; i < interfaces_.size(); ++i) {
+			ifaces_.push_back(instance_factory_->new_interface_instance(interface_type(i),
+			                                                            interface_id(i)));
+			owned_ifaces_.push_back(true);
+			// entries are copied into the interface with the logged size
+			if ((memcmp(ifaces_[i]->hash(), interfaces_[i].interface_hash, INTERFACE_HASH_SIZE_) != 0)
+			    || (ifaces_[i]->datasize() != interfaces_[i].data_size)) {
+				throw TypeMismatchException("Logged interface %s::%s does not match the "
+				                            "available interface",
+				                            interface_type(i),
+				                            interface_id(i));
+			}
+		}
+	} catch (Exception &e) {
+		if (instance_factory_) {
+			for (unsigned int i = 0; i < ifaces_.size(); ++i) {
+				instance_factory_->delete_interface_instance(ifaces_[i]);
+			}
+		}
+		free(filename_);
+		free(scenario_);
+		fclose(f_);
+		throw;
+	}
+
+	rewind();
+}
+
+/** Destructor. */
+BBLogContainerFile::~BBLogContainerFile()
+{
+	for (unsigned int i = 0; i < ifaces_.size(); ++i) {
+		if (owned_ifaces_[i]) {
+			instance_factory_->delete_interface_instance(ifaces_[i]);
+		}
+	}
+
+	fclose(f_);
+
+	free(filename_);
+	free(scenario_);
+}
+
+/** Check if file is a container file.
+ * @param filename file to check
+ * @return true if the file exists and has the container file magic, false otherwise
+ */
+bool
+BBLogContainerFile::is_container(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	if (!f)
+		return false;
+
+	uint32_t magic;
+	bool     rv = ((fread(&magic, sizeof(uint32_t), 1, f) == 1)
+               && (ntohl(magic) == BBLOGGER_CONTAINER_MAGIC));
+	fclose(f);
+	return rv;
+}
+
+/** Read file header. */
+void
+BBLogContainerFile::read_header()
+{
+	if (fread(&header_, sizeof(bblog_container_header), 1, f_) != 1) {
+		throw FileReadException(filename_, errno, "Failed to read file header");
+	}
+	if ((ntohl(header_.file_magic) != BBLOGGER_CONTAINER_MAGIC)
+	    || (ntohl(header_.file_version) != BBLOGGER_CONTAINER_VERSION)) {
+		throw Exception("File magic/version %X/%u does not match (expected %X/%u)",
+		                ntohl(header_.file_magic),
+		                ntohl(header_.file_version),
+		                BBLOGGER_CONTAINER_MAGIC,
+		                BBLOGGER_CONTAINER_VERSION);
+	}
+
+#if BYTE_ORDER_ == LITTLE_ENDIAN_
+	if (header_.endianess == 1)
+#else
+	if (header_.endianess == 0)
+#endif
+	{
+		Exception e("File %s has incompatible endianess", filename_);
+		e.set_type_id("bblogfile-endianess-mismatch");
+		throw e;
+	}
+
+	scenario_ = strndup(header_.scenario, BBLOG_SCENARIO_SIZE);
+	start_time_.set_time(header_.start_time_sec, header_.start_time_usec);
+}
+
+/** Read seek index and interface table from end of file. */
+void
+BBLogContainerFile::read_index()
+{
+	// the counts are read from the file, bound them before allocating anything
+	struct stat fs;
+	if (fstat(fileno(f_), &fs) != 0) {
+		throw Exception(errno, "Failed to stat file %s", filename_);
+	}
+	uint64_t index_size = (uint64_t)header_.num_chunks * sizeof(bblog_index_entry)
+	                      + (uint64_t)header_.num_interfaces * sizeof(bblog_container_interface);
+	if ((header_.index_offset < sizeof(bblog_container_header))
+	    || (header_.index_offset > (uint64_t)fs.st_size)
+	    || (index_size > (uint64_t)fs.st_size - header_.index_offset)) {
+		throw FileReadException(filename_, "Seek index exceeds file size");
+	}
+
+	if (fseek(f_, header_.index_offset, SEEK_SET) != 0) {
+		throw Exception(errno, "Cannot seek to index of %s", filename_);
+	}
+
+	index_.resize(header_.num_chunks);
+	interfaces_.resize(header_.num_interfaces);
+	if ((!index_.empty()
+	     && (fread(&index_[0], sizeof(bblog_index_entry), index_.size(), f_) != index_.size()))
+	    || (!interfaces_.empty()
+	        && (fread(&interfaces_[0], sizeof(bblog_container_interface), interfaces_.size(), f_)
+	            != interfaces_.size()))) {
+		throw FileReadException(filename_, errno, "Failed to read seek index");
+	}
+	for (bblog_container_interface &desc : interfaces_) {
+		terminate_strings(desc);
+	}
+	has_index_ = true;
+}
+
+/** Rebuild seek index and interface table by scanning all chunks.
+ * Scanning stops at the first incomplete or corrupted chunk, for example
+ * if the file is truncated because the logger crashed.
+ */
+void
+BBLogContainerFile::scan_chunks()
+{
+	struct stat fs;
+	if (fstat(fileno(f_), &fs) != 0) {
+		throw Exception(errno, "Failed to stat file %s", filename_);
+	}
+
+	long offset = sizeof(bblog_container_header);
+	while (offset + (long)sizeof(bblog_chunk_header) <= fs.st_size) {
+		bblog_chunk_header chead;
+		if ((fseek(f_, offset, SEEK_SET) != 0) || (fread(&chead, sizeof(chead), 1, f_) != 1)
+		    || (chead.chunk_magic != BBLOG_CHUNK_MAGIC)
+		    || (offset + (long)sizeof(chead) + (long)chead.stored_size > fs.st_size)) {
+			break;
+		}
+
+		if (chead.chunk_type == BBLOG_CHUNK_TYPE_INTERFACE) {
+			bblog_container_interface desc;
+			if ((chead.stored_size != sizeof(desc)) || (fread(&desc, sizeof(desc), 1, f_) != 1)) {
+				throw FileReadException(filename_, errno, "Invalid interface chunk");
+			}
+			terminate_strings(desc);
+			interfaces_.push_back(desc);
+		} else if (chead.chunk_type == BBLOG_CHUNK_TYPE_DATA) {
+			bblog_index_entry ie;
+			ie.chunk_offset        = offset;
+			ie.num_entries         = chead.num_entries;
+			ie.first_rel_time_sec  = chead.first_rel_time_sec;
+			ie.first_rel_time_usec = chead.first_rel_time_usec;
+			ie.last_rel_time_sec   = chead.last_rel_time_sec;
+			ie.last_rel_time_usec  = chead.last_rel_time_usec;
+			index_.push_back(ie);
+		}
+
+		offset += sizeof(chead) + chead.stored_size;
+	}
+}
+
+/** Load and decompress a data chunk.
+ * @param chunk_index index of the chunk in the seek index
+ */
+void
+BBLogContainerFile::load_chunk(size_t chunk_index)
+{
+	const bblog_index_entry &ie = index_[chunk_index];
+
+	bblog_chunk_header chead;
+	if ((fseek(f_, ie.chunk_offset, SEEK_SET) != 0) || (fread(&chead, sizeof(chead), 1, f_) != 1)
+	    || (chead.chunk_magic != BBLOG_CHUNK_MAGIC)) {
+		throw FileReadException(filename_, errno, "Failed to read chunk header");
+	}
+
+	// sizes are read from the file, bound them before allocating anything
+	struct stat fs;
+	if (fstat(fileno(f_), &fs) != 0) {
+		throw Exception(errno, "Failed to stat file %s", filename_);
+	}
+	if ((long)ie.chunk_offset + (long)sizeof(chead) + (long)chead.stored_size > fs.st_size) {
+		throw FileReadException(filename_, "Chunk exceeds file size");
+	}
+
+	if (chead.compression == BBLOG_COMPRESSION_NONE) {
+		if (chead.raw_size != chead.stored_size) {
+			throw FileReadException(filename_, "Invalid uncompressed chunk size");
+		}
+		chunk_.resize(chead.raw_size);
+		if ((chead.raw_size > 0) && (fread(&chunk_[0], chead.raw_size, 1, f_) != 1)) {
+			throw FileReadException(filename_, errno, "Failed to read chunk");
+		}
+	} else {
+		compressed_.resize(chead.stored_size);
+		if ((chead.stored_size > 0) && (fread(&compressed_[0], chead.stored_size, 1, f_) != 1)) {
+			throw FileReadException(filename_, errno, "Failed to read chunk");
+		}
+		bool decompressed = false;
+#ifdef HAVE_LZ4
+		if (chead.compression == BBLOG_COMPRESSION_LZ4) {
+			// LZ4 cannot expand data by more than a factor of 255
+			if ((uint64_t)chead.raw_size > (uint64_t)chead.stored_size * 255) {
+				throw FileReadException(filename_, "Invalid LZ4 chunk size");
+			}
+			chunk_.resize(chead.raw_size);
+			int size = LZ4_decompress_safe(&compressed_[0],
+			                               &chunk_[0],
+			                               chead.stored_size,
+			                               chead.raw_size);
+			if (size != (int)chead.raw_size) {
+				throw Exception("Failed to decompress LZ4 chunk in %s", filename_);
+			}
+			decompressed = true;
+		}
+#endif
+#ifdef HAVE_ZSTD
+		if (chead.compression == BBLOG_COMPRESSION_ZSTD) {
+			// the frame header records the content size, it must match, and a
+			// block of at most 128 KB is never stored in less than 4 bytes
+			unsigned long long content_size =
+			  ZSTD_getFrameContentSize(&compressed_[0], chead.stored_size);
+			if ((content_size != chead.raw_size)
+			    || ((uint64_t)chead.raw_size > (uint64_t)chead.stored_size * 32768)) {
+				throw FileReadException(filename_, "Invalid zstd chunk size");
+			}
+			chunk_.resize(chead.raw_size);
+			size_t size =
+			  ZSTD_decompress(&chunk_[0], chead.raw_size, &compressed_[0], chead.stored_size);
+			if (ZSTD_isError(size) || (size != chead.raw_size)) {
+				throw Exception("Failed to decompress zstd chunk in %s", filename_);
+			}
+			decompressed = true;
+		}
+#endif
+		if (!decompressed) {
+			throw Exception("Chunk in %s uses unsupported compression %u",
+			                filename_,
+			                chead.compression);
+		}
+	}
+
+	chunk_pos_  = 0;
+	next_chunk_ = chunk_index + 1;
+}
+
+/** Rewind file to start.
+ * This moves the file cursor immediately before the first entry.
+ */
+void
+BBLogContainerFile::rewind()
+{
+	chunk_.clear();
+	chunk_pos_  = 0;
+	next_chunk_ = 0;
+	entry_offset_.set_time(0, 0);
+	entry_interface_index_ = 0;
+}
+
+/** Seek to time offset.
+ * Positions the file such that the next call to read_next() reads the
+ * first entry which has an offset equal to or greater than the given
+ * offset. The chunk is found by binary search on the seek index.
+ * @param offset offset relative to the start time
+ */
+void
+BBLogContainerFile::seek(const fawkes::Time &offset)
+{
+	std::vector<bblog_index_entry>::iterator c =
+	  std::lower_bound(index_.begin(), index_.end(), offset, index_entry_ends_before);
+
+	if (c == index_.end()) {
+		// past the end, nothing left to read
+		chunk_.clear();
+		chunk_pos_  = 0;
+		next_chunk_ = index_.size();
+		return;
+	}
+
+	load_chunk(c - index_.begin());
+
+	while (chunk_pos_ + sizeof(bblog_container_entry_header) <= chunk_.size()) {
+		bblog_container_entry_header *ehead = (bblog_container_entry_header *)&chunk_[chunk_pos_];
+		if (Time(ehead->rel_time_sec, ehead->rel_time_usec) >= offset)
+			break;
+		check_interface_index(ehead->interface_index);
+		chunk_pos_ +=
+		  sizeof(bblog_container_entry_header) + interfaces_[ehead->interface_index].data_size;
+	}
+}
+
+/** Check if another entry is available.
+ * @return true if a consecutive read_next() will succeed, false otherwise
+ */
+bool
+BBLogContainerFile::has_next()
+{
+	return (chunk_pos_ < chunk_.size()) || (next_chunk_ < index_.size());
+}
+
+/** Read next entry.
+ * The data is stored in the interface of the entry, cf. entry_interface().
+ * @exception Exception thrown if reading fails, for example because no more
+ * entries are left.
+ */
+void
+BBLogContainerFile::read_next()
+{
+	while (chunk_pos_ >= chunk_.size()) {
+		if (next_chunk_ >= index_.size()) {
+			throw Exception("Cannot read interface data, no more entries");
+		}
+		load_chunk(next_chunk_);
+	}
+
+	if (chunk_pos_ + sizeof(bblog_container_entry_header) > chunk_.size()) {
+		throw Exception("Corrupted chunk in %s", filename_);
+	}
+	bblog_container_entry_header *ehead = (bblog_container_entry_header *)&chunk_[chunk_pos_];
+	check_interface_index(ehead->interface_index);
+	size_t data_size = interfaces_[ehead->interface_index].data_size;
+	if (chunk_pos_ + sizeof(bblog_container_entry_header) + data_size > chunk_.size()) {
+		throw Exception("Corrupted chunk in %s", filename_);
+	}
+
+	entry_interface_index_ = ehead->interface_index;
+	entry_offset_.set_time(ehead->rel_time_sec, ehead->rel_time_usec);
+	ifaces_[entry_interface_index_]->set_from_chunk(
+	  &chunk_[chunk_pos_ + sizeof(bblog_container_entry_header)]);
+
+	chunk_pos_ += sizeof(bblog_container_entry_header) + data_size;
+}
+
+/** Get current entry offset.
+ * @return offset from start time of current entry (may be 0 if no entry has
+ * been read, yet, or after rewind()).
+ */
+const fawkes::Time &
+BBLogContainerFile::entry_offset() const
+{
+	return entry_offset_;
+}
+
+/** Get interface index of current entry.
+ * @return index of interface the last read entry belongs to
+ */
+unsigned int
+BBLogContainerFile::entry_interface_index() const
+{
+	return entry_interface_index_;
+}
+
+/** Get interface of current entry.
+ * @return interface which holds the data of the last read entry
+ */
+fawkes::Interface *
+BBLogContainerFile::entry_interface()
+{
+	return ifaces_[entry_interface_index_];
+}
+
+/** Print an entry.
+ * Verbose print of the last read entry.
+ * @param outf file handle to print to
+ */
+void
+BBLogContainerFile::print_entry(FILE *outf)
+{
+	Interface *iface = ifaces_[entry_interface_index_];
+	fprintf(outf, "Time Offset: %f  Interface: %s\n", entry_offset_.in_sec(), iface->uid());
+
+	InterfaceFieldIterator i;
+	for (i = iface->fields(); i != iface->fields_end(); ++i) {
+		char *typesize;
+		if (i.get_length() > 1) {
+			if (asprintf(&typesize, "%s[%zu]", i.get_typename(), i.get_length()) == -1) {
+				throw Exception("Out of memory");
+			}
+		} else {
+			if (asprintf(&typesize, "%s", i.get_typename()) == -1) {
+				throw Exception("Out of memory");
+			}
+		}
+		fprintf(outf, "%-16s %-18s: %s\n", i.get_name(), typesize, i.get_value_string());
+		free(typesize);
+	}
+}
+
+/** Print file meta info.
+ * @param line_prefix a prefix printed before each line
+ * @param outf file handle to print to
+ */
+void
+BBLogContainerFile::print_info(const char *line_prefix, FILE *outf)
+{
+	struct stat fs;
+	if (fstat(fileno(f_), &fs) != 0) {
+		throw Exception(errno, "Failed to get stat file");
+	}
+
+	fprintf(outf,
+	        "%sFile version: %-10u  Endianess: %s Endian\n"
+	        "%s# data items: %-10lu  # chunks: %u%s\n"
+	        "%sHeader size:  %zu bytes   File size: %li bytes\n"
+	        "%s\n"
+	        "%sScenario:   %s\n"
+	        "%sStart time: %s\n"
+	        "%sInterfaces: %zu\n",
+	        line_prefix,
+	        file_version(),
+	        (header_.endianess == 1) ? "Big" : "Little",
+	        line_prefix,
+	        (unsigned long)header_.num_data_items,
+	        (unsigned int)index_.size(),
+	        has_index_ ? "" : " (no index, rebuilt)",
+	        line_prefix,
+	        sizeof(bblog_container_header),
+	        (long int)fs.st_size,
+	        line_prefix,
+	        line_prefix,
+	        scenario_,
+	        line_prefix,
+	        start_time_.str(),
+	        line_prefix,
+	        interfaces_.size());
+
+	for (unsigned int i = 0; i < interfaces_.size(); ++i) {
+		fprintf(outf,
+		        "%s  %3u  %s::%s (%u bytes)\n",
+		        line_prefix,
+		        i,
+		        interface_type(i),
+		        interface_id(i),
+		        interfaces_[i].data_size);
+	}
+}
+
+/** Check interface index.
+ * @param index interface index to check
+ * @exception OutOfBoundsException thrown if index is invalid
+ */
+void
+BBLogContainerFile::check_interface_index(unsigned int index) const
+{
+	if (index >= interfaces_.size()) {
+		throw OutOfBoundsException("Invalid interface index", index, 0, interfaces_.size());
+	}
+}
+
+/** Get interface instance.
+ * @param index interface index
+ * @return internally used interface
+ */
+fawkes::Interface *
+BBLogContainerFile::interface(unsigned int index)
+{
+	check_interface_index(index);
+	return ifaces_[index];
+}
+
+/** Set an interface.
+ * @param index index of interface to replace
+ * @param interface an interface matching the type, ID, and hash of the
+ * logged interface with the given index.
+ */
+void
+BBLogContainerFile::set_interface(unsigned int index, fawkes::Interface *interface)
+{
+	check_interface_index(index);
+
+	if ((strcmp(interface->type(), interface_type(index)) == 0)
+	    && (strcmp(interface->id(), interface_id(index)) == 0)
+	    && (memcmp(interface->hash(), interfaces_[index].interface_hash, INTERFACE_HASH_SIZE_) == 0)
+	    && (interface->datasize() == interfaces_[index].data_size)) {
+		if (owned_ifaces_[index]) {
+			instance_factory_->delete_interface_instance(ifaces_[index]);
+			owned_ifaces_[index] = false;
+		}
+		ifaces_[index] = interface;
+	} else {
+		throw TypeMismatchException("Interfaces incompatible");
+	}
+}
+
+/** Get file version.
+ * @return file version
+ */
+uint32_t
+BBLogContainerFile::file_version() const
+{
+	return ntohl(header_.file_version);
+}
+
+/** Check if file is big endian.
+ * @return true if file is big endian, false otherwise
+ */
+bool
+BBLogContainerFile::is_big_endian() const
+{
+	return (header_.endianess == 1);
+}
+
+/** Get number of data items in file.
+ * @return number of data items, may be zero if unknown
+ */
+uint64_t
+BBLogContainerFile::num_data_items() const
+{
+	return header_.num_data_items;
+}
+
+/** Get number of data chunks.
+ * @return number of data chunks
+ */
+uint32_t
+BBLogContainerFile::num_chunks() const
+{
+	return index_.size();
+}
+
+/** Get scenario identifier.
+ * @return scenario identifier
+ */
+const char *
+BBLogContainerFile::scenario() const
+{
+	return scenario_;
+}
+
+/** Get start time.
+ * @return starting time of log
+ */
+fawkes::Time &
+BBLogContainerFile::start_time()
+{
+	return start_time_;
+}
+
+/** Check if the file contains a seek index.
+ * @return true if the index was read from the file, false if it had to be
+ * rebuilt by scanning the file.
+ */
+bool
+BBLogContainerFile::has_index() const
+{
+	return has_index_;
+}
+
+/** Get number of interfaces.
+ * @return number of logged interfaces
+ */
+unsigned int
+BBLogContainerFile::num_interfaces() const
+{
+	return interfaces_.size();
+}
+
+/** Get interface type.
+ * @param index interface index
+ * @return type of logged interface
+ */
+const char *
+BBLogContainerFile::interface_type(unsigned int index) const
+{
+	check_interface_index(index);
+	return interfaces_[index].interface_type;
+}
+
+/** Get interface ID.
+ * @param index interface index
+ * @return ID of logged interface
+ */
+const char *
+BBLogContainerFile::interface_id(unsigned int index) const
+{
+	check_interface_index(index);
+	return interfaces_[index].interface_id;
+}
+
+/** Get interface hash.
+ * @param index interface index
+ * @return interface hash
+ */
+unsigned char *
+BBLogContainerFile::interface_hash(unsigned int index)
+{
+	check_interface_index(index);
+	return interfaces_[index].interface_hash;
+}
+
+/** Get data size.
+ * @param index interface index
+ * @return size of the pure data part of the entries of the given interface
+ */
+uint32_t
+BBLogContainerFile::data_size(unsigned int index) const
+{
+	check_interface_index(index);
+	return interfaces_[index].data_size;
+}
@@ -0,0 +1,107 @@
+
+/***************************************************************************
+ *  container_file.h - BlackBoard log container file access class
+ *
+ *  Created: Sat Oct 17 11:02:44 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_BBLOGGER_CONTAINER_FILE_H_
+#define _PLUGINS_BBLOGGER_CONTAINER_FILE_H_
+
+#include "file.h"
+
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace fawkes {
+class Interface;
+class BlackBoardInstanceFactory;
+} // namespace fawkes
+
+class BBLogContainerFile
+{
+public:
+	explicit BBLogContainerFile(const char *filename);
+	~BBLogContainerFile();
+
+	static bool is_container(const char *filename);
+
+	bool                has_next();
+	void                read_next();
+	void                seek(const fawkes::Time &offset);
+	void                rewind();
+	const fawkes::Time &entry_offset() const;
+	unsigned int        entry_interface_index() const;
+	fawkes::Interface * entry_interface();
+	void                print_entry(FILE *outf = stdout);
+
+	void print_info(const char *line_prefix = "", FILE *outf = stdout);
+
+	// Header information
+	uint32_t      file_version() const;
+	bool          is_big_endian() const;
+	uint64_t      num_data_items() const;
+	uint32_t      num_chunks() const;
+	const char *  scenario() const;
+	fawkes::Time &start_time();
+	bool          has_index() const;
+
+	// Interface information
+	unsigned int   num_interfaces() const;
+	const char *   interface_type(unsigned int index) const;
+	const char *   interface_id(unsigned int index) const;
+	unsigned char *interface_hash(unsigned int index);
+	uint32_t       data_size(unsigned int index) const;
+
+	void               set_interface(unsigned int index, fawkes::Interface *interface);
+	fawkes::Interface *interface(unsigned int index);
+
+private: // methods
+	void read_header();
+	void read_index();
+	void scan_chunks();
+	void load_chunk(size_t chunk_index);
+	void check_interface_index(unsigned int index) const;
+
+private: // members
+	FILE *                 f_;
+	char *                 filename_;
+	bblog_container_header header_;
+	char *                 scenario_;
+	bool                   has_index_;
+
+	std::vector<bblog_container_interface> interfaces_;
+	std::vector<fawkes::Interface *>       ifaces_;
+	std::vector<bool>                      owned_ifaces_;
+	std::vector<bblog_index_entry>         index_;
+
+	std::vector<char> chunk_;
+	std::vector<char> compressed_;
+	size_t            chunk_pos_;
+	size_t            next_chunk_;
+
+	std::unique_ptr<fawkes::BlackBoardInstanceFactory> instance_factory_;
+	fawkes::Time                                       start_time_;
+	fawkes::Time                                       entry_offset_;
+	unsigned int                                       entry_interface_index_;
+};
+
+#endif
@@ -0,0 +1,488 @@
+
+/***************************************************************************
+ *  container_writer.cpp - BlackBoard log container file writer
+ *
+ *  Created: Sat Oct 17 10:24:05 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "container_writer.h"
+
+#include <core/exceptions/system.h>
+#include <core/threading/mutex_locker.h>
+#include <interface/interface.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#ifdef __FreeBSD__
+#	include <sys/endian.h>
+#elif defined(__MACH__) && defined(__APPLE__)
+#	include <sys/_endian.h>
+#else
+#	include <endian.h>
+#endif
+#include <arpa/inet.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef HAVE_LZ4
+#	include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD
+#	include <zstd.h>
+#endif
+
+using namespace fawkes;
+
+/** @class BBLogContainerWriter "container_writer.h"
+ * Writer for bblogger container files.
+ * A container file stores the data of many interfaces in a single file.
+ * Entries are collected in memory until the configured chunk size is
+ * reached. The chunk is then (optionally compressed and) written as a
+ * whole and recorded in the seek index, which is appended to the file
+ * together with the interface table on close(). The writer is thread-safe,
+ * all logger threads of a scenario can share a single instance.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param filename name of the file to create, must not exist
+ * @param scenario ID of the log scenario
+ * @param start_time time to use as start time for the log
+ * @param chunk_size approximate size in bytes of uncompressed data chunks
+ * @param compression compression to use for data chunks, one of
+ * BBLOG_COMPRESSION_*, cf. parse_compression()
+ * @param flushing true to flush the file stream after each written chunk
+ * @exception CouldNotOpenFileException thrown if file cannot be created
+ * @exception FileWriteException thrown if the header cannot be written
+ */
+BBLogContainerWriter::BBLogContainerWriter(const char *        filename,
+                                           const char *        scenario,
+                                           const fawkes::Time &start_time,
+                                           size_t              chunk_size,
+                                           uint16_t            compression,
+                                           bool                flushing)
+: start_time_(start_time)
+{
+	chunk_size_     = chunk_size;
+	compression_    = compression;
+	flushing_       = flushing;
+	num_data_items_ = 0;
+	num_interfaces_ = 0;
+	chunk_entries_  = 0;
+
+	chunk_first_sec_ = chunk_first_usec_ = 0;
+	chunk_last_sec_ = chunk_last_usec_ = 0;
+
+	// use open because fopen does not provide O_CREAT | O_EXCL
+	mode_t m  = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+	int    fd = open(filename, O_RDWR | O_CREAT | O_EXCL, m);
+	if (fd == -1) {
+		throw CouldNotOpenFileException(filename, errno, "Failed to open container log");
+	}
+	f_ = fdopen(fd, "w+");
+	if (!f_) {
+		::close(fd);
+		throw CouldNotOpenFileException(filename, errno, "Failed to open container log stream");
+	}
+
+	filename_ = strdup(filename);
+
+	bblog_container_header header;
+	memset(&header, 0, sizeof(header));
+	header.file_magic   = htonl(BBLOGGER_CONTAINER_MAGIC);
+	header.file_version = htonl(BBLOGGER_CONTAINER_VERSION);
+#if BYTE_ORDER_ == BIG_ENDIAN_
+	header.endianess = BBLOG_BIG_ENDIAN;
+#else
+	header.endianess = BBLOG_LITTLE_ENDIAN;
+#endif
+	strncpy(header.scenario, scenario, BBLOG_SCENARIO_SIZE - 1);
+	long start_time_sec, start_time_usec;
+	start_time_.get_timestamp(start_time_sec, start_time_usec);
+	header.start_time_sec  = start_time_sec;
+	header.start_time_usec = start_time_usec;
+	if (fwrite(&header, sizeof(header), 1, f_) != 1) {
+		fclose(f_);
+		f_ = NULL;
+		free(filename_);
+		throw FileWriteException(filename, "Failed to write container header");
+	}
+	fflush(f_);
+
+	chunk_.reserve(chunk_size_);
+}
+
+/** Destructor.
+ * Closes the file if that has not been done explicitly.
+ */
+BBLogContainerWriter::~BBLogContainerWriter()
+{
+	try {
+		close();
+	} catch (Exception &e) {
+	} // ignored, nothing we can do about it anymore
+	free(filename_);
+}
+
+/** Parse compression setting.
+ * @param compression one of "none", "lz4", or "zstd"
+ * @return compression constant to pass to the constructor
+ * @exception Exception thrown if compression is unknown or has not been
+ * enabled at compile time
+ */
+uint16_t
+BBLogContainerWriter::parse_compression(const char *compression)
+{
+	if (strcmp(compression, "none") == 0) {
+		return BBLOG_COMPRESSION_NONE;
+	} else if (strcmp(compression, "lz4") == 0) {
+#ifdef HAVE_LZ4
+		return BBLOG_COMPRESSION_LZ4;
+#else
+		throw Exception("LZ4 compression requested, but liblz4 not available");
+#endif
+	} else if (strcmp(compression, "zstd") == 0) {
+#ifdef HAVE_ZSTD
+		return BBLOG_COMPRESSION_ZSTD;
+#else
+		throw Exception("zstd compression requested, but libzstd not available");
+#endif
+	} else {
+		throw Exception("Unknown compression '%s'", compression);
+	}
+}
+
+/** Add interface to log.
+ * This writes an interface chunk announcing the interface.
+ * @param interface interface to add
+ * @return interface index to pass to append()
+ */
+unsigned int
+BBLogContainerWriter::add_interface(fawkes::Interface *interface)
+{
+	MutexLocker lock(&mutex_);
+
+	if (!f_) {
+		throw Exception("Container %s has already been closed", filename_);
+	}
+
+	bblog_container_interface desc;
+	memset(&desc, 0, sizeof(desc));
+	strncpy(desc.interface_type, interface->type(), BBLOG_INTERFACE_TYPE_SIZE - 1);
+	strncpy(desc.interface_id, interface->id(), BBLOG_INTERFACE_ID_SIZE - 1);
+	memcpy(desc.interface_hash, interface->hash(), BBLOG_INTERFACE_HASH_SIZE);
+	desc.data_size = interface->datasize();
+
+	// interface chunks must precede any data of the interface
+	write_data_chunk();
+	write_chunk(BBLOG_CHUNK_TYPE_INTERFACE, &desc, sizeof(desc), 1);
+
+	interfaces_.push_back(desc);
+	return num_interfaces_++;
+}
+
+/** Append an entry.
+ * Entries must be appended in the order of their time, the seek index
+ * relies on it. Use append_now() if multiple threads append entries.
+ * @param interface_index index of interface as returned by add_interface()
+ * @param time time of the entry, the offset to the start time is stored
+ * @param data interface data chunk, must be of the interface's data size
+ * @exception Exception thrown if the entry precedes the start time or the
+ * previous entry, the entry is not stored in that case.
+ */
+void
+BBLogContainerWriter::append(unsigned int        interface_index,
+                             const fawkes::Time &time,
+                             const void *        data)
+{
+	MutexLocker lock(&mutex_);
+	append_locked(interface_index, time, data);
+}
+
+/** Append an entry with the current time.
+ * The time is taken while holding the container lock. Entries appended
+ * concurrently by multiple threads are therefore ordered by time.
+ * @param interface_index index of interface as returned by add_interface()
+ * @param time upon return set to the time of the entry, the time is taken
+ * from the clock the time is associated with, if any
+ * @param data interface data chunk, must be of the interface's data size
+ * @exception Exception thrown if the entry precedes the start time or the
+ * previous entry, e.g., because the clock jumped back. The entry is not
+ * stored in that case.
+ */
+void
+BBLogContainerWriter::append_now(unsigned int  interface_index,
+                                 fawkes::Time &time,
+                                 const void *  data)
+{
+	MutexLocker lock(&mutex_);
+	time.stamp();
+	append_locked(interface_index, time, data);
+}
+
+void
+BBLogContainerWriter::append_locked(unsigned int        interface_index,
+                                    const fawkes::Time &time,
+                                    const void *        data)
+{
+	if (!f_) {
+		throw Exception("Container %s has already been closed", filename_);
+	}
+	if (interface_index >= num_interfaces_) {
+		throw Exception("Invalid interface index %u", interface_index);
+	}
+
+	Time d = time - start_time_;
+	long rel_time_sec, rel_time_usec;
+	d.get_timestamp(rel_time_sec, rel_time_usec);
+	if (rel_time_sec < 0 || rel_time_usec < 0) {
+		throw Exception("Entry time %s precedes start time of %s", time.str(), filename_);
+	}
+
+	bblog_container_entry_header ehead;
+	ehead.interface_index = interface_index;
+	ehead.rel_time_sec    = rel_time_sec;
+	ehead.rel_time_usec   = rel_time_usec;
+
+	if ((num_data_items_ > 0)
+	    && ((ehead.rel_time_sec < chunk_last_sec_)
+	        || ((ehead.rel_time_sec == chunk_last_sec_)
+	            && (ehead.rel_time_usec < chunk_last_usec_)))) {
+		throw Exception("Entry time %s precedes previous entry of %s", time.str(), filename_);
+	}
+	if (chunk_entries_ == 0) {
+		chunk_first_sec_  = ehead.rel_time_sec;
+		chunk_first_usec_ = ehead.rel_time_usec;
+	}
+	chunk_last_sec_  = ehead.rel_time_sec;
+	chunk_last_usec_ = ehead.rel_time_usec;
+
+	const char *ehead_p = (const char *)&ehead;
+	const char *data_p  = (const char *)data;
+	chunk_.insert(chunk_.end(), ehead_p, ehead_p + sizeof(ehead));
+	chunk_.insert(chunk_.end(), data_p, data_p + interfaces_[interface_index].data_size);
+	chunk_entries_ += 1;
+	num_data_items_ += 1;
+
+	if (chunk_.size() >= chunk_size_) {
+		write_data_chunk();
+	}
+}
+
+/** Flush data.
+ * Writes the currently buffered entries as a chunk and updates the header.
+ */
+void
+BBLogContainerWriter::flush()
+{
+	MutexLocker lock(&mutex_);
+	if (!f_)
+		return;
+
+	write_data_chunk();
+	fflush(f_);
+	update_header();
+}
+
+/** Close file.
+ * Writes any remaining data, the seek index, the interface table and the
+ * final header. After
+ * this no more data can be appended. Calling this multiple times is safe.
+ */
+void
+BBLogContainerWriter::close()
+{
+	MutexLocker lock(&mutex_);
+	if (!f_)
+		return;
+
+	write_data_chunk();
+
+	if (fseek(f_, 0, SEEK_END) != 0) {
+		throw Exception(errno, "Cannot seek to end of %s", filename_);
+	}
+	long index_offset = ftell(f_);
+	if (!index_.empty()
+	    && (fwrite(&index_[0], sizeof(bblog_index_entry), index_.size(), f_) != index_.size())) {
+		fclose(f_);
+		f_ = NULL;
+		throw FileWriteException(filename_, "Failed to write seek index");
+	}
+	if (!interfaces_.empty()
+	    && (fwrite(&interfaces_[0], sizeof(bblog_container_interface), interfaces_.size(), f_)
+	        != interfaces_.size())) {
+		fclose(f_);
+		f_ = NULL;
+		throw FileWriteException(filename_, "Failed to write interface table");
+	}
+	fflush(f_);
+
+	bblog_container_header header;
+	if ((fseek(f_, 0, SEEK_SET) == 0) && (fread(&header, sizeof(header), 1, f_) == 1)) {
+		header.num_interfaces = num_interfaces_;
+		header.num_chunks     = index_.size();
+		header.num_data_items = num_data_items_;
+		header.index_offset   = index_offset;
+		if ((fseek(f_, 0, SEEK_SET) != 0) || (fwrite(&header, sizeof(header), 1, f_) != 1)) {
+			fclose(f_);
+			f_ = NULL;
+			throw FileWriteException(filename_, "Failed to write final header");
+		}
+	}
+
+	fclose(f_);
+	f_ = NULL;
+}
+
+/** Get filename.
+ * @return name of the container file
+ */
+const char *
+BBLogContainerWriter::filename() const
+{
+	return filename_;
+}
+
+/** Get number of data items.
+ * @return number of entries appended so far
+ */
+uint64_t
+BBLogContainerWriter::num_data_items() const
+{
+	return num_data_items_;
+}
+
+/** Write a chunk to the end of the file.
+ * Must be called with the mutex locked.
+ * @param chunk_type chunk type
+ * @param payload chunk payload
+ * @param size size in bytes of payload
+ * @param num_entries number of entries in payload
+ */
+void
+BBLogContainerWriter::write_chunk(uint16_t    chunk_type,
+                                  const void *payload,
+                                  size_t      size,
+                                  uint32_t    num_entries)
+{
+	bblog_chunk_header chead;
+	memset(&chead, 0, sizeof(chead));
+	chead.chunk_magic = BBLOG_CHUNK_MAGIC;
+	chead.chunk_type  = chunk_type;
+	chead.compression = BBLOG_COMPRESSION_NONE;
+	chead.num_entries = num_entries;
+	chead.raw_size    = size;
+	chead.stored_size = size;
+
+	const void *stored = payload;
+
+	if (chunk_type == BBLOG_CHUNK_TYPE_DATA) {
+		chead.first_rel_time_sec  = chunk_first_sec_;
+		chead.first_rel_time_usec = chunk_first_usec_;
+		chead.last_rel_time_sec   = chunk_last_sec_;
+		chead.last_rel_time_usec  = chunk_last_usec_;
+
+#ifdef HAVE_LZ4
+		if (compression_ == BBLOG_COMPRESSION_LZ4) {
+			compress_buffer_.resize(LZ4_compressBound(size));
+			int csize = LZ4_compress_default((const char *)payload,
+			                                 &compress_buffer_[0],
+			                                 size,
+			                                 compress_buffer_.size());
+			if ((csize > 0) && ((size_t)csize < size)) {
+				chead.compression = BBLOG_COMPRESSION_LZ4;
+				chead.stored_size = csize;
+				stored            = &compress_buffer_[0];
+			}
+		}
+#endif
+#ifdef HAVE_ZSTD
+		if (compression_ == BBLOG_COMPRESSION_ZSTD) {
+			compress_buffer_.resize(ZSTD_compressBound(size));
+			size_t csize =
+			  ZSTD_compress(&compress_buffer_[0], compress_buffer_.size(), payload, size, 1);
+			if (!ZSTD_isError(csize) && (csize < size)) {
+				chead.compression = BBLOG_COMPRESSION_ZSTD;
+				chead.stored_size = csize;
+				stored            = &compress_buffer_[0];
+			}
+		}
+#endif
+	}
+
+	if (fseek(f_, 0, SEEK_END) != 0) {
+		throw Exception(errno, "Cannot seek to end of %s", filename_);
+	}
+	long chunk_offset = ftell(f_);
+
+	if ((fwrite(&chead, sizeof(chead), 1, f_) != 1)
+	    || (fwrite(stored, chead.stored_size, 1, f_) != 1)) {
+		throw FileWriteException(filename_, "Failed to write chunk");
+	}
+	if (flushing_)
+		fflush(f_);
+
+	if (chunk_type == BBLOG_CHUNK_TYPE_DATA) {
+		bblog_index_entry ie;
+		ie.chunk_offset        = chunk_offset;
+		ie.num_entries         = num_entries;
+		ie.first_rel_time_sec  = chead.first_rel_time_sec;
+		ie.first_rel_time_usec = chead.first_rel_time_usec;
+		ie.last_rel_time_sec   = chead.last_rel_time_sec;
+		ie.last_rel_time_usec  = chead.last_rel_time_usec;
+		index_.push_back(ie);
+	}
+}
+
+/** Write buffered entries as data chunk.
+ * Must be called with the mutex locked.
+ */
+void
+BBLogContainerWriter::write_data_chunk()
+{
+	if (chunk_entries_ == 0)
+		return;
+
+	write_chunk(BBLOG_CHUNK_TYPE_DATA, &chunk_[0], chunk_.size(), chunk_entries_);
+	chunk_.clear();
+	chunk_entries_ = 0;
+}
+
+/** Update counters in file header.
+ * Must be called with the mutex locked. The index offset is only written
+ * on close(), readers of a file that is still being written scan the chunks.
+ */
+void
+BBLogContainerWriter::update_header()
+{
+	bblog_container_header header;
+	long                   pos = ftell(f_);
+	if ((fseek(f_, 0, SEEK_SET) == 0) && (fread(&header, sizeof(header), 1, f_) == 1)) {
+		header.num_interfaces = num_interfaces_;
+		header.num_chunks     = index_.size();
+		header.num_data_items = num_data_items_;
+		if (fseek(f_, 0, SEEK_SET) == 0) {
+			if (fwrite(&header, sizeof(header), 1, f_) != 1) {
+				throw FileWriteException(filename_, "Failed to update header");
+			}
+		}
+	}
+	fseek(f_, pos, SEEK_SET);
+	fflush(f_);
+}
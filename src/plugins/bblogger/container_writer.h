@@ -0,0 +1,91 @@
+
+/***************************************************************************
+ *  container_writer.h - BlackBoard log container file writer
+ *
+ *  Created: Sat Oct 17 10:12:31 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_BBLOGGER_CONTAINER_WRITER_H_
+#define _PLUGINS_BBLOGGER_CONTAINER_WRITER_H_
+
+#include "file.h"
+
+#include <core/threading/mutex.h>
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace fawkes {
+class Interface;
+}
+
+class BBLogContainerWriter
+{
+public:
+	BBLogContainerWriter(const char *        filename,
+	                     const char *        scenario,
+	                     const fawkes::Time &start_time,
+	                     size_t              chunk_size  = 256 * 1024,
+	                     uint16_t            compression = BBLOG_COMPRESSION_NONE,
+	                     bool                flushing    = false);
+	~BBLogContainerWriter();
+
+	unsigned int add_interface(fawkes::Interface *interface);
+	void         append(unsigned int interface_index, const fawkes::Time &time, const void *data);
+	void         append_now(unsigned int interface_index, fawkes::Time &time, const void *data);
+	void         flush();
+	void         close();
+
+	const char *filename() const;
+	uint64_t    num_data_items() const;
+
+	static uint16_t parse_compression(const char *compression);
+
+private:
+	void append_locked(unsigned int interface_index, const fawkes::Time &time, const void *data);
+	void write_chunk(uint16_t chunk_type, const void *payload, size_t size, uint32_t num_entries);
+	void write_data_chunk();
+	void update_header();
+
+private:
+	fawkes::Mutex mutex_;
+
+	FILE *       f_;
+	char *       filename_;
+	fawkes::Time start_time_;
+	size_t       chunk_size_;
+	uint16_t     compression_;
+	bool         flushing_;
+
+	uint64_t num_data_items_;
+	uint32_t num_interfaces_;
+
+	std::vector<bblog_container_interface> interfaces_;
+	std::vector<char>                      chunk_;
+	std::vector<char>                      compress_buffer_;
+	std::vector<bblog_index_entry>         index_;
+
+	uint32_t chunk_entries_;
+	uint32_t chunk_first_sec_;
+	uint32_t chunk_first_usec_;
+	uint32_t chunk_last_sec_;
+	uint32_t chunk_last_usec_;
+};
+
+#endif
@@ -30,6 +30,9 @@
 #define BBLOGGER_FILE_MAGIC 0xffbbffbb
 #define BBLOGGER_FILE_VERSION 1
 
+#define BBLOGGER_CONTAINER_MAGIC 0xffbbffbc
+#define BBLOGGER_CONTAINER_VERSION 1
+
 #pragma pack(push, 4)
 
 #define BBLOG_BIG_ENDIAN 1
@@ -40,6 +43,15 @@
 #define BBLOG_INTERFACE_HASH_SIZE INTERFACE_HASH_SIZE_
 #define BBLOG_SCENARIO_SIZE 32
 
+#define BBLOG_CHUNK_MAGIC 0xbbc0ffee
+
+#define BBLOG_CHUNK_TYPE_INTERFACE 1
+#define BBLOG_CHUNK_TYPE_DATA 2
+
+#define BBLOG_COMPRESSION_NONE 0
+#define BBLOG_COMPRESSION_LZ4 1
+#define BBLOG_COMPRESSION_ZSTD 2
+
 /** BBLogger file header definition.
  * To identify log files created for different interfaces but belonging to a
  * single run files must be
@@ -78,6 +90,91 @@ typedef struct
 	uint32_t rel_time_usec; /**< time since start time, microseconds */
 } bblog_entry_header;
 
+/** BBLogger container file header.
+ * A container file stores the data of many interfaces in a single file.
+ * The header is followed by a sequence of chunks, each starting with a
+ * bblog_chunk_header. Interface chunks announce a logged interface, data
+ * chunks contain a number of (possibly compressed) entries. When the file
+ * is closed properly, a seek index of bblog_index_entry records, one for
+ * each data chunk, is appended followed by a table of num_interfaces
+ * bblog_container_interface records. The position of the index is stored
+ * in index_offset. If index_offset is zero (e.g. after a crash) readers
+ * must scan the chunks sequentially to rebuild index and interface table.
+ * As for bblog_file_header, magic and version are stored in network byte
+ * order, everything else in the native system format.
+ */
+typedef struct
+{
+	uint32_t file_magic;                    /**< Magic value to identify file,
+				 * must be 0xFFBBFFBC (big endian) */
+	uint32_t file_version;                  /**< File version, set to BBLOGGER_CONTAINER_VERSION
+				 * on write and verify on read (big endian) */
+	uint32_t endianess : 1;                 /**< Endianess, 0 little endian, 1 big endian */
+	uint32_t reserved : 31;                 /**< Reserved for future use */
+	uint32_t num_interfaces;                /**< Number of logged interfaces */
+	uint32_t num_chunks;                    /**< Number of data chunks, 0 if unknown */
+	uint32_t pad;                           /**< Padding, must be zero */
+	uint64_t num_data_items;                /**< Number of data items of all interfaces,
+				 * 0 if unknown */
+	uint64_t index_offset;                  /**< File offset of seek index, 0 if none */
+	char     scenario[BBLOG_SCENARIO_SIZE]; /**< Scenario as defined in config */
+	uint64_t start_time_sec;                /**< Start time, timestamp seconds */
+	uint64_t start_time_usec;               /**< Start time, timestamp microseconds */
+} bblog_container_header;
+
+/** BBLogger container chunk header.
+ * This header is written before every chunk in a container file.
+ */
+typedef struct
+{
+	uint32_t chunk_magic;         /**< Chunk magic, must be BBLOG_CHUNK_MAGIC */
+	uint16_t chunk_type;          /**< Chunk type, one of BBLOG_CHUNK_TYPE_* */
+	uint16_t compression;         /**< Compression of payload, one of BBLOG_COMPRESSION_* */
+	uint32_t num_entries;         /**< Number of entries in data chunk */
+	uint32_t raw_size;            /**< Size of uncompressed payload */
+	uint32_t stored_size;         /**< Size of payload as stored in file */
+	uint32_t first_rel_time_sec;  /**< Time of first entry since start time, seconds */
+	uint32_t first_rel_time_usec; /**< Time of first entry since start time, microseconds */
+	uint32_t last_rel_time_sec;   /**< Time of last entry since start time, seconds */
+	uint32_t last_rel_time_usec;  /**< Time of last entry since start time, microseconds */
+} bblog_chunk_header;
+
+/** BBLogger container interface descriptor.
+ * Payload of an interface chunk. Interfaces are numbered in the order
+ * they appear in the file, starting at zero.
+ */
+typedef struct
+{
+	char          interface_type[BBLOG_INTERFACE_TYPE_SIZE]; /**< Interface type */
+	char          interface_id[BBLOG_INTERFACE_ID_SIZE];     /**< Interface ID */
+	unsigned char interface_hash[BBLOG_INTERFACE_HASH_SIZE]; /**< Interface Hash */
+	uint32_t      data_size; /**< size of one interface data block */
+} bblog_container_interface;
+
+/** BBLogger container entry header.
+ * Within an uncompressed data chunk payload every data block of
+ * data_size bytes of the respective interface is preceded by this header.
+ */
+typedef struct
+{
+	uint32_t interface_index; /**< Index of interface this entry belongs to */
+	uint32_t rel_time_sec;    /**< time since start time, seconds */
+	uint32_t rel_time_usec;   /**< time since start time, microseconds */
+} bblog_container_entry_header;
+
+/** BBLogger container seek index entry.
+ * One entry per data chunk, sorted by time.
+ */
+typedef struct
+{
+	uint64_t chunk_offset;        /**< File offset of chunk header */
+	uint32_t num_entries;         /**< Number of entries in chunk */
+	uint32_t first_rel_time_sec;  /**< Time of first entry since start time, seconds */
+	uint32_t first_rel_time_usec; /**< Time of first entry since start time, microseconds */
+	uint32_t last_rel_time_sec;   /**< Time of last entry since start time, seconds */
+	uint32_t last_rel_time_usec;  /**< Time of last entry since start time, microseconds */
+} bblog_index_entry;
+
 #pragma pack(pop)
 
 #endif
@@ -22,7 +22,9 @@
 
 #include "log_thread.h"
 
+#include "container_writer.h"
 #include "file.h"
+#include "writer_thread.h"
 
 #include <blackboard/blackboard.h>
 #include <core/exceptions/system.h>
@@ -45,6 +47,7 @@
 #include <arpa/inet.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 using namespace fawkes;
 
@@ -64,6 +67,11 @@ using namespace fawkes;
  * up to then.
  * The interface listener listens for events for a particular interface and
  * then writes the changes to the file.
+ * If a container writer is given, the data is not written to a file of its
+ * own, but appended to the shared container file instead.
+ * If a background writer thread is given, the data is copied into the
+ * writer's ring buffer during the event and written by the writer thread
+ * in batches, such that producers never wait for I/O.
  * @author Tim Niemueller
  */
 
@@ -74,13 +82,19 @@ using namespace fawkes;
  * @param flushing true to flush after each written chunk
  * @param scenario ID of the log scenario
  * @param start_time time to use as start time for the log
+ * @param container optional container writer shared by all logger threads,
+ * if NULL a log file is written for this interface
+ * @param writer optional background writer thread shared by all logger
+ * threads, if NULL data is written by this thread
  */
-BBLoggerThread::BBLoggerThread(const char *  iface_uid,
-                               const char *  logdir,
-                               bool          buffering,
-                               bool          flushing,
-                               const char *  scenario,
-                               fawkes::Time *start_time)
+BBLoggerThread::BBLoggerThread(const char *          iface_uid,
+                               const char *          logdir,
+                               bool                  buffering,
+                               bool                  flushing,
+                               const char *          scenario,
+                               fawkes::Time *        start_time,
+                               BBLogContainerWriter *container,
+                               BBLogWriterThread *   writer)
 : Thread("BBLoggerThread", Thread::OPMODE_WAITFORWAKEUP),
   BlackBoardInterfaceListener("BBLoggerThread(%s)", iface_uid)
 {
@@ -98,6 +112,10 @@ BBLoggerThread::BBLoggerThread(const char *  iface_uid,
 	data_size_   = 0;
 	is_master_   = false;
 	enabled_     = true;
+	container_   = container;
+	f_data_      = NULL;
+	writer_      = writer;
+	use_writer_  = false;
 
 	now_ = NULL;
 
@@ -109,9 +127,16 @@ BBLoggerThread::BBLoggerThread(const char *  iface_uid,
 	struct tm *tmp = localtime(&(now.get_timeval()->tv_sec));
 	strftime(date, 21, "%F-%H-%M-%S", tmp);
 
-	if (asprintf(
-	      &filename_, "%s/%s-%s-%s-%s.log", LOGDIR, scenario_, type_.c_str(), id_.c_str(), date)
-	    == -1) {
+	if (container_) {
+		filename_ = strdup(container_->filename());
+	} else if (asprintf(&filename_,
+	                    "%s/%s-%s-%s-%s.log",
+	                    LOGDIR,
+	                    scenario_,
+	                    type_.c_str(),
+	                    id_.c_str(),
+	                    date)
+	           == -1) {
 		throw OutOfMemoryException("Cannot generate log name");
 	}
 }
@@ -141,16 +166,18 @@ BBLoggerThread::init()
 	num_data_items_ = 0;
 	session_start_  = 0;
 
-	// use open because fopen does not provide O_CREAT | O_EXCL
-	// open read/write because of usage of mmap
-	mode_t m  = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
-	int    fd = open(filename_, O_RDWR | O_CREAT | O_EXCL, m);
-	if (!fd) {
-		throw CouldNotOpenFileException(filename_, errno, "Failed to open log 1");
-	} else {
-		f_data_ = fdopen(fd, "w+");
-		if (!f_data_) {
-			throw CouldNotOpenFileException(filename_, errno, "Failed to open log 2");
+	if (!container_) {
+		// use open because fopen does not provide O_CREAT | O_EXCL
+		// open read/write because of usage of mmap
+		mode_t m  = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+		int    fd = open(filename_, O_RDWR | O_CREAT | O_EXCL, m);
+		if (!fd) {
+			throw CouldNotOpenFileException(filename_, errno, "Failed to open log 1");
+		} else {
+			f_data_ = fdopen(fd, "w+");
+			if (!f_data_) {
+				throw CouldNotOpenFileException(filename_, errno, "Failed to open log 2");
+			}
 		}
 	}
 
@@ -158,20 +185,43 @@ BBLoggerThread::init()
 		iface_     = blackboard->open_for_reading(type_.c_str(), id_.c_str());
 		data_size_ = iface_->datasize();
 	} catch (Exception &e) {
-		fclose(f_data_);
+		if (f_data_)
+			fclose(f_data_);
 		throw;
 	}
 
 	try {
-		write_header();
-	} catch (FileWriteException &e) {
+		if (container_) {
+			container_index_ = container_->add_interface(iface_);
+		} else {
+			write_header();
+		}
+	} catch (Exception &e) {
 		blackboard->close(iface_);
-		fclose(f_data_);
+		if (f_data_)
+			fclose(f_data_);
 		throw;
 	}
 
 	now_ = new Time(clock);
 
+	use_writer_ = false;
+	if (writer_) {
+		if (data_size_ <= writer_->max_data_size()) {
+			if (container_) {
+				writer_sink_ = writer_->add_sink(container_, container_index_);
+			} else {
+				writer_sink_ = writer_->add_sink(fileno(f_data_), *start_);
+			}
+			use_writer_ = true;
+		} else {
+			logger->log_warn(name(),
+			                 "Data size %zu exceeds writer slot size %zu, writing directly",
+			                 data_size_,
+			                 writer_->max_data_size());
+		}
+	}
+
 	if (is_master_) {
 		try {
 			switch_if_ = blackboard->open_for_writing<SwitchInterface>("BBLogger");
@@ -179,7 +229,8 @@ BBLoggerThread::init()
 			switch_if_->write();
 			bbil_add_message_interface(switch_if_);
 		} catch (Exception &e) {
-			fclose(f_data_);
+			if (f_data_)
+				fclose(f_data_);
 			throw;
 		}
 	}
@@ -201,7 +252,19 @@ BBLoggerThread::finalize()
 		blackboard->close(switch_if_);
 	}
 	update_header();
-	fclose(f_data_);
+	if (use_writer_) {
+		// the writer must no longer access the file once it is closed
+		writer_->remove_sink(writer_sink_);
+		use_writer_ = false;
+	}
+	if (f_data_) {
+		fflush(f_data_);
+		if (fsync(fileno(f_data_)) != 0) {
+			logger->log_warn(name(), "Failed to sync %s: %s", filename_, strerror(errno));
+		}
+		fclose(f_data_);
+		f_data_ = NULL;
+	}
 	for (unsigned int q = 0; q < 2; ++q) {
 		while (!queues_[q].empty()) {
 			void *t = queues_[q].front();
@@ -237,7 +300,6 @@ BBLoggerThread::set_enabled(bool enabled)
 		                 "Logging disabled (wrote %u entries), flushing",
 		                 (num_data_items_ - session_start_));
 		update_header();
-		fflush(f_data_);
 	}
 
 	enabled_ = enabled;
@@ -284,10 +346,26 @@ BBLoggerThread::write_header()
 	fflush(f_data_);
 }
 
-/** Updates the num_data_items field in the header. */
+/** Updates the num_data_items field in the header and flushes the file. */
 void
 BBLoggerThread::update_header()
 {
+	if (use_writer_) {
+		// make sure everything enqueued so far has been written
+		writer_->flush();
+		num_data_items_ = writer_->num_written(writer_sink_);
+	}
+
+	if (container_) {
+		try {
+			container_->flush();
+		} catch (Exception &e) {
+			logger->log_warn(name(), "Failed to flush container");
+			logger->log_warn(name(), e);
+		}
+		return;
+	}
+
 	// write updated num_data_items field
 #if _POSIX_MAPPED_FILES
 	void *h = mmap(NULL, sizeof(bblog_file_header), PROT_WRITE, MAP_SHARED, fileno(f_data_), 0);
@@ -306,12 +384,25 @@ BBLoggerThread::update_header()
 	                 "Memory mapped files not available, "
 	                 "not updating number of data items on close");
 #endif
+	fflush(f_data_);
 }
 
 void
 BBLoggerThread::write_chunk(const void *chunk)
 {
 	bblog_entry_header ehead;
+	if (container_) {
+		try {
+			// stamped by the container, other loggers may append concurrently
+			container_->append_now(container_index_, *now_, chunk);
+			num_data_items_ += 1;
+		} catch (Exception &e) {
+			logger->log_warn(name(), "Failed to write chunk");
+			logger->log_warn(name(), e);
+		}
+		return;
+	}
+
 	now_->stamp();
 	Time d = *now_ - *start_;
 	long rel_time_sec, rel_time_usec;
@@ -365,7 +456,8 @@ BBLoggerThread::bb_interface_message_received(Interface *interface, Message *mes
 
 	for (ThreadList::iterator i = threads_.begin(); i != threads_.end(); ++i) {
 		BBLoggerThread *bblt = dynamic_cast<BBLoggerThread *>(*i);
-		bblt->set_enabled(enabled);
+		if (bblt)
+			bblt->set_enabled(enabled);
 	}
 
 	switch_if_->set_enabled(enabled_);
@@ -383,7 +475,10 @@ BBLoggerThread::bb_interface_data_changed(Interface *interface) throw()
 	try {
 		iface_->read();
 
-		if (buffering_) {
+		if (use_writer_) {
+			Time now(clock);
+			writer_->enqueue(writer_sink_, now, iface_->datachunk(), data_size_);
+		} else if (buffering_) {
 			void *c = malloc(iface_->datasize());
 			memcpy(c, iface_->datachunk(), iface_->datasize());
 			queue_mutex_->lock();
@@ -417,5 +512,4 @@ BBLoggerThread::bb_interface_writer_removed(Interface *  interface,
 	                 "Writer removed (wrote %u entries), flushing",
 	                 (num_data_items_ - session_start_));
 	update_header();
-	fflush(f_data_);
 }
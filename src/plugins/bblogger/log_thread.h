@@ -42,6 +42,9 @@ class Time;
 class SwitchInterface;
 } // namespace fawkes
 
+class BBLogContainerWriter;
+class BBLogWriterThread;
+
 class BBLoggerThread : public fawkes::Thread,
                        public fawkes::LoggingAspect,
                        public fawkes::ConfigurableAspect,
@@ -50,12 +53,14 @@ class BBLoggerThread : public fawkes::Thread,
                        public fawkes::BlackBoardInterfaceListener
 {
 public:
-	BBLoggerThread(const char *  iface_uid,
-	               const char *  logdir,
-	               bool          buffering,
-	               bool          flushing,
-	               const char *  scenario,
-	               fawkes::Time *start_time);
+	BBLoggerThread(const char *          iface_uid,
+	               const char *          logdir,
+	               bool                  buffering,
+	               bool                  flushing,
+	               const char *          scenario,
+	               fawkes::Time *        start_time,
+	               BBLogContainerWriter *container = NULL,
+	               BBLogWriterThread *   writer    = NULL);
 	virtual ~BBLoggerThread();
 
 	const char *get_filename() const;
@@ -105,6 +110,13 @@ private:
 	std::string id_;
 	FILE *      f_data_;
 
+	BBLogContainerWriter *container_;
+	unsigned int          container_index_;
+
+	BBLogWriterThread *writer_;
+	bool               use_writer_;
+	unsigned int       writer_sink_;
+
 	fawkes::Time *start_;
 	fawkes::Time *now_;
 
@@ -53,7 +53,9 @@ using namespace fawkes;
 /** @class BBLogReplayThread "logreplay_thread.h"
  * BlackBoard log Replay thread.
  * Writes the data of the logfile into a blackboard interface, considering the
- * time-step differences between the data.
+ * time-step differences between the data. If the log file is a container
+ * file, the data of all contained interfaces is replayed in the order in
+ * which it was logged.
  * @author Masrur Doostdar
  * @author Tim Niemueller
  */
@@ -90,6 +92,9 @@ BBLogReplayThread::BBLogReplayThread(const char *           logfile_name,
 	filename_         = NULL;
 	cfg_grace_period_ = grace_period;
 	cfg_loop_replay_  = loop_replay;
+	cfg_speed_        = 1.0;
+	cfg_start_offset_ = 0.;
+	cfg_mmap_         = false;
 	if (th_opmode == OPMODE_WAITFORWAKEUP) {
 		cfg_non_blocking_ = non_blocking;
 	} else {
@@ -106,10 +111,31 @@ BBLogReplayThread::~BBLogReplayThread()
 	free(scenario_);
 }
 
+/** Set replay options.
+ * Must be called before the thread is initialized.
+ * @param speed replay speed factor, e.g. 2.0 to replay twice as fast as
+ * recorded, or 0.5 to replay at half speed
+ * @param start_offset offset in seconds relative to the start of the log
+ * at which to start replaying, this is also used when looping
+ * @param use_mmap true to memory-map per-interface log files for fast
+ * seeking and in-place reading
+ */
+void
+BBLogReplayThread::set_replay_options(float speed, float start_offset, bool use_mmap)
+{
+	if (speed <= 0.) {
+		throw Exception("Invalid replay speed %f, must be positive", speed);
+	}
+	cfg_speed_        = speed;
+	cfg_start_offset_ = start_offset;
+	cfg_mmap_         = use_mmap;
+}
+
 void
 BBLogReplayThread::init()
 {
 	logfile_   = NULL;
+	container_ = NULL;
 	interface_ = NULL;
 	filename_  = NULL;
 
@@ -118,49 +144,127 @@ BBLogReplayThread::init()
 	}
 
 	try {
-		logfile_ = new BBLogFile(filename_, true);
+		if (BBLogContainerFile::is_container(filename_)) {
+			container_ = new BBLogContainerFile(filename_);
+		} else {
+			logfile_ = new BBLogFile(filename_, true);
+			if (cfg_mmap_)
+				logfile_->map();
+		}
+		log_rewind();
 	} catch (Exception &e) {
 		finalize();
 		throw;
 	}
 
-	if (!logfile_->has_next()) {
+	if (!log_has_next()) {
 		finalize();
 		throw Exception("Log file %s does not have any entries", filename_);
 	}
 
-	interface_ = blackboard->open_for_writing(logfile_->interface_type(), logfile_->interface_id());
-
 	try {
-		logfile_->set_interface(interface_);
+		if (container_) {
+			for (unsigned int i = 0; i < container_->num_interfaces(); ++i) {
+				Interface *iface = blackboard->open_for_writing(container_->interface_type(i),
+				                                                container_->interface_id(i));
+				container_ifaces_.push_back(iface);
+				container_->set_interface(i, iface);
+			}
+		} else {
+			interface_ =
+			  blackboard->open_for_writing(logfile_->interface_type(), logfile_->interface_id());
+			logfile_->set_interface(interface_);
+		}
 	} catch (Exception &e) {
 		finalize();
 		throw;
 	}
 
-	logger->log_info(name(), "Replaying from %s:", filename_);
+	if (container_) {
+		logger->log_info(name(),
+		                 "Replaying %u interfaces from %s:",
+		                 container_->num_interfaces(),
+		                 filename_);
+	} else {
+		logger->log_info(name(), "Replaying from %s:", filename_);
+	}
 }
 
 void
 BBLogReplayThread::finalize()
 {
 	delete logfile_;
+	delete container_;
+	logfile_   = NULL;
+	container_ = NULL;
 	if (filename_)
 		free(filename_);
+	filename_ = NULL;
 	blackboard->close(interface_);
+	interface_ = NULL;
+	for (unsigned int i = 0; i < container_ifaces_.size(); ++i) {
+		blackboard->close(container_ifaces_[i]);
+	}
+	container_ifaces_.clear();
+}
+
+bool
+BBLogReplayThread::log_has_next()
+{
+	return container_ ? container_->has_next() : logfile_->has_next();
+}
+
+void
+BBLogReplayThread::log_read_next()
+{
+	if (container_) {
+		container_->read_next();
+	} else {
+		logfile_->read_next();
+	}
+}
+
+void
+BBLogReplayThread::log_write()
+{
+	if (container_) {
+		container_->entry_interface()->write();
+	} else {
+		interface_->write();
+	}
+}
+
+void
+BBLogReplayThread::log_rewind()
+{
+	if (container_) {
+		container_->rewind();
+		if (cfg_start_offset_ > 0.)
+			container_->seek(Time((double)cfg_start_offset_));
+	} else {
+		logfile_->rewind();
+		if (cfg_start_offset_ > 0.)
+			logfile_->seek(Time((double)cfg_start_offset_));
+	}
+}
+
+const fawkes::Time &
+BBLogReplayThread::log_entry_offset() const
+{
+	return container_ ? container_->entry_offset() : logfile_->entry_offset();
 }
 
 void
 BBLogReplayThread::once()
 {
 	// Write first immediately, skip first offset
-	logfile_->read_next();
-	interface_->write();
-	last_offset_ = logfile_->entry_offset();
-	if (logfile_->has_next()) {
-		logfile_->read_next();
-		offsetdiff_  = logfile_->entry_offset() - last_offset_;
-		last_offset_ = logfile_->entry_offset();
+	log_read_next();
+	log_write();
+	last_offset_ = log_entry_offset();
+	if (log_has_next()) {
+		log_read_next();
+		offsetdiff_  = log_entry_offset() - last_offset_;
+		last_offset_ = log_entry_offset();
 	}
 	last_loop_.stamp();
 }
@@ -168,32 +272,33 @@ BBLogReplayThread::once()
 void
 BBLogReplayThread::loop()
 {
-	if (logfile_->has_next()) {
+	if (log_has_next()) {
 		// check if there is time left to wait
 		now_.stamp();
 		loopdiff_ = now_ - last_loop_;
-		if ((offsetdiff_.in_sec() - loopdiff_.in_sec()) > cfg_grace_period_) {
+		double remaining = offsetdiff_.in_sec() / cfg_speed_ - loopdiff_.in_sec();
+		if (remaining > cfg_grace_period_) {
 			if (cfg_non_blocking_) {
 				// need to keep waiting before posting, but in non-blocking mode
 				// just wait for next loop
 				return;
 			} else {
-				waittime_ = offsetdiff_ - loopdiff_;
+				waittime_.set_time(remaining);
 				waittime_.wait();
 			}
 		}
 
-		interface_->write();
-		logfile_->read_next();
+		log_write();
+		log_read_next();
 
 		last_loop_.stamp();
-		offsetdiff_  = logfile_->entry_offset() - last_offset_;
-		last_offset_ = logfile_->entry_offset();
+		offsetdiff_  = log_entry_offset() - last_offset_;
+		last_offset_ = log_entry_offset();
 
 	} else {
 		if (cfg_loop_replay_) {
 			logger->log_info(name(), "replay finished, looping");
-			logfile_->rewind();
+			log_rewind();
 		} else {
 			if (opmode() == OPMODE_CONTINUOUS) {
 				// block
@@ -25,6 +25,7 @@
 #define _PLUGINS_BBLOGGER_LOGREPLAY_THREAD_H_
 
 #include "bblogfile.h"
+#include "container_file.h"
 
 #include <aspect/blackboard.h>
 #include <aspect/clock.h>
@@ -34,6 +35,7 @@
 #include <core/utils/lock_queue.h>
 
 #include <cstdio>
+#include <vector>
 
 namespace fawkes {
 class BlackBoard;
@@ -58,6 +60,8 @@ public:
 	                  fawkes::Thread::OpMode th_opmode    = Thread::OPMODE_CONTINUOUS);
 	virtual ~BBLogReplayThread();
 
+	void set_replay_options(float speed, float start_offset, bool use_mmap);
+
 	virtual void init();
 	virtual void finalize();
 	virtual void loop();
@@ -71,6 +75,13 @@ protected:
 		Thread::run();
 	}
 
+private:
+	bool                log_has_next();
+	void                log_read_next();
+	void                log_write();
+	void                log_rewind();
+	const fawkes::Time &log_entry_offset() const;
+
 private:
 	char *scenario_;
 	char *filename_;
@@ -79,8 +90,13 @@ private:
 	float cfg_grace_period_;
 	bool  cfg_non_blocking_;
 	bool  cfg_loop_replay_;
+	float cfg_speed_;
+	float cfg_start_offset_;
+	bool  cfg_mmap_;
 
-	BBLogFile *logfile_;
+	BBLogFile *                      logfile_;
+	BBLogContainerFile *             container_;
+	std::vector<fawkes::Interface *> container_ifaces_;
 
 	fawkes::Time       last_offset_;
 	fawkes::Time       offsetdiff_;
@@ -0,0 +1,512 @@
+
+/***************************************************************************
+ *  writer_thread.cpp - BB Logger background writer thread
+ *
+ *  Created: Sat Oct 17 14:18:52 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "writer_thread.h"
+
+#include "container_writer.h"
+#include "file.h"
+
+#include <core/exceptions/system.h>
+#include <core/threading/mutex_locker.h>
+#include <logging/logger.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace fawkes;
+
+/// @cond INTERNAL
+/** Meta data stored at the beginning of each ring slot. */
+typedef struct
+{
+	uint32_t sink;      ///< sink index
+	uint32_t size;      ///< size of data
+	int64_t  time_sec;  ///< time of entry, seconds
+	int64_t  time_usec; ///< time of entry, microseconds
+} bblog_slot_meta;
+
+// the entry header directly precedes the data so that both can be
+// written with a single iovec
+static const size_t SLOT_HEADER_SIZE = sizeof(bblog_slot_meta) + sizeof(bblog_entry_header);
+/// @endcond
+
+/** @class BBLogWriterThread "writer_thread.h"
+ * BlackBoard logger background writer thread.
+ * This thread decouples writing log data from the logger threads. Entries
+ * are copied into slots of a preallocated ring buffer by enqueue(), which
+ * never blocks on I/O and drops entries if the ring is full. The thread
+ * periodically commits all queued entries as a group: entries for the same
+ * file are written with a single writev() call, entries for a container
+ * file are appended to the container writer. Files are synced to disk in
+ * the configured interval.
+ * The number of dropped entries and the write latency are recorded and
+ * reported when the thread is finalized.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param ring_size number of slots in the ring buffer
+ * @param slot_size maximum size of the data of a single entry
+ * @param commit_interval time in seconds between group commits
+ * @param fsync_interval time in seconds between syncing data to disk,
+ * zero or negative to never sync explicitly
+ */
+BBLogWriterThread::BBLogWriterThread(unsigned int ring_size,
+                                     size_t       slot_size,
+                                     float        commit_interval,
+                                     float        fsync_interval)
+: Thread("BBLogWriterThread", Thread::OPMODE_CONTINUOUS)
+{
+	cfg_ring_size_       = ring_size;
+	cfg_slot_size_       = slot_size;
+	cfg_commit_interval_ = commit_interval;
+	cfg_fsync_interval_  = fsync_interval;
+
+	if (cfg_ring_size_ == 0) {
+		throw Exception("Ring size must be greater than zero");
+	}
+
+	// round to 8 byte boundary to keep slots aligned
+	slot_stride_ = (SLOT_HEADER_SIZE + cfg_slot_size_ + 7) & ~((size_t)7);
+	ring_        = (char *)malloc(cfg_ring_size_ * slot_stride_);
+	if (!ring_) {
+		throw OutOfMemoryException("Cannot allocate ring buffer of %u slots", cfg_ring_size_);
+	}
+	ready_.reset(new std::atomic<bool>[cfg_ring_size_]);
+	for (unsigned int i = 0; i < cfg_ring_size_; ++i) {
+		ready_[i] = false;
+	}
+
+	head_                = 0;
+	tail_                = 0;
+	num_dropped_         = 0;
+	last_num_dropped_    = 0;
+	num_batches_         = 0;
+	num_writes_          = 0;
+	total_write_latency_ = 0.;
+	max_write_latency_   = 0.;
+}
+
+/** Destructor. */
+BBLogWriterThread::~BBLogWriterThread()
+{
+	free(ring_);
+}
+
+void
+BBLogWriterThread::init()
+{
+	last_sync_.stamp();
+	logger->log_info(name(),
+	                 "Ring of %u slots with %zu bytes, commit every %.3f sec, sync every %.3f sec",
+	                 cfg_ring_size_,
+	                 cfg_slot_size_,
+	                 cfg_commit_interval_,
+	                 cfg_fsync_interval_);
+}
+
+void
+BBLogWriterThread::finalize()
+{
+	write_mutex_.lock();
+	drain();
+	sync();
+	write_mutex_.unlock();
+
+	logger->log_info(name(),
+	                 "Wrote %lu batches, %lu dropped entries, "
+	                 "write latency avg %.3f ms, max %.3f ms",
+	                 (unsigned long)num_batches_,
+	                 (unsigned long)num_dropped_.load(),
+	                 avg_write_latency() * 1000.,
+	                 max_write_latency() * 1000.);
+}
+
+void
+BBLogWriterThread::loop()
+{
+	CancelState old_state;
+	set_cancel_state(CANCEL_DISABLED, &old_state);
+	flush();
+
+	uint64_t dropped = num_dropped_.load();
+	if (dropped != last_num_dropped_) {
+		logger->log_warn(name(),
+		                 "Dropped %lu entries (%lu total), ring too small or disk too slow",
+		                 (unsigned long)(dropped - last_num_dropped_),
+		                 (unsigned long)dropped);
+		last_num_dropped_ = dropped;
+	}
+	set_cancel_state(old_state);
+
+	usleep((useconds_t)(cfg_commit_interval_ * 1000000.));
+}
+
+/** Add file sink.
+ * Entries for this sink are written as bblog_entry_header plus data to
+ * the given file descriptor at its current position.
+ * @param fd file descriptor to write to
+ * @param start_time start time of the log, entry times are stored relative
+ * to this time
+ * @return sink index to pass to enqueue()
+ */
+unsigned int
+BBLogWriterThread::add_sink(int fd, const fawkes::Time &start_time)
+{
+	Sink *s            = new Sink();
+	s->fd              = fd;
+	s->start_time      = start_time;
+	s->container       = NULL;
+	s->container_index = 0;
+	s->num_written     = 0;
+	s->needs_sync      = false;
+	s->removed         = false;
+
+	MutexLocker lock(&reserve_mutex_);
+	sinks_.push_back(std::unique_ptr<Sink>(s));
+	return sinks_.size() - 1;
+}
+
+/** Add container sink.
+ * Entries for this sink are appended to the given container.
+ * @param container container writer to append to
+ * @param container_index interface index within the container
+ * @return sink index to pass to enqueue()
+ */
+unsigned int
+BBLogWriterThread::add_sink(BBLogContainerWriter *container, unsigned int container_index)
+{
+	Sink *s            = new Sink();
+	s->fd              = -1;
+	s->container       = container;
+	s->container_index = container_index;
+	s->num_written     = 0;
+	s->needs_sync      = false;
+	s->removed         = false;
+
+	MutexLocker lock(&reserve_mutex_);
+	sinks_.push_back(std::unique_ptr<Sink>(s));
+	return sinks_.size() - 1;
+}
+
+/** Remove sink.
+ * Writes all entries queued so far and syncs them to disk. Entries
+ * enqueued for the sink afterwards are dropped. This must be called
+ * before the file descriptor or container of the sink is closed.
+ * @param sink sink index as returned by add_sink()
+ */
+void
+BBLogWriterThread::remove_sink(unsigned int sink)
+{
+	MutexLocker lock(&write_mutex_);
+	drain();
+
+	reserve_mutex_.lock();
+	if (sink >= sinks_.size()) {
+		reserve_mutex_.unlock();
+		return;
+	}
+	Sink *s    = sinks_[sink].get();
+	s->removed = true;
+	reserve_mutex_.unlock();
+
+	if (s->needs_sync) {
+		if (fdatasync(s->fd) != 0) {
+			logger->log_warn(name(), "Failed to sync data: %s", strerror(errno));
+		}
+		s->needs_sync = false;
+	}
+	s->fd        = -1;
+	s->container = NULL;
+}
+
+/** Get maximum size of data per entry.
+ * @return maximum size of data that can be passed to enqueue()
+ */
+size_t
+BBLogWriterThread::max_data_size() const
+{
+	return cfg_slot_size_;
+}
+
+/** Enqueue an entry.
+ * This copies the data into a slot of the ring buffer. It never waits for
+ * I/O, if no slot is available the entry is dropped.
+ * @param sink sink index as returned by add_sink()
+ * @param time upon return set to the time of the entry. The time is taken
+ * from the clock the time is associated with, if any, while reserving the
+ * slot, entries are therefore written in the order of their time.
+ * @param data data to write
+ * @param size size of data, must not exceed max_data_size()
+ * @return true if the entry has been enqueued, false if it was dropped
+ */
+bool
+BBLogWriterThread::enqueue(unsigned int  sink,
+                           fawkes::Time &time,
+                           const void *  data,
+                           size_t        size)
+{
+	if (size > cfg_slot_size_) {
+		num_dropped_ += 1;
+		return false;
+	}
+
+	reserve_mutex_.lock();
+	if ((sink >= sinks_.size()) || sinks_[sink]->removed
+	    || (head_ - tail_.load() >= cfg_ring_size_)) {
+		reserve_mutex_.unlock();
+		num_dropped_ += 1;
+		return false;
+	}
+	uint64_t pos = head_++;
+	Sink *   s   = sinks_[sink].get();
+	time.stamp();
+	reserve_mutex_.unlock();
+
+	unsigned int slot_idx = pos % cfg_ring_size_;
+	char *       slot     = ring_ + slot_idx * slot_stride_;
+
+	long sec, usec;
+	time.get_timestamp(sec, usec);
+	bblog_slot_meta *meta = (bblog_slot_meta *)slot;
+	meta->sink            = sink;
+	meta->size            = size;
+	meta->time_sec        = sec;
+	meta->time_usec       = usec;
+
+	if (!s->container) {
+		Time d = time - s->start_time;
+		d.get_timestamp(sec, usec);
+		bblog_entry_header *ehead = (bblog_entry_header *)(slot + sizeof(bblog_slot_meta));
+		ehead->rel_time_sec       = sec;
+		ehead->rel_time_usec      = usec;
+	}
+	memcpy(slot + SLOT_HEADER_SIZE, data, size);
+
+	ready_[slot_idx].store(true, std::memory_order_release);
+	return true;
+}
+
+/** Write all queued entries.
+ * This is done periodically by the thread, but may also be called from
+ * another thread to make sure all entries enqueued so far have been
+ * written, for example before updating a file header.
+ */
+void
+BBLogWriterThread::flush()
+{
+	MutexLocker lock(&write_mutex_);
+	drain();
+}
+
+/** Write all entries from the ring buffer.
+ * Must be called with the write mutex locked.
+ */
+void
+BBLogWriterThread::drain()
+{
+	uint64_t tail = tail_.load();
+	while (true) {
+		uint64_t start = tail;
+		while ((tail - start < cfg_ring_size_)
+		       && ready_[tail % cfg_ring_size_].load(std::memory_order_acquire)) {
+			++tail;
+		}
+		if (tail == start)
+			break;
+
+		// sinks are only removed with the write mutex held, the removed
+		// flag cannot change while we write
+		std::vector<Sink *> sinks;
+		reserve_mutex_.lock();
+		for (unsigned int i = 0; i < sinks_.size(); ++i) {
+			sinks.push_back(sinks_[i].get());
+		}
+		reserve_mutex_.unlock();
+		if (sink_iov_.size() < sinks.size()) {
+			sink_iov_.resize(sinks.size());
+		}
+
+		for (uint64_t p = start; p != tail; ++p) {
+			char *           slot = ring_ + (p % cfg_ring_size_) * slot_stride_;
+			bblog_slot_meta *meta = (bblog_slot_meta *)slot;
+			Sink *           s    = sinks[meta->sink];
+			if (s->removed) {
+				// enqueued while the sink was being removed
+				num_dropped_ += 1;
+			} else if (s->container) {
+				try {
+					s->container->append(s->container_index,
+					                     Time(meta->time_sec, meta->time_usec),
+					                     slot + SLOT_HEADER_SIZE);
+					s->num_written += 1;
+				} catch (Exception &e) {
+					logger->log_warn(name(), "Failed to append to container");
+					logger->log_warn(name(), e);
+				}
+			} else {
+				struct iovec iov;
+				iov.iov_base = slot + sizeof(bblog_slot_meta);
+				iov.iov_len  = sizeof(bblog_entry_header) + meta->size;
+				sink_iov_[meta->sink].push_back(iov);
+			}
+		}
+
+		for (unsigned int i = 0; i < sink_iov_.size(); ++i) {
+			if (!sink_iov_[i].empty()) {
+				write_iov(sinks[i], sink_iov_[i]);
+				sink_iov_[i].clear();
+			}
+		}
+		num_batches_ += 1;
+
+		// release slots before publishing the new tail
+		for (uint64_t p = start; p != tail; ++p) {
+			ready_[p % cfg_ring_size_].store(false, std::memory_order_relaxed);
+		}
+		tail_.store(tail, std::memory_order_release);
+	}
+
+	if (cfg_fsync_interval_ > 0.) {
+		Time now;
+		if ((now - last_sync_).in_sec() >= cfg_fsync_interval_) {
+			sync();
+		}
+	}
+}
+
+/** Write a batch of entries to a file sink.
+ * Must be called with the write mutex locked.
+ * @param sink sink to write to
+ * @param iov entries to write, modified on partial writes
+ */
+void
+BBLogWriterThread::write_iov(Sink *sink, std::vector<struct iovec> &iov)
+{
+	Time start;
+
+	size_t i = 0;
+	while (i < iov.size()) {
+		int     count   = std::min(iov.size() - i, (size_t)IOV_MAX);
+		ssize_t written = writev(sink->fd, &iov[i], count);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			logger->log_warn(name(), "Failed to write %zu entries: %s", iov.size() - i, strerror(errno));
+			break;
+		}
+		// skip completely written entries, adjust partially written one
+		while ((written > 0) && (i < iov.size())) {
+			if ((size_t)written >= iov[i].iov_len) {
+				written -= iov[i].iov_len;
+				++i;
+				sink->num_written += 1;
+			} else {
+				iov[i].iov_base = (char *)iov[i].iov_base + written;
+				iov[i].iov_len -= written;
+				written = 0;
+			}
+		}
+	}
+	sink->needs_sync = true;
+
+	Time   end;
+	double latency = (end - start).in_sec();
+	total_write_latency_ += latency;
+	max_write_latency_ = std::max(max_write_latency_, latency);
+	num_writes_ += 1;
+}
+
+/** Sync written data of all file sinks to disk.
+ * Must be called with the write mutex locked.
+ */
+void
+BBLogWriterThread::sync()
+{
+	std::vector<Sink *> sinks;
+	reserve_mutex_.lock();
+	for (unsigned int i = 0; i < sinks_.size(); ++i) {
+		sinks.push_back(sinks_[i].get());
+	}
+	reserve_mutex_.unlock();
+
+	for (Sink *s : sinks) {
+		if (s->needs_sync && !s->removed) {
+			if (fdatasync(s->fd) != 0) {
+				logger->log_warn(name(), "Failed to sync data: %s", strerror(errno));
+			}
+			s->needs_sync = false;
+		}
+	}
+	last_sync_.stamp();
+}
+
+/** Get number of written entries.
+ * @param sink sink index
+ * @return number of entries written to the given sink
+ */
+uint64_t
+BBLogWriterThread::num_written(unsigned int sink)
+{
+	MutexLocker lock(&reserve_mutex_);
+	return sinks_[sink]->num_written.load();
+}
+
+/** Get number of dropped entries.
+ * @return number of entries dropped because the ring buffer was full
+ */
+uint64_t
+BBLogWriterThread::num_dropped() const
+{
+	return num_dropped_.load();
+}
+
+/** Get number of group commits.
+ * @return number of batches written
+ */
+uint64_t
+BBLogWriterThread::num_batches() const
+{
+	return num_batches_;
+}
+
+/** Get average write latency.
+ * @return average duration of a batched write in seconds
+ */
+float
+BBLogWriterThread::avg_write_latency() const
+{
+	return (num_writes_ > 0) ? total_write_latency_ / num_writes_ : 0.;
+}
+
+/** Get maximum write latency.
+ * @return maximum duration of a batched write in seconds
+ */
+float
+BBLogWriterThread::max_write_latency() const
+{
+	return max_write_latency_;
+}
@@ -0,0 +1,118 @@
+
+/***************************************************************************
+ *  writer_thread.h - BB Logger background writer thread
+ *
+ *  Created: Sat Oct 17 14:05:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_BBLOGGER_WRITER_THREAD_H_
+#define _PLUGINS_BBLOGGER_WRITER_THREAD_H_
+
+#include <aspect/logging.h>
+#include <core/threading/mutex.h>
+#include <core/threading/thread.h>
+#include <sys/uio.h>
+#include <utils/time/time.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class BBLogContainerWriter;
+
+class BBLogWriterThread : public fawkes::Thread, public fawkes::LoggingAspect
+{
+public:
+	BBLogWriterThread(unsigned int ring_size,
+	                  size_t       slot_size,
+	                  float        commit_interval,
+	                  float        fsync_interval);
+	virtual ~BBLogWriterThread();
+
+	virtual void init();
+	virtual void finalize();
+	virtual void loop();
+
+	unsigned int add_sink(int fd, const fawkes::Time &start_time);
+	unsigned int add_sink(BBLogContainerWriter *container, unsigned int container_index);
+	void         remove_sink(unsigned int sink);
+
+	size_t   max_data_size() const;
+	bool     enqueue(unsigned int sink, fawkes::Time &time, const void *data, size_t size);
+	void     flush();
+	uint64_t num_written(unsigned int sink);
+
+	uint64_t num_dropped() const;
+	uint64_t num_batches() const;
+	float    avg_write_latency() const;
+	float    max_write_latency() const;
+
+	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
+protected:
+	virtual void
+	run()
+	{
+		Thread::run();
+	}
+
+private:
+	/// @cond INTERNAL
+	typedef struct
+	{
+		int                   fd;
+		fawkes::Time          start_time;
+		BBLogContainerWriter *container;
+		unsigned int          container_index;
+		std::atomic<uint64_t> num_written;
+		bool                  needs_sync;
+		bool                  removed;
+	} Sink;
+	/// @endcond
+
+	void drain();
+	void write_iov(Sink *sink, std::vector<struct iovec> &iov);
+	void sync();
+
+private:
+	unsigned int cfg_ring_size_;
+	size_t       cfg_slot_size_;
+	float        cfg_commit_interval_;
+	float        cfg_fsync_interval_;
+
+	std::vector<std::unique_ptr<Sink>> sinks_;
+
+	size_t                               slot_stride_;
+	char *                               ring_;
+	std::unique_ptr<std::atomic<bool>[]> ready_;
+	fawkes::Mutex                        reserve_mutex_;
+	uint64_t                             head_;
+	std::atomic<uint64_t>                tail_;
+
+	fawkes::Mutex                          write_mutex_;
+	std::vector<std::vector<struct iovec>> sink_iov_;
+	fawkes::Time                           last_sync_;
+
+	std::atomic<uint64_t> num_dropped_;
+	uint64_t              last_num_dropped_;
+	uint64_t              num_batches_;
+	double                total_write_latency_;
+	double                max_write_latency_;
+	uint64_t              num_writes_;
+};
+
+#endif
@@ -32,6 +32,15 @@
 
 using namespace fawkes;
 
+/// @cond INTERNAL
+/** Result of a query handed to CLIPS as cursor. */
+struct QueryResultCursor
+{
+	QueryCache::DocumentsPtr documents; ///< documents of the query result
+	size_t                   next;      ///< index of the next document to return
+};
+/// @endcond
+
 /** @class ClipsRobotMemoryThread 'clips_robot_memory_thread.h' 
  * CLIPS feature to access the robot memory.
  * MongoDB access through CLIPS first appeared in the RCLL referee box.
@@ -572,11 +581,10 @@ ClipsRobotMemoryThread::clips_robotmemory_query_sort(std::string collection,
 			find_opts.sort(bs->view());
 		}
 
-		auto cursor = robot_memory->query(b->view(), collection, find_opts);
-		//std::unique_ptr<mongocxx::cursor> c = new mongocxx::cursor(std::move(cursor));
-		return CLIPS::Value(new std::unique_ptr<mongocxx::cursor>(
-		                      new mongocxx::cursor(std::move(cursor))),
-		                    CLIPS::TYPE_EXTERNAL_ADDRESS);
+		QueryResultCursor *cursor = new QueryResultCursor();
+		cursor->documents         = robot_memory->query_cached(b->view(), collection, find_opts);
+		cursor->next              = 0;
+		return CLIPS::Value(cursor, CLIPS::TYPE_EXTERNAL_ADDRESS);
 	} catch (std::system_error &e) {
 		logger->log_warn("MongoDB", "Query failed: %s", e.what());
 		return CLIPS::Value("FALSE", CLIPS::TYPE_SYMBOL);
@@ -603,8 +611,8 @@ ClipsRobotMemoryThread::clips_robotmemory_query(const std::string &collection, v
 void
 ClipsRobotMemoryThread::clips_robotmemory_cursor_destroy(void *cursor)
 {
-	auto c = static_cast<std::unique_ptr<mongocxx::cursor> *>(cursor);
-	if (!c || !c->get()) {
+	auto c = static_cast<QueryResultCursor *>(cursor);
+	if (!c) {
 		logger->log_error("MongoDB", "mongodb-cursor-destroy: got invalid cursor");
 		return;
 	}
@@ -622,26 +630,19 @@ ClipsRobotMemoryThread::clips_robotmemory_cursor_more(void *cursor)
 CLIPS::Value
 ClipsRobotMemoryThread::clips_robotmemory_cursor_next(void *cursor)
 {
-	auto c = static_cast<std::unique_ptr<mongocxx::cursor> *>(cursor);
+	auto c = static_cast<QueryResultCursor *>(cursor);
 
-	if (!c || !c->get()) {
+	if (!c || !c->documents) {
 		logger->log_error("MongoDB", "mongodb-cursor-next: got invalid cursor");
 		return CLIPS::Value("FALSE", CLIPS::TYPE_SYMBOL);
 	}
 
-	try {
-		auto it = (*c)->begin();
-		if (it == (*c)->end()) {
-			return CLIPS::Value("FALSE", CLIPS::TYPE_SYMBOL);
-		} else {
-			auto b = new bsoncxx::builder::basic::document();
-			b->append(bsoncxx::builder::concatenate(*it));
-			it++;
-			return CLIPS::Value(b);
-		}
-	} catch (std::system_error &e) {
-		logger->log_error("MongoDB", "mongodb-cursor-next: got invalid query: %s", e.what());
+	if (c->next >= c->documents->size()) {
 		return CLIPS::Value("FALSE", CLIPS::TYPE_SYMBOL);
+	} else {
+		auto b = new bsoncxx::builder::basic::document();
+		b->append(bsoncxx::builder::concatenate((*c->documents)[c->next++].view()));
+		return CLIPS::Value(b);
 	}
 }
 
@@ -32,6 +32,8 @@
 #include <utils/time/time.h>
 
 #include <clipsmm.h>
+#include <cmath>
+#include <limits>
 
 using namespace fawkes;
 
@@ -179,6 +181,7 @@ BlackboardCLIPSFeature::clips_context_destroyed(const std::string &env_name)
 		}
 		interfaces_.erase(env_name);
 	}
+	templates_.erase(env_name);
 	envs_.erase(env_name);
 }
 
@@ -495,70 +498,181 @@ BlackboardCLIPSFeature::clips_blackboard_read(const std::string &env_name)
 	fawkes::MutexLocker lock(envs_[env_name].objmutex_ptr());
 	CLIPS::Environment &env = **(envs_[env_name]);
 	for (auto &iface_map : interfaces_[env_name].reading) {
-		for (auto i : iface_map.second) {
-			i->read();
-			if (i->changed()) {
-				if (!cfg_retract_early_) {
-					std::string fun = std::string("(") + i->type() + "-cleanup-late \"" + i->id() + "\")";
-					env.evaluate(fun);
+		// only changed interfaces are copied and returned
+		for (auto i : blackboard_->read_changed(iface_map.second)) {
+			if (!cfg_retract_early_) {
+				std::string fun = std::string("(") + i->type() + "-cleanup-late \"" + i->id() + "\")";
+				env.evaluate(fun);
+			}
+			if (!clips_assert_interface_fact(env_name, env, i)) {
+				clips_assert_interface_fact_string(env, i);
+			}
+		}
+	}
+}
+
+/** Convert a single interface field value to a CLIPS value.
+ * The conversion matches the slot types of the deftemplate created in
+ * clips_assert_interface_type(). Infinite and NaN values are mapped to
+ * the same substitutes as when reading the value from a string.
+ * @param f field iterator pointing to the field to convert
+ * @param index index of the value for array fields
+ * @return CLIPS value
+ */
+CLIPS::Value
+BlackboardCLIPSFeature::field_value(const InterfaceFieldIterator &f, unsigned int index)
+{
+	switch (f.get_type()) {
+	case IFT_BOOL: return CLIPS::Value(f.get_bool(index) ? "TRUE" : "FALSE", CLIPS::TYPE_SYMBOL);
+	case IFT_INT8: return CLIPS::Value((long long int)f.get_int8(index));
+	case IFT_UINT8: return CLIPS::Value((long long int)f.get_uint8(index));
+	case IFT_INT16: return CLIPS::Value((long long int)f.get_int16(index));
+	case IFT_UINT16: return CLIPS::Value((long long int)f.get_uint16(index));
+	case IFT_INT32: return CLIPS::Value((long long int)f.get_int32(index));
+	case IFT_UINT32: return CLIPS::Value((long long int)f.get_uint32(index));
+	case IFT_INT64: return CLIPS::Value((long long int)f.get_int64(index));
+	case IFT_UINT64: return CLIPS::Value((long long int)f.get_uint64(index));
+	case IFT_BYTE: return CLIPS::Value((long long int)f.get_byte(index));
+	case IFT_FLOAT:
+	case IFT_DOUBLE: {
+		double v = (f.get_type() == IFT_FLOAT) ? f.get_float(index) : f.get_double(index);
+		if (std::isinf(v)) {
+			v = std::signbit(v) ? std::numeric_limits<double>::min() : std::numeric_limits<double>::max();
+		} else if (std::isnan(v)) {
+			v = std::signbit(v) ? std::numeric_limits<double>::min() + 1
+			                    : std::numeric_limits<double>::max() - 1;
+		}
+		return CLIPS::Value(v);
+	}
+	case IFT_STRING: return CLIPS::Value(f.get_string(), CLIPS::TYPE_STRING);
+	case IFT_ENUM: return CLIPS::Value(f.get_enum_string(index), CLIPS::TYPE_SYMBOL);
+	}
+	return CLIPS::Value(CLIPS::TYPE_SYMBOL);
+}
+
+/** Assert a fact for an interface by setting the slots directly.
+ * The fact is created from the deftemplate of the interface type and the
+ * slots are filled from the typed field values. This avoids building a
+ * string representation which CLIPS would have to parse again. The
+ * template and slot names are cached per environment and interface type.
+ * @param env_name name of the environment
+ * @param env environment to assert the fact in, must be locked
+ * @param iface interface to assert the fact for
+ * @return true if the fact has been asserted, false if the template
+ * could not be found and the string-based variant must be used
+ */
+bool
+BlackboardCLIPSFeature::clips_assert_interface_fact(const std::string & env_name,
+                                                    CLIPS::Environment &env,
+                                                    Interface *         iface)
+{
+	std::map<std::string, FactTemplate> &env_templates = templates_[env_name];
+
+	auto t = env_templates.find(iface->type());
+	if (t == env_templates.end()) {
+		FactTemplate ft;
+		ft.tmpl = env.get_template(iface->type());
+		if (!ft.tmpl)
+			return false;
+		InterfaceFieldIterator f, f_end = iface->fields_end();
+		for (f = iface->fields(); f != f_end; ++f) {
+			ft.slots.push_back(f.get_name());
+		}
+		t = env_templates.insert(std::make_pair(std::string(iface->type()), ft)).first;
+	}
+	FactTemplate &ft = t->second;
+
+	CLIPS::Fact::pointer fact = CLIPS::Fact::create(env, ft.tmpl);
+	fact->set_slot("id", CLIPS::Value(iface->id(), CLIPS::TYPE_STRING));
+
+	const Time *  ts = iface->timestamp();
+	CLIPS::Values time(2, CLIPS::Value(CLIPS::TYPE_INTEGER));
+	time[0] = ts->get_sec();
+	time[1] = ts->get_usec();
+	fact->set_slot("time", time);
+
+	InterfaceFieldIterator f, f_end = iface->fields_end();
+	unsigned int           slot = 0;
+	for (f = iface->fields(); f != f_end; ++f, ++slot) {
+		if (f.get_length() > 1 && f.get_type() != IFT_STRING) {
+			CLIPS::Values values;
+			values.reserve(f.get_length());
+			for (unsigned int j = 0; j < f.get_length(); ++j) {
+				values.push_back(field_value(f, j));
+			}
+			fact->set_slot(ft.slots[slot], values);
+		} else {
+			fact->set_slot(ft.slots[slot], field_value(f, 0));
+		}
+	}
+
+	if (!env.assert_fact(fact)) {
+		logger_->log_warn(("BBCLIPS|" + env_name).c_str(),
+		                  "Failed to assert fact for %s",
+		                  iface->uid());
+	}
+	return true;
+}
+
+/** Assert a fact for an interface from its string representation.
+ * This is used if the deftemplate of the interface type is not available.
+ * @param env environment to assert the fact in, must be locked
+ * @param iface interface to assert the fact for
+ */
+void
+BlackboardCLIPSFeature::clips_assert_interface_fact_string(CLIPS::Environment &env,
+                                                           Interface *         iface)
+{
+	const Time *t = iface->timestamp();
+
+	std::string fact = std::string("(") + iface->type() + " (id \"" + iface->id() + "\")" + " (time "
+	                   + StringConversions::to_string(t->get_sec()) + " "
+	                   + StringConversions::to_string(t->get_usec()) + ")";
+
+	InterfaceFieldIterator f, f_end = iface->fields_end();
+	for (f = iface->fields(); f != f_end; ++f) {
+		std::string value;
+		if (f.get_type() == IFT_STRING) {
+			value                      = f.get_value_string();
+			std::string::size_type pos = 0;
+			while ((pos = value.find("\"", pos)) != std::string::npos) {
+				value.replace(pos, 1, "\\\"");
+				pos += 2;
+			}
+			value = std::string("\"") + value + "\"";
+		} else {
+			f.append_value_string(value, " ");
+
+			if (f.get_type() == IFT_FLOAT || f.get_type() == IFT_DOUBLE) {
+				std::string::size_type pos;
+				while ((pos = value.find("-inf")) != std::string::npos) {
+					value = value.replace(pos, 4, std::to_string(std::numeric_limits<double>::min()));
 				}
-				const Time *t = i->timestamp();
-
-				std::string fact = std::string("(") + i->type() + " (id \"" + i->id() + "\")" + " (time "
-				                   + StringConversions::to_string(t->get_sec()) + " "
-				                   + StringConversions::to_string(t->get_usec()) + ")";
-
-				InterfaceFieldIterator f, f_end = i->fields_end();
-				for (f = i->fields(); f != f_end; ++f) {
-					std::string value;
-					if (f.get_type() == IFT_STRING) {
-						value                      = f.get_value_string();
-						std::string::size_type pos = 0;
-						while ((pos = value.find("\"", pos)) != std::string::npos) {
-							value.replace(pos, 1, "\\\"");
-							pos += 2;
-						}
-						value = std::string("\"") + value + "\"";
-					} else {
-						value = f.get_value_string();
-						std::string::size_type pos;
-						while ((pos = value.find(",")) != std::string::npos) {
-							value = value.erase(pos, 1);
-						}
-
-						if (f.get_type() == IFT_FLOAT || f.get_type() == IFT_DOUBLE) {
-							std::string::size_type pos;
-							while ((pos = value.find("-inf")) != std::string::npos) {
-								value = value.replace(pos, 4, std::to_string(std::numeric_limits<double>::min()));
-							}
-							while ((pos = value.find("inf")) != std::string::npos) {
-								value = value.replace(pos, 3, std::to_string(std::numeric_limits<double>::max()));
-							}
-							while ((pos = value.find("-nan")) != std::string::npos) {
-								value =
-								  value.replace(pos, 4, std::to_string(std::numeric_limits<double>::min() + 1));
-							}
-							while ((pos = value.find("nan")) != std::string::npos) {
-								value =
-								  value.replace(pos, 3, std::to_string(std::numeric_limits<double>::max() - 1));
-							}
-						} else if (f.get_type() == IFT_BOOL) {
-							std::string::size_type pos;
-							while ((pos = value.find("false")) != std::string::npos) {
-								value = value.replace(pos, 5, "FALSE");
-							}
-							while ((pos = value.find("true")) != std::string::npos) {
-								value = value.replace(pos, 4, "TRUE");
-							}
-						}
-					}
-					fact += std::string(" (") + f.get_name() + " " + value + ")";
+				while ((pos = value.find("inf")) != std::string::npos) {
+					value = value.replace(pos, 3, std::to_string(std::numeric_limits<double>::max()));
+				}
+				while ((pos = value.find("-nan")) != std::string::npos) {
+					value =
+					  value.replace(pos, 4, std::to_string(std::numeric_limits<double>::min() + 1));
+				}
+				while ((pos = value.find("nan")) != std::string::npos) {
+					value =
+					  value.replace(pos, 3, std::to_string(std::numeric_limits<double>::max() - 1));
+				}
+			} else if (f.get_type() == IFT_BOOL) {
+				std::string::size_type pos;
+				while ((pos = value.find("false")) != std::string::npos) {
+					value = value.replace(pos, 5, "FALSE");
+				}
+				while ((pos = value.find("true")) != std::string::npos) {
+					value = value.replace(pos, 4, "TRUE");
 				}
-				fact += ")";
-				env.assert_fact(fact);
 			}
 		}
+		fact += std::string(" (") + f.get_name() + " " + value + ")";
 	}
+	fact += ")";
+	env.assert_fact(fact);
 }
 
 void
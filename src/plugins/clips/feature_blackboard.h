@@ -23,12 +23,14 @@
 #ifndef _PLUGINS_CLIPS_FEATURE_BLACKBOARD_H_
 #define _PLUGINS_CLIPS_FEATURE_BLACKBOARD_H_
 
+#include <clipsmm/template.h>
 #include <clipsmm/value.h>
 #include <plugins/clips/aspect/clips_feature.h>
 
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace CLIPS {
 class Environment;
@@ -71,6 +73,16 @@ private: // members
 	//which created message belongs to which interface
 	std::map<fawkes::Message *, fawkes::Interface *> interface_of_msg_;
 
+	/// @cond INTERNAL
+	typedef struct
+	{
+		CLIPS::Template::pointer tmpl;
+		std::vector<std::string> slots;
+	} FactTemplate;
+	/// @endcond
+	// per environment and interface type
+	std::map<std::string, std::map<std::string, FactTemplate>> templates_;
+
 private: // methods
 	void clips_blackboard_open_interface(const std::string &env_name,
 	                                     const std::string &type,
@@ -86,6 +98,10 @@ private: // methods
 	                                      const std::string &type,
 	                                      const std::string &id);
 	void clips_blackboard_read(const std::string &env_name);
+	bool clips_assert_interface_fact(const std::string &env_name,
+	                                 CLIPS::Environment &env,
+	                                 fawkes::Interface * iface);
+	void clips_assert_interface_fact_string(CLIPS::Environment &env, fawkes::Interface *iface);
 	void clips_blackboard_write(const std::string &env_name, const std::string &uid);
 
 	void          clips_blackboard_enable_time_read(const std::string &env_name);
@@ -130,6 +146,7 @@ private: // methods
 	                    const std::string &            env_name,
 	                    const std::string &            field,
 	                    CLIPS::Values                  values);
+	static CLIPS::Value field_value(const fawkes::InterfaceFieldIterator &f, unsigned int index);
 };
 
 #endif
@@ -0,0 +1,181 @@
+/***************************************************************************
+ *  metrics_registry.cpp - Lock-free metrics aggregated on retrieval
+ *
+ *  Created: Sat Oct 17 23:48:12 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <core/threading/mutex_locker.h>
+#include <plugins/metrics/aspect/metrics_registry.h>
+
+namespace fawkes {
+
+/** @class MetricsRegistry <plugins/metrics/aspect/metrics_registry.h>
+ * Registry of lock-free metrics.
+ * Threads create counters, gauges, and histograms once, e.g., during
+ * init(), and then update them from hot paths without locking or memory
+ * allocation. Metric families are only created when metrics are retrieved.
+ * The metrics are kept in a MetricSet, the registry either owns one or
+ * exports an existing one, such as the core metrics of MetricSet::core().
+ * The registry is a metrics supplier and can be passed to the
+ * MetricsAspect:
+ * @code
+ * class MyThread : public Thread, public MetricsAspect
+ * {
+ *  public:
+ *   MyThread() : Thread("MyThread"), MetricsAspect(&metrics_registry_) {}
+ *   ...
+ *  private:
+ *   MetricsRegistry metrics_registry_;
+ * };
+ * @endcode
+ * Metrics are never removed, pointers returned remain valid for the
+ * lifetime of the registry.
+ * @author agent
+ */
+
+/** Constructor.
+ * Creates a registry with its own set of metrics.
+ */
+MetricsRegistry::MetricsRegistry() : set_(&own_set_)
+{
+}
+
+/** Constructor to export an existing set of metrics.
+ * @param set metric set to export, e.g., MetricSet::core(), must remain
+ * valid for the lifetime of the registry
+ */
+MetricsRegistry::MetricsRegistry(MetricSet *set) : set_(set)
+{
+}
+
+/** Destructor. */
+MetricsRegistry::~MetricsRegistry()
+{
+}
+
+/** Get counter.
+ * @param name name of the metric family
+ * @param help help string of the metric family
+ * @param labels labels of the counter
+ * @return counter, an existing one if name and labels match
+ * @exception Exception thrown if a non-counter metric of that name exists
+ */
+MetricCounter *
+MetricsRegistry::counter(const std::string &name, const std::string &help, const Labels &labels)
+{
+	return set_->counter(name, help, labels);
+}
+
+/** Get gauge.
+ * @param name name of the metric family
+ * @param help help string of the metric family
+ * @param labels labels of the gauge
+ * @return gauge, an existing one if name and labels match
+ * @exception Exception thrown if a non-gauge metric of that name exists
+ */
+MetricGauge *
+MetricsRegistry::gauge(const std::string &name, const std::string &help, const Labels &labels)
+{
+	return set_->gauge(name, help, labels);
+}
+
+/** Get histogram.
+ * @param name name of the metric family
+ * @param help help string of the metric family
+ * @param upper_bounds upper bounds of the exported buckets in the
+ * exported unit, ignored if the histogram exists
+ * @param labels labels of the histogram
+ * @param scale factor to convert recorded values to the exported unit,
+ * the default records nanoseconds and exports seconds
+ * @return histogram, an existing one if name and labels match
+ * @exception Exception thrown if a non-histogram metric of that name exists
+ */
+MetricHistogram *
+MetricsRegistry::histogram(const std::string &        name,
+                           const std::string &        help,
+                           const std::vector<double> &upper_bounds,
+                           const Labels &             labels,
+                           double                     scale)
+{
+	return set_->histogram(name, help, upper_bounds, labels, scale);
+}
+
+/// @cond INTERNALS
+static void
+add_labels(io::prometheus::client::Metric *m, const MetricsRegistry::Labels &labels)
+{
+	for (const auto &l : labels) {
+		io::prometheus::client::LabelPair *lp = m->add_label();
+		lp->set_name(l.first);
+		lp->set_value(l.second);
+	}
+}
+/// @endcond
+
+std::list<io::prometheus::client::MetricFamily>
+MetricsRegistry::metrics()
+{
+	std::list<io::prometheus::client::MetricFamily> rv;
+	std::vector<uint64_t>                           counts;
+
+	MutexLocker lock(set_->mutex());
+	for (const auto &fp : set_->families()) {
+		const MetricSet::Family &f = fp.second;
+
+		io::prometheus::client::MetricFamily mf;
+		mf.set_name(fp.first);
+		mf.set_help(f.help);
+		switch (f.type) {
+		case MetricSet::COUNTER: mf.set_type(io::prometheus::client::COUNTER); break;
+		case MetricSet::GAUGE: mf.set_type(io::prometheus::client::GAUGE); break;
+		case MetricSet::HISTOGRAM: mf.set_type(io::prometheus::client::HISTOGRAM); break;
+		}
+
+		for (const auto &c : f.counters) {
+			io::prometheus::client::Metric *m = mf.add_metric();
+			add_labels(m, c.first);
+			m->mutable_counter()->set_value(c.second.value());
+		}
+		for (const auto &g : f.gauges) {
+			io::prometheus::client::Metric *m = mf.add_metric();
+			add_labels(m, g.first);
+			m->mutable_gauge()->set_value(g.second.value());
+		}
+		for (const auto &h : f.histograms) {
+			io::prometheus::client::Metric *m = mf.add_metric();
+			add_labels(m, h.first);
+			io::prometheus::client::Histogram *ph = m->mutable_histogram();
+			h.second.cumulative_counts(counts);
+			const std::vector<double> &upper_bounds = h.second.upper_bounds();
+			for (size_t i = 0; i < upper_bounds.size(); ++i) {
+				io::prometheus::client::Bucket *b = ph->add_bucket();
+				b->set_cumulative_count(counts[i]);
+				b->set_upper_bound(upper_bounds[i]);
+			}
+			// take the count from the buckets to stay consistent with them
+			ph->set_sample_count(counts.back());
+			ph->set_sample_sum(h.second.sum());
+		}
+
+		rv.push_back(std::move(mf));
+	}
+
+	return rv;
+}
+
+} // end namespace fawkes
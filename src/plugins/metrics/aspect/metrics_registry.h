@@ -0,0 +1,66 @@
+/***************************************************************************
+ *  metrics_registry.h - Lock-free metrics aggregated on retrieval
+ *
+ *  Created: Sat Oct 17 23:48:12 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _PLUGINS_METRICS_ASPECT_METRICS_REGISTRY_H_
+#define _PLUGINS_METRICS_ASPECT_METRICS_REGISTRY_H_
+
+#include <core/utils/metrics.h>
+#include <plugins/metrics/aspect/metrics_supplier.h>
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+
+class MetricsRegistry : public MetricsSupplier
+{
+public:
+	/** Label names mapped to values. */
+	typedef MetricSet::Labels Labels;
+
+	MetricsRegistry();
+	explicit MetricsRegistry(MetricSet *set);
+	virtual ~MetricsRegistry();
+
+	MetricCounter *counter(const std::string &name,
+	                       const std::string &help,
+	                       const Labels &     labels = Labels());
+	MetricGauge *  gauge(const std::string &name,
+	                     const std::string &help,
+	                     const Labels &     labels = Labels());
+
+	MetricHistogram *histogram(const std::string &        name,
+	                           const std::string &        help,
+	                           const std::vector<double> &upper_bounds,
+	                           const Labels &             labels = Labels(),
+	                           double                     scale  = 1e-9);
+
+	virtual std::list<io::prometheus::client::MetricFamily> metrics();
+
+private:
+	MetricSet  own_set_;
+	MetricSet *set_;
+};
+
+} // end namespace fawkes
+
+#endif
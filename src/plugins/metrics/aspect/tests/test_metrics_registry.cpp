@@ -0,0 +1,85 @@
+/***************************************************************************
+ *  test_metrics_registry.cpp - MetricsRegistry Unit Test
+ *
+ *  Created: Sat Oct 17 14:05:12 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include <gtest/gtest.h>
+#include <plugins/metrics/aspect/metrics_registry.h>
+
+#include <limits>
+#include <memory>
+
+using namespace fawkes;
+
+TEST(MetricHistogramTest, SmallValuesExact)
+{
+	for (uint64_t v = 0; v < MetricHistogram::SUB_BUCKETS; ++v) {
+		ASSERT_EQ(v, MetricHistogram::bucket(v));
+		ASSERT_EQ(v, MetricHistogram::bucket_max(v));
+	}
+}
+
+TEST(MetricHistogramTest, BucketBoundaries)
+{
+	for (unsigned int b = 0; b < MetricHistogram::NUM_BUCKETS - 1; ++b) {
+		uint64_t max = MetricHistogram::bucket_max(b);
+		ASSERT_EQ(b, MetricHistogram::bucket(max)) << "upper boundary of bucket " << b;
+		ASSERT_EQ(b + 1, MetricHistogram::bucket(max + 1)) << "lower boundary of bucket " << b + 1;
+	}
+}
+
+TEST(MetricHistogramTest, RelativeError)
+{
+	for (uint64_t v = 1; v < (1ull << 30); v = v * 3 / 2 + 1) {
+		uint64_t max = MetricHistogram::bucket_max(MetricHistogram::bucket(v));
+		ASSERT_GE(max, v);
+		ASSERT_LE(max - v, v / MetricHistogram::SUB_BUCKETS) << "value " << v;
+	}
+}
+
+TEST(MetricHistogramTest, Overflow)
+{
+	const uint64_t limit = 1ull << (MetricHistogram::MAX_MSB + 1);
+	ASSERT_EQ(MetricHistogram::NUM_BUCKETS - 2, MetricHistogram::bucket(limit - 1));
+	ASSERT_EQ(MetricHistogram::NUM_BUCKETS - 1, MetricHistogram::bucket(limit));
+	ASSERT_EQ(MetricHistogram::NUM_BUCKETS - 1,
+	          MetricHistogram::bucket(std::numeric_limits<uint64_t>::max()));
+	ASSERT_EQ(std::numeric_limits<uint64_t>::max(),
+	          MetricHistogram::bucket_max(MetricHistogram::NUM_BUCKETS - 1));
+}
+
+TEST(MetricHistogramTest, CumulativeCounts)
+{
+	// bounds in seconds, values in nanoseconds, bounds on internal bucket edges
+	std::unique_ptr<MetricHistogram> h(new MetricHistogram({1.024e-6, 1.024e-3}, 1e-9));
+
+	h->observe(1023);
+	h->observe(1024);
+	h->observe(500000);
+	h->observe(2000000000);
+
+	std::vector<uint64_t> counts;
+	h->cumulative_counts(counts);
+	ASSERT_EQ(3u, counts.size());
+	EXPECT_EQ(1u, counts[0]);
+	EXPECT_EQ(3u, counts[1]);
+	EXPECT_EQ(4u, counts[2]);
+	EXPECT_EQ(4u, h->count());
+	EXPECT_DOUBLE_EQ(2000502047 * 1e-9, h->sum());
+}
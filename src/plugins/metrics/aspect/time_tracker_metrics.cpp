@@ -0,0 +1,105 @@
+/***************************************************************************
+ *  time_tracker_metrics.cpp - Export TimeTracker summaries as metrics
+ *
+ *  Created: Sun Oct 18 16:41:09 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <core/threading/mutex_locker.h>
+#include <plugins/metrics/aspect/time_tracker_metrics.h>
+#include <utils/time/tracker.h>
+
+namespace fawkes {
+
+/** @class TimeTrackerMetricsSupplier <plugins/metrics/aspect/time_tracker_metrics.h>
+ * Metrics supplier for the classes of all named time trackers.
+ * Each class of a tracker which has been given a name with
+ * TimeTracker::set_name() is exported as a summary with the count and
+ * sum of durations and the 50th, 90th, and 99th percentile since the
+ * last reset of the tracker, and a gauge of the maximum duration. The
+ * metrics are labeled with the name of the tracker and of the class.
+ * @author agent
+ */
+
+/** Constructor. */
+TimeTrackerMetricsSupplier::TimeTrackerMetricsSupplier()
+{
+}
+
+/** Destructor. */
+TimeTrackerMetricsSupplier::~TimeTrackerMetricsSupplier()
+{
+}
+
+std::list<io::prometheus::client::MetricFamily>
+TimeTrackerMetricsSupplier::metrics()
+{
+	static const double quantiles[] = {0.5, 0.9, 0.99};
+
+	io::prometheus::client::MetricFamily mf_durations;
+	mf_durations.set_name("fawkes_timetracker_duration_seconds");
+	mf_durations.set_help("Durations recorded by a time tracker class");
+	mf_durations.set_type(io::prometheus::client::SUMMARY);
+
+	io::prometheus::client::MetricFamily mf_max;
+	mf_max.set_name("fawkes_timetracker_duration_max_seconds");
+	mf_max.set_help("Maximum duration recorded by a time tracker class");
+	mf_max.set_type(io::prometheus::client::GAUGE);
+
+	LockMap<TimeTracker *, std::string> &trackers = TimeTracker::named_trackers();
+	MutexLocker                          lock(trackers.mutex());
+	for (auto &t : trackers) {
+		TimeTracker *tracker     = t.first;
+		unsigned int num_classes = tracker->num_classes();
+		for (unsigned int c = 0; c < num_classes; ++c) {
+			std::string cls = tracker->class_name(c);
+			if (cls.empty())
+				continue;
+
+			TimeTracker::Summary summary;
+			tracker->summary(c, summary);
+
+			io::prometheus::client::Metric *m = mf_durations.add_metric();
+			io::prometheus::client::Metric *g = mf_max.add_metric();
+			for (io::prometheus::client::Metric *metric : {m, g}) {
+				io::prometheus::client::LabelPair *lp = metric->add_label();
+				lp->set_name("tracker");
+				lp->set_value(t.second);
+				lp = metric->add_label();
+				lp->set_name("class");
+				lp->set_value(cls);
+			}
+
+			io::prometheus::client::Summary *s = m->mutable_summary();
+			s->set_sample_count(summary.count);
+			s->set_sample_sum(summary.sum);
+			for (double q : quantiles) {
+				io::prometheus::client::Quantile *pq = s->add_quantile();
+				pq->set_quantile(q);
+				pq->set_value(tracker->quantile(c, q));
+			}
+			g->mutable_gauge()->set_value(summary.max);
+		}
+	}
+
+	std::list<io::prometheus::client::MetricFamily> rv;
+	rv.push_back(std::move(mf_durations));
+	rv.push_back(std::move(mf_max));
+	return rv;
+}
+
+} // end namespace fawkes
@@ -0,0 +1,40 @@
+/***************************************************************************
+ *  time_tracker_metrics.h - Export TimeTracker summaries as metrics
+ *
+ *  Created: Sun Oct 18 16:41:09 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _PLUGINS_METRICS_ASPECT_TIME_TRACKER_METRICS_H_
+#define _PLUGINS_METRICS_ASPECT_TIME_TRACKER_METRICS_H_
+
+#include <plugins/metrics/aspect/metrics_supplier.h>
+
+namespace fawkes {
+
+class TimeTrackerMetricsSupplier : public MetricsSupplier
+{
+public:
+	TimeTrackerMetricsSupplier();
+	virtual ~TimeTrackerMetricsSupplier();
+
+	virtual std::list<io::prometheus::client::MetricFamily> metrics();
+};
+
+} // end namespace fawkes
+
+#endif
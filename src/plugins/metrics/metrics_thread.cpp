@@ -21,18 +21,24 @@
 #include "metrics_thread.h"
 
 #include "metrics_processor.h"
+#include "thread_metrics.h"
 
 #include <core/threading/mutex_locker.h>
+#include <interface/interface_info.h>
 #include <interfaces/MetricCounterInterface.h>
 #include <interfaces/MetricGaugeInterface.h>
 #include <interfaces/MetricHistogramInterface.h>
 #include <interfaces/MetricUntypedInterface.h>
+#include <interfaces/ThreadMetricsInterface.h>
 #include <utils/misc/string_split.h>
 #include <webview/url_manager.h>
 
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <map>
 
 using namespace fawkes;
 
@@ -41,6 +47,16 @@ using namespace fawkes;
 
 /** @class MetricsThread "metrics_thread.h"
  * Thread to export metrics for Prometheus.
+ * Besides the metrics of suppliers and metrics provided via the
+ * blackboard, the thread exports internal metrics about metrics retrieval,
+ * the time between main loop iterations as observed by this thread, and
+ * the number of blackboard interfaces, readers and writers. The values are
+ * kept in a lock-free MetricsRegistry and only aggregated on retrieval.
+ * The metrics recorded by the core libraries in MetricSet::core(), such
+ * as the runtime of main loop hooks and blackboard operations, are
+ * exported as well.
+ * Per-thread resource usage is additionally written periodically to one
+ * ThreadMetricsInterface per thread.
  * @author Tim Niemueller
  */
 
@@ -49,7 +65,8 @@ MetricsThread::MetricsThread()
 : Thread("MetricsThread", Thread::OPMODE_WAITFORWAKEUP),
   BlockedTimingAspect(BlockedTimingAspect::WAKEUP_HOOK_POST_LOOP),
   AspectProviderAspect(&metrics_aspect_inifin_),
-  BlackBoardInterfaceListener("MetricsThread")
+  BlackBoardInterfaceListener("MetricsThread"),
+  core_metrics_(&MetricSet::core())
 {
 }
 
@@ -63,7 +80,62 @@ MetricsThread::init()
 {
 	metrics_aspect_inifin_.set_manager(this);
 
-	bbio_add_observed_create("MetricFamilyInterface", "*");
+	im_loop_count_ =
+	  internal_metrics_.counter("fawkes_loop_count", "Number of Fawkes main loop iterations");
+	im_metrics_requests_ =
+	  internal_metrics_.counter("fawkes_metrics_requests", "Number of requests for metrics");
+	im_bb_interfaces_created_ =
+	  internal_metrics_.counter("fawkes_blackboard_interfaces_created",
+	                            "Number of interfaces created on the blackboard");
+	im_bb_interfaces_destroyed_ =
+	  internal_metrics_.counter("fawkes_blackboard_interfaces_destroyed",
+	                            "Number of interfaces destroyed on the blackboard");
+	im_bb_interfaces_ =
+	  internal_metrics_.gauge("fawkes_blackboard_interfaces", "Number of blackboard interfaces");
+	im_bb_readers_ = internal_metrics_.gauge("fawkes_blackboard_readers",
+	                                         "Number of readers of all blackboard interfaces");
+	im_bb_writers_ = internal_metrics_.gauge("fawkes_blackboard_writers",
+	                                         "Number of writers of all blackboard interfaces");
+
+	im_loop_time_ = NULL;
+	try {
+		std::vector<float> buckets_le = config->get_floats("/metrics/internal/loop_time/buckets");
+		if (!buckets_le.empty()) {
+			im_loop_time_ = internal_metrics_.histogram("fawkes_loop_time",
+			                                            "Time between main loop iterations",
+			                                            std::vector<double>(buckets_le.begin(),
+			                                                                buckets_le.end()));
+		}
+	} catch (Exception &e) {
+		logger->log_warn(name(), "Internal metric loop_time bucket bounds not configured, disabling");
+	}
+
+	im_metrics_proctime_ = NULL;
+	try {
+		std::vector<float> buckets_le =
+		  config->get_floats("/metrics/internal/metrics_requests/buckets");
+		if (!buckets_le.empty()) {
+			im_metrics_proctime_ = internal_metrics_.histogram("fawkes_metrics_proctime",
+			                                                   "Time required to process metrics",
+			                                                   std::vector<double>(buckets_le.begin(),
+			                                                                       buckets_le.end()));
+		}
+	} catch (Exception &e) {
+		logger->log_warn(name(),
+		                 "Internal metric metrics_proctime bucket bounds not configured, disabling");
+	}
+
+	last_loop_ = std::chrono::steady_clock::time_point();
+
+	thread_metrics_interval_ = 1.0;
+	try {
+		thread_metrics_interval_ = config->get_float(CFG_PREFIX "thread-metrics/blackboard-interval");
+	} catch (Exception &e) {
+	} // ignored, use default
+	last_thread_metrics_ = std::chrono::steady_clock::time_point();
+
+	bbio_add_observed_create("*", "*");
+	bbio_add_observed_destroy("*", "*");
 	blackboard->register_observer(this);
 
 	MutexLocker                        lock(metric_bbs_.mutex());
@@ -85,45 +157,13 @@ MetricsThread::init()
 
 	lock.unlock();
 
-	imf_loop_count_ = std::make_shared<io::prometheus::client::MetricFamily>();
-	imf_loop_count_->set_name("fawkes_loop_count");
-	imf_loop_count_->set_help("Number of Fawkes main loop iterations");
-	imf_loop_count_->set_type(io::prometheus::client::COUNTER);
-	imf_loop_count_->add_metric();
-	internal_metrics_.push_back(imf_loop_count_);
-
-	imf_metrics_requests_ = std::make_shared<io::prometheus::client::MetricFamily>();
-	imf_metrics_requests_->set_name("fawkes_metrics_requests");
-	imf_metrics_requests_->set_help("Number of requests for metrics");
-	imf_metrics_requests_->set_type(io::prometheus::client::COUNTER);
-	imf_metrics_requests_->add_metric();
-	internal_metrics_.push_back(imf_metrics_requests_);
-
-	try {
-		std::vector<float> buckets_le =
-		  config->get_floats("/metrics/internal/metrics_requests/buckets");
-
-		if (!buckets_le.empty()) {
-			std::sort(buckets_le.begin(), buckets_le.end());
-
-			imf_metrics_proctime_ = std::make_shared<io::prometheus::client::MetricFamily>();
-			imf_metrics_proctime_->set_name("fawkes_metrics_proctime");
-			imf_metrics_proctime_->set_help("Time required to process metrics");
-			imf_metrics_proctime_->set_type(io::prometheus::client::HISTOGRAM);
-			auto m = imf_metrics_proctime_->add_metric();
-			auto h = m->mutable_histogram();
-			for (float &b : buckets_le) {
-				h->add_bucket()->set_upper_bound(b);
-			}
-			internal_metrics_.push_back(imf_metrics_proctime_);
-		}
-	} catch (Exception &e) {
-		logger->log_warn(name(),
-		                 "Internal metric metrics_proctime bucket bounds not configured, disabling");
-	}
-
 	metrics_suppliers_.push_back(this);
 
+	thread_metrics_ = new ThreadMetricsSupplier(syncpoint_manager);
+	metrics_suppliers_.push_back(thread_metrics_);
+	metrics_suppliers_.push_back(&time_tracker_metrics_);
+	metrics_suppliers_.push_back(&core_metrics_);
+
 	req_proc_ = new MetricsRequestProcessor(this, logger, URL_PREFIX);
 	webview_url_manager->add_handler(WebRequest::METHOD_GET,
 	                                 URL_PREFIX,
@@ -137,18 +177,98 @@ MetricsThread::finalize()
 {
 	webview_url_manager->remove_handler(WebRequest::METHOD_GET, URL_PREFIX);
 	delete req_proc_;
+
+	remove_supplier(&core_metrics_);
+	remove_supplier(&time_tracker_metrics_);
+	remove_supplier(thread_metrics_);
+	close_thread_metrics_interfaces();
+	delete thread_metrics_;
 }
 
 void
 MetricsThread::loop()
 {
-	imf_loop_count_->mutable_metric(0)->mutable_counter()->set_value(
-	  imf_loop_count_->metric(0).counter().value() + 1);
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (im_loop_time_ && last_loop_ != std::chrono::steady_clock::time_point()) {
+		im_loop_time_->observe(now - last_loop_);
+	}
+	last_loop_ = now;
+	im_loop_count_->inc();
+
+	if (thread_metrics_interval_ > 0.
+	    && now - last_thread_metrics_
+	         >= std::chrono::duration<float>(thread_metrics_interval_)) {
+		last_thread_metrics_ = now;
+		update_thread_metrics_interfaces();
+	}
+}
+
+void
+MetricsThread::update_thread_metrics_interfaces()
+{
+	std::list<ThreadMetricsSupplier::ThreadStats> stats = thread_metrics_->thread_stats();
+
+	// close interfaces of threads which have exited
+	for (auto i = thread_metrics_ifs_.begin(); i != thread_metrics_ifs_.end();) {
+		auto s = std::find_if(stats.begin(), stats.end(), [&i](const auto &ts) {
+			return ts.tid == i->first;
+		});
+		if (s == stats.end()) {
+			blackboard->close(i->second);
+			i = thread_metrics_ifs_.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	uint64_t           bb_lock_contentions = Interface::lock_contentions();
+	double             bb_lock_wait        = Interface::lock_wait_time();
+
+	for (const auto &ts : stats) {
+		ThreadMetricsInterface *tmi;
+		auto                    i = thread_metrics_ifs_.find(ts.tid);
+		if (i == thread_metrics_ifs_.end()) {
+			std::string id = "Thread Metrics/" + ts.tid;
+			try {
+				tmi = blackboard->open_for_writing<ThreadMetricsInterface>(id.c_str());
+			} catch (Exception &e) {
+				logger->log_warn(name(), "Failed to open %s: %s", id.c_str(), e.what_no_backtrace());
+				continue;
+			}
+			tmi->set_thread_name(ts.name.c_str());
+			tmi->set_tid(atoi(ts.tid.c_str()));
+			thread_metrics_ifs_[ts.tid] = tmi;
+		} else {
+			tmi = i->second;
+		}
+
+		tmi->set_cpu_user(ts.cpu_user);
+		tmi->set_cpu_system(ts.cpu_system);
+		tmi->set_voluntary_context_switches(ts.voluntary_context_switches);
+		tmi->set_involuntary_context_switches(ts.involuntary_context_switches);
+		tmi->set_runqueue_wait(ts.runqueue_wait);
+		tmi->set_bb_lock_contentions(bb_lock_contentions);
+		tmi->set_bb_lock_wait(bb_lock_wait);
+		tmi->write();
+	}
+}
+
+void
+MetricsThread::close_thread_metrics_interfaces()
+{
+	for (auto &i : thread_metrics_ifs_) {
+		blackboard->close(i.second);
+	}
+	thread_metrics_ifs_.clear();
 }
 
 void
 MetricsThread::bb_interface_created(const char *type, const char *id) throw()
 {
+	im_bb_interfaces_created_->inc();
+	if (strcmp(type, "MetricFamilyInterface") != 0)
+		return;
+
 	MutexLocker            lock(metric_bbs_.mutex());
 	MetricFamilyInterface *mfi;
 	try {
@@ -182,14 +302,18 @@ MetricsThread::bb_interface_created(const char *type, const char *id) throw()
 	metric_bbs_[id] = mfbb;
 }
 
+void
+MetricsThread::bb_interface_destroyed(const char *type, const char *id) throw()
+{
+	im_bb_interfaces_destroyed_->inc();
+}
+
 std::list<io::prometheus::client::MetricFamily>
 MetricsThread::metrics()
 {
-	std::chrono::high_resolution_clock::time_point proc_start =
-	  std::chrono::high_resolution_clock::now();
+	std::chrono::steady_clock::time_point proc_start = std::chrono::steady_clock::now();
 
-	imf_metrics_requests_->mutable_metric(0)->mutable_counter()->set_value(
-	  imf_metrics_requests_->metric(0).counter().value() + 1);
+	im_metrics_requests_->inc();
 
 	std::list<io::prometheus::client::MetricFamily> rv;
 
@@ -257,27 +381,29 @@ MetricsThread::metrics()
 		rv.push_back(std::move(mf));
 	}
 
-	if (imf_metrics_proctime_) {
-		std::chrono::high_resolution_clock::time_point proc_end =
-		  std::chrono::high_resolution_clock::now();
-		const std::chrono::duration<double> proc_diff = proc_end - proc_start;
-		for (int i = 0; i < imf_metrics_proctime_->metric(0).histogram().bucket_size(); ++i) {
-			io::prometheus::client::Histogram *h =
-			  imf_metrics_proctime_->mutable_metric(0)->mutable_histogram();
-			if (proc_diff.count() < h->bucket(i).upper_bound()) {
-				io::prometheus::client::Bucket *b = h->mutable_bucket(i);
-				b->set_cumulative_count(b->cumulative_count() + 1);
-				h->set_sample_count(h->sample_count() + 1);
-				h->set_sample_sum(h->sample_sum() + proc_diff.count());
-				break;
-			}
+	lock.unlock();
+
+	try {
+		InterfaceInfoList *iil     = blackboard->list_all();
+		unsigned int       readers = 0, writers = 0;
+		for (const auto &ii : *iil) {
+			readers += ii.num_readers();
+			writers += ii.has_writer() ? 1 : 0;
 		}
+		im_bb_interfaces_->set(iil->size());
+		im_bb_readers_->set(readers);
+		im_bb_writers_->set(writers);
+		delete iil;
+	} catch (Exception &e) {
+		logger->log_warn(name(), "Failed to list blackboard interfaces: %s", e.what_no_backtrace());
 	}
 
-	for (auto &im : internal_metrics_) {
-		rv.push_back(std::move(*im));
+	if (im_metrics_proctime_) {
+		im_metrics_proctime_->observe(std::chrono::steady_clock::now() - proc_start);
 	}
 
+	rv.splice(rv.end(), internal_metrics_.metrics());
+
 	return rv;
 }
 
@@ -285,9 +411,25 @@ std::list<io::prometheus::client::MetricFamily>
 MetricsThread::all_metrics()
 {
 	std::list<io::prometheus::client::MetricFamily> metrics;
+	// families by name, suppliers may export metrics of the same family,
+	// e.g., with different labels, but a family must appear only once
+	std::map<std::string, io::prometheus::client::MetricFamily *> families;
 
+	MutexLocker lock(metrics_suppliers_.mutex());
 	for (auto &s : metrics_suppliers_) {
-		metrics.splice(metrics.begin(), std::move(s->metrics()));
+		for (auto &mf : s->metrics()) {
+			auto f = families.find(mf.name());
+			if (f == families.end()) {
+				metrics.push_back(std::move(mf));
+				families[metrics.back().name()] = &metrics.back();
+			} else if (f->second->type() == mf.type()) {
+				f->second->mutable_metric()->MergeFrom(mf.metric());
+			} else {
+				logger->log_warn(name(),
+				                 "Dropping metric family %s, type differs from earlier family",
+				                 mf.name().c_str());
+			}
+		}
 	}
 
 	return metrics;
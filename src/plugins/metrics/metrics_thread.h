@@ -22,13 +22,16 @@
 #define _PLUGINS_METRICS_METRICS_THREAD_H_
 
 #include "aspect/metrics_inifin.h"
+#include "aspect/metrics_registry.h"
 #include "aspect/metrics_supplier.h"
+#include "aspect/time_tracker_metrics.h"
 
 #include <aspect/aspect_provider.h>
 #include <aspect/blackboard.h>
 #include <aspect/blocked_timing.h>
 #include <aspect/configurable.h>
 #include <aspect/logging.h>
+#include <aspect/syncpoint_manager.h>
 #include <aspect/webview.h>
 #include <blackboard/interface_listener.h>
 #include <blackboard/interface_observer.h>
@@ -36,15 +39,18 @@
 #include <core/utils/lock_map.h>
 #include <interfaces/MetricFamilyInterface.h>
 
-#include <memory>
+#include <chrono>
+#include <map>
 
 class MetricsRequestProcessor;
+class ThreadMetricsSupplier;
 
 namespace fawkes {
 class MetricCounterInterface;
 class MetricGaugeInterface;
 class MetricUntypedInterface;
 class MetricHistogramInterface;
+class ThreadMetricsInterface;
 //MetricSummaryInterface;
 } // namespace fawkes
 
@@ -62,6 +68,7 @@ class MetricsThread : public fawkes::Thread,
                       public fawkes::BlackBoardAspect,
                       public fawkes::WebviewAspect,
                       public fawkes::BlockedTimingAspect,
+                      public fawkes::SyncPointManagerAspect,
                       public fawkes::AspectProviderAspect,
                       public fawkes::BlackBoardInterfaceObserver,
                       public fawkes::BlackBoardInterfaceListener,
@@ -103,6 +110,7 @@ private:
 private:
 	// for BlackBoardInterfaceObserver
 	virtual void bb_interface_created(const char *type, const char *id) throw();
+	virtual void bb_interface_destroyed(const char *type, const char *id) throw();
 
 	// for BlackBoardInterfaceListener
 	virtual void bb_interface_writer_removed(fawkes::Interface *interface,
@@ -125,19 +133,35 @@ private:
 	bool conditional_open(const std::string &id, MetricFamilyBB &mfbb);
 	void conditional_close(fawkes::Interface *interface) throw();
 	void parse_labels(const std::string &labels, io::prometheus::client::Metric *m);
+	void update_thread_metrics_interfaces();
+	void close_thread_metrics_interfaces();
 
 private:
 	MetricsRequestProcessor *                    req_proc_;
+	ThreadMetricsSupplier *                      thread_metrics_;
+	fawkes::TimeTrackerMetricsSupplier           time_tracker_metrics_;
+	fawkes::MetricsRegistry                      core_metrics_;
+
+	std::map<std::string, fawkes::ThreadMetricsInterface *> thread_metrics_ifs_;
+	float                                                   thread_metrics_interval_;
+	std::chrono::steady_clock::time_point                   last_thread_metrics_;
 	fawkes::LockMap<std::string, MetricFamilyBB> metric_bbs_;
 
 	fawkes::MetricsAspectIniFin metrics_aspect_inifin_;
 
-	// Internal metric families
-	std::shared_ptr<io::prometheus::client::MetricFamily> imf_loop_count_;
-	std::shared_ptr<io::prometheus::client::MetricFamily> imf_metrics_requests_;
-	std::shared_ptr<io::prometheus::client::MetricFamily> imf_metrics_proctime_;
-
-	std::vector<std::shared_ptr<io::prometheus::client::MetricFamily>> internal_metrics_;
+	// Internal metrics
+	fawkes::MetricsRegistry  internal_metrics_;
+	fawkes::MetricCounter *  im_loop_count_;
+	fawkes::MetricHistogram *im_loop_time_;
+	fawkes::MetricCounter *  im_metrics_requests_;
+	fawkes::MetricHistogram *im_metrics_proctime_;
+	fawkes::MetricCounter *  im_bb_interfaces_created_;
+	fawkes::MetricCounter *  im_bb_interfaces_destroyed_;
+	fawkes::MetricGauge *    im_bb_interfaces_;
+	fawkes::MetricGauge *    im_bb_readers_;
+	fawkes::MetricGauge *    im_bb_writers_;
+
+	std::chrono::steady_clock::time_point last_loop_;
 
 	fawkes::LockList<MetricsSupplier *> metrics_suppliers_;
 };
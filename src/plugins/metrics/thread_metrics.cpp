@@ -0,0 +1,299 @@
+/***************************************************************************
+ *  thread_metrics.cpp - Per-thread CPU and contention metrics
+ *
+ *  Created: Sun Oct 18 00:21:37 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "thread_metrics.h"
+
+#include <interface/interface.h>
+#include <syncpoint/syncpoint.h>
+#include <syncpoint/syncpoint_manager.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+using namespace fawkes;
+using namespace io::prometheus::client;
+
+/// @cond INTERNALS
+namespace {
+
+MetricFamily &
+add_family(std::list<MetricFamily> &metrics,
+           const char *             name,
+           const char *             help,
+           MetricType               type)
+{
+	metrics.emplace_back();
+	MetricFamily &mf = metrics.back();
+	mf.set_name(name);
+	mf.set_help(help);
+	mf.set_type(type);
+	return mf;
+}
+
+Metric *
+add_metric(MetricFamily &mf, const std::vector<std::pair<const char *, std::string>> &labels)
+{
+	Metric *m = mf.add_metric();
+	for (const auto &l : labels) {
+		LabelPair *lp = m->add_label();
+		lp->set_name(l.first);
+		lp->set_value(l.second);
+	}
+	return m;
+}
+
+bool
+read_line(const std::string &path, std::string &line)
+{
+	std::ifstream f(path);
+	return static_cast<bool>(std::getline(f, line));
+}
+
+} // namespace
+/// @endcond
+
+/** @class ThreadMetricsSupplier "thread_metrics.h"
+ * Supplier of per-thread CPU and contention metrics.
+ * All values are read when metrics are retrieved, there is no overhead
+ * for the observed threads. Per-thread values are taken from
+ * /proc/self/task and labeled with the thread name (as set by Fawkes,
+ * truncated to 15 characters by the kernel) and the thread ID:
+ * - CPU time in user and system mode
+ * - voluntary context switches, i.e., the thread blocked, for example
+ *   on a lock or syncpoint, and involuntary ones, i.e., the thread was
+ *   preempted
+ * - time the thread was ready to run but waited for a CPU, if the kernel
+ *   provides scheduler statistics
+ *
+ * Time spent blocked on syncpoints is derived from the recent wait calls
+ * recorded by each syncpoint, waiting for blackboard interface data locks
+ * is accounted by the interfaces of this process.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param syncpoint_manager syncpoint manager to get wait times from,
+ * may be NULL to omit syncpoint metrics
+ */
+ThreadMetricsSupplier::ThreadMetricsSupplier(SyncPointManager *syncpoint_manager)
+: syncpoint_manager_(syncpoint_manager), task_dir_("/proc/self/task")
+{
+	long ticks   = sysconf(_SC_CLK_TCK);
+	clock_ticks_ = (ticks > 0) ? (double)ticks : 100.;
+}
+
+/** Destructor. */
+ThreadMetricsSupplier::~ThreadMetricsSupplier()
+{
+}
+
+std::list<MetricFamily>
+ThreadMetricsSupplier::metrics()
+{
+	std::list<MetricFamily> rv;
+	add_thread_metrics(rv);
+	add_syncpoint_metrics(rv);
+	add_blackboard_metrics(rv);
+	return rv;
+}
+
+/** Read resource usage of all threads of this process.
+ * Threads which exit while reading are omitted.
+ * @return resource usage of each thread, values which the kernel does
+ * not provide are flagged as invalid
+ */
+std::list<ThreadMetricsSupplier::ThreadStats>
+ThreadMetricsSupplier::thread_stats() const
+{
+	std::list<ThreadStats> rv;
+
+	DIR *dir = opendir(task_dir_.c_str());
+	if (!dir)
+		return rv;
+
+	struct dirent *de;
+	while ((de = readdir(dir)) != NULL) {
+		if (de->d_name[0] < '0' || de->d_name[0] > '9')
+			continue;
+
+		ThreadStats ts = {};
+		ts.tid           = de->d_name;
+		std::string path = task_dir_ + "/" + ts.tid;
+		if (!read_line(path + "/comm", ts.name)) {
+			// thread has exited meanwhile
+			continue;
+		}
+
+		std::string stat;
+		if (read_line(path + "/stat", stat)) {
+			// the name may contain spaces or parentheses, fields start after the last ')'
+			std::string::size_type p = stat.rfind(')');
+			if (p != std::string::npos) {
+				std::istringstream       ss(stat.substr(p + 1));
+				std::vector<std::string> fields;
+				std::string              field;
+				while (fields.size() < 13 && ss >> field)
+					fields.push_back(field);
+				// fields[0] is field 3 (state), utime is field 14, stime field 15
+				if (fields.size() == 13) {
+					ts.has_cpu    = true;
+					ts.cpu_user   = strtoull(fields[11].c_str(), NULL, 10) / clock_ticks_;
+					ts.cpu_system = strtoull(fields[12].c_str(), NULL, 10) / clock_ticks_;
+				}
+			}
+		}
+
+		std::ifstream status(path + "/status");
+		std::string   line;
+		while (std::getline(status, line)) {
+			unsigned long long *count = NULL;
+			if (line.compare(0, 24, "voluntary_ctxt_switches:") == 0) {
+				count = &ts.voluntary_context_switches;
+			} else if (line.compare(0, 27, "nonvoluntary_ctxt_switches:") == 0) {
+				count = &ts.involuntary_context_switches;
+			} else {
+				continue;
+			}
+			ts.has_context_switches = true;
+			*count                  = strtoull(line.c_str() + line.find(':') + 1, NULL, 10);
+		}
+
+		std::string schedstat;
+		if (read_line(path + "/schedstat", schedstat)) {
+			// on-CPU time, run queue wait time (both in ns), number of time slices
+			std::istringstream ss(schedstat);
+			unsigned long long runtime_ns, wait_ns;
+			if (ss >> runtime_ns >> wait_ns) {
+				ts.has_runqueue_wait = true;
+				ts.runqueue_wait     = wait_ns / 1e9;
+			}
+		}
+
+		rv.push_back(ts);
+	}
+	closedir(dir);
+
+	return rv;
+}
+
+void
+ThreadMetricsSupplier::add_thread_metrics(std::list<MetricFamily> &metrics)
+{
+	MetricFamily &mf_cpu = add_family(metrics,
+	                                  "fawkes_thread_cpu_seconds",
+	                                  "CPU time consumed by a thread",
+	                                  COUNTER);
+	MetricFamily &mf_ctxsw = add_family(metrics,
+	                                    "fawkes_thread_context_switches",
+	                                    "Context switches of a thread",
+	                                    COUNTER);
+	MetricFamily &mf_runq = add_family(metrics,
+	                                   "fawkes_thread_runqueue_wait_seconds",
+	                                   "Time a thread was runnable but waited for a CPU",
+	                                   COUNTER);
+
+	for (const ThreadStats &ts : thread_stats()) {
+		if (ts.has_cpu) {
+			add_metric(mf_cpu, {{"thread", ts.name}, {"tid", ts.tid}, {"mode", "user"}})
+			  ->mutable_counter()
+			  ->set_value(ts.cpu_user);
+			add_metric(mf_cpu, {{"thread", ts.name}, {"tid", ts.tid}, {"mode", "system"}})
+			  ->mutable_counter()
+			  ->set_value(ts.cpu_system);
+		}
+		if (ts.has_context_switches) {
+			add_metric(mf_ctxsw, {{"thread", ts.name}, {"tid", ts.tid}, {"type", "voluntary"}})
+			  ->mutable_counter()
+			  ->set_value(ts.voluntary_context_switches);
+			add_metric(mf_ctxsw, {{"thread", ts.name}, {"tid", ts.tid}, {"type", "involuntary"}})
+			  ->mutable_counter()
+			  ->set_value(ts.involuntary_context_switches);
+		}
+		if (ts.has_runqueue_wait) {
+			add_metric(mf_runq, {{"thread", ts.name}, {"tid", ts.tid}})
+			  ->mutable_counter()
+			  ->set_value(ts.runqueue_wait);
+		}
+	}
+}
+
+void
+ThreadMetricsSupplier::add_syncpoint_metrics(std::list<MetricFamily> &metrics)
+{
+	if (!syncpoint_manager_)
+		return;
+
+	MetricFamily &mf_mean = add_family(metrics,
+	                                   "fawkes_syncpoint_wait_mean_seconds",
+	                                   "Mean wait time of recent calls waiting for a syncpoint",
+	                                   GAUGE);
+	MetricFamily &mf_max = add_family(metrics,
+	                                  "fawkes_syncpoint_wait_max_seconds",
+	                                  "Maximum wait time of recent calls waiting for a syncpoint",
+	                                  GAUGE);
+
+	const std::pair<SyncPoint::WakeupType, const char *> types[] = {
+	  {SyncPoint::WAIT_FOR_ONE, "one"}, {SyncPoint::WAIT_FOR_ALL, "all"}};
+
+	for (const RefPtr<SyncPoint> &sp : syncpoint_manager_->get_syncpoints()) {
+		for (const auto &t : types) {
+			CircularBuffer<SyncPointCall> calls = sp->get_wait_calls(t.first);
+			if (calls.size() == 0)
+				continue;
+
+			double sum = 0., max = 0.;
+			for (const SyncPointCall &c : calls) {
+				double wait = c.get_wait_time().in_sec();
+				sum += wait;
+				max = std::max(max, wait);
+			}
+			add_metric(mf_mean, {{"syncpoint", sp->get_identifier()}, {"wakeup", t.second}})
+			  ->mutable_gauge()
+			  ->set_value(sum / calls.size());
+			add_metric(mf_max, {{"syncpoint", sp->get_identifier()}, {"wakeup", t.second}})
+			  ->mutable_gauge()
+			  ->set_value(max);
+		}
+	}
+}
+
+void
+ThreadMetricsSupplier::add_blackboard_metrics(std::list<MetricFamily> &metrics)
+{
+	add_family(metrics,
+	           "fawkes_blackboard_lock_contentions",
+	           "Number of times reading or writing an interface waited for its lock",
+	           COUNTER)
+	  .add_metric()
+	  ->mutable_counter()
+	  ->set_value(Interface::lock_contentions());
+	add_family(metrics,
+	           "fawkes_blackboard_lock_wait_seconds",
+	           "Time spent waiting for interface locks when reading or writing",
+	           COUNTER)
+	  .add_metric()
+	  ->mutable_counter()
+	  ->set_value(Interface::lock_wait_time());
+}
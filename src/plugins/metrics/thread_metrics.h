@@ -0,0 +1,69 @@
+/***************************************************************************
+ *  thread_metrics.h - Per-thread CPU and contention metrics
+ *
+ *  Created: Sun Oct 18 00:21:37 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_METRICS_THREAD_METRICS_H_
+#define _PLUGINS_METRICS_THREAD_METRICS_H_
+
+#include "aspect/metrics_supplier.h"
+
+#include <list>
+#include <string>
+
+namespace fawkes {
+class SyncPointManager;
+}
+
+class ThreadMetricsSupplier : public fawkes::MetricsSupplier
+{
+public:
+	explicit ThreadMetricsSupplier(fawkes::SyncPointManager *syncpoint_manager);
+	virtual ~ThreadMetricsSupplier();
+
+	virtual std::list<io::prometheus::client::MetricFamily> metrics();
+
+	/** Resource usage of a single thread. */
+	typedef struct
+	{
+		std::string        name;                         /**< thread name */
+		std::string        tid;                          /**< kernel thread ID */
+		bool               has_cpu;                      /**< CPU times are valid */
+		double             cpu_user;                     /**< user mode CPU time in sec */
+		double             cpu_system;                   /**< system mode CPU time in sec */
+		bool               has_context_switches;         /**< context switches are valid */
+		unsigned long long voluntary_context_switches;   /**< voluntary context switches */
+		unsigned long long involuntary_context_switches; /**< involuntary context switches */
+		bool               has_runqueue_wait;            /**< run queue wait time is valid */
+		double             runqueue_wait;                /**< run queue wait time in sec */
+	} ThreadStats;
+
+	std::list<ThreadStats> thread_stats() const;
+
+private:
+	void add_thread_metrics(std::list<io::prometheus::client::MetricFamily> &metrics);
+	void add_syncpoint_metrics(std::list<io::prometheus::client::MetricFamily> &metrics);
+	void add_blackboard_metrics(std::list<io::prometheus::client::MetricFamily> &metrics);
+
+private:
+	fawkes::SyncPointManager *syncpoint_manager_;
+	double                    clock_ticks_;
+	std::string               task_dir_;
+};
+
+#endif
@@ -0,0 +1,168 @@
+
+/***************************************************************************
+ *  interface_serializer.cpp - Serialize interface data to BSON
+ *
+ *  Created: Sat Oct 17 18:02:31 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <interface/field_iterator.h>
+#include <plugins/mongodb/aspect/interface_serializer.h>
+
+#include <cstring>
+
+using namespace bsoncxx::builder;
+
+namespace fawkes {
+
+/** @class InterfaceBsonSerializer <plugins/mongodb/aspect/interface_serializer.h>
+ * Serialize interface data to BSON.
+ * Walking the fields with an InterfaceFieldIterator means deciding on the
+ * field type and creating the key string for every field on every write.
+ * This serializer does this once when it is created. It records name,
+ * type, length and offset into the data chunk of each field together with
+ * a function to append the field's value. Appending is then a walk over
+ * this list reading values directly from the data chunk.
+ *
+ * The serializer can be used for any interface of the same type and
+ * hash, use compatible() to check. Unsigned 32 and 64 bit integers are
+ * stored as 64 bit integers, arrays (except strings) as BSON arrays.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param interface interface to create the serializer for
+ * @param enums_as_strings true to store enum values as their string
+ * representation, false to store them as integers
+ */
+InterfaceBsonSerializer::InterfaceBsonSerializer(Interface *interface, bool enums_as_strings)
+{
+	type_      = interface->type();
+	data_size_ = interface->datasize();
+	memcpy(hash_, interface->hash(), INTERFACE_HASH_SIZE_);
+
+	const char *data = (const char *)interface->datachunk();
+
+	for (InterfaceFieldIterator i = interface->fields(); i != interface->fields_end(); ++i) {
+		FieldInfo f;
+		f.name     = i.get_name();
+		f.type     = i.get_type();
+		f.length   = i.get_length();
+		f.offset   = (const char *)i.get_value() - data;
+		f.enumtype = i.is_enum() ? i.get_typename() : NULL;
+
+		switch (f.type) {
+		case IFT_BOOL: f.append = append_value<bool, bool>; break;
+		case IFT_INT8: f.append = append_value<int8_t, int32_t>; break;
+		case IFT_UINT8: f.append = append_value<uint8_t, int32_t>; break;
+		case IFT_INT16: f.append = append_value<int16_t, int32_t>; break;
+		case IFT_UINT16: f.append = append_value<uint16_t, int32_t>; break;
+		case IFT_INT32: f.append = append_value<int32_t, int32_t>; break;
+		case IFT_UINT32: f.append = append_value<uint32_t, int64_t>; break;
+		case IFT_INT64: f.append = append_value<int64_t, int64_t>; break;
+		case IFT_UINT64: f.append = append_value<uint64_t, int64_t>; break;
+		case IFT_FLOAT: f.append = append_value<float, double>; break;
+		case IFT_DOUBLE: f.append = append_value<double, double>; break;
+		case IFT_STRING: f.append = append_string; break;
+		case IFT_BYTE: f.append = append_value<uint8_t, int32_t>; break;
+		case IFT_ENUM:
+			if (enums_as_strings) {
+				f.append = append_enum_string;
+			} else {
+				f.append = append_value<int32_t, int32_t>;
+			}
+			break;
+		}
+		fields_.push_back(std::move(f));
+	}
+}
+
+/** Check if serializer can be used for an interface.
+ * @param interface interface to check
+ * @return true if the interface has the same type and hash as the one the
+ * serializer has been created for, false otherwise
+ */
+bool
+InterfaceBsonSerializer::compatible(const Interface *interface) const
+{
+	return (type_ == interface->type() && data_size_ == interface->datasize()
+	        && memcmp(hash_, interface->hash(), INTERFACE_HASH_SIZE_) == 0);
+}
+
+/** Append interface fields to document.
+ * The current data of the interface is appended, it must have been read
+ * before if desired.
+ * @param document document to append to
+ * @param interface interface to serialize, must be compatible
+ */
+void
+InterfaceBsonSerializer::append(basic::document &document, const Interface *interface) const
+{
+	const char *data = (const char *)interface->datachunk();
+	for (const FieldInfo &f : fields_) {
+		f.append(document, f, interface, data);
+	}
+}
+
+template <typename FieldType, typename BsonType>
+void
+InterfaceBsonSerializer::append_value(basic::document &document,
+                                      const FieldInfo &field,
+                                      const Interface *interface,
+                                      const char *     data)
+{
+	const FieldType *values = (const FieldType *)(data + field.offset);
+	if (field.length > 1) {
+		document.append(basic::kvp(field.name, [values, &field](basic::sub_array array) {
+			for (size_t l = 0; l < field.length; ++l) {
+				array.append(static_cast<BsonType>(values[l]));
+			}
+		}));
+	} else {
+		document.append(basic::kvp(field.name, static_cast<BsonType>(values[0])));
+	}
+}
+
+void
+InterfaceBsonSerializer::append_string(basic::document &document,
+                                       const FieldInfo &field,
+                                       const Interface *interface,
+                                       const char *     data)
+{
+	const char *value = data + field.offset;
+	document.append(basic::kvp(field.name, std::string(value, strnlen(value, field.length))));
+}
+
+void
+InterfaceBsonSerializer::append_enum_string(basic::document &document,
+                                            const FieldInfo &field,
+                                            const Interface *interface,
+                                            const char *     data)
+{
+	const int32_t *values = (const int32_t *)(data + field.offset);
+	if (field.length > 1) {
+		document.append(basic::kvp(field.name, [values, &field, interface](basic::sub_array array) {
+			for (size_t l = 0; l < field.length; ++l) {
+				array.append(interface->enum_tostring(field.enumtype, values[l]));
+			}
+		}));
+	} else {
+		document.append(basic::kvp(field.name, interface->enum_tostring(field.enumtype, values[0])));
+	}
+}
+
+} // end namespace fawkes
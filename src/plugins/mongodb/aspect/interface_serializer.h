@@ -0,0 +1,85 @@
+
+/***************************************************************************
+ *  interface_serializer.h - Serialize interface data to BSON
+ *
+ *  Created: Sat Oct 17 18:02:31 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _PLUGINS_MONGODB_ASPECT_INTERFACE_SERIALIZER_H_
+#define _PLUGINS_MONGODB_ASPECT_INTERFACE_SERIALIZER_H_
+
+#include <interface/interface.h>
+#include <interface/types.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+
+class InterfaceBsonSerializer
+{
+public:
+	explicit InterfaceBsonSerializer(Interface *interface, bool enums_as_strings = false);
+
+	bool compatible(const Interface *interface) const;
+	void append(bsoncxx::builder::basic::document &document, const Interface *interface) const;
+
+private:
+	/// @cond INTERNALS
+	struct FieldInfo;
+	typedef void (*AppendFunc)(bsoncxx::builder::basic::document &document,
+	                           const FieldInfo &                  field,
+	                           const Interface *                  interface,
+	                           const char *                       data);
+
+	struct FieldInfo
+	{
+		std::string           name;
+		interface_fieldtype_t type;
+		size_t                length;
+		size_t                offset;
+		const char *          enumtype;
+		AppendFunc            append;
+	};
+	/// @endcond
+
+	static void append_string(bsoncxx::builder::basic::document &document,
+	                          const FieldInfo &                  field,
+	                          const Interface *                  interface,
+	                          const char *                       data);
+	static void append_enum_string(bsoncxx::builder::basic::document &document,
+	                               const FieldInfo &                  field,
+	                               const Interface *                  interface,
+	                               const char *                       data);
+	template <typename FieldType, typename BsonType>
+	static void append_value(bsoncxx::builder::basic::document &document,
+	                         const FieldInfo &                  field,
+	                         const Interface *                  interface,
+	                         const char *                       data);
+
+private:
+	std::string            type_;
+	unsigned char          hash_[INTERFACE_HASH_SIZE_];
+	size_t                 data_size_;
+	std::vector<FieldInfo> fields_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -22,6 +22,8 @@
 
 #include "mongodb_log_bb_thread.h"
 
+#include "mongodb_log_writer_thread.h"
+
 #include <core/threading/mutex_locker.h>
 #include <plugins/mongodb/aspect/mongodb_conncreator.h>
 
@@ -37,14 +39,20 @@ using namespace fawkes;
  * MongoDB Logging Thread.
  * This thread registers to interfaces specified with patterns in the
  * configurationa and logs any changes to MongoDB.
+ * If a writer thread is given, documents are handed to it for batched
+ * writing instead of inserting them from the interface writer's context.
  *
  * @author Tim Niemueller
  */
 
-/** Constructor. */
-MongoLogBlackboardThread::MongoLogBlackboardThread()
+/** Constructor.
+ * @param writer writer thread to enqueue documents to, NULL to insert
+ * documents directly
+ */
+MongoLogBlackboardThread::MongoLogBlackboardThread(MongoLogWriterThread *writer)
 : Thread("MongoLogBlackboardThread", Thread::OPMODE_WAITFORWAKEUP), MongoDBAspect("default")
 {
+	writer_ = writer;
 }
 
 /** Destructor. */
@@ -100,9 +108,9 @@ MongoLogBlackboardThread::init()
 				continue;
 
 			logger->log_debug(name(), "Adding %s", (*i)->uid());
-			client *mc = mongodb_connmgr->create_client();
+			client *mc = writer_ ? NULL : mongodb_connmgr->create_client();
 			listeners_[(*i)->uid()] =
-			  new InterfaceListener(blackboard, *i, mc, database_, collections_, logger, now_);
+			  new InterfaceListener(blackboard, *i, mc, database_, collections_, logger, now_, writer_);
 		}
 	}
 
@@ -118,7 +126,8 @@ MongoLogBlackboardThread::finalize()
 	for (i = listeners_.begin(); i != listeners_.end(); ++i) {
 		client *mc = i->second->mongodb_client();
 		delete i->second;
-		mongodb_connmgr->delete_client(mc);
+		if (mc)
+			mongodb_connmgr->delete_client(mc);
 	}
 	listeners_.clear();
 }
@@ -146,9 +155,9 @@ MongoLogBlackboardThread::bb_interface_created(const char *type, const char *id)
 		Interface *interface = blackboard->open_for_reading(type, id);
 		if (listeners_.find(interface->uid()) == listeners_.end()) {
 			logger->log_debug(name(), "Opening new %s", interface->uid());
-			client *mc = mongodb_connmgr->create_client();
-			listeners_[interface->uid()] =
-			  new InterfaceListener(blackboard, interface, mc, database_, collections_, logger, now_);
+			client *mc = writer_ ? NULL : mongodb_connmgr->create_client();
+			listeners_[interface->uid()] = new InterfaceListener(
+			  blackboard, interface, mc, database_, collections_, logger, now_, writer_);
 		} else {
 			logger->log_warn(name(), "Interface %s already opened", interface->uid());
 			blackboard->close(interface);
@@ -162,11 +171,13 @@ MongoLogBlackboardThread::bb_interface_created(const char *type, const char *id)
 /** Constructor.
  * @param blackboard blackboard
  * @param interface interface to listen for
- * @param mongodb MongoDB client to write to
+ * @param mongodb MongoDB client to write to, may be NULL if writer is set
  * @param database name of database to write to
  * @param colls collections
  * @param logger logger
  * @param now Time
+ * @param writer writer thread to enqueue documents to, NULL to insert
+ * documents directly using the given client
  */
 MongoLogBlackboardThread::InterfaceListener::InterfaceListener(BlackBoard *          blackboard,
                                                                Interface *           interface,
@@ -174,16 +185,19 @@ MongoLogBlackboardThread::InterfaceListener::InterfaceListener(BlackBoard *
                                                                std::string &         database,
                                                                LockSet<std::string> &colls,
                                                                Logger *              logger,
-                                                               Time *                now)
+                                                               Time *                now,
+                                                               MongoLogWriterThread *writer)
 : BlackBoardInterfaceListener("MongoLogListener-%s", interface->uid()),
   database_(database),
-  collections_(colls)
+  collections_(colls),
+  serializer_(interface)
 {
 	blackboard_ = blackboard;
 	interface_  = interface;
 	mongodb_    = mongodb;
 	logger_     = logger;
 	now_        = now;
+	writer_     = writer;
 
 	// sanitize interface ID to be suitable for MongoDB
 	std::string id  = interface->id();
@@ -220,187 +234,13 @@ MongoLogBlackboardThread::InterfaceListener::bb_interface_data_changed(Interface
 		using namespace bsoncxx::builder;
 		basic::document document;
 		document.append(basic::kvp("timestamp", static_cast<int64_t>(now_->in_msec())));
-		InterfaceFieldIterator i;
-		for (i = interface->fields(); i != interface->fields_end(); ++i) {
-			size_t length   = i.get_length();
-			bool   is_array = (length > 1);
-
-			std::string key{i.get_name()};
-			switch (i.get_type()) {
-			case IFT_BOOL:
-				if (is_array) {
-					bool *bools = i.get_bools();
-					document.append(basic::kvp(key, [bools, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(bools[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_bool()));
-				}
-				break;
-
-			case IFT_INT8:
-				if (is_array) {
-					int8_t *ints = i.get_int8s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(ints[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_int8()));
-				}
-				break;
-
-			case IFT_UINT8:
-				if (is_array) {
-					uint8_t *ints = i.get_uint8s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(ints[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_uint8()));
-				}
-				break;
-
-			case IFT_INT16:
-				if (is_array) {
-					int16_t *ints = i.get_int16s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(ints[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_int16()));
-				}
-				break;
-
-			case IFT_UINT16:
-				if (is_array) {
-					uint16_t *ints = i.get_uint16s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(ints[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_uint16()));
-				}
-				break;
-
-			case IFT_INT32:
-				if (is_array) {
-					int32_t *ints = i.get_int32s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(ints[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_int32()));
-				}
-				break;
-
-			case IFT_UINT32:
-				if (is_array) {
-					uint32_t *ints = i.get_uint32s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(static_cast<int64_t>(ints[l]));
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, static_cast<int64_t>(i.get_uint32())));
-				}
-				break;
-
-			case IFT_INT64:
-				if (is_array) {
-					int64_t *ints = i.get_int64s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(ints[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_int64()));
-				}
-				break;
-
-			case IFT_UINT64:
-				if (is_array) {
-					uint64_t *ints = i.get_uint64s();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(static_cast<int64_t>(ints[l]));
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, static_cast<int64_t>(i.get_uint64())));
-				}
-				break;
-
-			case IFT_FLOAT:
-				if (is_array) {
-					float *floats = i.get_floats();
-					document.append(basic::kvp(key, [floats, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(floats[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_float()));
-				}
-				break;
-
-			case IFT_DOUBLE:
-				if (is_array) {
-					double *doubles = i.get_doubles();
-					document.append(basic::kvp(key, [doubles, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(doubles[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_double()));
-				}
-				break;
-
-			case IFT_STRING: document.append(basic::kvp(key, i.get_string())); break;
-
-			case IFT_BYTE:
-				if (is_array) {
-					uint8_t *bytes = i.get_bytes();
-					document.append(basic::kvp(key, [bytes, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(bytes[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_byte()));
-				}
-				break;
+		serializer_.append(document, interface);
 
-			case IFT_ENUM:
-				if (is_array) {
-					int32_t *ints = i.get_enums();
-					document.append(basic::kvp(key, [ints, length](basic::sub_array subarray) {
-						for (size_t l = 0; l < length; ++l) {
-							subarray.append(ints[l]);
-						}
-					}));
-				} else {
-					document.append(basic::kvp(key, i.get_enum()));
-				}
-				break;
-			}
+		if (writer_) {
+			writer_->enqueue(collection_, document.extract());
+		} else {
+			mongodb_->database(database_)[collection_].insert_one(document.view());
 		}
-
-		mongodb_->database(database_)[collection_].insert_one(document.view());
 	} catch (operation_exception &e) {
 		logger_->log_warn(
 		  bbil_name(), "Failed to log to %s.%s: %s", database_.c_str(), collection_.c_str(), e.what());
@@ -32,10 +32,13 @@
 #include <core/threading/thread.h>
 #include <core/utils/lock_map.h>
 #include <core/utils/lock_set.h>
+#include <plugins/mongodb/aspect/interface_serializer.h>
 #include <plugins/mongodb/aspect/mongodb.h>
 
 #include <string>
 
+class MongoLogWriterThread;
+
 class MongoLogBlackboardThread : public fawkes::Thread,
                                  public fawkes::LoggingAspect,
                                  public fawkes::ConfigurableAspect,
@@ -45,7 +48,7 @@ class MongoLogBlackboardThread : public fawkes::Thread,
                                  public fawkes::BlackBoardInterfaceObserver
 {
 public:
-	MongoLogBlackboardThread();
+	explicit MongoLogBlackboardThread(MongoLogWriterThread *writer = NULL);
 	virtual ~MongoLogBlackboardThread();
 
 	virtual void init();
@@ -74,7 +77,8 @@ private:
 		                  std::string &                 database,
 		                  fawkes::LockSet<std::string> &colls,
 		                  fawkes::Logger *              logger,
-		                  fawkes::Time *                now);
+		                  fawkes::Time *                now,
+		                  MongoLogWriterThread *        writer);
 		~InterfaceListener();
 
 		/** Get MongoDB Client.
@@ -89,20 +93,23 @@ private:
 		virtual void bb_interface_data_changed(fawkes::Interface *interface) throw();
 
 	private:
-		fawkes::BlackBoard *          blackboard_;
-		fawkes::Interface *           interface_;
-		mongocxx::client *            mongodb_;
-		fawkes::Logger *              logger_;
-		std::string                   collection_;
-		std::string &                 database_;
-		fawkes::LockSet<std::string> &collections_;
-		fawkes::Time *                now_;
+		fawkes::BlackBoard *            blackboard_;
+		fawkes::Interface *             interface_;
+		mongocxx::client *              mongodb_;
+		fawkes::Logger *                logger_;
+		std::string                     collection_;
+		std::string &                   database_;
+		fawkes::LockSet<std::string> &  collections_;
+		fawkes::Time *                  now_;
+		MongoLogWriterThread *          writer_;
+		fawkes::InterfaceBsonSerializer serializer_;
 	};
 
 	fawkes::LockMap<std::string, InterfaceListener *> listeners_;
 	fawkes::LockSet<std::string>                      collections_;
 	std::string                                       database_;
 	fawkes::Time *                                    now_;
+	MongoLogWriterThread *                            writer_;
 
 	std::vector<std::string> excludes_;
 };
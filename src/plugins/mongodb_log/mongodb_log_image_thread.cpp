@@ -22,6 +22,8 @@
 
 #include "mongodb_log_image_thread.h"
 
+#include "mongodb_log_writer_thread.h"
+
 #include <core/threading/mutex_locker.h>
 #include <fvutils/color/colorspaces.h>
 #include <fvutils/ipc/shm_image.h>
@@ -31,7 +33,7 @@
 #include <bsoncxx/builder/basic/document.hpp>
 #include <fnmatch.h>
 #include <mongocxx/client.hpp>
-#include <mongocxx/exception/operation_exception.hpp>
+#include <mongocxx/exception/exception.hpp>
 #include <mongocxx/gridfs/uploader.hpp>
 
 using namespace fawkes;
@@ -44,11 +46,15 @@ using namespace mongocxx;
  * @author Bastian Klingen
  */
 
-/** Constructor. */
-MongoLogImagesThread::MongoLogImagesThread()
+/** Constructor.
+ * @param writer writer thread to enqueue meta data documents to, NULL
+ * to insert them directly. Data is always uploaded to GridFS directly.
+ */
+MongoLogImagesThread::MongoLogImagesThread(MongoLogWriterThread *writer)
 : Thread("MongoLogImagesThread", Thread::OPMODE_CONTINUOUS), MongoDBAspect("default")
 {
 	set_prepfin_conc_loop(true);
+	writer_ = writer;
 }
 
 /** Destructor. */
@@ -122,7 +128,8 @@ MongoLogImagesThread::loop()
 	MutexLocker  lock(mutex_);
 	fawkes::Time loop_start(clock);
 	wait_->mark_start();
-	unsigned int num_stored = 0;
+	unsigned int num_stored  = 0;
+	unsigned int num_dropped = 0;
 
 	now_->stamp();
 	if (*now_ - last_update_ >= 5.0) {
@@ -142,17 +149,17 @@ MongoLogImagesThread::loop()
 			imginfo.last_sent = cap_time;
 			document.append(basic::kvp("timestamp", static_cast<int64_t>(cap_time.in_msec())));
 
+			std::stringstream name;
+			name << imginfo.topic_name << "_" << cap_time.in_msec();
+			auto uploader = gridfs_.open_upload_stream(name.str());
+			uploader.write((uint8_t *)imginfo.img->buffer(), imginfo.img->data_size());
+			auto result = uploader.close();
+
 			document.append(basic::kvp("image", [&](basic::sub_document subdoc) {
 				subdoc.append(basic::kvp("image_id", imginfo.img->image_id()));
 				subdoc.append(basic::kvp("width", static_cast<int32_t>(imginfo.img->width())));
 				subdoc.append(basic::kvp("height", static_cast<int32_t>(imginfo.img->height())));
 				subdoc.append(basic::kvp("colorspace", colorspace_to_string(imginfo.img->colorspace())));
-
-				std::stringstream name;
-				name << imginfo.topic_name << "_" << cap_time.in_msec();
-				auto uploader = gridfs_.open_upload_stream(name.str());
-				uploader.write((uint8_t *)imginfo.img->buffer(), imginfo.img->data_size());
-				auto result = uploader.close();
 				subdoc.append(basic::kvp("data", [&](basic::sub_document subdoc) {
 					subdoc.append(basic::kvp("id", result.id()));
 					subdoc.append(basic::kvp("filename", name.str()));
@@ -160,9 +167,19 @@ MongoLogImagesThread::loop()
 			}));
 
 			try {
-				mongodb_->database(database_)[imginfo.topic_name].insert_one(document.view());
-				++num_stored;
-			} catch (operation_exception &e) {
+				if (writer_) {
+					if (writer_->enqueue(imginfo.topic_name, document.extract())) {
+						++num_stored;
+					} else {
+						// the image data would not be referenced by any document
+						++num_dropped;
+						gridfs_.delete_file(result.id());
+					}
+				} else {
+					mongodb_->database(database_)[imginfo.topic_name].insert_one(document.view());
+					++num_stored;
+				}
+			} catch (mongocxx::exception &e) {
 				logger->log_warn(this->name(),
 				                 "Failed to insert image %s into %s.%s: %s",
 				                 imginfo.img->image_id(),
@@ -180,6 +197,9 @@ MongoLogImagesThread::loop()
 	                  num_stored,
 	                  imgs_.size(),
 	                  (loop_end - &loop_start) * 1000.);
+	if (num_dropped > 0) {
+		logger->log_warn(name(), "Dropped %u images, writer queue full", num_dropped);
+	}
 	wait_->wait();
 }
 
@@ -48,6 +48,8 @@ class Mutex;
 class TimeWait;
 } // namespace fawkes
 
+class MongoLogWriterThread;
+
 namespace mongo {
 class GridFS;
 }
@@ -59,7 +61,7 @@ class MongoLogImagesThread : public fawkes::Thread,
                              public fawkes::MongoDBAspect
 {
 public:
-	MongoLogImagesThread();
+	explicit MongoLogImagesThread(MongoLogWriterThread *writer = NULL);
 	virtual ~MongoLogImagesThread();
 
 	virtual void init();
@@ -92,6 +94,7 @@ private:
 
 	fawkes::Time *           last_update_;
 	fawkes::Time *           now_;
+	MongoLogWriterThread *   writer_;
 	mongocxx::client *       mongodb_;
 	mongocxx::gridfs::bucket gridfs_;
 	std::string              collection_;
@@ -22,6 +22,8 @@
 
 #include "mongodb_log_pcl_thread.h"
 
+#include "mongodb_log_writer_thread.h"
+
 // Fawkes
 #include <core/threading/mutex_locker.h>
 #include <utils/time/wait.h>
@@ -29,7 +31,7 @@
 // from MongoDB
 #include <fnmatch.h>
 #include <mongocxx/client.hpp>
-#include <mongocxx/exception/operation_exception.hpp>
+#include <mongocxx/exception/exception.hpp>
 #include <mongocxx/gridfs/uploader.hpp>
 #include <unistd.h>
 
@@ -42,11 +44,15 @@ using namespace mongocxx;
  * @author Bastian Klingen
  */
 
-/** Constructor. */
-MongoLogPointCloudThread::MongoLogPointCloudThread()
+/** Constructor.
+ * @param writer writer thread to enqueue meta data documents to, NULL
+ * to insert them directly. Data is always uploaded to GridFS directly.
+ */
+MongoLogPointCloudThread::MongoLogPointCloudThread(MongoLogWriterThread *writer)
 : Thread("MongoLogPointCloudThread", Thread::OPMODE_CONTINUOUS), MongoDBAspect("default")
 {
 	set_prepfin_conc_loop(true);
+	writer_ = writer;
 }
 
 /** Destructor. */
@@ -186,7 +192,8 @@ MongoLogPointCloudThread::loop()
 	fawkes::Time loop_start(clock);
 	wait_->mark_start();
 	std::map<std::string, PointCloudInfo>::iterator p;
-	unsigned int                                    num_stored = 0;
+	unsigned int                                    num_stored  = 0;
+	unsigned int                                    num_dropped = 0;
 	for (p = pcls_.begin(); p != pcls_.end(); ++p) {
 		PointCloudInfo &pi = p->second;
 		std::string     frame_id;
@@ -236,9 +243,19 @@ MongoLogPointCloudThread::loop()
 			}));
 
 			try {
-				mongodb_->database(database_)[pi.topic_name].insert_one(document.view());
-				++num_stored;
-			} catch (operation_exception &e) {
+				if (writer_) {
+					if (writer_->enqueue(pi.topic_name, document.extract())) {
+						++num_stored;
+					} else {
+						// the point data would not be referenced by any document
+						++num_dropped;
+						gridfs_.delete_file(result.id());
+					}
+				} else {
+					mongodb_->database(database_)[pi.topic_name].insert_one(document.view());
+					++num_stored;
+				}
+			} catch (mongocxx::exception &e) {
 				logger->log_warn(this->name(),
 				                 "Failed to insert into %s: %s",
 				                 collection_.c_str(),
@@ -266,6 +283,9 @@ MongoLogPointCloudThread::loop()
 	                  num_stored,
 	                  pcls_.size(),
 	                  (loop_end - &loop_start) * 1000.);
+	if (num_dropped > 0) {
+		logger->log_warn(name(), "Dropped %u point clouds, writer queue full", num_dropped);
+	}
 
 	if (cfg_flush_after_write_) {
 		// flush database
@@ -50,6 +50,8 @@ class Mutex;
 class TimeWait;
 } // namespace fawkes
 
+class MongoLogWriterThread;
+
 class MongoLogPointCloudThread : public fawkes::Thread,
                                  public fawkes::ClockAspect,
                                  public fawkes::LoggingAspect,
@@ -58,7 +60,7 @@ class MongoLogPointCloudThread : public fawkes::Thread,
                                  public fawkes::MongoDBAspect
 {
 public:
-	MongoLogPointCloudThread();
+	explicit MongoLogPointCloudThread(MongoLogWriterThread *writer = NULL);
 	virtual ~MongoLogPointCloudThread();
 
 	virtual void init();
@@ -91,6 +93,7 @@ private:
 	/// @endcond
 	std::map<std::string, PointCloudInfo> pcls_;
 
+	MongoLogWriterThread *   writer_;
 	mongocxx::client *       mongodb_;
 	mongocxx::gridfs::bucket gridfs_;
 	std::string              collection_;
@@ -24,6 +24,7 @@
 #include "mongodb_log_logger_thread.h"
 #include "mongodb_log_pcl_thread.h"
 #include "mongodb_log_tf_thread.h"
+#include "mongodb_log_writer_thread.h"
 
 #include <core/plugin.h>
 
@@ -42,13 +43,25 @@ public:
    */
 	explicit MongoLogPlugin(Configuration *config) : Plugin(config)
 	{
+		// the writer goes first to be initialized first and finalized last
+		MongoLogWriterThread *writer        = NULL;
+		bool                  enable_writer = true;
+		try {
+			enable_writer = config->get_bool("/plugins/mongodb-log/writer/enable");
+		} catch (Exception &e) {
+		}
+		if (enable_writer) {
+			writer = new MongoLogWriterThread();
+			thread_list.push_back(writer);
+		}
+
 		bool enable_bb = true;
 		try {
 			enable_bb = config->get_bool("/plugins/mongodb-log/enable-blackboard");
 		} catch (Exception &e) {
 		}
 		if (enable_bb) {
-			thread_list.push_back(new MongoLogBlackboardThread());
+			thread_list.push_back(new MongoLogBlackboardThread(writer));
 		}
 
 		bool enable_pcls = true;
@@ -57,7 +70,7 @@ public:
 		} catch (Exception &e) {
 		}
 		if (enable_pcls) {
-			thread_list.push_back(new MongoLogPointCloudThread());
+			thread_list.push_back(new MongoLogPointCloudThread(writer));
 		}
 
 		bool enable_images = true;
@@ -66,7 +79,7 @@ public:
 		} catch (Exception &e) {
 		}
 		if (enable_images) {
-			thread_list.push_back(new MongoLogImagesThread());
+			thread_list.push_back(new MongoLogImagesThread(writer));
 		}
 
 		bool enable_logger = true;
@@ -84,10 +97,10 @@ public:
 		} catch (Exception &e) {
 		}
 		if (enable_tf) {
-			thread_list.push_back(new MongoLogTransformsThread());
+			thread_list.push_back(new MongoLogTransformsThread(writer));
 		}
 
-		if (thread_list.empty()) {
+		if (thread_list.size() == (writer ? 1 : 0)) {
 			throw Exception("MongoLogPlugin: no logging thread enabled");
 		}
 
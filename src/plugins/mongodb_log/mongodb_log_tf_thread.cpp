@@ -21,6 +21,8 @@
 
 #include "mongodb_log_tf_thread.h"
 
+#include "mongodb_log_writer_thread.h"
+
 #include <core/threading/mutex_locker.h>
 #include <plugins/mongodb/aspect/mongodb_conncreator.h>
 #include <tf/time_cache.h>
@@ -42,13 +44,17 @@ using namespace fawkes;
  * @author Tim Niemueller
  */
 
-/** Constructor. */
-MongoLogTransformsThread::MongoLogTransformsThread()
+/** Constructor.
+ * @param writer writer thread to enqueue documents to, NULL to insert
+ * documents directly
+ */
+MongoLogTransformsThread::MongoLogTransformsThread(MongoLogWriterThread *writer)
 : Thread("MongoLogTransformsThread", Thread::OPMODE_CONTINUOUS),
   MongoDBAspect("default"),
   TransformAspect(TransformAspect::ONLY_LISTENER)
 {
 	set_prepfin_conc_loop(true);
+	writer_ = writer;
 }
 
 /** Destructor. */
@@ -194,7 +200,7 @@ MongoLogTransformsThread::store(std::vector<tf::TimeCacheInterfacePtr> &caches,
 		      storage.size(), frame_map[i].c_str());
     */
 
-		document.append(basic::kvp("transforms", [storage, frame_map](basic::sub_array array) {
+		document.append(basic::kvp("transforms", [&storage, &frame_map](basic::sub_array array) {
 			for (auto s = storage.begin(); s != storage.end(); ++s) {
 				/*
 	      "frame" : "/bl_caster_rotation_link",
@@ -230,6 +236,11 @@ MongoLogTransformsThread::store(std::vector<tf::TimeCacheInterfacePtr> &caches,
 			}
 		}));
 
+		if (writer_) {
+			writer_->enqueue(collection_, document.extract());
+			continue;
+		}
+
 		try {
 			mongodb_client->database(database_)[collection_].insert_one(document.view());
 		} catch (operation_exception &e) {
@@ -38,6 +38,8 @@ namespace fawkes {
 class TimeWait;
 }
 
+class MongoLogWriterThread;
+
 class MongoLogTransformsThread : public fawkes::Thread,
                                  public fawkes::LoggingAspect,
                                  public fawkes::ConfigurableAspect,
@@ -47,7 +49,7 @@ class MongoLogTransformsThread : public fawkes::Thread,
                                  public fawkes::TransformAspect
 {
 public:
-	MongoLogTransformsThread();
+	explicit MongoLogTransformsThread(MongoLogWriterThread *writer = NULL);
 	virtual ~MongoLogTransformsThread();
 
 	virtual void init();
@@ -69,6 +71,7 @@ private:
 	           std::vector<fawkes::Time> &                     to);
 
 private:
+	MongoLogWriterThread *    writer_;
 	fawkes::Mutex *           mutex_;
 	fawkes::TimeWait *        wait_;
 	std::string               database_;
@@ -0,0 +1,235 @@
+
+/***************************************************************************
+ *  mongodb_log_writer_thread.cpp - MongoDB logging batch writer thread
+ *
+ *  Created: Sat Oct 17 17:21:46 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "mongodb_log_writer_thread.h"
+
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
+#include <utils/time/time.h>
+
+#include <cmath>
+#include <map>
+#include <mongocxx/client.hpp>
+#include <mongocxx/exception/operation_exception.hpp>
+#include <mongocxx/options/insert.hpp>
+#include <vector>
+
+using namespace fawkes;
+
+/** @class MongoLogWriterThread "mongodb_log_writer_thread.h"
+ * MongoDB logging batch writer thread.
+ * The logging threads hand their documents to this thread instead of
+ * inserting them synchronously, which would block the writer of a
+ * blackboard interface or the logging loop on the database round-trip.
+ * Documents are queued and written in batches, one unordered insert_many
+ * per collection, once the configured batch size is reached or the
+ * commit interval has passed. The queue is bounded, if it is full new
+ * documents are dropped and the number of dropped documents is reported.
+ * @author agent
+ */
+
+/** Constructor. */
+MongoLogWriterThread::MongoLogWriterThread()
+: Thread("MongoLogWriterThread", Thread::OPMODE_CONTINUOUS), MongoDBAspect("default")
+{
+	queue_mutex_    = new Mutex();
+	queue_waitcond_ = new WaitCondition(queue_mutex_);
+
+	// defaults until the configuration has been read in init()
+	cfg_batch_size_      = 100;
+	cfg_commit_interval_ = 0.1;
+	cfg_queue_size_      = 10000;
+
+	num_dropped_      = 0;
+	last_num_dropped_ = 0;
+	num_written_      = 0;
+	num_failed_       = 0;
+	num_batches_      = 0;
+	max_write_time_   = 0.;
+}
+
+/** Destructor. */
+MongoLogWriterThread::~MongoLogWriterThread()
+{
+	delete queue_waitcond_;
+	delete queue_mutex_;
+}
+
+void
+MongoLogWriterThread::init()
+{
+	database_ = "fflog";
+	try {
+		database_ = config->get_string("/plugins/mongodb-log/database");
+	} catch (Exception &e) {
+		logger->log_info(name(), "No database configured, writing to %s", database_.c_str());
+	}
+
+	MutexLocker lock(queue_mutex_);
+	try {
+		cfg_batch_size_ = config->get_uint("/plugins/mongodb-log/writer/batch-size");
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		cfg_commit_interval_ = config->get_float("/plugins/mongodb-log/writer/commit-interval");
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		cfg_queue_size_ = config->get_uint("/plugins/mongodb-log/writer/queue-size");
+	} catch (Exception &e) {
+	} // ignored, use default
+
+	if (cfg_batch_size_ == 0)
+		cfg_batch_size_ = 1;
+	if (cfg_queue_size_ < cfg_batch_size_)
+		cfg_queue_size_ = cfg_batch_size_;
+
+	logger->log_info(name(),
+	                 "Batches of up to %u documents every %.3f sec, queue size %u",
+	                 cfg_batch_size_,
+	                 cfg_commit_interval_,
+	                 cfg_queue_size_);
+}
+
+void
+MongoLogWriterThread::finalize()
+{
+	queue_mutex_->lock();
+	std::deque<Entry> batch;
+	batch.swap(queue_);
+	queue_mutex_->unlock();
+	write(batch);
+
+	logger->log_info(name(),
+	                 "Wrote %lu documents in %lu batches, %lu failed, %lu dropped, "
+	                 "max batch write time %.1f ms",
+	                 (unsigned long)num_written_,
+	                 (unsigned long)num_batches_,
+	                 (unsigned long)num_failed_,
+	                 (unsigned long)num_dropped_.load(),
+	                 max_write_time_ * 1000.);
+}
+
+void
+MongoLogWriterThread::loop()
+{
+	std::deque<Entry> batch;
+
+	queue_mutex_->lock();
+	if (queue_.size() < cfg_batch_size_) {
+		float        wait_sec;
+		float        wait_frac = modff(cfg_commit_interval_, &wait_sec);
+		unsigned int nsec      = (unsigned int)(wait_frac * 1000000000.);
+		queue_waitcond_->reltimed_wait((unsigned int)wait_sec, nsec);
+	}
+	batch.swap(queue_);
+	queue_mutex_->unlock();
+
+	CancelState old_state;
+	set_cancel_state(CANCEL_DISABLED, &old_state);
+	write(batch);
+
+	uint64_t dropped = num_dropped_.load();
+	if (dropped != last_num_dropped_) {
+		logger->log_warn(name(),
+		                 "Dropped %lu documents (%lu total), queue too small or database too slow",
+		                 (unsigned long)(dropped - last_num_dropped_),
+		                 (unsigned long)dropped);
+		last_num_dropped_ = dropped;
+	}
+	set_cancel_state(old_state);
+}
+
+/** Enqueue document for writing.
+ * This method does not block on the database and may be called from any
+ * thread. The document is moved into the queue and written with the next
+ * batch.
+ * @param collection collection to insert the document into
+ * @param document document to insert
+ * @return true if the document has been queued, false if it has been
+ * dropped because the queue is full
+ */
+bool
+MongoLogWriterThread::enqueue(const std::string &collection, bsoncxx::document::value &&document)
+{
+	MutexLocker lock(queue_mutex_);
+	if (queue_.size() >= cfg_queue_size_) {
+		num_dropped_ += 1;
+		return false;
+	}
+	queue_.emplace_back(collection, std::move(document));
+	if (queue_.size() >= cfg_batch_size_) {
+		queue_waitcond_->wake_all();
+	}
+	return true;
+}
+
+/** Get number of dropped documents.
+ * @return number of documents dropped because the queue was full
+ */
+uint64_t
+MongoLogWriterThread::num_dropped() const
+{
+	return num_dropped_.load();
+}
+
+void
+MongoLogWriterThread::write(std::deque<Entry> &batch)
+{
+	if (batch.empty())
+		return;
+
+	Time start;
+
+	std::map<std::string, std::vector<bsoncxx::document::value>> collections;
+	for (auto &e : batch) {
+		collections[e.first].push_back(std::move(e.second));
+	}
+	batch.clear();
+
+	mongocxx::options::insert options;
+	options.ordered(false);
+
+	for (auto &c : collections) {
+		try {
+			auto result = mongodb_client->database(database_)[c.first].insert_many(c.second, options);
+			if (result) {
+				num_written_ += result->inserted_count();
+				num_failed_ += c.second.size() - result->inserted_count();
+			}
+		} catch (mongocxx::operation_exception &e) {
+			num_failed_ += c.second.size();
+			logger->log_warn(name(),
+			                 "Failed to write %zu documents to %s.%s: %s",
+			                 c.second.size(),
+			                 database_.c_str(),
+			                 c.first.c_str(),
+			                 e.what());
+		}
+	}
+	num_batches_ += 1;
+
+	Time   end;
+	double write_time = end - &start;
+	if (write_time > max_write_time_)
+		max_write_time_ = write_time;
+}
@@ -0,0 +1,90 @@
+
+/***************************************************************************
+ *  mongodb_log_writer_thread.h - MongoDB logging batch writer thread
+ *
+ *  Created: Sat Oct 17 17:21:46 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_MONGODB_LOG_MONGODB_LOG_WRITER_THREAD_H_
+#define _PLUGINS_MONGODB_LOG_MONGODB_LOG_WRITER_THREAD_H_
+
+#include <aspect/configurable.h>
+#include <aspect/logging.h>
+#include <core/threading/thread.h>
+#include <plugins/mongodb/aspect/mongodb.h>
+
+#include <atomic>
+#include <bsoncxx/document/value.hpp>
+#include <deque>
+#include <string>
+#include <utility>
+
+namespace fawkes {
+class Mutex;
+class WaitCondition;
+} // namespace fawkes
+
+class MongoLogWriterThread : public fawkes::Thread,
+                             public fawkes::LoggingAspect,
+                             public fawkes::ConfigurableAspect,
+                             public fawkes::MongoDBAspect
+{
+public:
+	MongoLogWriterThread();
+	virtual ~MongoLogWriterThread();
+
+	virtual void init();
+	virtual void loop();
+	virtual void finalize();
+
+	bool enqueue(const std::string &collection, bsoncxx::document::value &&document);
+
+	uint64_t num_dropped() const;
+
+	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
+protected:
+	virtual void
+	run()
+	{
+		Thread::run();
+	}
+
+private:
+	/// @cond INTERNALS
+	typedef std::pair<std::string, bsoncxx::document::value> Entry;
+	/// @endcond
+
+	void write(std::deque<Entry> &batch);
+
+private:
+	std::string  database_;
+	unsigned int cfg_batch_size_;
+	float        cfg_commit_interval_;
+	unsigned int cfg_queue_size_;
+
+	fawkes::Mutex *        queue_mutex_;
+	fawkes::WaitCondition *queue_waitcond_;
+	std::deque<Entry>      queue_;
+	std::atomic<uint64_t>  num_dropped_;
+	uint64_t               last_num_dropped_;
+	uint64_t               num_written_;
+	uint64_t               num_failed_;
+	uint64_t               num_batches_;
+	double                 max_write_time_;
+};
+
+#endif
@@ -96,9 +96,9 @@ OpenraveRobotMemoryThread::construct_scene()
 		query.append(basic::kvp("frame", "base_link"));
 		query.append(basic::kvp("allow_tf", true));
 		logger->log_info(name(), "Querying: %s", to_json(query).c_str());
-		auto cursor = robot_memory->query(query, collection);
-		//while (cur->more()) {
-		for (auto block : cursor) {
+		auto blocks = robot_memory->query_cached(query, collection);
+		for (auto &block_doc : *blocks) {
+			bsoncxx::document::view block = block_doc.view();
 			//logger->log_info(name(), "Adding: %s", cfg_prefix.c_str(), to_json(block).c_str());
 			std::string block_name =
 			  block[config->get_string(cfg_prefix + "name-key")].get_utf8().value.to_string();
@@ -116,8 +116,6 @@ PddlRobotMemoryThread::loop()
 	//Dictionary how to fill the templates
 	ctemplate::TemplateDictionary dict("pddl-rm");
 
-	basic::document facets;
-
 	//find queries in template
 	size_t                             cur_pos = 0;
 	std::map<std::string, std::string> templates;
@@ -149,21 +147,12 @@ PddlRobotMemoryThread::loop()
 
 		try {
 			//fill dictionary to expand query template:
-			/*
-	    QResCursor cursor = robot_memory->query(fromjson(query_str), collection);
-      while(cursor->more())
-      {
-        BSONObj obj = cursor->next();
-        //dictionary for one entry
-        ctemplate::TemplateDictionary *entry_dict = dict.AddSectionDictionary(template_name);
-        fill_dict_from_document(entry_dict, obj);
-      }
-	    */
-			facets.append(basic::kvp(template_name, [query_str](basic::sub_array array) {
-				basic::document query;
-				query.append(basic::kvp("$match", from_json(query_str)));
-				array.append(query.view());
-			}));
+			auto docs = robot_memory->query_cached(from_json(query_str), collection);
+			for (auto &doc : *docs) {
+				//dictionary for one entry
+				ctemplate::TemplateDictionary *entry_dict = dict.AddSectionDictionary(template_name);
+				fill_dict_from_document(entry_dict, doc.view());
+			}
 		} catch (bsoncxx::exception &e) {
 			logger->log_error("PddlRobotMemory",
 			                  "Template query failed: %s\n%s",
@@ -172,19 +161,6 @@ PddlRobotMemoryThread::loop()
 		}
 	}
 
-	basic::document aggregate_query;
-	aggregate_query.append(basic::kvp("$facet", facets.view()));
-	std::vector<document::view> aggregate_pipeline{aggregate_query.view()};
-	auto                        res    = robot_memory->aggregate(aggregate_pipeline, collection);
-	auto                        result = res.view()["result"]["0"].get_document().view();
-	//BSONObj                     result = res.getField("result").Obj()["0"].Obj();
-	for (auto e : result) {
-		for (auto f : e.get_document().view()) {
-			ctemplate::TemplateDictionary *entry_dict = dict.AddSectionDictionary(std::string(e.key()));
-			fill_dict_from_document(entry_dict, f.get_document().view());
-		}
-	}
-
 	//Add goal to dictionary
 	dict.SetValue("GOAL", goal);
 
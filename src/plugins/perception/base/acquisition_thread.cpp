@@ -92,6 +92,8 @@ FvAcquisitionThread::FvAcquisitionThread(const char *id,
 
 #ifdef FVBASE_TIMETRACKER
 	tt_          = new TimeTracker();
+	tt_->set_name(name());
+	tt_->set_max_samples(1000);
 	loop_count_  = 0;
 	ttc_capture_ = tt_->add_class("Capture");
 	ttc_lock_    = tt_->add_class("Lock");
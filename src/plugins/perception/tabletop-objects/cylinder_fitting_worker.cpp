@@ -0,0 +1,65 @@
+
+/***************************************************************************
+ *  cylinder_fitting_worker.cpp - Fit cylinders to object clusters in parallel
+ *
+ *  Created: Sat Oct 17 22:41:05 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "cylinder_fitting_worker.h"
+
+using namespace fawkes;
+
+/** @class CylinderFittingWorker "cylinder_fitting_worker.h"
+ * Cylinder fitting worker.
+ * The workers are created once and woken up by the tabletop objects
+ * thread with a barrier for every frame. Each runs the job set before
+ * the wakeup, which takes clusters from a shared counter until all
+ * clusters have been fitted.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param index index of this worker in the pool
+ */
+CylinderFittingWorker::CylinderFittingWorker(unsigned int index)
+: Thread("CylinderFittingWorker", Thread::OPMODE_WAITFORWAKEUP)
+{
+	set_name("CylinderFittingWorker %u", index);
+}
+
+/** Destructor. */
+CylinderFittingWorker::~CylinderFittingWorker()
+{
+}
+
+/** Set job to run on the next wakeup.
+ * Must only be called while the worker is waiting.
+ * @param job job to run
+ */
+void
+CylinderFittingWorker::set_job(std::function<void()> job)
+{
+	job_ = job;
+}
+
+void
+CylinderFittingWorker::loop()
+{
+	if (job_) {
+		job_();
+	}
+}
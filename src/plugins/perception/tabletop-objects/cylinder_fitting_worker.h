@@ -0,0 +1,51 @@
+
+/***************************************************************************
+ *  cylinder_fitting_worker.h - Fit cylinders to object clusters in parallel
+ *
+ *  Created: Sat Oct 17 22:41:05 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_PERCEPTION_TABLETOP_OBJECTS_CYLINDER_FITTING_WORKER_H_
+#define _PLUGINS_PERCEPTION_TABLETOP_OBJECTS_CYLINDER_FITTING_WORKER_H_
+
+#include <core/threading/thread.h>
+
+#include <functional>
+
+class CylinderFittingWorker : public fawkes::Thread
+{
+public:
+	CylinderFittingWorker(unsigned int index);
+	virtual ~CylinderFittingWorker();
+
+	void set_job(std::function<void()> job);
+
+	virtual void loop();
+
+	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
+protected:
+	virtual void
+	run()
+	{
+		Thread::run();
+	}
+
+private:
+	std::function<void()> job_;
+};
+
+#endif
@@ -0,0 +1,123 @@
+
+/***************************************************************************
+ *  qa_table_plane_tracking.cpp - Benchmark table plane tracking
+ *
+ *  Created: Sat Oct 17 21:04:18 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../table_plane_tracker.h"
+
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/sample_consensus/method_types.h>
+#include <pcl/sample_consensus/model_types.h>
+#include <pcl/segmentation/sac_segmentation.h>
+#include <utils/time/time.h>
+
+#include <cstdio>
+
+using namespace fawkes;
+
+typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
+
+int
+main(int argc, char **argv)
+{
+	if (argc < 2) {
+		printf("Usage: %s <cloud.pcd> [cloud.pcd...]\n"
+		       "Compare full RANSAC plane segmentation with plane tracking\n"
+		       "on a sequence of recorded point clouds.\n",
+		       argv[0]);
+		return 1;
+	}
+
+	pcl::VoxelGrid<pcl::PointXYZ> grid;
+	grid.setLeafSize(0.02, 0.02, 0.02);
+
+	pcl::SACSegmentation<pcl::PointXYZ> seg;
+	seg.setOptimizeCoefficients(true);
+	seg.setModelType(pcl::SACMODEL_PLANE);
+	seg.setMethodType(pcl::SAC_RANSAC);
+	seg.setMaxIterations(1000);
+	seg.setDistanceThreshold(0.022);
+
+	TablePlaneTracker tracker(0.022, 0.12, 0.01);
+
+	double       sum_ransac = 0., sum_track = 0.;
+	unsigned int num_frames = 0, num_tracked = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		Cloud::Ptr cloud(new Cloud());
+		if (pcl::io::loadPCDFile(argv[i], *cloud) < 0) {
+			printf("Failed to load %s, skipping\n", argv[i]);
+			continue;
+		}
+		Cloud::Ptr voxelized(new Cloud());
+		grid.setInputCloud(cloud);
+		grid.filter(*voxelized);
+
+		pcl::ModelCoefficients coeff_ransac, coeff_track;
+		pcl::PointIndices      inliers_ransac, inliers_track;
+
+		Time start;
+		seg.setInputCloud(voxelized);
+		seg.segment(inliers_ransac, coeff_ransac);
+		Time   ransac_end;
+		bool   tracked = tracker.track(*voxelized, coeff_track, inliers_track);
+		Time   track_end;
+		double t_ransac = ransac_end - &start;
+		double t_track  = track_end - &ransac_end;
+
+		float angle = 0., offset = 0.;
+		if (tracked) {
+			TablePlaneTracker::plane_difference(coeff_ransac, coeff_track, angle, offset);
+			++num_tracked;
+		}
+		printf("%-40s  %6zu points  RANSAC %8.3f ms (%6zu inliers)  "
+		       "tracking %8.3f ms (%s, %6zu inliers, angle %.4f, offset %.4f)\n",
+		       argv[i],
+		       voxelized->points.size(),
+		       t_ransac * 1000.,
+		       inliers_ransac.indices.size(),
+		       t_track * 1000.,
+		       tracked ? "tracked" : "lost",
+		       inliers_track.indices.size(),
+		       angle,
+		       offset);
+
+		sum_ransac += t_ransac;
+		sum_track += t_track;
+		++num_frames;
+
+		// re-initialize from RANSAC if lost, as the plugin would
+		if (!tracked)
+			tracker.set_plane(coeff_ransac);
+	}
+
+	if (num_frames > 0) {
+		printf("\n%u frames, %u tracked, avg RANSAC %.3f ms, avg tracking %.3f ms\n",
+		       num_frames,
+		       num_tracked,
+		       sum_ransac / num_frames * 1000.,
+		       sum_track / num_frames * 1000.);
+	}
+	return 0;
+}
+
+/// @endcond
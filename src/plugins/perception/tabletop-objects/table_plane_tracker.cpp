@@ -0,0 +1,208 @@
+
+/***************************************************************************
+ *  table_plane_tracker.cpp - Track table plane from frame to frame
+ *
+ *  Created: Sat Oct 17 20:12:37 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "table_plane_tracker.h"
+
+#include <pcl/features/normal_3d.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/** @class TablePlaneTracker "table_plane_tracker.h"
+ * Track table plane from frame to frame.
+ * Finding the table plane with RANSAC in every frame is expensive, but
+ * the table usually moves only slightly relative to the camera between
+ * two frames. The tracker takes the plane from the previous frame as a
+ * hypothesis and checks it against the new frame. If enough points are
+ * close to the plane, and the mean residual of these points is small, the
+ * plane is refined by a least-squares fit to the inliers. Otherwise
+ * tracking fails and the caller must run a full segmentation again and
+ * set the result with set_plane().
+ * @author agent
+ */
+
+/** Constructor.
+ * @param distance_threshold maximum distance of a point to the plane to
+ * be considered an inlier
+ * @param min_inlier_quota minimum fraction of points which must be
+ * inliers for the plane to be tracked
+ * @param max_mean_residual maximum mean distance of the inliers to the
+ * plane for the plane to be tracked
+ */
+TablePlaneTracker::TablePlaneTracker(float distance_threshold,
+                                     float min_inlier_quota,
+                                     float max_mean_residual)
+: distance_threshold_(distance_threshold),
+  min_inlier_quota_(min_inlier_quota),
+  max_mean_residual_(max_mean_residual)
+{
+	reset();
+}
+
+/** Set plane to track.
+ * @param coeff plane coefficients in Hessian normal form
+ */
+void
+TablePlaneTracker::set_plane(const pcl::ModelCoefficients &coeff)
+{
+	if (coeff.values.size() != 4) {
+		reset();
+		return;
+	}
+	plane_ = Eigen::Vector4f(coeff.values[0], coeff.values[1], coeff.values[2], coeff.values[3]);
+	float norm = plane_.head<3>().norm();
+	if (norm == 0.) {
+		reset();
+		return;
+	}
+	plane_ /= norm;
+	has_plane_ = true;
+}
+
+/** Forget the tracked plane. */
+void
+TablePlaneTracker::reset()
+{
+	has_plane_     = false;
+	plane_         = Eigen::Vector4f::Zero();
+	mean_residual_ = 0.;
+	inlier_quota_  = 0.;
+}
+
+/** Check if a plane is tracked.
+ * @return true if a plane has been set and not been lost since
+ */
+bool
+TablePlaneTracker::has_plane() const
+{
+	return has_plane_;
+}
+
+/** Track plane in new frame.
+ * @param cloud cloud of the new frame, typically voxelized
+ * @param coeff upon success contains the refined plane coefficients
+ * @param inliers upon success contains the indices of the points close
+ * to the plane
+ * @return true if the plane could be tracked, false if a full
+ * segmentation is required
+ */
+bool
+TablePlaneTracker::track(const pcl::PointCloud<pcl::PointXYZ> &cloud,
+                         pcl::ModelCoefficients &              coeff,
+                         pcl::PointIndices &                   inliers)
+{
+	if (!has_plane_ || cloud.points.empty())
+		return false;
+
+	inliers.indices.clear();
+	inliers.indices.reserve(cloud.points.size());
+
+	double residual_sum = 0.;
+	for (size_t i = 0; i < cloud.points.size(); ++i) {
+		const pcl::PointXYZ &p = cloud.points[i];
+		float d = fabsf(plane_[0] * p.x + plane_[1] * p.y + plane_[2] * p.z + plane_[3]);
+		if (d <= distance_threshold_) {
+			inliers.indices.push_back(i);
+			residual_sum += d;
+		}
+	}
+
+	inlier_quota_ = (float)inliers.indices.size() / (float)cloud.points.size();
+	if (inliers.indices.size() < 3 || inlier_quota_ < min_inlier_quota_) {
+		has_plane_ = false;
+		return false;
+	}
+	mean_residual_ = residual_sum / inliers.indices.size();
+	if (mean_residual_ > max_mean_residual_) {
+		has_plane_ = false;
+		return false;
+	}
+
+	Eigen::Vector4f refined;
+	float           curvature;
+	if (!pcl::computePointNormal(cloud, inliers.indices, refined, curvature)
+	    || !std::isfinite(refined[3])) {
+		has_plane_ = false;
+		return false;
+	}
+	// keep the orientation of the tracked plane
+	if (refined.head<3>().dot(plane_.head<3>()) < 0.) {
+		refined *= -1.;
+	}
+	plane_ = refined;
+
+	coeff.values.resize(4);
+	for (unsigned int i = 0; i < 4; ++i)
+		coeff.values[i] = plane_[i];
+	coeff.header = cloud.header;
+	return true;
+}
+
+/** Get mean residual of last tracking attempt.
+ * @return mean distance of the inliers to the plane
+ */
+float
+TablePlaneTracker::mean_residual() const
+{
+	return mean_residual_;
+}
+
+/** Get inlier quota of last tracking attempt.
+ * @return fraction of points close to the plane
+ */
+float
+TablePlaneTracker::inlier_quota() const
+{
+	return inlier_quota_;
+}
+
+/** Calculate difference of two planes.
+ * The orientation of the normals is ignored.
+ * @param a first plane in Hessian normal form
+ * @param b second plane in Hessian normal form
+ * @param angle upon return contains the angle between the normals
+ * @param offset upon return contains the difference of the distances of
+ * the planes to the origin
+ */
+void
+TablePlaneTracker::plane_difference(const pcl::ModelCoefficients &a,
+                                    const pcl::ModelCoefficients &b,
+                                    float &                       angle,
+                                    float &                       offset)
+{
+	if (a.values.size() != 4 || b.values.size() != 4) {
+		angle = offset = std::numeric_limits<float>::max();
+		return;
+	}
+
+	Eigen::Vector4f pa(a.values[0], a.values[1], a.values[2], a.values[3]);
+	Eigen::Vector4f pb(b.values[0], b.values[1], b.values[2], b.values[3]);
+	pa /= pa.head<3>().norm();
+	pb /= pb.head<3>().norm();
+	if (pa.head<3>().dot(pb.head<3>()) < 0.) {
+		pb *= -1.;
+	}
+
+	float cos_angle = std::min(1.f, std::max(-1.f, pa.head<3>().dot(pb.head<3>())));
+	angle           = acosf(cos_angle);
+	offset          = fabsf(pa[3] - pb[3]);
+}
@@ -0,0 +1,66 @@
+
+/***************************************************************************
+ *  table_plane_tracker.h - Track table plane from frame to frame
+ *
+ *  Created: Sat Oct 17 20:12:37 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_PERCEPTION_TABLETOP_OBJECTS_TABLE_PLANE_TRACKER_H_
+#define _PLUGINS_PERCEPTION_TABLETOP_OBJECTS_TABLE_PLANE_TRACKER_H_
+
+#include <pcl/ModelCoefficients.h>
+#include <pcl/PointIndices.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <Eigen/Core>
+
+class TablePlaneTracker
+{
+public:
+	TablePlaneTracker(float distance_threshold, float min_inlier_quota, float max_mean_residual);
+
+	void set_plane(const pcl::ModelCoefficients &coeff);
+	void reset();
+	bool has_plane() const;
+
+	bool track(const pcl::PointCloud<pcl::PointXYZ> &cloud,
+	           pcl::ModelCoefficients &              coeff,
+	           pcl::PointIndices &                   inliers);
+
+	float mean_residual() const;
+	float inlier_quota() const;
+
+	static void plane_difference(const pcl::ModelCoefficients &a,
+	                             const pcl::ModelCoefficients &b,
+	                             float &                       angle,
+	                             float &                       offset);
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+	float distance_threshold_;
+	float min_inlier_quota_;
+	float max_mean_residual_;
+
+	bool            has_plane_;
+	Eigen::Vector4f plane_;
+	float           mean_residual_;
+	float           inlier_quota_;
+};
+
+#endif
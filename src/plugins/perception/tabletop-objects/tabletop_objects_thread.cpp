@@ -22,6 +22,8 @@
 #include "tabletop_objects_thread.h"
 
 #include "cluster_colors.h"
+#include "cylinder_fitting_worker.h"
+#include "table_plane_tracker.h"
 #ifdef HAVE_VISUAL_DEBUGGING
 #	include "visualization_thread_base.h"
 #endif
@@ -33,6 +35,9 @@
 #ifdef USE_TIMETRACKER
 #	include <utils/time/tracker.h>
 #endif
+#include <core/threading/barrier.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
 #include <interfaces/Position3DInterface.h>
 #include <interfaces/SwitchInterface.h>
 #include <pcl/ModelCoefficients.h>
@@ -58,7 +63,10 @@
 #include <utils/time/tracker_macros.h>
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <iostream>
+#include <thread>
 using namespace std;
 
 #define CFG_PREFIX "/perception/tabletop-objects/"
@@ -124,13 +132,54 @@ TabletopObjectsThread::init()
 	} catch (const Exception &e) {
 		cfg_verbose_cylinder_fitting_ = false;
 	}
+	try {
+		cfg_cylinder_fitting_threads_ = config->get_uint(CFG_PREFIX "cylinder_fitting_threads");
+	} catch (const Exception &e) {
+		cfg_cylinder_fitting_threads_ = 1;
+	}
+	if (cfg_cylinder_fitting_threads_ == 0) {
+		cfg_cylinder_fitting_threads_ = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	try {
+		cfg_incremental_ = config->get_bool(CFG_PREFIX "incremental/enable");
+	} catch (const Exception &e) {
+		cfg_incremental_ = false;
+	}
+	try {
+		cfg_inc_max_age_ = config->get_uint(CFG_PREFIX "incremental/max_age");
+	} catch (const Exception &e) {
+		cfg_inc_max_age_ = 30;
+	}
+	try {
+		cfg_inc_max_mean_residual_ = config->get_float(CFG_PREFIX "incremental/max_mean_residual");
+	} catch (const Exception &e) {
+		cfg_inc_max_mean_residual_ = 0.01;
+	}
+	try {
+		cfg_inc_hull_max_angle_change_ =
+		  deg2rad(config->get_float(CFG_PREFIX "incremental/hull_max_angle_change"));
+	} catch (const Exception &e) {
+		cfg_inc_hull_max_angle_change_ = deg2rad(2.0);
+	}
+	try {
+		cfg_inc_hull_max_offset_change_ =
+		  config->get_float(CFG_PREFIX "incremental/hull_max_offset_change");
+	} catch (const Exception &e) {
+		cfg_inc_hull_max_offset_change_ = 0.01;
+	}
+	try {
+		cfg_inc_roi_max_height_ = config->get_float(CFG_PREFIX "incremental/roi_max_height");
+	} catch (const Exception &e) {
+		cfg_inc_roi_max_height_ = 0.;
+	}
 
 	if (pcl_manager->exists_pointcloud<PointType>(cfg_input_pointcloud_.c_str())) {
-		finput_ = pcl_manager->get_pointcloud<PointType>(cfg_input_pointcloud_.c_str());
+		finput_ = pcl_manager->acquire_pointcloud<PointType>(cfg_input_pointcloud_.c_str());
 		input_  = pcl_utils::cloudptr_from_refptr(finput_);
 	} else if (pcl_manager->exists_pointcloud<ColorPointType>(cfg_input_pointcloud_.c_str())) {
 		logger->log_warn(name(), "XYZ/RGB input point cloud, conversion required");
-		fcoloredinput_ = pcl_manager->get_pointcloud<ColorPointType>(cfg_input_pointcloud_.c_str());
+		fcoloredinput_ = pcl_manager->acquire_pointcloud<ColorPointType>(cfg_input_pointcloud_.c_str());
 		colored_input_ = pcl_utils::cloudptr_from_refptr(fcoloredinput_);
 		converted_input_.reset(new Cloud());
 		input_                            = converted_input_;
@@ -254,9 +303,20 @@ TabletopObjectsThread::init()
 	seg_.setMaxIterations(cfg_segm_max_iterations_);
 	seg_.setDistanceThreshold(cfg_segm_distance_threshold_);
 
+	plane_tracker_ = new TablePlaneTracker(cfg_segm_distance_threshold_,
+	                                       cfg_segm_inlier_quota_,
+	                                       cfg_inc_max_mean_residual_);
+
+	inc_age_             = 0;
+	inc_hull_valid_      = false;
+	inc_num_tracked_     = 0;
+	inc_num_full_        = 0;
+	inc_num_hull_reused_ = 0;
+
 	loop_count_ = 0;
 
 	last_pcl_time_ = new Time(clock);
+	last_pcl_seq_  = 0;
 
 	first_run_ = true;
 
@@ -272,6 +332,7 @@ TabletopObjectsThread::init()
 	ttc_convert_            = tt_->add_class("Input Conversion");
 	ttc_voxelize_           = tt_->add_class("Downsampling");
 	ttc_plane_              = tt_->add_class("Plane Segmentation");
+	ttc_hull_reuse_         = tt_->add_class("Table Hull Reuse");
 	ttc_extract_plane_      = tt_->add_class("Plane Extraction");
 	ttc_plane_downsampling_ = tt_->add_class("Plane Downsampling");
 	ttc_cluster_plane_      = tt_->add_class("Plane Clustering");
@@ -284,16 +345,31 @@ TabletopObjectsThread::init()
 	ttc_polygon_filter_     = tt_->add_class("Polygon Filter");
 	ttc_table_to_output_    = tt_->add_class("Table to Output");
 	ttc_cluster_objects_    = tt_->add_class("Object Clustering");
+	ttc_cylinder_fitting_   = tt_->add_class("Cylinder Fitting");
 	ttc_visualization_      = tt_->add_class("Visualization");
 	ttc_hungarian_          = tt_->add_class("Hungarian Method (centroids)");
 	ttc_old_centroids_      = tt_->add_class("Old Centroid Removal");
 	ttc_obj_extraction_     = tt_->add_class("Object Extraction");
 #endif
+
+	// the tabletop thread fits clusters itself, the workers help it
+	for (unsigned int i = 1; i < cfg_cylinder_fitting_threads_; ++i) {
+		CylinderFittingWorker *worker = new CylinderFittingWorker(i);
+		worker->start();
+		fitting_workers_.push_back(worker);
+	}
 }
 
 void
 TabletopObjectsThread::finalize()
 {
+	for (CylinderFittingWorker *worker : fitting_workers_) {
+		worker->cancel();
+		worker->join();
+		delete worker;
+	}
+	fitting_workers_.clear();
+
 	input_.reset();
 	clusters_.reset();
 	simplified_polygon_.reset();
@@ -313,7 +389,10 @@ TabletopObjectsThread::finalize()
 	fclusters_.reset();
 	ftable_model_.reset();
 	fsimplified_polygon_.reset();
+	inc_hull_.reset();
+	inc_hull_proj_.reset();
 
+	delete plane_tracker_;
 	delete last_pcl_time_;
 #ifdef USE_TIMETRACKER
 	delete tt_;
@@ -388,14 +467,32 @@ TabletopObjectsThread::loop()
 
 	TIMETRACK_END(ttc_msgproc_);
 
+	// block until the producer publishes a new cloud, producers which
+	// never publish are polled by the time stamp of the cloud below
+	if (pcl_manager->published_seq(cfg_input_pointcloud_.c_str()) > 0
+	    && !pcl_manager->wait_pointcloud(cfg_input_pointcloud_.c_str(), last_pcl_seq_, 250)) {
+		TIMETRACK_ABORT(ttc_full_loop_);
+		return;
+	}
+
+	// hold on to the latest published cloud while processing it, the
+	// producer will not modify it as long as we reference it
 	fawkes::Time pcl_time;
 	if (colored_input_) {
+		fcoloredinput_ = pcl_manager->acquire_pointcloud<ColorPointType>(cfg_input_pointcloud_.c_str(),
+		                                                                 &last_pcl_seq_);
+		colored_input_ = pcl_utils::cloudptr_from_refptr(fcoloredinput_);
 		pcl_utils::get_time(colored_input_, pcl_time);
 	} else {
+		finput_ = pcl_manager->acquire_pointcloud<PointType>(cfg_input_pointcloud_.c_str(),
+		                                                     &last_pcl_seq_);
+		input_  = pcl_utils::cloudptr_from_refptr(finput_);
 		pcl_utils::get_time(input_, pcl_time);
 	}
 	if (*last_pcl_time_ == pcl_time) {
-		TimeWait::wait(20000);
+		if (last_pcl_seq_ == 0) {
+			TimeWait::wait(20000);
+		}
 		TIMETRACK_ABORT(ttc_full_loop_);
 		return;
 	}
@@ -445,6 +542,11 @@ TabletopObjectsThread::loop()
 	// Planes found along the way not satisfying any of the criteria are removed,
 	// the first plane either satisfying all criteria, or violating the first
 	// one end the loop
+	// In incremental mode the plane of the previous loop is tried first. If
+	// it can be tracked it is subject to the same criteria, only the RANSAC
+	// run is saved. Every max_age loops a full segmentation is enforced.
+	bool plane_tracked = (cfg_incremental_ && (inc_age_ < cfg_inc_max_age_)
+	                      && plane_tracker_->track(*temp_cloud, *coeff, *inliers));
 	bool happy_with_plane = false;
 	while (!happy_with_plane) {
 		happy_with_plane = true;
@@ -460,8 +562,10 @@ TabletopObjectsThread::loop()
 			return;
 		}
 
-		seg_.setInputCloud(temp_cloud);
-		seg_.segment(*inliers, *coeff);
+		if (!plane_tracked) {
+			seg_.setInputCloud(temp_cloud);
+			seg_.segment(*inliers, *coeff);
+		}
 
 		// 1. check for a minimum number of expected inliers
 		if ((double)inliers->indices.size()
@@ -546,6 +650,10 @@ TabletopObjectsThread::loop()
 
 		if (!happy_with_plane) {
 			// throw away
+			if (plane_tracked) {
+				plane_tracker_->reset();
+				plane_tracked = false;
+			}
 			Cloud extracted;
 			extract_.setNegative(true);
 			extract_.setInputCloud(temp_cloud);
@@ -559,110 +667,159 @@ TabletopObjectsThread::loop()
 	// Do NOT set it here, we will still try to determine the rotation as well
 	// set_position(table_pos_if_, true, table_centroid);
 
-	TIMETRACK_INTER(ttc_plane_, ttc_extract_plane_)
+	// The hull of the previous loop can be reused if the plane has been
+	// tracked and did not move considerably since the hull was computed.
+	bool reuse_hull = false;
+	if (cfg_incremental_) {
+		if (plane_tracked) {
+			inc_age_ += 1;
+			inc_num_tracked_ += 1;
+			if (inc_hull_valid_) {
+				float angle, offset;
+				TablePlaneTracker::plane_difference(*coeff, inc_hull_coeff_, angle, offset);
+				reuse_hull = ((angle <= cfg_inc_hull_max_angle_change_)
+				              && (offset <= cfg_inc_hull_max_offset_change_));
+			}
+		} else {
+			plane_tracker_->set_plane(*coeff);
+			inc_age_ = 0;
+			inc_num_full_ += 1;
+		}
+		if ((loop_count_ % 100) == 0) {
+			logger->log_debug(name(),
+			                  "[L %u] incremental: %u tracked, %u full segmentations, %u hulls reused",
+			                  loop_count_,
+			                  inc_num_tracked_,
+			                  inc_num_full_,
+			                  inc_num_hull_reused_);
+		}
+	}
 
-	extract_.setNegative(false);
 	extract_.setInputCloud(temp_cloud);
 	extract_.setIndices(inliers);
-	extract_.filter(*temp_cloud2);
-
-	// Project the model inliers
-	pcl::ProjectInliers<PointType> proj;
-	proj.setModelType(pcl::SACMODEL_PLANE);
-	proj.setInputCloud(temp_cloud2);
-	proj.setModelCoefficients(coeff);
-	cloud_proj_.reset(new Cloud());
-	proj.filter(*cloud_proj_);
-
-	TIMETRACK_INTER(ttc_extract_plane_, ttc_plane_downsampling_);
-
-	// ***
-	// In the following cluster the projected table plane. This is done to get
-	// the largest continuous part of the plane to remove outliers, for instance
-	// if the intersection of the plane with a wall or object is taken into the
-	// table points.
-	// To achieve this cluster, if an acceptable cluster was found, extract this
-	// cluster as the new table points. Otherwise continue with the existing
-	// point cloud.
-
-	// further downsample table
-	CloudPtr                  cloud_table_voxelized(new Cloud());
-	pcl::VoxelGrid<PointType> table_grid;
-	table_grid.setLeafSize(cfg_table_downsample_leaf_size_,
-	                       cfg_table_downsample_leaf_size_,
-	                       cfg_table_downsample_leaf_size_);
-	table_grid.setInputCloud(cloud_proj_);
-	table_grid.filter(*cloud_table_voxelized);
-
-	TIMETRACK_INTER(ttc_plane_downsampling_, ttc_cluster_plane_);
 
-	// Creating the KdTree object for the search method of the extraction
-	pcl::search::KdTree<PointType>::Ptr kdtree_table(new pcl::search::KdTree<PointType>());
-	kdtree_table->setInputCloud(cloud_table_voxelized);
-
-	std::vector<pcl::PointIndices>             table_cluster_indices;
-	pcl::EuclideanClusterExtraction<PointType> table_ec;
-	table_ec.setClusterTolerance(cfg_table_cluster_tolerance_);
-	table_ec.setMinClusterSize(cfg_table_min_cluster_quota_ * cloud_table_voxelized->points.size());
-	table_ec.setMaxClusterSize(cloud_table_voxelized->points.size());
-	table_ec.setSearchMethod(kdtree_table);
-	table_ec.setInputCloud(cloud_table_voxelized);
-	table_ec.extract(table_cluster_indices);
-
-	if (!table_cluster_indices.empty()) {
-		// take the first, i.e. the largest cluster
-		CloudPtr                    cloud_table_extracted(new Cloud());
-		pcl::PointIndices::ConstPtr table_cluster_indices_ptr(
-		  new pcl::PointIndices(table_cluster_indices[0]));
-		pcl::ExtractIndices<PointType> table_cluster_extract;
-		table_cluster_extract.setNegative(false);
-		table_cluster_extract.setInputCloud(cloud_table_voxelized);
-		table_cluster_extract.setIndices(table_cluster_indices_ptr);
-		table_cluster_extract.filter(*cloud_table_extracted);
-		*cloud_proj_ = *cloud_table_extracted;
-
-		// recompute based on the new chosen table cluster
-		pcl::compute3DCentroid(*cloud_proj_, table_centroid);
+	if (reuse_hull) {
+		TIMETRACK_INTER(ttc_plane_, ttc_hull_reuse_)
 
+		inc_num_hull_reused_ += 1;
+		cloud_proj_    = inc_hull_proj_;
+		cloud_hull_    = inc_hull_;
+		table_centroid = inc_hull_centroid_;
+
+		TIMETRACK_INTER(ttc_hull_reuse_, ttc_find_edge_)
 	} else {
-		// Don't mess with the table, clustering didn't help to make it any better
-		logger->log_info(name(),
-		                 "[L %u] table plane clustering did not generate any clusters",
-		                 loop_count_);
-	}
+		TIMETRACK_INTER(ttc_plane_, ttc_extract_plane_)
+
+		extract_.setNegative(false);
+		extract_.filter(*temp_cloud2);
+
+		// Project the model inliers
+		pcl::ProjectInliers<PointType> proj;
+		proj.setModelType(pcl::SACMODEL_PLANE);
+		proj.setInputCloud(temp_cloud2);
+		proj.setModelCoefficients(coeff);
+		cloud_proj_.reset(new Cloud());
+		proj.filter(*cloud_proj_);
+
+		TIMETRACK_INTER(ttc_extract_plane_, ttc_plane_downsampling_);
+
+		// ***
+		// In the following cluster the projected table plane. This is done to get
+		// the largest continuous part of the plane to remove outliers, for instance
+		// if the intersection of the plane with a wall or object is taken into the
+		// table points.
+		// To achieve this cluster, if an acceptable cluster was found, extract this
+		// cluster as the new table points. Otherwise continue with the existing
+		// point cloud.
+
+		// further downsample table
+		CloudPtr                  cloud_table_voxelized(new Cloud());
+		pcl::VoxelGrid<PointType> table_grid;
+		table_grid.setLeafSize(cfg_table_downsample_leaf_size_,
+		                       cfg_table_downsample_leaf_size_,
+		                       cfg_table_downsample_leaf_size_);
+		table_grid.setInputCloud(cloud_proj_);
+		table_grid.filter(*cloud_table_voxelized);
+
+		TIMETRACK_INTER(ttc_plane_downsampling_, ttc_cluster_plane_);
+
+		// Creating the KdTree object for the search method of the extraction
+		pcl::search::KdTree<PointType>::Ptr kdtree_table(new pcl::search::KdTree<PointType>());
+		kdtree_table->setInputCloud(cloud_table_voxelized);
+
+		std::vector<pcl::PointIndices>             table_cluster_indices;
+		pcl::EuclideanClusterExtraction<PointType> table_ec;
+		table_ec.setClusterTolerance(cfg_table_cluster_tolerance_);
+		table_ec.setMinClusterSize(cfg_table_min_cluster_quota_ * cloud_table_voxelized->points.size());
+		table_ec.setMaxClusterSize(cloud_table_voxelized->points.size());
+		table_ec.setSearchMethod(kdtree_table);
+		table_ec.setInputCloud(cloud_table_voxelized);
+		table_ec.extract(table_cluster_indices);
+
+		if (!table_cluster_indices.empty()) {
+			// take the first, i.e. the largest cluster
+			CloudPtr                    cloud_table_extracted(new Cloud());
+			pcl::PointIndices::ConstPtr table_cluster_indices_ptr(
+			  new pcl::PointIndices(table_cluster_indices[0]));
+			pcl::ExtractIndices<PointType> table_cluster_extract;
+			table_cluster_extract.setNegative(false);
+			table_cluster_extract.setInputCloud(cloud_table_voxelized);
+			table_cluster_extract.setIndices(table_cluster_indices_ptr);
+			table_cluster_extract.filter(*cloud_table_extracted);
+			*cloud_proj_ = *cloud_table_extracted;
+
+			// recompute based on the new chosen table cluster
+			pcl::compute3DCentroid(*cloud_proj_, table_centroid);
 
-	TIMETRACK_INTER(ttc_cluster_plane_, ttc_convex_hull_)
+		} else {
+			// Don't mess with the table, clustering didn't help to make it any better
+			logger->log_info(name(),
+			                 "[L %u] table plane clustering did not generate any clusters",
+			                 loop_count_);
+		}
 
-	// Estimate 3D convex hull -> TABLE BOUNDARIES
-	pcl::ConvexHull<PointType> hr;
+		TIMETRACK_INTER(ttc_cluster_plane_, ttc_convex_hull_)
+
+		// Estimate 3D convex hull -> TABLE BOUNDARIES
+		pcl::ConvexHull<PointType> hr;
 #ifdef PCL_VERSION_COMPARE
 #	if PCL_VERSION_COMPARE(>=, 1, 5, 0)
-	hr.setDimension(2);
+		hr.setDimension(2);
 #	endif
 #endif
 
-	//hr.setAlpha(0.1);  // only for ConcaveHull
-	hr.setInputCloud(cloud_proj_);
-	cloud_hull_.reset(new Cloud());
-	hr.reconstruct(*cloud_hull_);
+		//hr.setAlpha(0.1);  // only for ConcaveHull
+		hr.setInputCloud(cloud_proj_);
+		cloud_hull_.reset(new Cloud());
+		hr.reconstruct(*cloud_hull_);
 
-	if (cloud_hull_->points.empty()) {
-		logger->log_warn(name(), "[L %u] convex hull of table empty, skipping loop", loop_count_);
-		TIMETRACK_ABORT(ttc_convex_hull_);
-		TIMETRACK_ABORT(ttc_full_loop_);
-		set_position(table_pos_if_, false);
-		return;
-	}
+		if (cloud_hull_->points.empty()) {
+			logger->log_warn(name(), "[L %u] convex hull of table empty, skipping loop", loop_count_);
+			inc_hull_valid_ = false;
+			TIMETRACK_ABORT(ttc_convex_hull_);
+			TIMETRACK_ABORT(ttc_full_loop_);
+			set_position(table_pos_if_, false);
+			return;
+		}
 
-	TIMETRACK_INTER(ttc_convex_hull_, ttc_simplify_polygon_)
+		TIMETRACK_INTER(ttc_convex_hull_, ttc_simplify_polygon_)
 
-	CloudPtr simplified_polygon = simplify_polygon(cloud_hull_, 0.02);
-	*simplified_polygon_        = *simplified_polygon;
-	//logger->log_debug(name(), "Original polygon: %zu  simplified: %zu", cloud_hull_->points.size(),
-	//                  simplified_polygon->points.size());
-	*cloud_hull_ = *simplified_polygon;
+		CloudPtr simplified_polygon = simplify_polygon(cloud_hull_, 0.02);
+		*simplified_polygon_        = *simplified_polygon;
+		//logger->log_debug(name(), "Original polygon: %zu  simplified: %zu",
+		//                  cloud_hull_->points.size(), simplified_polygon->points.size());
+		*cloud_hull_ = *simplified_polygon;
 
-	TIMETRACK_INTER(ttc_simplify_polygon_, ttc_find_edge_)
+		if (cfg_incremental_) {
+			inc_hull_coeff_    = *coeff;
+			inc_hull_          = cloud_hull_;
+			inc_hull_proj_     = cloud_proj_;
+			inc_hull_centroid_ = table_centroid;
+			inc_hull_valid_    = true;
+		}
+
+		TIMETRACK_INTER(ttc_simplify_polygon_, ttc_find_edge_)
+	}
 
 #ifdef HAVE_VISUAL_DEBUGGING
 	TabletopVisualizationThreadBase::V_Vector4f good_hull_edges;
@@ -1038,6 +1195,19 @@ TabletopObjectsThread::loop()
 	  new pcl_utils::PlaneDistanceComparison<PointType>(coeff, op));
 	pcl::ConditionAnd<PointType>::Ptr above_cond(new pcl::ConditionAnd<PointType>());
 	above_cond->addComparison(above_comp);
+	if (cfg_incremental_ && (cfg_inc_roi_max_height_ > 0.)) {
+		// restrict region of interest to a slab above the table, everything
+		// higher up cannot be an object standing on the table
+		pcl_utils::PlaneDistanceComparison<PointType>::ConstPtr below_comp(
+		  (op == pcl::ComparisonOps::GT)
+		    ? new pcl_utils::PlaneDistanceComparison<PointType>(coeff,
+		                                                        pcl::ComparisonOps::LT,
+		                                                        cfg_inc_roi_max_height_)
+		    : new pcl_utils::PlaneDistanceComparison<PointType>(coeff,
+		                                                        pcl::ComparisonOps::GT,
+		                                                        -cfg_inc_roi_max_height_));
+		above_cond->addComparison(below_comp);
+	}
 	pcl::ConditionalRemoval<PointType> above_condrem;
 	above_condrem.setCondition(above_cond);
 	above_condrem.setInputCloud(cloud_filt_);
@@ -1261,6 +1431,7 @@ TabletopObjectsThread::cluster_objects(CloudConstPtr               input_cloud,
 	if (num_points > 0) {
 		std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f>> new_centroids(
 		  MAX_CENTROIDS);
+		std::vector<ColorCloudPtr> objs_in_base_frame(MAX_CENTROIDS);
 
 		unsigned int centroid_i = 0;
 
@@ -1300,15 +1471,54 @@ TabletopObjectsThread::cluster_objects(CloudConstPtr               input_cloud,
 			                                *tf_listener);
 
 			pcl::compute3DCentroid(*obj_in_base_frame, new_centroids[centroid_i]);
-
-			if (cfg_cylinder_fitting_) {
-				new_centroids[centroid_i] =
-				  fit_cylinder(obj_in_base_frame, new_centroids[centroid_i], centroid_i);
-			}
+			objs_in_base_frame[centroid_i] = obj_in_base_frame;
 		}
 		object_count = centroid_i;
 		new_centroids.resize(object_count);
 
+		if (cfg_cylinder_fitting_ && object_count > 0) {
+			TIMETRACK_START(ttc_cylinder_fitting_);
+			// The clusters are independent of each other, fit them in parallel.
+			// fit_cylinder() only writes to the entries of its own cluster,
+			// create them beforehand so that the maps are not modified concurrently.
+			for (unsigned int i = 0; i < object_count; ++i) {
+				cylinder_params_[i]      = Eigen::Vector4f(0, 0, 0, 0);
+				obj_shape_confidence_[i] = 0.0;
+				best_obj_guess_[i]       = -1;
+			}
+
+			std::atomic<unsigned int> next_cluster(0);
+			std::exception_ptr        fitting_error;
+			Mutex                     fitting_error_mutex;
+
+			auto fit_clusters = [&]() {
+				try {
+					for (unsigned int i = next_cluster++; i < object_count; i = next_cluster++) {
+						new_centroids[i] = fit_cylinder(objs_in_base_frame[i], new_centroids[i], i);
+					}
+				} catch (...) {
+					MutexLocker lock(&fitting_error_mutex);
+					if (!fitting_error)
+						fitting_error = std::current_exception();
+				}
+			};
+
+			unsigned int num_workers =
+			  std::min((unsigned int)fitting_workers_.size(), object_count - 1);
+			Barrier barrier(num_workers + 1);
+			for (unsigned int w = 0; w < num_workers; ++w) {
+				fitting_workers_[w]->set_job(fit_clusters);
+				fitting_workers_[w]->wakeup(&barrier);
+			}
+			fit_clusters();
+			barrier.wait();
+			if (fitting_error) {
+				TIMETRACK_ABORT(ttc_cylinder_fitting_);
+				std::rethrow_exception(fitting_error);
+			}
+			TIMETRACK_END(ttc_cylinder_fitting_);
+		}
+
 		// save cylinder fitting variables
 		// to temporary variables to be able to reassign IDs
 		CentroidMap                         cylinder_params(cylinder_params_);
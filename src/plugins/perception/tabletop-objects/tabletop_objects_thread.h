@@ -58,6 +58,8 @@ class TimeTracker;
 #ifdef HAVE_VISUAL_DEBUGGING
 class TabletopVisualizationThreadBase;
 #endif
+class TablePlaneTracker;
+class CylinderFittingWorker;
 
 /** @class OldCentroid "tabletop_objects_thread.h"
  * This class is used to save old centroids in order to check for reappearance.
@@ -273,6 +275,7 @@ private:
 	fawkes::SwitchInterface *switch_if_;
 
 	fawkes::Time *last_pcl_time_;
+	uint64_t      last_pcl_seq_;
 
 	float        cfg_depth_filter_min_x_;
 	float        cfg_depth_filter_max_x_;
@@ -305,6 +308,15 @@ private:
 	bool         cfg_cylinder_fitting_;
 	bool         cfg_track_objects_;
 	bool         cfg_verbose_cylinder_fitting_;
+	unsigned int cfg_cylinder_fitting_threads_;
+
+	std::vector<CylinderFittingWorker *> fitting_workers_;
+	bool         cfg_incremental_;
+	unsigned int cfg_inc_max_age_;
+	float        cfg_inc_max_mean_residual_;
+	float        cfg_inc_hull_max_angle_change_;
+	float        cfg_inc_hull_max_offset_change_;
+	float        cfg_inc_roi_max_height_;
 
 	fawkes::RefPtr<Cloud> ftable_model_;
 	CloudPtr              table_model_;
@@ -320,6 +332,17 @@ private:
 
 	std::map<uint, std::vector<double>> obj_likelihoods_;
 
+	TablePlaneTracker *    plane_tracker_;
+	unsigned int           inc_age_;
+	bool                   inc_hull_valid_;
+	pcl::ModelCoefficients inc_hull_coeff_;
+	CloudPtr               inc_hull_;
+	CloudPtr               inc_hull_proj_;
+	Eigen::Vector4f        inc_hull_centroid_;
+	unsigned int           inc_num_tracked_;
+	unsigned int           inc_num_full_;
+	unsigned int           inc_num_hull_reused_;
+
 #ifdef USE_TIMETRACKER
 	fawkes::TimeTracker *tt_;
 	unsigned int         tt_loopcount_;
@@ -328,6 +351,7 @@ private:
 	unsigned int         ttc_convert_;
 	unsigned int         ttc_voxelize_;
 	unsigned int         ttc_plane_;
+	unsigned int         ttc_hull_reuse_;
 	unsigned int         ttc_extract_plane_;
 	unsigned int         ttc_plane_downsampling_;
 	unsigned int         ttc_cluster_plane_;
@@ -340,6 +364,7 @@ private:
 	unsigned int         ttc_polygon_filter_;
 	unsigned int         ttc_table_to_output_;
 	unsigned int         ttc_cluster_objects_;
+	unsigned int         ttc_cylinder_fitting_;
 	unsigned int         ttc_visualization_;
 	unsigned int         ttc_hungarian_;
 	unsigned int         ttc_old_centroids_;
@@ -55,6 +55,7 @@ Realsense2Thread::init()
 	laser_power_ = config->get_float_or_default((cfg_prefix + "laser_power").c_str(), -1);
 
 	cfg_use_switch_ = config->get_bool_or_default((cfg_prefix + "use_switch").c_str(), true);
+	cfg_shm_slots_  = config->get_uint_or_default((cfg_prefix + "shm_slots").c_str(), 0);
 
 	if (cfg_use_switch_) {
 		logger->log_info(name(), "Switch enabled");
@@ -105,7 +106,12 @@ Realsense2Thread::loop()
 		rs2::frame depth_frame = rs_data_.first(RS2_STREAM_DEPTH);
 		error_counter_         = 0;
 		const uint16_t *image  = reinterpret_cast<const uint16_t *>(depth_frame.get_data());
-		Cloud::iterator it     = realsense_depth_->begin();
+
+		fawkes::RefPtr<Cloud> cloud = pcl_manager->writable_pointcloud<PointType>(pcl_id_.c_str());
+		cloud->width                = intrinsics_.width;
+		cloud->height               = intrinsics_.height;
+		cloud->resize(intrinsics_.width * intrinsics_.height);
+		Cloud::iterator it = cloud->begin();
 		for (int y = 0; y < intrinsics_.height; y++) {
 			for (int x = 0; x < intrinsics_.width; x++) {
 				float scaled_depth = camera_scale_ * (static_cast<float>(*image));
@@ -119,7 +125,8 @@ Realsense2Thread::loop()
 				++it;
 			}
 		}
-		pcl_utils::set_time(realsense_depth_refptr_, fawkes::Time(clock));
+		pcl_utils::set_time(cloud, fawkes::Time(clock));
+		pcl_manager->publish_pointcloud(pcl_id_.c_str());
 	} else {
 		error_counter_++;
 		logger->log_warn(name(), "Poll for frames not successful ()");
@@ -167,6 +174,11 @@ Realsense2Thread::start_camera()
 		realsense_depth_->width  = intrinsics_.width;
 		realsense_depth_->height = intrinsics_.height;
 		realsense_depth_->resize(intrinsics_.width * intrinsics_.height);
+		if (cfg_shm_slots_ > 0) {
+			pcl_manager->share_pointcloud(pcl_id_.c_str(),
+			                              intrinsics_.width * intrinsics_.height,
+			                              cfg_shm_slots_);
+		}
 		rs2::depth_sensor sensor = rs_device_.first<rs2::depth_sensor>();
 		camera_scale_            = sensor.get_depth_scale();
 		logger->log_info(name(),
@@ -80,6 +80,7 @@ protected:
 private:
 	fawkes::SwitchInterface *switch_if_;
 	bool                     cfg_use_switch_;
+	unsigned int             cfg_shm_slots_;
 
 	typedef pcl::PointXYZ              PointType;
 	typedef pcl::PointCloud<PointType> Cloud;
@@ -0,0 +1,148 @@
+/***************************************************************************
+ *  client_pool.cpp - Per-thread MongoDB clients for the robot memory
+ *
+ *  Created: Sat Oct 17 22:18:44 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "client_pool.h"
+
+#include <core/threading/mutex_locker.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace fawkes;
+
+/// @cond INTERNALS
+/** Release the clients of a thread once it exits. */
+class ClientPool::ThreadReleaser
+{
+public:
+	~ThreadReleaser()
+	{
+		std::thread::id id = std::this_thread::get_id();
+		for (auto &p : pools) {
+			std::shared_ptr<Clients> clients = p.lock();
+			if (clients) {
+				ClientPool::release(clients.get(), id);
+			}
+		}
+	}
+
+	std::vector<std::weak_ptr<Clients>> pools;
+};
+/// @endcond
+
+/** @class ClientPool "client_pool.h"
+ * Per-thread MongoDB clients for the robot memory.
+ * A mongocxx::client must not be used by multiple threads at the same
+ * time. Instead of serializing all operations on a single client, each
+ * thread accessing the robot memory gets its own client, which is created
+ * on first use. Operations from different threads then run in parallel.
+ * Since a thread always gets the same client, cursors returned by a query
+ * remain valid while the thread continues to use the robot memory.
+ *
+ * The client of a thread is deleted when the thread exits, or earlier
+ * if the thread calls release(). Threads using the robot memory come
+ * and go, e.g., when plugins are loaded and unloaded, their clients and
+ * connections must not accumulate.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param conn_creator MongoDB connection creator to create clients with
+ * @param config_name MongoDB client configuration name
+ */
+ClientPool::ClientPool(MongoDBConnCreator *conn_creator, const std::string &config_name)
+: config_name_(config_name), clients_(std::make_shared<Clients>())
+{
+	clients_->conn_creator = conn_creator;
+}
+
+/** Destructor. */
+ClientPool::~ClientPool()
+{
+	// threads exiting later may still reference the shared client map,
+	// leave it empty such that they do not use the connection creator
+	MutexLocker lock(&clients_->mutex);
+	for (auto &c : clients_->clients) {
+		clients_->conn_creator->delete_client(c.second);
+	}
+	clients_->clients.clear();
+}
+
+/** Get client of the calling thread.
+ * @return client exclusively used by the calling thread
+ * @exception Exception thrown if the client cannot be created
+ */
+mongocxx::client *
+ClientPool::client()
+{
+	std::thread::id id = std::this_thread::get_id();
+
+	MutexLocker lock(&clients_->mutex);
+	auto        c = clients_->clients.find(id);
+	if (c != clients_->clients.end()) {
+		return c->second;
+	}
+	// creation may throw, in which case the next call tries again
+	mongocxx::client *client = clients_->conn_creator->create_client(config_name_);
+	clients_->clients[id]    = client;
+
+	static thread_local ThreadReleaser releaser;
+	releaser.pools.erase(std::remove_if(releaser.pools.begin(),
+	                                    releaser.pools.end(),
+	                                    [](const std::weak_ptr<Clients> &p) { return p.expired(); }),
+	                     releaser.pools.end());
+	releaser.pools.push_back(clients_);
+	return client;
+}
+
+/** Release client of the calling thread.
+ * Cursors and other objects obtained through the client become invalid.
+ * The next call to client() from this thread creates a new client.
+ */
+void
+ClientPool::release()
+{
+	release(clients_.get(), std::this_thread::get_id());
+}
+
+/** Delete client of a thread.
+ * @param clients clients of a pool
+ * @param id ID of thread whose client to delete
+ */
+void
+ClientPool::release(Clients *clients, std::thread::id id)
+{
+	MutexLocker lock(&clients->mutex);
+	auto        c = clients->clients.find(id);
+	if (c != clients->clients.end()) {
+		clients->conn_creator->delete_client(c->second);
+		clients->clients.erase(c);
+	}
+}
+
+/** Get number of clients.
+ * @return number of clients, i.e., threads which used the pool
+ */
+size_t
+ClientPool::size() const
+{
+	MutexLocker lock(&clients_->mutex);
+	return clients_->clients.size();
+}
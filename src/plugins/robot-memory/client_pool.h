@@ -0,0 +1,60 @@
+/***************************************************************************
+ *  client_pool.h - Per-thread MongoDB clients for the robot memory
+ *
+ *  Created: Sat Oct 17 22:18:44 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_ROBOT_MEMORY_CLIENT_POOL_H_
+#define _PLUGINS_ROBOT_MEMORY_CLIENT_POOL_H_
+
+#include <core/threading/mutex.h>
+#include <plugins/mongodb/aspect/mongodb_conncreator.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+class ClientPool
+{
+public:
+	ClientPool(fawkes::MongoDBConnCreator *conn_creator, const std::string &config_name);
+	virtual ~ClientPool();
+
+	mongocxx::client *client();
+	void              release();
+	size_t            size() const;
+
+private:
+	/// @cond INTERNALS
+	struct Clients
+	{
+		fawkes::MongoDBConnCreator *                  conn_creator;
+		fawkes::Mutex                                 mutex;
+		std::map<std::thread::id, mongocxx::client *> clients;
+	};
+	class ThreadReleaser;
+	/// @endcond
+
+	static void release(Clients *clients, std::thread::id id);
+
+private:
+	std::string              config_name_;
+	std::shared_ptr<Clients> clients_;
+};
+
+#endif
@@ -21,6 +21,8 @@
 
 #include "blackboard_computable.h"
 
+#include <core/threading/mutex_locker.h>
+
 #include <bsoncxx/builder/basic/document.hpp>
 
 /** @class BlackboardComputable  blackboard_computable.h
@@ -89,50 +91,26 @@ BlackboardComputable::compute_interfaces(const document::view &query, const std:
 		basic::document doc;
 		doc.append(basic::kvp("interface", interface->type()));
 		doc.append(basic::kvp("id", interface->id()));
-		for (InterfaceFieldIterator it = interface->fields(); it != interface->fields_end(); ++it) {
-			if (it.get_length() > 1 && it.get_type() != IFT_STRING) {
-				doc.append(basic::kvp(std::string(it.get_name()), [it](basic::sub_array array) {
-					for (unsigned int i = 0; i < it.get_length(); i++) {
-						switch (it.get_type()) {
-						case IFT_BOOL: array.append(it.get_bool(i)); break;
-						case IFT_INT8: array.append(it.get_int8(i)); break;
-						case IFT_UINT8: array.append(it.get_uint8(i)); break;
-						case IFT_INT16: array.append(it.get_int16(i)); break;
-						case IFT_UINT16: array.append(it.get_uint16(i)); break;
-						case IFT_INT32: array.append(it.get_int32(i)); break;
-						case IFT_UINT32: array.append(static_cast<int64_t>(it.get_uint32(i))); break;
-						case IFT_INT64: array.append(static_cast<int64_t>(it.get_int64(i))); break;
-						case IFT_UINT64: array.append(static_cast<int64_t>(it.get_uint64(i))); break;
-						case IFT_FLOAT: array.append(it.get_float(i)); break;
-						case IFT_DOUBLE: array.append(it.get_double(i)); break;
-						case IFT_STRING: array.append(it.get_string()); break;
-						case IFT_BYTE: array.append(it.get_byte(i)); break;
-						case IFT_ENUM: array.append(it.get_enum_string(i)); break;
-						}
-					}
-				}));
-			} else {
-				std::string key{it.get_name()};
-				switch (it.get_type()) {
-				case IFT_BOOL: doc.append(basic::kvp(key, it.get_bool())); break;
-				case IFT_INT8: doc.append(basic::kvp(key, it.get_int8())); break;
-				case IFT_UINT8: doc.append(basic::kvp(key, it.get_uint8())); break;
-				case IFT_INT16: doc.append(basic::kvp(key, it.get_int16())); break;
-				case IFT_UINT16: doc.append(basic::kvp(key, it.get_uint16())); break;
-				case IFT_INT32: doc.append(basic::kvp(key, it.get_int32())); break;
-				case IFT_UINT32: doc.append(basic::kvp(key, static_cast<int64_t>(it.get_uint32()))); break;
-				case IFT_INT64: doc.append(basic::kvp(key, static_cast<int64_t>(it.get_int64()))); break;
-				case IFT_UINT64: doc.append(basic::kvp(key, static_cast<int64_t>(it.get_uint64()))); break;
-				case IFT_FLOAT: doc.append(basic::kvp(key, it.get_float())); break;
-				case IFT_DOUBLE: doc.append(basic::kvp(key, it.get_double())); break;
-				case IFT_STRING: doc.append(basic::kvp(key, it.get_string())); break;
-				case IFT_BYTE: doc.append(basic::kvp(key, it.get_byte())); break;
-				case IFT_ENUM: doc.append(basic::kvp(key, it.get_enum_string())); break;
-				}
-			}
-		}
+		serializer(interface)->append(doc, interface);
 		res.push_back(doc.extract());
 		blackboard_->close(interface);
 	}
 	return res;
 }
+
+/** Get serializer for an interface.
+ * Serializers are created once per interface type and reused as long as
+ * the interface hash does not change.
+ * @param interface interface to get the serializer for
+ * @return serializer for the interface
+ */
+std::shared_ptr<InterfaceBsonSerializer>
+BlackboardComputable::serializer(Interface *interface)
+{
+	MutexLocker lock(&serializers_mutex_);
+	auto &      s = serializers_[interface->type()];
+	if (!s || !s->compatible(interface)) {
+		s = std::make_shared<InterfaceBsonSerializer>(interface, /* enums as strings */ true);
+	}
+	return s;
+}
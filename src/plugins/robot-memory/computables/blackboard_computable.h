@@ -27,8 +27,13 @@
 #include <aspect/logging.h>
 #include <blackboard/blackboard.h>
 #include <config/config.h>
+#include <core/threading/mutex.h>
+#include <plugins/mongodb/aspect/interface_serializer.h>
 
 #include <bsoncxx/document/value.hpp>
+#include <map>
+#include <memory>
+#include <string>
 
 /** @class BlackboardComputable  blackboard_computable.h
  *
@@ -46,11 +51,15 @@ public:
 private:
 	std::list<bsoncxx::document::value> compute_interfaces(const bsoncxx::document::view &query,
 	                                                       const std::string &            collection);
+	std::shared_ptr<fawkes::InterfaceBsonSerializer> serializer(fawkes::Interface *interface);
 
 	RobotMemory *       robot_memory_;
 	fawkes::BlackBoard *blackboard_;
 	fawkes::Logger *    logger_;
 	Computable *        computable;
+
+	fawkes::Mutex                                                           serializers_mutex_;
+	std::map<std::string, std::shared_ptr<fawkes::InterfaceBsonSerializer>> serializers_;
 };
 
 #endif /* FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COMPUTABLES_BLACKBOARD_COMPUTABLE_H_ */
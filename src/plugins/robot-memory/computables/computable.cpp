@@ -117,3 +117,13 @@ Computable::get_priority()
 {
 	return priority;
 }
+
+/**
+ * Gets the caching time of the computable
+ * @return How long computed results are cached in milliseconds
+ */
+int
+Computable::get_caching_time()
+{
+	return caching_time;
+}
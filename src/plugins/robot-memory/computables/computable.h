@@ -44,6 +44,7 @@ public:
 	bsoncxx::document::value            get_query();
 	std::string                         get_collection();
 	int                                 get_priority();
+	int                                 get_caching_time();
 
 private:
 	boost::function<std::list<bsoncxx::document::value>(bsoncxx::document::view, std::string)>
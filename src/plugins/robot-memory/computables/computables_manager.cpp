@@ -21,15 +21,21 @@
 
 #include "computables_manager.h"
 
+#include "query_matcher.h"
+
 #include <core/exception.h>
+#include <core/threading/mutex_locker.h>
 #ifdef USE_TIMETRACKER
 #	include <utils/time/tracker.h>
 #endif
 #include <plugins/robot-memory/robot_memory.h>
 #include <utils/time/tracker_macros.h>
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
 #include <mongocxx/exception/operation_exception.hpp>
+#include <set>
 
 /** @class ComputablesManager  computables_manager.h
  *  This class manages registering computables and can check
@@ -41,6 +47,14 @@ using namespace fawkes;
 using namespace mongocxx;
 using namespace bsoncxx;
 
+namespace {
+long long
+current_time_ms()
+{
+	return std::chrono::system_clock::now().time_since_epoch() / std::chrono::milliseconds(1);
+}
+} // namespace
+
 /**
  * Constructor for class managing computables with refereces to plugin objects
  * @param config Configuration
@@ -49,7 +63,8 @@ using namespace bsoncxx;
 ComputablesManager::ComputablesManager(fawkes::Configuration *config, RobotMemory *robot_memory)
 : config_(config),
   robot_memory_(robot_memory),
-  matching_test_collection_("robmem.computables_matching")
+  matching_test_collection_("robmem.computables_matching"),
+  computing_waitcond_(&cached_querries_mutex_)
 {
 	try {
 		matching_test_collection_ =
@@ -60,6 +75,8 @@ ComputablesManager::ComputablesManager(fawkes::Configuration *config, RobotMemor
 	srand(time(NULL));
 #ifdef USE_TIMETRACKER
 	tt_                       = new TimeTracker();
+	tt_->set_name("robot-memory-computables");
+	tt_->set_max_samples(1000);
 	tt_loopcount_             = 0;
 	ttc_cleanup_              = tt_->add_class("RobotMemory Cleanup Function Call");
 	ttc_cleanup_inner_loop_   = tt_->add_class("RobotMemory Cleanup Inner Loop");
@@ -94,18 +111,38 @@ ComputablesManager::~ComputablesManager()
 void
 ComputablesManager::remove_computable(Computable *computable)
 {
-	for (std::list<Computable *>::iterator it = computables.begin(); it != computables.end(); ++it) {
-		if ((*it) == computable) {
-			Computable *comp = *it;
+	MutexLocker lock(&computables_mutex_);
+	for (auto it = computables.begin(); it != computables.end(); ++it) {
+		if (it->get() == computable) {
+			// deleted once computations using it have finished
 			computables.erase(it);
-			delete comp;
 			return;
 		}
 	}
 }
 
+/**
+ * Check if any computable provides information for a collection
+ * @param collection The database and collection to check (e.g. robmem.worldmodel)
+ * @return true if at least one registered computable fills the collection
+ */
+bool
+ComputablesManager::has_computables(const std::string &collection)
+{
+	MutexLocker lock(&computables_mutex_);
+	for (const std::shared_ptr<Computable> &comp : computables) {
+		if (comp->get_collection() == collection) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * Checks if computable knowledge is queried and calls the compute functions in this case
+ * Results are remembered for the caching time of the computables, also if
+ * nothing was computed. Concurrent requests for the same query are
+ * coalesced, only the first computes while the others wait for it.
  * @param query The query that might ask for computable knowledge
  * @param collection The collection that is querried
  * @return Were computed documents added?
@@ -113,49 +150,135 @@ ComputablesManager::remove_computable(Computable *computable)
 bool
 ComputablesManager::check_and_compute(const document::view &query, std::string collection)
 {
-	//check if computation result of the query is already cached
-	for (std::map<std::tuple<std::string, std::string>, long long>::iterator it =
-	       cached_querries_.begin();
-	     it != cached_querries_.end();
-	     ++it) {
-		if (collection == std::get<0>(it->first) && to_json(query) == std::get<1>(it->first)) {
+	if (collection.find(matching_test_collection_) != std::string::npos)
+		return false; //not necessary for matching test itself
+
+	std::vector<std::shared_ptr<Computable>> candidates;
+	computables_mutex_.lock();
+	for (const std::shared_ptr<Computable> &comp : computables) {
+		if (comp->get_collection() == collection) {
+			candidates.push_back(comp);
+		}
+	}
+	computables_mutex_.unlock();
+	if (candidates.empty())
+		return false;
+
+	//equivalent queries with a different field order share cached results
+	std::tuple<std::string, std::string> cache_key =
+	  std::make_tuple(collection, QueryCache::make_key(query, mongocxx::options::find()));
+	{
+		MutexLocker lock(&cached_querries_mutex_);
+		while (computing_querries_.find(cache_key) != computing_querries_.end()) {
+			computing_waitcond_.wait();
+		}
+		//check if computation result of the query is already cached
+		if (cached_querries_.find(cache_key) != cached_querries_.end()) {
 			return false;
 		}
+		auto empty = empty_querries_.find(cache_key);
+		if (empty != empty_querries_.end() && empty->second >= current_time_ms()) {
+			return false;
+		}
+		computing_querries_.insert(cache_key);
 	}
-	if (collection.find(matching_test_collection_) != std::string::npos)
-		return false; //not necessary for matching test itself
-	bool added_computed_docs = false;
-	//check if the query is matched by the computable identifyer
-	//to do that we just insert the query as if it would be a document and query for it with the computable identifiers
-	std::string current_test_collection = matching_test_collection_ + std::to_string(rand());
+
+	std::list<document::value> computed_docs;
+	long long                  cached_until = std::numeric_limits<long long>::max();
 	try {
-		robot_memory_->insert(query, current_test_collection);
-	} catch (mongocxx::operation_exception &e) {
-		// This may happen if the query contains fields that cannot be inserted, e.g., a $regex
-		robot_memory_->drop_collection(current_test_collection);
-		return false;
+		for (const std::shared_ptr<Computable> &comp : match_computables(query, candidates)) {
+			std::list<document::value> docs = comp->compute(query);
+			if (!docs.empty()) {
+				cached_until =
+				  std::min<long long>(cached_until,
+				                      docs.front().view()["_robmem_info"]["cached_until"].get_int64());
+				computed_docs.splice(computed_docs.end(), docs);
+			}
+		}
+		//insert documents of all computables at once
+		if (!computed_docs.empty()) {
+			std::vector<document::view> computed_docs_vector(computed_docs.begin(),
+			                                                 computed_docs.end());
+			robot_memory_->insert(computed_docs_vector, collection);
+		}
+	} catch (...) {
+		MutexLocker lock(&cached_querries_mutex_);
+		computing_querries_.erase(cache_key);
+		computing_waitcond_.wake_all();
+		throw;
+	}
+
+	MutexLocker lock(&cached_querries_mutex_);
+	if (!computed_docs.empty()) {
+		//remember how long a query is cached
+		cached_querries_[cache_key] = cached_until;
+	} else {
+		//nothing to compute, remember for the shortest caching time of the candidates
+		int caching_time = std::numeric_limits<int>::max();
+		for (const std::shared_ptr<Computable> &comp : candidates) {
+			caching_time = std::min(caching_time, comp->get_caching_time());
+		}
+		if (caching_time > 0) {
+			empty_querries_[cache_key] = current_time_ms() + caching_time;
+		}
 	}
-	for (std::list<Computable *>::iterator it = computables.begin(); it != computables.end(); ++it) {
-		auto cursor = robot_memory_->query((*it)->get_query(), current_test_collection);
-		if (collection == (*it)->get_collection() && cursor.begin() != cursor.end()) {
-			std::list<document::value> computed_docs_list = (*it)->compute(query);
-			if (!computed_docs_list.empty()) {
-				//move list into vector
-				std::vector<document::view> computed_docs_vector{
-				  std::make_move_iterator(std::begin(computed_docs_list)),
-				  std::make_move_iterator(std::end(computed_docs_list))};
-				//remember how long a query is cached:
-				long long cached_until =
-				  computed_docs_vector[0]["_robmem_info"]["cached_until"].get_int64();
-				cached_querries_[std::make_tuple(collection, to_json(query))] = cached_until;
-				//TODO: fix minor problem: equivalent queries in different order jield unequal strings
-				robot_memory_->insert(computed_docs_vector, (*it)->get_collection());
-				added_computed_docs = true;
+	computing_querries_.erase(cache_key);
+	computing_waitcond_.wake_all();
+	return !computed_docs.empty();
+}
+
+/**
+ * Determine computables whose identifier matches a query.
+ * The query is treated as if it would be a document and matched against
+ * the computable identifiers in-process. Only if the identifiers use
+ * features not supported by the QueryMatcher, the query is inserted into
+ * a temporary collection and the database is asked.
+ * @param query The query that might ask for computable knowledge
+ * @param candidates The computables of the queried collection, in order of priority
+ * @return Matching computables, in order of priority
+ */
+std::vector<std::shared_ptr<Computable>>
+ComputablesManager::match_computables(const document::view &                          query,
+                                      const std::vector<std::shared_ptr<Computable>> &candidates)
+{
+	bool                              in_process = !QueryMatcher::has_operator_keys(query);
+	std::vector<QueryMatcher::Result> results;
+	bool                              need_db = false;
+	for (const std::shared_ptr<Computable> &comp : candidates) {
+		QueryMatcher::Result r = QueryMatcher::UNSUPPORTED;
+		if (in_process) {
+			r = QueryMatcher::match(comp->get_query(), query);
+		}
+		need_db |= (r == QueryMatcher::UNSUPPORTED);
+		results.push_back(r);
+	}
+
+	if (need_db) {
+		std::string current_test_collection = matching_test_collection_ + std::to_string(rand());
+		try {
+			robot_memory_->insert(query, current_test_collection);
+		} catch (mongocxx::operation_exception &e) {
+			// This may happen if the query contains fields that cannot be inserted, e.g., a $regex
+			robot_memory_->drop_collection(current_test_collection);
+			return std::vector<std::shared_ptr<Computable>>();
+		}
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			if (results[i] == QueryMatcher::UNSUPPORTED) {
+				auto cursor = robot_memory_->query(candidates[i]->get_query(), current_test_collection);
+				results[i] =
+				  (cursor.begin() != cursor.end()) ? QueryMatcher::MATCH : QueryMatcher::NO_MATCH;
 			}
 		}
+		robot_memory_->drop_collection(current_test_collection);
+	}
+
+	std::vector<std::shared_ptr<Computable>> matching;
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		if (results[i] == QueryMatcher::MATCH) {
+			matching.push_back(candidates[i]);
+		}
 	}
-	robot_memory_->drop_collection(current_test_collection);
-	return added_computed_docs;
+	return matching;
 }
 
 /**
@@ -165,26 +288,38 @@ void
 ComputablesManager::cleanup_computed_docs()
 {
 	TIMETRACK_START(ttc_cleanup_);
-	long long current_time_ms =
-	  std::chrono::system_clock::now().time_since_epoch() / std::chrono::milliseconds(1);
-	for (std::map<std::tuple<std::string, std::string>, long long>::iterator it =
-	       cached_querries_.begin();
-	     it != cached_querries_.end();
-	     ++it) {
-		TIMETRACK_START(ttc_cleanup_inner_loop_);
-		if (current_time_ms > it->second) {
-			using namespace bsoncxx::builder;
-			basic::document doc;
-			doc.append(basic::kvp("_robmem_info.computed", true));
-			doc.append(
-			  basic::kvp("_robmem_info.cached_until", [current_time_ms](basic::sub_document subdoc) {
-				  subdoc.append(basic::kvp("$lt", static_cast<std::int64_t>(current_time_ms)));
-			  }));
-			TIMETRACK_START(ttc_cleanup_remove_query_);
-			robot_memory_->remove(doc, std::get<0>(it->first));
-			TIMETRACK_END(ttc_cleanup_remove_query_);
-			cached_querries_.erase(it->first);
+	long long now_ms = current_time_ms();
+	//collect expired queries first, the removal must not block queries of other threads
+	std::set<std::string> expired_collections;
+	{
+		MutexLocker lock(&cached_querries_mutex_);
+		for (auto it = cached_querries_.begin(); it != cached_querries_.end();) {
+			if (now_ms > it->second) {
+				expired_collections.insert(std::get<0>(it->first));
+				it = cached_querries_.erase(it);
+			} else {
+				++it;
+			}
+		}
+		for (auto it = empty_querries_.begin(); it != empty_querries_.end();) {
+			if (now_ms > it->second) {
+				it = empty_querries_.erase(it);
+			} else {
+				++it;
+			}
 		}
+	}
+	for (const std::string &collection : expired_collections) {
+		TIMETRACK_START(ttc_cleanup_inner_loop_);
+		using namespace bsoncxx::builder;
+		basic::document doc;
+		doc.append(basic::kvp("_robmem_info.computed", true));
+		doc.append(basic::kvp("_robmem_info.cached_until", [now_ms](basic::sub_document subdoc) {
+			subdoc.append(basic::kvp("$lt", static_cast<std::int64_t>(now_ms)));
+		}));
+		TIMETRACK_START(ttc_cleanup_remove_query_);
+		robot_memory_->remove(doc, collection);
+		TIMETRACK_END(ttc_cleanup_remove_query_);
 		TIMETRACK_END(ttc_cleanup_inner_loop_);
 	}
 	TIMETRACK_END(ttc_cleanup_);
@@ -27,12 +27,18 @@
 #include <aspect/clock.h>
 #include <aspect/configurable.h>
 #include <aspect/logging.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
 
 #include <boost/bind.hpp>
 #include <map>
+#include <memory>
 #include <mongocxx/client.hpp>
+#include <set>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 //forward declaration
 class RobotMemory;
@@ -50,6 +56,7 @@ public:
 	virtual ~ComputablesManager();
 
 	bool check_and_compute(const bsoncxx::document::view &query, std::string collection);
+	bool has_computables(const std::string &collection);
 	void remove_computable(Computable *computable);
 	void cleanup_computed_docs();
 
@@ -73,28 +80,40 @@ public:
 	                    double caching_time = 0.0,
 	                    int    priority     = 0)
 	{
-		Computable *comp = new Computable(
+		std::shared_ptr<Computable> comp = std::make_shared<Computable>(
 		  query_to_compute, collection, boost::bind(compute_func, obj, _1, _2), caching_time, priority);
 		//sort it into the right position
-		std::list<Computable *>::iterator pos = computables.begin();
+		fawkes::MutexLocker                                 lock(&computables_mutex_);
+		std::list<std::shared_ptr<Computable>>::iterator pos = computables.begin();
 		while (pos != computables.end() && priority < (*pos)->get_priority())
 			pos++;
 		computables.insert(pos, comp);
-		return comp;
+		return comp.get();
 	}
 
 private:
 	ComputablesManager(const ComputablesManager &other);
+	std::vector<std::shared_ptr<Computable>>
+	match_computables(const bsoncxx::document::view &                 query,
+	                  const std::vector<std::shared_ptr<Computable>> &candidates);
 
 private:
 	std::string            name = "RobotMemory ComputablesManager";
 	fawkes::Configuration *config_;
 	RobotMemory *          robot_memory_;
 
-	std::list<Computable *> computables;
+	// computations in progress keep removed computables alive
+	std::list<std::shared_ptr<Computable>> computables;
+	fawkes::Mutex                          computables_mutex_;
 	std::string             matching_test_collection_;
 	//cached querries as ((collection, querry), cached_until)
 	std::map<std::tuple<std::string, std::string>, long long> cached_querries_;
+	//querries for which nothing was computed as ((collection, querry), valid_until)
+	std::map<std::tuple<std::string, std::string>, long long> empty_querries_;
+	//querries currently computed, other threads wait for the result
+	std::set<std::tuple<std::string, std::string>> computing_querries_;
+	fawkes::Mutex                                  cached_querries_mutex_;
+	fawkes::WaitCondition                          computing_waitcond_;
 #ifdef USE_TIMETRACKER
 	fawkes::TimeTracker *tt_;
 	unsigned int         tt_loopcount_;
@@ -0,0 +1,316 @@
+/***************************************************************************
+ *  query_matcher.cpp - Match documents against queries in-process
+ *
+ *  Created: Sat Oct 17 23:06:51 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "query_matcher.h"
+
+#include <bsoncxx/array/view.hpp>
+#include <bsoncxx/types.hpp>
+#include <string>
+
+using namespace bsoncxx;
+
+namespace {
+
+typedef QueryMatcher::Result Result;
+
+std::string
+element_key(const document::element &element)
+{
+	return std::string(element.key().data(), element.key().size());
+}
+
+Result
+combine_and(Result a, Result b)
+{
+	if (a == QueryMatcher::NO_MATCH || b == QueryMatcher::NO_MATCH)
+		return QueryMatcher::NO_MATCH;
+	if (a == QueryMatcher::UNSUPPORTED || b == QueryMatcher::UNSUPPORTED)
+		return QueryMatcher::UNSUPPORTED;
+	return QueryMatcher::MATCH;
+}
+
+bool
+is_number(type t)
+{
+	return t == type::k_double || t == type::k_int32 || t == type::k_int64;
+}
+
+template <typename Element>
+double
+number(const Element &e)
+{
+	switch (e.type()) {
+	case type::k_double: return e.get_double().value;
+	case type::k_int32: return e.get_int32().value;
+	default: return e.get_int64().value;
+	}
+}
+
+template <typename A, typename B>
+bool values_equal(const A &a, const B &b);
+
+/* Embedded documents are equal if they have the same fields in the same
+ * order with equal values, e.g., {a: 1} equals {a: 1.0}.
+ */
+bool
+documents_equal(const document::view &a, const document::view &b)
+{
+	auto ia = a.begin(), ib = b.begin();
+	for (; ia != a.end() && ib != b.end(); ++ia, ++ib) {
+		if (ia->key() != ib->key() || !values_equal(*ia, *ib))
+			return false;
+	}
+	return ia == a.end() && ib == b.end();
+}
+
+bool
+arrays_equal(const array::view &a, const array::view &b)
+{
+	auto ia = a.begin(), ib = b.begin();
+	for (; ia != a.end() && ib != b.end(); ++ia, ++ib) {
+		if (!values_equal(*ia, *ib))
+			return false;
+	}
+	return ia == a.end() && ib == b.end();
+}
+
+template <typename A, typename B>
+bool
+values_equal(const A &a, const B &b)
+{
+	if (is_number(a.type()) && is_number(b.type())) {
+		return number(a) == number(b);
+	}
+	if (a.type() != b.type())
+		return false;
+	switch (a.type()) {
+	case type::k_document: return documents_equal(a.get_document().value, b.get_document().value);
+	case type::k_array: return arrays_equal(a.get_array().value, b.get_array().value);
+	default: return a.get_value() == b.get_value();
+	}
+}
+
+/* Equality as in queries: a missing field equals null and an array field
+ * equals a value if any of its elements does.
+ */
+template <typename Value>
+bool
+field_equals(const document::element &field, const Value &value)
+{
+	if (!field)
+		return value.type() == type::k_null;
+	if (values_equal(field, value))
+		return true;
+	if (field.type() == type::k_array && value.type() != type::k_array) {
+		for (const auto &e : field.get_array().value) {
+			if (values_equal(e, value))
+				return true;
+		}
+	}
+	return false;
+}
+
+/* Lookup field by dotted path. Paths traversing arrays are not supported. */
+document::element
+lookup(const document::view &doc, const std::string &path, bool &unsupported)
+{
+	std::string::size_type pos = path.find('.');
+	document::element      e   = doc[path.substr(0, pos)];
+	if (pos == std::string::npos || !e)
+		return e;
+	if (e.type() == type::k_document)
+		return lookup(e.get_document().value, path.substr(pos + 1), unsupported);
+	if (e.type() == type::k_array)
+		unsupported = true;
+	return document::element();
+}
+
+Result
+match_operator(const document::element &field, const document::element &op)
+{
+	std::string name = element_key(op);
+	if (name == "$exists") {
+		bool want = true;
+		if (op.type() == type::k_bool) {
+			want = op.get_bool().value;
+		} else if (is_number(op.type())) {
+			want = (number(op) != 0.);
+		}
+		return (static_cast<bool>(field) == want) ? QueryMatcher::MATCH : QueryMatcher::NO_MATCH;
+	} else if (name == "$eq" || name == "$ne") {
+		if (op.type() == type::k_regex)
+			return QueryMatcher::UNSUPPORTED;
+		return (field_equals(field, op) == (name == "$eq")) ? QueryMatcher::MATCH
+		                                                     : QueryMatcher::NO_MATCH;
+	} else if (name == "$in" || name == "$nin") {
+		if (op.type() != type::k_array)
+			return QueryMatcher::UNSUPPORTED;
+		bool found = false;
+		for (const auto &v : op.get_array().value) {
+			if (v.type() == type::k_regex)
+				return QueryMatcher::UNSUPPORTED;
+			if (field_equals(field, v)) {
+				found = true;
+				break;
+			}
+		}
+		return (found == (name == "$in")) ? QueryMatcher::MATCH : QueryMatcher::NO_MATCH;
+	} else if (name == "$gt" || name == "$gte" || name == "$lt" || name == "$lte") {
+		if (!field)
+			return QueryMatcher::NO_MATCH;
+		if (field.type() == type::k_array)
+			return QueryMatcher::UNSUPPORTED;
+		int cmp;
+		if (is_number(field.type()) && is_number(op.type())) {
+			double a = number(field), b = number(op);
+			cmp      = (a < b) ? -1 : ((a > b) ? 1 : 0);
+		} else if (field.type() == type::k_utf8 && op.type() == type::k_utf8) {
+			cmp = field.get_utf8().value.to_string().compare(op.get_utf8().value.to_string());
+		} else if ((is_number(field.type()) || field.type() == type::k_utf8)
+		           && (is_number(op.type()) || op.type() == type::k_utf8)) {
+			// numbers and strings are never compared with each other
+			return QueryMatcher::NO_MATCH;
+		} else {
+			return QueryMatcher::UNSUPPORTED;
+		}
+		bool matches = (name == "$gt") ? (cmp > 0)
+		                               : (name == "$gte") ? (cmp >= 0)
+		                                                  : (name == "$lt") ? (cmp < 0) : (cmp <= 0);
+		return matches ? QueryMatcher::MATCH : QueryMatcher::NO_MATCH;
+	}
+	return QueryMatcher::UNSUPPORTED;
+}
+
+Result
+match_condition(const document::element &field, const document::element &cond)
+{
+	if (cond.type() == type::k_document) {
+		document::view ops = cond.get_document().value;
+		if (ops.begin() != ops.end() && element_key(*ops.begin()).compare(0, 1, "$") == 0) {
+			Result result = QueryMatcher::MATCH;
+			for (const auto &op : ops) {
+				result = combine_and(result, match_operator(field, op));
+				if (result == QueryMatcher::NO_MATCH)
+					break;
+			}
+			return result;
+		}
+	} else if (cond.type() == type::k_regex) {
+		return QueryMatcher::UNSUPPORTED;
+	}
+	return field_equals(field, cond) ? QueryMatcher::MATCH : QueryMatcher::NO_MATCH;
+}
+
+Result
+match_logical(const std::string &op, const document::element &e, const document::view &doc)
+{
+	if (e.type() != type::k_array)
+		return QueryMatcher::UNSUPPORTED;
+
+	bool any_match = false, any_unsupported = false, all_match = true;
+	for (const auto &sub : e.get_array().value) {
+		if (sub.type() != type::k_document)
+			return QueryMatcher::UNSUPPORTED;
+		Result r = QueryMatcher::match(sub.get_document().value, doc);
+		any_match |= (r == QueryMatcher::MATCH);
+		any_unsupported |= (r == QueryMatcher::UNSUPPORTED);
+		all_match &= (r == QueryMatcher::MATCH);
+		if (op == "$and" && r == QueryMatcher::NO_MATCH)
+			return QueryMatcher::NO_MATCH;
+	}
+	if (op == "$and") {
+		return all_match ? QueryMatcher::MATCH : QueryMatcher::UNSUPPORTED;
+	}
+	Result any = any_match ? QueryMatcher::MATCH
+	                       : (any_unsupported ? QueryMatcher::UNSUPPORTED : QueryMatcher::NO_MATCH);
+	if (op == "$nor" && any != QueryMatcher::UNSUPPORTED) {
+		return (any == QueryMatcher::MATCH) ? QueryMatcher::NO_MATCH : QueryMatcher::MATCH;
+	}
+	return any;
+}
+
+} // namespace
+
+/** @class QueryMatcher "query_matcher.h"
+ * Match documents against queries in-process.
+ * The computables manager needs to know whether a query asks for
+ * information provided by a computable. Instead of inserting the query
+ * into a temporary collection and asking the database, the common subset
+ * of the query language is evaluated directly: field equality (also on
+ * dotted paths and array fields), the comparison operators $eq, $ne, $gt,
+ * $gte, $lt, $lte, $in, $nin, and $exists, as well as $and, $or, and
+ * $nor. For anything else the result is UNSUPPORTED and the caller must
+ * fall back to the database.
+ * @author agent
+ */
+
+/** Match document against query.
+ * @param query query to evaluate
+ * @param doc document to check
+ * @return MATCH if the document matches the query, NO_MATCH if it does not,
+ * UNSUPPORTED if the query cannot be evaluated in-process
+ */
+QueryMatcher::Result
+QueryMatcher::match(const document::view &query, const document::view &doc)
+{
+	Result result = MATCH;
+	for (const auto &e : query) {
+		std::string key = element_key(e);
+		Result      r;
+		if (key == "$and" || key == "$or" || key == "$nor") {
+			r = match_logical(key, e, doc);
+		} else if (key.compare(0, 1, "$") == 0) {
+			r = UNSUPPORTED;
+		} else {
+			bool              unsupported = false;
+			document::element field       = lookup(doc, key, unsupported);
+			r                             = unsupported ? UNSUPPORTED : match_condition(field, e);
+		}
+		result = combine_and(result, r);
+		if (result == NO_MATCH)
+			break;
+	}
+	return result;
+}
+
+/** Check if a document contains keys starting with $.
+ * Whether such documents, e.g., queries with operators, can be stored in
+ * the database depends on the server version. To keep matching behavior
+ * unchanged, they must be matched by the database.
+ * @param doc document to check, including all sub-documents
+ * @return true if any key starts with $
+ */
+bool
+QueryMatcher::has_operator_keys(const document::view &doc)
+{
+	for (const auto &e : doc) {
+		if (element_key(e).compare(0, 1, "$") == 0)
+			return true;
+		if (e.type() == type::k_document && has_operator_keys(e.get_document().value))
+			return true;
+		if (e.type() == type::k_array) {
+			for (const auto &a : e.get_array().value) {
+				if (a.type() == type::k_document && has_operator_keys(a.get_document().value))
+					return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,40 @@
+/***************************************************************************
+ *  query_matcher.h - Match documents against queries in-process
+ *
+ *  Created: Sat Oct 17 23:06:51 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COMPUTABLES_QUERY_MATCHER_H_
+#define FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COMPUTABLES_QUERY_MATCHER_H_
+
+#include <bsoncxx/document/view.hpp>
+
+class QueryMatcher
+{
+public:
+	/** Result of matching a document. */
+	enum Result {
+		MATCH,      ///< document matches the query
+		NO_MATCH,   ///< document does not match the query
+		UNSUPPORTED ///< query uses features not supported, ask the database
+	};
+
+	static Result match(const bsoncxx::document::view &query, const bsoncxx::document::view &doc);
+	static bool   has_operator_keys(const bsoncxx::document::view &doc);
+};
+
+#endif
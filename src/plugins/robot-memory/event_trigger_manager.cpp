@@ -74,6 +74,8 @@ EventTriggerManager::EventTriggerManager(Logger *            logger,
 	}
 #ifdef USE_TIMETRACKER
 	tt_                = new fawkes::TimeTracker();
+	tt_->set_name("robot-memory-triggers");
+	tt_->set_max_samples(1000);
 	ttc_trigger_loop_  = tt_->add_class("RM Trigger Trigger Loop");
 	ttc_callback_loop_ = tt_->add_class("RM Trigger Callback Loop");
 	ttc_callback_      = tt_->add_class("RM Trigger Single Callback");
@@ -0,0 +1,340 @@
+/***************************************************************************
+ *  query_cache.cpp - Cache for robot memory query results
+ *
+ *  Created: Sat Oct 17 21:38:02 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "query_cache.h"
+
+#include <core/threading/mutex_locker.h>
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/json.hpp>
+
+using namespace fawkes;
+
+namespace {
+
+template <typename Element>
+void append_normalized_value(std::string &out, const Element &element, bool filter);
+
+std::string
+element_key(const bsoncxx::document::element &element)
+{
+	return std::string(element.key().data(), element.key().size());
+}
+
+/* Append a document in a canonical form to a string.
+ * Field order is significant for embedded documents compared for
+ * equality, but not for filter documents and operator expressions.
+ * Only the latter are sorted by key, the order of all others is kept.
+ */
+void
+append_normalized_document(std::string &out, const bsoncxx::document::view &doc, bool filter)
+{
+	std::vector<bsoncxx::document::element> elements(doc.begin(), doc.end());
+	bool operator_doc = !elements.empty() && element_key(elements.front()).compare(0, 1, "$") == 0;
+	if (filter || operator_doc) {
+		std::sort(elements.begin(),
+		          elements.end(),
+		          [](const bsoncxx::document::element &a, const bsoncxx::document::element &b) {
+			          return element_key(a) < element_key(b);
+		          });
+	}
+
+	out += '{';
+	for (const auto &e : elements) {
+		std::string key = element_key(e);
+		out += '"';
+		out += key;
+		out += "\":";
+		// arrays of logical operators contain filter documents
+		bool logical = (key == "$and" || key == "$or" || key == "$nor");
+		append_normalized_value(out, e, logical);
+		out += ',';
+	}
+	out += '}';
+}
+
+template <typename Element>
+void
+append_normalized_value(std::string &out, const Element &element, bool filter)
+{
+	using namespace bsoncxx::builder;
+
+	switch (element.type()) {
+	case bsoncxx::type::k_document:
+		append_normalized_document(out, element.get_document().value, filter);
+		break;
+	case bsoncxx::type::k_array:
+		out += '[';
+		for (const auto &a : element.get_array().value) {
+			append_normalized_value(out, a, filter);
+			out += ',';
+		}
+		out += ']';
+		break;
+	default: out += bsoncxx::to_json(basic::make_document(basic::kvp("", element.get_value())));
+	}
+}
+
+} // namespace
+
+/** @class QueryCache "query_cache.h"
+ * Cache for robot memory query results.
+ * Agents often issue the very same queries in every cycle while the
+ * data does not change. For collections for which it is enabled, the
+ * cache keeps the resulting documents keyed by a normalized form of the
+ * query and the find options. Equivalent filters with a different field
+ * order map to the same entry.
+ *
+ * All entries of a collection are dropped whenever it is modified. The
+ * robot memory does this synchronously for its own modifications and
+ * uses change streams to notice modifications by other clients.
+ *
+ * Each collection has a generation counter which is increased on every
+ * invalidation. Results are only stored if the generation did not change
+ * while the query was running, otherwise a result computed before a
+ * concurrent modification could be kept after the invalidation.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param max_entries maximum number of cached queries per collection,
+ * the oldest is dropped if exceeded
+ */
+QueryCache::QueryCache(unsigned int max_entries)
+: max_entries_(max_entries), hits_(0), misses_(0), invalidations_(0)
+{
+}
+
+/** Destructor. */
+QueryCache::~QueryCache()
+{
+}
+
+/** Enable cache for a collection.
+ * @param collection collection in the form database.collection
+ */
+void
+QueryCache::enable(const std::string &collection)
+{
+	MutexLocker lock(&mutex_);
+	collections_.insert(collection);
+}
+
+/** Check if cache is enabled for a collection.
+ * @param collection collection in the form database.collection
+ * @return true if results of queries on the collection are cached
+ */
+bool
+QueryCache::enabled(const std::string &collection) const
+{
+	MutexLocker lock(&mutex_);
+	return collections_.find(collection) != collections_.end();
+}
+
+/** Get collections for which the cache is enabled.
+ * @return set of collection names in the form database.collection
+ */
+std::set<std::string>
+QueryCache::collections() const
+{
+	MutexLocker lock(&mutex_);
+	return collections_;
+}
+
+/** Create cache key.
+ * @param query query filter
+ * @param options find options, options which influence the result
+ * are part of the key
+ * @return key for lookup() and store()
+ */
+std::string
+QueryCache::make_key(const bsoncxx::document::view &query, const mongocxx::options::find &options)
+{
+	std::string key;
+	append_normalized_document(key, query, true);
+	if (options.projection()) {
+		key += "|projection:" + bsoncxx::to_json(options.projection()->view());
+	}
+	if (options.sort()) {
+		key += "|sort:" + bsoncxx::to_json(options.sort()->view());
+	}
+	if (options.collation()) {
+		key += "|collation:" + bsoncxx::to_json(options.collation()->view());
+	}
+	if (options.skip()) {
+		key += "|skip:" + std::to_string(*options.skip());
+	}
+	if (options.limit()) {
+		key += "|limit:" + std::to_string(*options.limit());
+	}
+	return key;
+}
+
+/** Lookup cached result.
+ * @param collection collection in the form database.collection
+ * @param key key created with make_key()
+ * @return cached documents, or an empty pointer if there is no entry
+ */
+QueryCache::DocumentsPtr
+QueryCache::lookup(const std::string &collection, const std::string &key)
+{
+	MutexLocker lock(&mutex_);
+	auto        c = caches_.find(collection);
+	if (c != caches_.end()) {
+		auto e = c->second.entries.find(key);
+		if (e != c->second.entries.end()) {
+			hits_ += 1;
+			return e->second;
+		}
+	}
+	misses_ += 1;
+	return DocumentsPtr();
+}
+
+/** Get current generation of a collection.
+ * Get the generation before running the query and pass it to store().
+ * @param collection collection in the form database.collection
+ * @return current generation
+ */
+uint64_t
+QueryCache::generation(const std::string &collection)
+{
+	MutexLocker lock(&mutex_);
+	return caches_[collection].generation;
+}
+
+/** Store query result.
+ * @param collection collection in the form database.collection
+ * @param key key created with make_key()
+ * @param documents documents returned by the query
+ * @param generation generation of the collection before the query was
+ * executed, the result is discarded if it is outdated
+ */
+void
+QueryCache::store(const std::string &collection,
+                  const std::string &key,
+                  DocumentsPtr       documents,
+                  uint64_t           generation)
+{
+	MutexLocker      lock(&mutex_);
+	CollectionCache &cache = caches_[collection];
+	if (cache.generation != generation)
+		return;
+
+	if (cache.entries.find(key) == cache.entries.end()) {
+		cache.insertion_order.push_back(key);
+	}
+	cache.entries[key] = documents;
+	while (cache.entries.size() > max_entries_) {
+		cache.entries.erase(cache.insertion_order.front());
+		cache.insertion_order.pop_front();
+	}
+}
+
+/** Invalidate all entries of a collection.
+ * @param collection collection in the form database.collection
+ */
+void
+QueryCache::invalidate(const std::string &collection)
+{
+	if (!enabled(collection))
+		return;
+
+	MutexLocker      lock(&mutex_);
+	CollectionCache &cache = caches_[collection];
+	cache.generation += 1;
+	if (!cache.entries.empty()) {
+		cache.entries.clear();
+		cache.insertion_order.clear();
+		invalidations_ += 1;
+	}
+}
+
+/** Invalidate all entries of all collections. */
+void
+QueryCache::invalidate_all()
+{
+	for (const std::string &c : collections_) {
+		invalidate(c);
+	}
+}
+
+/** Change stream callback.
+ * Invalidates the collection the change event refers to.
+ * @param change change event
+ */
+void
+QueryCache::on_change(const bsoncxx::document::view &change)
+{
+	auto ns = change["ns"];
+	if (ns && ns.type() == bsoncxx::type::k_document) {
+		auto db   = ns.get_document().value["db"];
+		auto coll = ns.get_document().value["coll"];
+		if (db && coll && db.type() == bsoncxx::type::k_utf8
+		    && coll.type() == bsoncxx::type::k_utf8) {
+			invalidate(db.get_utf8().value.to_string() + "." + coll.get_utf8().value.to_string());
+			return;
+		}
+	}
+	// e.g., dropDatabase events do not name a collection
+	invalidate_all();
+}
+
+/** Get number of cache hits.
+ * @return number of lookups which returned a result
+ */
+unsigned long int
+QueryCache::hits() const
+{
+	MutexLocker lock(&mutex_);
+	return hits_;
+}
+
+/** Get number of cache misses.
+ * @return number of lookups which did not return a result
+ */
+unsigned long int
+QueryCache::misses() const
+{
+	MutexLocker lock(&mutex_);
+	return misses_;
+}
+
+/** Get number of invalidations.
+ * @return number of times cached entries of a collection were dropped
+ */
+unsigned long int
+QueryCache::invalidations() const
+{
+	MutexLocker lock(&mutex_);
+	return invalidations_;
+}
+
+/** Get hit rate.
+ * @return ratio of hits to lookups, 0 if there have not been any lookups
+ */
+float
+QueryCache::hit_rate() const
+{
+	MutexLocker lock(&mutex_);
+	unsigned long int lookups = hits_ + misses_;
+	return (lookups > 0) ? (float)hits_ / (float)lookups : 0.f;
+}
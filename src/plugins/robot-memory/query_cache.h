@@ -0,0 +1,91 @@
+/***************************************************************************
+ *  query_cache.h - Cache for robot memory query results
+ *
+ *  Created: Sat Oct 17 21:38:02 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_ROBOT_MEMORY_QUERY_CACHE_H_
+#define _PLUGINS_ROBOT_MEMORY_QUERY_CACHE_H_
+
+#include <core/threading/mutex.h>
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <list>
+#include <map>
+#include <memory>
+#include <mongocxx/options/find.hpp>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class QueryCache
+{
+public:
+	/** List of documents returned by a query. */
+	typedef std::vector<bsoncxx::document::value> Documents;
+	/** Shared pointer to immutable query result. */
+	typedef std::shared_ptr<const Documents> DocumentsPtr;
+
+	explicit QueryCache(unsigned int max_entries);
+	virtual ~QueryCache();
+
+	void                  enable(const std::string &collection);
+	bool                  enabled(const std::string &collection) const;
+	std::set<std::string> collections() const;
+
+	static std::string make_key(const bsoncxx::document::view &query,
+	                            const mongocxx::options::find &options);
+
+	DocumentsPtr lookup(const std::string &collection, const std::string &key);
+	uint64_t     generation(const std::string &collection);
+	void         store(const std::string &collection,
+	                   const std::string &key,
+	                   DocumentsPtr       documents,
+	                   uint64_t           generation);
+
+	void invalidate(const std::string &collection);
+	void invalidate_all();
+	void on_change(const bsoncxx::document::view &change);
+
+	unsigned long int hits() const;
+	unsigned long int misses() const;
+	unsigned long int invalidations() const;
+	float             hit_rate() const;
+
+private:
+	/// @cond INTERNALS
+	struct CollectionCache
+	{
+		uint64_t                            generation = 0;
+		std::map<std::string, DocumentsPtr> entries;
+		std::list<std::string>              insertion_order;
+	};
+	/// @endcond
+
+	mutable fawkes::Mutex                  mutex_;
+	std::set<std::string>                  collections_;
+	unsigned int                           max_entries_;
+	std::map<std::string, CollectionCache> caches_;
+
+	unsigned long int hits_;
+	unsigned long int misses_;
+	unsigned long int invalidations_;
+};
+
+#endif
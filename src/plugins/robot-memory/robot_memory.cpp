@@ -35,6 +35,8 @@
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <mongocxx/client.hpp>
 #include <mongocxx/exception/operation_exception.hpp>
 #include <mongocxx/read_preference.hpp>
@@ -45,6 +47,30 @@ using namespace fawkes;
 using namespace mongocxx;
 using namespace bsoncxx;
 
+namespace {
+/* Invalidate cached query results of a collection when going out of scope.
+ * Declared at the beginning of modifying operations, the invalidation then
+ * happens after the modification has been completed.
+ */
+class QueryCacheInvalidator
+{
+public:
+	QueryCacheInvalidator(QueryCache *cache, const std::string &collection)
+	: cache_(cache), collection_(collection)
+	{
+	}
+
+	~QueryCacheInvalidator()
+	{
+		cache_->invalidate(collection_);
+	}
+
+private:
+	QueryCache *       cache_;
+	const std::string &collection_;
+};
+} // namespace
+
 /** @class RobotMemory "robot_memory.h"
  * Access to the robot memory based on mongodb.
  * Using this class, you can query/insert/remove/update information in
@@ -75,16 +101,30 @@ RobotMemory::RobotMemory(fawkes::Configuration *     config,
 	clock_                      = clock;
 	mongo_connection_manager_   = mongo_connection_manager;
 	blackboard_                 = blackboard;
-	mongodb_client_local_       = nullptr;
-	mongodb_client_distributed_ = nullptr;
+	clients_local_              = nullptr;
+	clients_distributed_        = nullptr;
+	distributed_                = false;
+	query_cache_                = nullptr;
 	debug_                      = false;
+
+	// latencies are exported with the core metrics
+	std::vector<double> latency_bounds = {1e-4, 5e-4, 1e-3, 5e-3, 1e-2, 5e-2, 0.1, 0.5, 1., 5.};
+	for (unsigned int i = 0; i < OP_NUM; ++i) {
+		latency_[i] = MetricSet::core().histogram("fawkes_robot_memory_operation_seconds",
+		                                          "Time spent in robot memory operations",
+		                                          latency_bounds,
+		                                          {{"op", operation_names_[i]}});
+	}
 }
 
 RobotMemory::~RobotMemory()
 {
-	mongo_connection_manager_->delete_client(mongodb_client_local_);
-	mongo_connection_manager_->delete_client(mongodb_client_distributed_);
+	report_latencies();
+	report_cache_statistics();
+	delete clients_local_;
+	delete clients_distributed_;
 	delete trigger_manager_;
+	delete query_cache_;
 	blackboard_->close(rm_if_);
 #ifdef USE_TIMETRACKER
 	delete tt_;
@@ -121,15 +161,44 @@ RobotMemory::init()
 	cfg_coord_mutex_collection_ =
 	  config_->get_string("/plugins/robot-memory/coordination/mutex-collection");
 
+	std::vector<std::string> cfg_cache_collections;
+	try {
+		cfg_cache_collections = config_->get_strings("/plugins/robot-memory/query-cache/collections");
+	} catch (Exception &) {
+	} // ignored, cache disabled
+	unsigned int cfg_cache_max_entries = 128;
+	try {
+		cfg_cache_max_entries = config_->get_uint("/plugins/robot-memory/query-cache/max-entries");
+	} catch (Exception &) {
+	} // ignored, use default
+	cfg_cache_report_interval_ = 60.;
+	try {
+		cfg_cache_report_interval_ =
+		  config_->get_float("/plugins/robot-memory/query-cache/report-interval");
+	} catch (Exception &) {
+	} // ignored, use default
+	cfg_slow_threshold_ms_ = 100.;
+	try {
+		cfg_slow_threshold_ms_ = config_->get_float("/plugins/robot-memory/latency/slow-threshold");
+	} catch (Exception &) {
+	} // ignored, use default
+	cfg_latency_report_interval_ = 0.;
+	try {
+		cfg_latency_report_interval_ =
+		  config_->get_float("/plugins/robot-memory/latency/report-interval");
+	} catch (Exception &) {
+	} // ignored, report on shutdown only
+
 	using namespace std::chrono_literals;
 
-	//initiate mongodb connections:
+	//initiate mongodb connections, each thread gets its own client on first access
 	log("Connect to local mongod");
+	clients_local_             = new ClientPool(mongo_connection_manager_, "robot-memory-local");
 	unsigned int startup_tries = 0;
 	for (; startup_tries < cfg_startup_grace_period_ * 2; ++startup_tries) {
 		// TODO if the last try fails, the client remains uninitialized
 		try {
-			mongodb_client_local_ = mongo_connection_manager_->create_client("robot-memory-local");
+			clients_local_->client();
 			break;
 		} catch (fawkes::Exception &) {
 			logger_->log_info(name_, "Waiting for local");
@@ -139,13 +208,13 @@ RobotMemory::init()
 
 	if (config_->exists("/plugins/mongodb/clients/robot-memory-distributed/enabled")
 	    && config_->get_bool("/plugins/mongodb/clients/robot-memory-distributed/enabled")) {
-		distributed_ = true;
+		distributed_         = true;
+		clients_distributed_ = new ClientPool(mongo_connection_manager_, "robot-memory-distributed");
 		log("Connect to distributed mongod");
 		for (startup_tries = 0; startup_tries < cfg_startup_grace_period_ * 2; ++startup_tries) {
 			// TODO if the last try fails, the client remains uninitialized
 			try {
-				mongodb_client_distributed_ =
-				  mongo_connection_manager_->create_client("robot-memory-distributed");
+				clients_distributed_->client();
 				break;
 			} catch (fawkes::Exception &) {
 				logger_->log_info(name_, "Waiting for distributed");
@@ -165,10 +234,21 @@ RobotMemory::init()
 	trigger_manager_     = new EventTriggerManager(logger_, config_, mongo_connection_manager_);
 	computables_manager_ = new ComputablesManager(config_, this);
 
+	//Setup query cache, modifications by other clients are noticed through change streams
+	query_cache_ = new QueryCache(cfg_cache_max_entries);
+	for (const std::string &c : cfg_cache_collections) {
+		enable_query_cache(c);
+	}
+
+	latency_last_report_ = std::chrono::steady_clock::now();
+	cache_last_report_   = latency_last_report_;
+
 	log_deb("Initialized RobotMemory");
 
 #ifdef USE_TIMETRACKER
 	tt_           = new TimeTracker();
+	tt_->set_name("robot-memory");
+	tt_->set_max_samples(1000);
 	tt_loopcount_ = 0;
 	ttc_events_   = tt_->add_class("RobotMemory Events");
 	ttc_cleanup_  = tt_->add_class("RobotMemory Cleanup");
@@ -184,6 +264,16 @@ RobotMemory::loop()
 	TIMETRACK_START(ttc_cleanup_);
 	computables_manager_->cleanup_computed_docs();
 	TIMETRACK_END(ttc_cleanup_);
+	if (cfg_latency_report_interval_ > 0.
+	    && std::chrono::steady_clock::now() - latency_last_report_
+	         >= std::chrono::duration<float>(cfg_latency_report_interval_)) {
+		report_latencies();
+	}
+	if (cfg_cache_report_interval_ > 0.
+	    && std::chrono::steady_clock::now() - cache_last_report_
+	         >= std::chrono::duration<float>(cfg_cache_report_interval_)) {
+		report_cache_statistics();
+	}
 #ifdef USE_TIMETRACKER
 	if (++tt_loopcount_ % 5 == 0) {
 		tt_->print_to_stdout();
@@ -191,6 +281,106 @@ RobotMemory::loop()
 #endif
 }
 
+/// @cond INTERNALS
+const char *RobotMemory::operation_names_[RobotMemory::OP_NUM] = {"query",
+                                                                  "computables",
+                                                                  "insert",
+                                                                  "update",
+                                                                  "find_one_and_update",
+                                                                  "remove",
+                                                                  "drop",
+                                                                  "create_index",
+                                                                  "mutex"};
+
+RobotMemory::OperationTimer::OperationTimer(RobotMemory *      robot_memory,
+                                            Operation          op,
+                                            const std::string &collection)
+: robot_memory_(robot_memory),
+  op_(op),
+  collection_(collection),
+  start_(std::chrono::steady_clock::now())
+{
+}
+
+RobotMemory::OperationTimer::~OperationTimer()
+{
+	std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - start_;
+	robot_memory_->latency_[op_]->observe(duration);
+	double msec = duration.count() / 1e6;
+	if (msec > robot_memory_->cfg_slow_threshold_ms_) {
+		robot_memory_->logger_->log_warn(robot_memory_->name_,
+		                                 "Slow %s on %s took %.1f ms",
+		                                 operation_names_[op_],
+		                                 collection_.c_str(),
+		                                 msec);
+	}
+}
+
+static std::string
+latency_summary(const MetricHistogram *histogram)
+{
+	std::vector<uint64_t> counts;
+	histogram->cumulative_counts(counts);
+	const std::vector<double> &upper_bounds = histogram->upper_bounds();
+
+	uint64_t n = counts.back();
+	char     tmp[64];
+	snprintf(tmp, sizeof(tmp), "n=%lu mean=%.2fms", (unsigned long)n, histogram->sum() / n * 1000.);
+	std::string rv = tmp;
+
+	const unsigned int percentiles[] = {50, 90, 99};
+	for (unsigned int p : percentiles) {
+		uint64_t rank = (uint64_t)std::ceil(p / 100. * n);
+		size_t   b    = 0;
+		while (b < upper_bounds.size() && counts[b] < rank)
+			++b;
+		if (b < upper_bounds.size()) {
+			snprintf(tmp, sizeof(tmp), " p%u<=%.2fms", p, upper_bounds[b] * 1000.);
+		} else {
+			snprintf(tmp, sizeof(tmp), " p%u>%.2fms", p, upper_bounds.back() * 1000.);
+		}
+		rv += tmp;
+	}
+	return rv;
+}
+/// @endcond
+
+/** Log latency statistics of all operations.
+ * The numbers are cumulative since the robot memory was started, they
+ * are also exported as fawkes_robot_memory_operation_seconds metric.
+ * Percentiles are given as the upper bound of the histogram bucket.
+ */
+void
+RobotMemory::report_latencies()
+{
+	for (unsigned int i = 0; i < OP_NUM; ++i) {
+		if (latency_[i]->count() > 0) {
+			logger_->log_info(name_,
+			                  "Latency %s: %s",
+			                  operation_names_[i],
+			                  latency_summary(latency_[i]).c_str());
+		}
+	}
+	latency_last_report_ = std::chrono::steady_clock::now();
+}
+
+/** Log query cache hit rate and invalidations.
+ * The numbers are cumulative since the robot memory was started.
+ */
+void
+RobotMemory::report_cache_statistics()
+{
+	if (query_cache_ && !query_cache_->collections().empty()) {
+		logger_->log_info(name_,
+		                  "Query cache: %lu hits, %lu misses (%.1f%% hit rate), %lu invalidations",
+		                  query_cache_->hits(),
+		                  query_cache_->misses(),
+		                  query_cache_->hit_rate() * 100.,
+		                  query_cache_->invalidations());
+	}
+	cache_last_report_ = std::chrono::steady_clock::now();
+}
+
 /**
  * Query information from the robot memory.
  * @param query The query returned documents have to match (essentially a BSONObj)
@@ -207,12 +397,12 @@ RobotMemory::query(document::view          query,
 	log_deb(std::string("Executing Query " + to_json(query) + " on collection " + collection_name));
 
 	//check if computation on demand is necessary and execute Computables
-	computables_manager_->check_and_compute(query, collection_name);
-
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
+	{
+		OperationTimer timer(this, OP_COMPUTABLES, collection_name);
+		computables_manager_->check_and_compute(query, collection_name);
+	}
 
-	//actually execute query
+	//actually execute query, documents are only retrieved when iterating the cursor
 	try {
 		return collection.find(query, query_options);
 	} catch (mongocxx::operation_exception &e) {
@@ -223,6 +413,99 @@ RobotMemory::query(document::view          query,
 	}
 }
 
+/**
+ * Enable the query cache for a collection.
+ * Collections listed in the config value
+ * /plugins/robot-memory/query-cache/collections are enabled on startup.
+ * Modifications are noticed through a change stream, hence mongod must
+ * run as a replica set.
+ * @param collection The database and collection to cache (e.g. robmem.worldmodel)
+ * @return true if the cache is enabled for the collection, false if the
+ * collection cannot be watched
+ */
+bool
+RobotMemory::enable_query_cache(const std::string &collection)
+{
+	if (query_cache_->enabled(collection)) {
+		return true;
+	}
+	try {
+		trigger_manager_->register_trigger(document::view(),
+		                                   collection,
+		                                   &QueryCache::on_change,
+		                                   query_cache_);
+		query_cache_->enable(collection);
+		log_deb("Enabled query cache for " + collection);
+		return true;
+	} catch (std::exception &e) {
+		logger_->log_warn(name_,
+		                  "Cannot watch %s, query cache disabled for it: %s",
+		                  collection.c_str(),
+		                  e.what());
+		return false;
+	}
+}
+
+/**
+ * Query information from the robot memory and retrieve all resulting documents.
+ * For collections for which the query cache is enabled (config value
+ * /plugins/robot-memory/query-cache/collections or enable_query_cache()),
+ * the result is cached
+ * until the collection is modified. Repeating the same query then does
+ * not require a round-trip to the database. Collections filled by
+ * computables are never cached.
+ * @param query The query returned documents have to match
+ * @param collection_name The database and collection to query as string (e.g. robmem.worldmodel)
+ * @param query_options Optional options to use to query the database
+ * @return shared pointer to the resulting documents, must not be modified
+ */
+QueryCache::DocumentsPtr
+RobotMemory::query_cached(document::view          query,
+                          const std::string &     collection_name,
+                          mongocxx::options::find query_options)
+{
+	bool cacheable = query_cache_->enabled(collection_name)
+	                 && !computables_manager_->has_computables(collection_name);
+
+	std::string key;
+	uint64_t    generation = 0;
+	if (cacheable) {
+		key                           = QueryCache::make_key(query, query_options);
+		QueryCache::DocumentsPtr docs = query_cache_->lookup(collection_name, key);
+		if (docs) {
+			return docs;
+		}
+		// get generation before querying, a concurrent modification then discards the result
+		generation = query_cache_->generation(collection_name);
+	} else {
+		OperationTimer timer(this, OP_COMPUTABLES, collection_name);
+		computables_manager_->check_and_compute(query, collection_name);
+	}
+
+	collection collection = get_collection(collection_name);
+	log_deb(std::string("Executing Query " + to_json(query) + " on collection " + collection_name));
+
+	std::shared_ptr<QueryCache::Documents> docs = std::make_shared<QueryCache::Documents>();
+	{
+		OperationTimer timer(this, OP_QUERY, collection_name);
+		try {
+			for (auto &&doc : collection.find(query, query_options)) {
+				docs->push_back(document::value(doc));
+			}
+		} catch (mongocxx::operation_exception &e) {
+			std::string error =
+			  std::string("Error for query ") + to_json(query) + "\n Exception: " + e.what();
+			log(error, "error");
+			throw;
+		}
+	}
+
+	if (cacheable) {
+		query_cache_->store(collection_name, key, docs, generation);
+	}
+	return docs;
+}
+
 /**
  * Aggregation call on the robot memory.
  * @param pipeline Series of commands defining the aggregation
@@ -277,8 +560,8 @@ RobotMemory::insert(bsoncxx::document::view doc, const std::string &collection_n
 {
 	collection collection = get_collection(collection_name);
 	log_deb(std::string("Inserting " + to_json(doc) + " into collection " + collection_name));
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
+	QueryCacheInvalidator invalidator(query_cache_, collection_name);
+	OperationTimer        timer(this, OP_INSERT, collection_name);
 	//actually execute insert
 	try {
 		collection.insert_one(doc);
@@ -305,9 +588,7 @@ RobotMemory::create_index(bsoncxx::document::view keys,
 	collection collection = get_collection(collection_name);
 
 	log_deb(std::string("Creating index " + to_json(keys) + " on collection " + collection_name));
-
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
+	OperationTimer timer(this, OP_CREATE_INDEX, collection_name);
 
 	//actually execute insert
 	try {
@@ -341,8 +622,8 @@ RobotMemory::insert(std::vector<bsoncxx::document::view> docs, const std::string
 	log_deb(std::string("Inserting vector of documents " + insert_string + " into collection "
 	                    + collection_name));
 
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
+	QueryCacheInvalidator invalidator(query_cache_, collection_name);
+	OperationTimer        timer(this, OP_INSERT, collection_name);
 
 	//actually execute insert
 	try {
@@ -386,8 +667,8 @@ RobotMemory::update(const bsoncxx::document::view &query,
 	log_deb(std::string("Executing Update " + to_json(update) + " for query " + to_json(query)
 	                    + " on collection " + collection_name));
 
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
+	QueryCacheInvalidator invalidator(query_cache_, collection_name);
+	OperationTimer        timer(this, OP_UPDATE, collection_name);
 
 	//actually execute update
 	try {
@@ -443,7 +724,8 @@ RobotMemory::find_one_and_update(const document::view &filter,
 	log_deb(std::string("Executing findOneAndUpdate " + to_json(update) + " for filter "
 	                    + to_json(filter) + " on collection " + collection_name));
 
-	MutexLocker lock(mutex_);
+	QueryCacheInvalidator invalidator(query_cache_, collection_name);
+	OperationTimer        timer(this, OP_FIND_ONE_AND_UPDATE, collection_name);
 
 	try {
 		auto res =
@@ -477,9 +759,9 @@ RobotMemory::find_one_and_update(const document::view &filter,
 int
 RobotMemory::remove(const bsoncxx::document::view &query, const std::string &collection_name)
 {
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
-	collection  collection = get_collection(collection_name);
+	QueryCacheInvalidator invalidator(query_cache_, collection_name);
+	OperationTimer        timer(this, OP_REMOVE, collection_name);
+	collection            collection = get_collection(collection_name);
 	log_deb(std::string("Executing Remove " + to_json(query) + " on collection " + collection_name));
 	//actually execute remove
 	try {
@@ -554,8 +836,9 @@ RobotMemory::aggregate(bsoncxx::document::view pipeline, const std::string &coll
 int
 RobotMemory::drop_collection(const std::string &collection_name)
 {
-	MutexLocker lock(mutex_);
-	collection  collection = get_collection(collection_name);
+	QueryCacheInvalidator invalidator(query_cache_, collection_name);
+	OperationTimer        timer(this, OP_DROP, collection_name);
+	collection            collection = get_collection(collection_name);
 	log_deb("Dropping collection " + collection_name);
 	collection.drop();
 	return 1;
@@ -568,11 +851,9 @@ RobotMemory::drop_collection(const std::string &collection_name)
 int
 RobotMemory::clear_memory()
 {
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
-
 	log_deb("Clearing whole robot memory");
-	mongodb_client_local_->database(database_name_).drop();
+	clients_local_->client()->database(database_name_).drop();
+	query_cache_->invalidate_all();
 	return 1;
 }
 
@@ -588,8 +869,7 @@ RobotMemory::restore_collection(const std::string &collection, const std::string
 	std::string coll{std::move(collection)};
 	drop_collection(coll);
 
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
+	QueryCacheInvalidator invalidator(query_cache_, collection);
 
 	//resolve path to restore
 	if (coll.find(".") == std::string::npos) {
@@ -637,9 +917,6 @@ RobotMemory::restore_collection(const std::string &collection, const std::string
 int
 RobotMemory::dump_collection(const std::string &collection, const std::string &directory)
 {
-	//lock (mongo_client not thread safe)
-	MutexLocker lock(mutex_);
-
 	//resolve path to dump to
 	if (collection.find(".") == std::string::npos) {
 		log(std::string("Unable to dump collection" + collection), "error");
@@ -738,15 +1015,25 @@ client *
 RobotMemory::get_mongodb_client(const std::string &collection)
 {
 	if (!distributed_) {
-		return mongodb_client_local_;
+		return clients_local_->client();
 	}
 	if (is_distributed_database(collection)) {
-		return mongodb_client_distributed_;
+		return clients_distributed_->client();
 	} else {
-		return mongodb_client_local_;
+		return clients_local_->client();
 	}
 }
 
+/**
+ * Get the mongodb client to use for coordination, i.e., for mutexes
+ * @return A pointer to the distributed client if enabled, the local client otherwise
+ */
+client *
+RobotMemory::get_coordination_client()
+{
+	return distributed_ ? clients_distributed_->client() : clients_local_->client();
+}
+
 /**
  * Get the collection object referred to by the given string.
  * @param dbcollection The name of the collection in the form <dbname>.<collname>
@@ -756,14 +1043,8 @@ RobotMemory::get_mongodb_client(const std::string &collection)
 collection
 RobotMemory::get_collection(const std::string &dbcollection)
 {
-	auto    db_coll_pair = split_db_collection_string(dbcollection);
-	client *client;
-	if (is_distributed_database(dbcollection)) {
-		client = mongodb_client_distributed_;
-	} else {
-		client = mongodb_client_local_;
-	}
-	return client->database(db_coll_pair.first)[db_coll_pair.second];
+	auto db_coll_pair = split_db_collection_string(dbcollection);
+	return get_mongodb_client(dbcollection)->database(db_coll_pair.first)[db_coll_pair.second];
 }
 
 /**
@@ -797,7 +1078,7 @@ RobotMemory::remove_computable(Computable *computable)
 bool
 RobotMemory::mutex_create(const std::string &name)
 {
-	client *client = distributed_ ? mongodb_client_distributed_ : mongodb_client_local_;
+	client *client = get_coordination_client();
 	using namespace bsoncxx::builder;
 	basic::document insert_doc{};
 	insert_doc.append(basic::kvp("$currentDate", [](basic::sub_document subdoc) {
@@ -806,9 +1087,10 @@ RobotMemory::mutex_create(const std::string &name)
 	insert_doc.append(basic::kvp("_id", name));
 	insert_doc.append(basic::kvp("locked", false));
 	try {
-		MutexLocker lock(mutex_);
-		collection  collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
-		auto        write_concern = mongocxx::write_concern();
+		OperationTimer timer(this, OP_MUTEX, cfg_coord_mutex_collection_);
+
+		collection collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
+		auto       write_concern = mongocxx::write_concern();
 		write_concern.majority(std::chrono::milliseconds(0));
 		collection.insert_one(insert_doc.view(), options::insert().write_concern(write_concern));
 		return true;
@@ -827,14 +1109,15 @@ RobotMemory::mutex_create(const std::string &name)
 bool
 RobotMemory::mutex_destroy(const std::string &name)
 {
-	client *client = distributed_ ? mongodb_client_distributed_ : mongodb_client_local_;
+	client *client = get_coordination_client();
 	using namespace bsoncxx::builder;
 	basic::document destroy_doc;
 	destroy_doc.append(basic::kvp("_id", name));
 	try {
-		MutexLocker lock(mutex_);
-		collection  collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
-		auto        write_concern = mongocxx::write_concern();
+		OperationTimer timer(this, OP_MUTEX, cfg_coord_mutex_collection_);
+
+		collection collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
+		auto       write_concern = mongocxx::write_concern();
 		write_concern.majority(std::chrono::milliseconds(0));
 		collection.delete_one(destroy_doc.view(),
 		                      options::delete_options().write_concern(write_concern));
@@ -859,7 +1142,7 @@ RobotMemory::mutex_destroy(const std::string &name)
 bool
 RobotMemory::mutex_try_lock(const std::string &name, const std::string &identity, bool force)
 {
-	client *client = distributed_ ? mongodb_client_distributed_ : mongodb_client_local_;
+	client *client = get_coordination_client();
 
 	std::string locked_by{identity};
 	if (identity.empty()) {
@@ -884,9 +1167,10 @@ RobotMemory::mutex_try_lock(const std::string &name, const std::string &identity
 		subdoc.append(basic::kvp("locked-by", locked_by));
 	}));
 	try {
-		MutexLocker lock(mutex_);
-		collection  collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
-		auto        write_concern = mongocxx::write_concern();
+		OperationTimer timer(this, OP_MUTEX, cfg_coord_mutex_collection_);
+
+		collection collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
+		auto       write_concern = mongocxx::write_concern();
 		write_concern.majority(std::chrono::milliseconds(0));
 		auto new_doc =
 		  collection.find_one_and_update(filter_doc.view(),
@@ -911,9 +1195,8 @@ RobotMemory::mutex_try_lock(const std::string &name, const std::string &identity
 			check_doc.append(basic::kvp("_id", name));
 			check_doc.append(basic::kvp("locked", true));
 			check_doc.append(basic::kvp("locked-by", locked_by));
-			MutexLocker lock(mutex_);
-			collection  collection = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
-			auto        res        = collection.find_one(check_doc.view());
+			collection collection = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
+			auto       res        = collection.find_one(check_doc.view());
 			logger_->log_info(name_, "Checking whether mutex was acquired succeeded");
 			if (res) {
 				logger_->log_warn(name_,
@@ -961,7 +1244,7 @@ RobotMemory::mutex_try_lock(const std::string &name, bool force)
 bool
 RobotMemory::mutex_unlock(const std::string &name, const std::string &identity)
 {
-	client *client = distributed_ ? mongodb_client_distributed_ : mongodb_client_local_;
+	client *client = get_coordination_client();
 
 	std::string locked_by{identity};
 	if (identity.empty()) {
@@ -985,9 +1268,10 @@ RobotMemory::mutex_unlock(const std::string &name, const std::string &identity)
 	}));
 
 	try {
-		MutexLocker lock(mutex_);
-		collection  collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
-		auto        write_concern = mongocxx::write_concern();
+		OperationTimer timer(this, OP_MUTEX, cfg_coord_mutex_collection_);
+
+		collection collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
+		auto       write_concern = mongocxx::write_concern();
 		write_concern.majority(std::chrono::milliseconds(0));
 		auto new_doc =
 		  collection.find_one_and_update(filter_doc.view(),
@@ -1014,7 +1298,7 @@ RobotMemory::mutex_unlock(const std::string &name, const std::string &identity)
 bool
 RobotMemory::mutex_renew_lock(const std::string &name, const std::string &identity)
 {
-	client *client = distributed_ ? mongodb_client_distributed_ : mongodb_client_local_;
+	client *client = get_coordination_client();
 
 	std::string locked_by{identity};
 	if (identity.empty()) {
@@ -1041,9 +1325,10 @@ RobotMemory::mutex_renew_lock(const std::string &name, const std::string &identi
 	}));
 
 	try {
-		MutexLocker lock(mutex_);
-		collection  collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
-		auto        write_concern = mongocxx::write_concern();
+		OperationTimer timer(this, OP_MUTEX, cfg_coord_mutex_collection_);
+
+		collection collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
+		auto       write_concern = mongocxx::write_concern();
 		write_concern.majority(std::chrono::milliseconds(0));
 		auto new_doc =
 		  collection.find_one_and_update(filter_doc.view(),
@@ -1073,9 +1358,7 @@ RobotMemory::mutex_renew_lock(const std::string &name, const std::string &identi
 bool
 RobotMemory::mutex_setup_ttl(float max_age_sec)
 {
-	MutexLocker lock(mutex_);
-
-	client *client = distributed_ ? mongodb_client_distributed_ : mongodb_client_local_;
+	client *client = get_coordination_client();
 
 	auto keys = builder::basic::make_document(builder::basic::kvp("lock-time", true));
 
@@ -1100,7 +1383,7 @@ RobotMemory::mutex_setup_ttl(float max_age_sec)
 bool
 RobotMemory::mutex_expire_locks(float max_age_sec)
 {
-	client *client = distributed_ ? mongodb_client_distributed_ : mongodb_client_local_;
+	client *client = get_coordination_client();
 
 	using std::chrono::high_resolution_clock;
 	using std::chrono::milliseconds;
@@ -1130,9 +1413,10 @@ RobotMemory::mutex_expire_locks(float max_age_sec)
 	}));
 
 	try {
-		MutexLocker lock(mutex_);
-		collection  collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
-		auto        write_concern = mongocxx::write_concern();
+		OperationTimer timer(this, OP_MUTEX, cfg_coord_mutex_collection_);
+
+		collection collection    = client->database(cfg_coord_database_)[cfg_coord_mutex_collection_];
+		auto       write_concern = mongocxx::write_concern();
 		write_concern.majority(std::chrono::milliseconds(0));
 		collection.update_many(filter_doc.view(),
 		                       update_doc.view(),
@@ -21,17 +21,21 @@
 #ifndef _PLUGINS_ROBOT_MEMORY_ROBOT_MEMORY_H_
 #define _PLUGINS_ROBOT_MEMORY_ROBOT_MEMORY_H_
 
+#include "client_pool.h"
 #include "computables/computables_manager.h"
 #include "event_trigger_manager.h"
+#include "query_cache.h"
 
 #include <aspect/blackboard.h>
 #include <aspect/clock.h>
 #include <aspect/configurable.h>
 #include <aspect/logging.h>
 #include <core/threading/mutex.h>
+#include <core/utils/metrics.h>
 #include <plugins/mongodb/aspect/mongodb_conncreator.h>
 
 #include <bsoncxx/json.hpp>
+#include <chrono>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -60,6 +64,11 @@ public:
 	mongocxx::cursor         query(bsoncxx::document::view query,
 	                               const std::string &     collection_name = "",
 	                               mongocxx::options::find query_options = mongocxx::options::find());
+	QueryCache::DocumentsPtr
+	query_cached(bsoncxx::document::view query,
+	             const std::string &     collection_name = "",
+	             mongocxx::options::find query_options   = mongocxx::options::find());
+	bool                     enable_query_cache(const std::string &collection);
 	bsoncxx::document::value aggregate(const std::vector<bsoncxx::document::view> &pipeline,
 	                                   const std::string &                         collection = "");
 	// TODO fix int return codes, should be booleans
@@ -171,8 +180,8 @@ public:
 
 private:
 	fawkes::MongoDBConnCreator *mongo_connection_manager_;
-	mongocxx::client *          mongodb_client_local_;
-	mongocxx::client *          mongodb_client_distributed_;
+	ClientPool *                clients_local_;
+	ClientPool *                clients_distributed_;
 	bool                        distributed_;
 	fawkes::Configuration *     config_;
 	fawkes::Logger *            logger_;
@@ -183,18 +192,57 @@ private:
 	std::string                   database_name_;
 	std::string                   default_collection_;
 	bool                          debug_;
-	fawkes::Mutex                 mutex_;
 	fawkes::RobotMemoryInterface *rm_if_;
 	EventTriggerManager *         trigger_manager_;
 	ComputablesManager *          computables_manager_;
+	QueryCache *                  query_cache_;
 	std::vector<std::string>      distributed_dbs_;
 
 	unsigned int cfg_startup_grace_period_;
 	std::string  cfg_coord_database_;
 	std::string  cfg_coord_mutex_collection_;
 
+	/// @cond INTERNALS
+	enum Operation {
+		OP_QUERY,
+		OP_COMPUTABLES,
+		OP_INSERT,
+		OP_UPDATE,
+		OP_FIND_ONE_AND_UPDATE,
+		OP_REMOVE,
+		OP_DROP,
+		OP_CREATE_INDEX,
+		OP_MUTEX,
+		OP_NUM
+	};
+
+	class OperationTimer
+	{
+	public:
+		OperationTimer(RobotMemory *robot_memory, Operation op, const std::string &collection);
+		~OperationTimer();
+
+	private:
+		RobotMemory *                                      robot_memory_;
+		Operation                                          op_;
+		const std::string &                                collection_;
+		std::chrono::time_point<std::chrono::steady_clock> start_;
+	};
+	/// @endcond
+
+	static const char *      operation_names_[OP_NUM];
+	fawkes::MetricHistogram *latency_[OP_NUM];
+	float                    cfg_slow_threshold_ms_;
+	float                    cfg_latency_report_interval_;
+	float                    cfg_cache_report_interval_;
+
+	std::chrono::time_point<std::chrono::steady_clock> latency_last_report_;
+	std::chrono::time_point<std::chrono::steady_clock> cache_last_report_;
+
 	void init();
 	void loop();
+	void report_latencies();
+	void report_cache_statistics();
 
 	// TODO make log level an enum (if we need it at all)
 	void log(const std::string &what, const std::string &level = "info");
@@ -208,6 +256,7 @@ private:
 
 	bool                 is_distributed_database(const std::string &dbcollection);
 	mongocxx::client *   get_mongodb_client(const std::string &collection);
+	mongocxx::client *   get_coordination_client();
 	mongocxx::collection get_collection(const std::string &dbcollection);
 
 #ifdef USE_TIMETRACKER
@@ -87,6 +87,8 @@ RobotMemoryThread::init()
 
 #ifdef USE_TIMETRACKER
 	tt_           = new TimeTracker();
+	tt_->set_name("robot-memory-thread");
+	tt_->set_max_samples(1000);
 	tt_loopcount_ = 0;
 	ttc_msgproc_  = tt_->add_class("Message Processing");
 	ttc_rmloop_   = tt_->add_class("Robot Memory Processing Loop");
@@ -116,16 +118,12 @@ RobotMemoryThread::loop()
 		if (robot_memory->rm_if_->msgq_first_is<RobotMemoryInterface::QueryMessage>()) {
 			RobotMemoryInterface::QueryMessage *msg =
 			  (RobotMemoryInterface::QueryMessage *)robot_memory->rm_if_->msgq_first();
-			std::string      query = msg->query();
-			mongocxx::cursor res   = robot_memory->query(bsoncxx::from_json(query), msg->collection());
+			std::string query = msg->query();
+			auto        res   = robot_memory->query_cached(bsoncxx::from_json(query), msg->collection());
 			//output result
 			std::string result = "Result of query " + query + ":\n";
-			while (true) {
-				auto doc = res.begin();
-				if (doc == res.end()) {
-					break;
-				}
-				result += bsoncxx::to_json(*doc) + "\n";
+			for (auto &doc : *res) {
+				result += bsoncxx::to_json(doc.view()) + "\n";
 			}
 			logger->log_info(name(), "%s", result.c_str());
 			robot_memory->rm_if_->set_result(result.c_str());
@@ -22,12 +22,14 @@
 #include "robot_memory_test.h"
 
 #include <interfaces/Position3DInterface.h>
+#include <plugins/robot-memory/computables/query_matcher.h>
 
 #include <algorithm>
 #include <bsoncxx/exception/exception.hpp>
 #include <list>
 #include <math.h>
 #include <mongocxx/exception/exception.hpp>
+#include <thread>
 
 using namespace fawkes;
 using namespace mongocxx;
@@ -115,6 +117,105 @@ TEST_F(RobotMemoryTest, Upsert)
 	ASSERT_NE(qres.begin(), qres.end());
 }
 
+TEST_F(RobotMemoryTest, QueryCachedStoreInsertQuery)
+{
+	ASSERT_TRUE(robot_memory->enable_query_cache("robmem.querycache"));
+	ASSERT_TRUE(robot_memory->insert(bsoncxx::from_json("{cached:'first'}"), "robmem.querycache"));
+	auto docs = robot_memory->query_cached(bsoncxx::from_json("{cached:{$exists:true}}"),
+	                                       "robmem.querycache");
+	ASSERT_EQ(1, docs->size());
+	// repeated query must still reflect the modification
+	ASSERT_TRUE(robot_memory->insert(bsoncxx::from_json("{cached:'second'}"), "robmem.querycache"));
+	docs = robot_memory->query_cached(bsoncxx::from_json("{cached:{$exists:true}}"),
+	                                  "robmem.querycache");
+	ASSERT_EQ(2, docs->size());
+	ASSERT_TRUE(robot_memory->remove(bsoncxx::from_json("{}"), "robmem.querycache"));
+	docs = robot_memory->query_cached(bsoncxx::from_json("{cached:{$exists:true}}"),
+	                                  "robmem.querycache");
+	ASSERT_TRUE(docs->empty());
+}
+
+TEST_F(RobotMemoryTest, QueryCacheKeyNormalized)
+{
+	mongocxx::options::find opts;
+	ASSERT_EQ(QueryCache::make_key(bsoncxx::from_json("{a:1, b:{$lt:3, $gt:1}}"), opts),
+	          QueryCache::make_key(bsoncxx::from_json("{b:{$gt:1, $lt:3}, a:1}"), opts));
+	// embedded documents are compared for equality, order matters
+	ASSERT_NE(QueryCache::make_key(bsoncxx::from_json("{a:{x:1, y:2}}"), opts),
+	          QueryCache::make_key(bsoncxx::from_json("{a:{y:2, x:1}}"), opts));
+	ASSERT_NE(QueryCache::make_key(bsoncxx::from_json("{a:1}"), opts),
+	          QueryCache::make_key(bsoncxx::from_json("{a:1}"), mongocxx::options::find().limit(1)));
+}
+
+TEST_F(RobotMemoryTest, QueryCacheInvalidation)
+{
+	QueryCache cache(2);
+	cache.enable("robmem.cache");
+	auto docs = std::make_shared<QueryCache::Documents>();
+	docs->push_back(bsoncxx::from_json("{a:1}"));
+
+	uint64_t gen = cache.generation("robmem.cache");
+	cache.store("robmem.cache", "k1", docs, gen);
+	ASSERT_EQ(docs, cache.lookup("robmem.cache", "k1"));
+	ASSERT_EQ(1, cache.hits());
+
+	// result of a query started before an invalidation is discarded
+	gen = cache.generation("robmem.cache");
+	cache.invalidate("robmem.cache");
+	ASSERT_FALSE(cache.lookup("robmem.cache", "k1"));
+	cache.store("robmem.cache", "k1", docs, gen);
+	ASSERT_FALSE(cache.lookup("robmem.cache", "k1"));
+
+	// change events invalidate the collection they refer to
+	cache.store("robmem.cache", "k1", docs, cache.generation("robmem.cache"));
+	cache.on_change(bsoncxx::from_json("{ns:{db:'robmem', coll:'cache'}}"));
+	ASSERT_FALSE(cache.lookup("robmem.cache", "k1"));
+
+	// oldest entry is dropped when exceeding the maximum
+	gen = cache.generation("robmem.cache");
+	cache.store("robmem.cache", "k1", docs, gen);
+	cache.store("robmem.cache", "k2", docs, gen);
+	cache.store("robmem.cache", "k3", docs, gen);
+	ASSERT_FALSE(cache.lookup("robmem.cache", "k1"));
+	ASSERT_TRUE(cache.lookup("robmem.cache", "k3"));
+}
+
+TEST_F(RobotMemoryTest, ConcurrentInsertQuery)
+{
+	using namespace bsoncxx::builder::basic;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.push_back(std::thread([this, t]() {
+			for (int i = 0; i < 25; ++i) {
+				auto doc = make_document(kvp("concurrent", t), kvp("i", i));
+				ASSERT_TRUE(robot_memory->insert(doc.view(), "robmem.concurrent"));
+				auto docs = robot_memory->query_cached(make_document(kvp("concurrent", t)).view(),
+				                                       "robmem.concurrent");
+				ASSERT_EQ(i + 1, docs->size());
+			}
+		}));
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	auto docs = robot_memory->query_cached(bsoncxx::from_json("{concurrent:{$exists:true}}"),
+	                                       "robmem.concurrent");
+	ASSERT_EQ(100, docs->size());
+	ASSERT_TRUE(robot_memory->drop_collection("robmem.concurrent"));
+}
+
+TEST_F(RobotMemoryTest, OperationLatency)
+{
+	MetricHistogram *latency =
+	  MetricSet::core().histogram("fawkes_robot_memory_operation_seconds",
+	                              "Time spent in robot memory operations",
+	                              {},
+	                              {{"op", "insert"}});
+	uint64_t before = latency->count();
+	ASSERT_TRUE(robot_memory->insert(bsoncxx::from_json("{latency:'recorded'}"), "robmem.test"));
+	ASSERT_GT(latency->count(), before);
+}
+
 TEST_F(RobotMemoryTest, QueryInvalid)
 {
 	ASSERT_THROW(robot_memory->query(bsoncxx::from_json("{key-:+'not existing'}")),
@@ -378,6 +479,27 @@ TEST_F(RobotMemoryTest, ComputableMultiple)
 	robot_memory->remove_computable(comp);
 }
 
+TEST_F(RobotMemoryTest, ComputableQueryMatcher)
+{
+	using bsoncxx::from_json;
+	ASSERT_EQ(QueryMatcher::MATCH,
+	          QueryMatcher::match(from_json("{interface:{$exists:true}}"),
+	                              from_json("{interface:'Position3DInterface', id:'test'}")));
+	ASSERT_EQ(QueryMatcher::NO_MATCH,
+	          QueryMatcher::match(from_json("{frame:{$exists:true}, allow_tf:true}"),
+	                              from_json("{frame:'base_link'}")));
+	ASSERT_EQ(QueryMatcher::MATCH,
+	          QueryMatcher::match(from_json("{a:1, 'b.c':{$in:['x', 'y']}}"),
+	                              from_json("{a:1.0, b:{c:'y'}}")));
+	ASSERT_EQ(QueryMatcher::MATCH,
+	          QueryMatcher::match(from_json("{$or:[{a:{$gt:5}}, {tags:'t'}]}"),
+	                              from_json("{a:3, tags:['s', 't']}")));
+	ASSERT_EQ(QueryMatcher::UNSUPPORTED,
+	          QueryMatcher::match(from_json("{a:{$size:2}}"), from_json("{a:[1, 2]}")));
+	ASSERT_TRUE(QueryMatcher::has_operator_keys(from_json("{a:{$exists:true}}")));
+	ASSERT_FALSE(QueryMatcher::has_operator_keys(from_json("{a:{b:1}}")));
+}
+
 TEST_F(RobotMemoryTest, BlackboardComputable)
 {
 	Position3DInterface *if3d = blackboard->open_for_writing<Position3DInterface>("test1");
@@ -66,6 +66,8 @@ public:
    * where TIMESTAMP|N is either a timestamp (in seconds since the epoch), or
    * the letter N to use the current time. DATA is a concatenation of formats
    * according to man sprintf and concatenated by colons, e.g. 1:2:3:4.5.
+   * The data may be written asynchronously, in which case N refers to the
+   * time of the call and errors while writing are only logged.
    */
 	virtual void add_data(const char *rrd_name, const char *format, ...) = 0;
 
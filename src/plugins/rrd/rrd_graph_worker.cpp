@@ -0,0 +1,86 @@
+/***************************************************************************
+ *  rrd_graph_worker.cpp - RRD graph rendering worker
+ *
+ *  Created: Sun Oct 18 00:52:06 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "rrd_graph_worker.h"
+
+#include <core/threading/mutex_locker.h>
+#include <core/threading/scoped_rwlock.h>
+#include <logging/logger.h>
+#include <plugins/rrd/aspect/rrd_descriptions.h>
+
+#include <rrd.h>
+
+using namespace fawkes;
+
+/** @class RRDGraphWorker "rrd_graph_worker.h"
+ * RRD graph rendering worker.
+ * Rendering graphs takes considerably longer than updating an RRD.
+ * Therefore, graphs are rendered by this worker, which is woken up by
+ * the RRD thread. rrd_graph_v() is not reentrant, it parses its
+ * arguments with getopt() and keeps global state, hence graphs are
+ * rendered one after another, each while holding the mutex that also
+ * guards the other non-reentrant librrd calls of the RRD thread.
+ * Failing to render a graph is logged and does not affect other graphs.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param graphs graphs to render
+ * @param logger logger for error messages
+ * @param rrd_mutex mutex to hold while calling non-reentrant librrd functions
+ */
+RRDGraphWorker::RRDGraphWorker(const RWLockVector<RRDGraphDefinition *> &graphs,
+                               Logger *                                  logger,
+                               Mutex *                                   rrd_mutex)
+: Thread("RRDGraphWorker", Thread::OPMODE_WAITFORWAKEUP),
+  graphs_(graphs),
+  logger_(logger),
+  rrd_mutex_(rrd_mutex)
+{
+}
+
+/** Destructor. */
+RRDGraphWorker::~RRDGraphWorker()
+{
+}
+
+void
+RRDGraphWorker::loop()
+{
+	ScopedRWLock lock(graphs_.rwlock(), ScopedRWLock::LOCK_READ);
+
+	for (RRDGraphDefinition *graph_def : graphs_) {
+		size_t       argc = 0;
+		const char **argv = graph_def->get_argv(argc);
+
+		MutexLocker rrd_lock(rrd_mutex_);
+		rrd_clear_error();
+		rrd_info_t *i = rrd_graph_v(argc, (char **)argv);
+		if (i == NULL) {
+			logger_->log_warn(name(),
+			                  "Creating graph %s (for RRD %s) failed: %s",
+			                  graph_def->get_name(),
+			                  graph_def->get_rrd_def()->get_name(),
+			                  rrd_get_error());
+			continue;
+		}
+		rrd_info_free(i);
+	}
+}
@@ -0,0 +1,57 @@
+/***************************************************************************
+ *  rrd_graph_worker.h - RRD graph rendering worker
+ *
+ *  Created: Sun Oct 18 00:52:06 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_RRD_RRD_GRAPH_WORKER_H_
+#define _PLUGINS_RRD_RRD_GRAPH_WORKER_H_
+
+#include <core/threading/thread.h>
+#include <core/utils/rwlock_vector.h>
+
+namespace fawkes {
+class Logger;
+class Mutex;
+class RRDGraphDefinition;
+} // namespace fawkes
+
+class RRDGraphWorker : public fawkes::Thread
+{
+public:
+	RRDGraphWorker(const fawkes::RWLockVector<fawkes::RRDGraphDefinition *> &graphs,
+	               fawkes::Logger *                                          logger,
+	               fawkes::Mutex *                                           rrd_mutex);
+	virtual ~RRDGraphWorker();
+
+	virtual void loop();
+
+	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
+protected:
+	virtual void
+	run()
+	{
+		Thread::run();
+	}
+
+private:
+	const fawkes::RWLockVector<fawkes::RRDGraphDefinition *> &graphs_;
+	fawkes::Logger *                                          logger_;
+	fawkes::Mutex *                                           rrd_mutex_;
+};
+
+#endif
@@ -22,11 +22,18 @@
 
 #include "rrd_thread.h"
 
+#include "rrd_graph_worker.h"
+
 #include <core/exceptions/system.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
 #include <core/threading/scoped_rwlock.h>
+#include <core/threading/wait_condition.h>
 #include <utils/misc/string_conversions.h>
 #include <utils/system/file.h>
+#include <utils/time/time.h>
 
+#include <cmath>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -41,6 +48,17 @@ using namespace fawkes;
  * aspect to access RRD to make it convenient for other threads to use
  * RRD.
  *
+ * Adding data does not write to the RRD immediately, which would block
+ * the calling thread on disk I/O. Updates are queued per RRD file and
+ * written by this thread once every flush interval, all pending values
+ * of a file with a single update call. Graphs are rendered by a graph
+ * worker so that slow graphing does not delay writing updates.
+ *
+ * Updates are written with the reentrant rrd_update_r(). Creating RRDs
+ * and rendering graphs is only possible with functions that parse their
+ * arguments with getopt() and are not reentrant, these calls are
+ * serialized with a mutex.
+ *
  * @author Tim Niemueller
  */
 
@@ -51,11 +69,24 @@ RRDThread::RRDThread()
   rrd_aspect_inifin_(this)
 {
 	set_prepfin_conc_loop(true);
+
+	queue_mutex_    = new Mutex();
+	queue_waitcond_ = new WaitCondition(queue_mutex_);
+	queue_length_   = 0;
+	num_dropped_    = 0;
+	rrd_mutex_      = new Mutex();
+
+	// defaults until the configuration has been read in init()
+	cfg_flush_interval_ = 5.;
+	cfg_queue_size_     = 10000;
 }
 
 /** Destructor. */
 RRDThread::~RRDThread()
 {
+	delete queue_waitcond_;
+	delete queue_mutex_;
+	delete rrd_mutex_;
 }
 
 void
@@ -67,48 +98,159 @@ RRDThread::init()
 	} catch (Exception &e) {
 	}
 
-	time_wait_ = new TimeWait(clock, time_sec_to_usec(cfg_graph_interval_));
+	MutexLocker lock(queue_mutex_);
+	try {
+		cfg_flush_interval_ = config->get_float("/plugins/rrd/flush_interval");
+	} catch (Exception &e) {
+	}
+	try {
+		cfg_queue_size_ = config->get_uint("/plugins/rrd/queue_size");
+	} catch (Exception &e) {
+	}
+	if (cfg_queue_size_ == 0)
+		cfg_queue_size_ = 1;
+	lock.unlock();
+
+	last_graph_ = new Time(clock);
+
+	graph_worker_ = new RRDGraphWorker(graphs_, logger, rrd_mutex_);
+	graph_worker_->start();
+
+	logger->log_info(name(), "Writing updates every %.1f sec", cfg_flush_interval_);
+}
+
+bool
+RRDThread::prepare_finalize_user()
+{
+	// stop waiting for the flush interval, loop() returns and the thread
+	// can be cancelled outside of the wait
+	MutexLocker lock(queue_mutex_);
+	queue_waitcond_->wake_all();
+	return true;
 }
 
 void
 RRDThread::finalize()
 {
-	delete time_wait_;
+	graph_worker_->cancel();
+	graph_worker_->join();
+	delete graph_worker_;
+
+	flush_updates();
+
+	delete last_graph_;
 }
 
 void
 RRDThread::loop()
 {
-	time_wait_->mark_start();
-	generate_graphs();
-	time_wait_->wait_systime();
+	UpdateQueue updates;
+
+	// The queue mutex is not released if cancelled while waiting, which
+	// would block finalize() and every add_data() caller. Cancellation is
+	// deferred until loop() returns, prepare_finalize() wakes us up early.
+	CancelState old_state;
+	set_cancel_state(CANCEL_DISABLED, &old_state);
+
+	queue_mutex_->lock();
+	// finalize_prepared is set before prepare_finalize_user() wakes us up
+	// and reset if finalization is cancelled
+	if (!finalize_prepared && queue_length_ < cfg_queue_size_ / 2) {
+		float        wait_sec;
+		float        wait_frac = modff(cfg_flush_interval_, &wait_sec);
+		unsigned int nsec      = (unsigned int)(wait_frac * 1000000000.);
+		queue_waitcond_->reltimed_wait((unsigned int)wait_sec, nsec);
+	}
+	updates.swap(queue_);
+	queue_length_        = 0;
+	unsigned int dropped = num_dropped_;
+	num_dropped_         = 0;
+	queue_mutex_->unlock();
+
+	write_updates(updates);
+	if (dropped > 0) {
+		logger->log_warn(name(), "Dropped %u updates, queue too small or disk too slow", dropped);
+	}
+
+	Time now(clock);
+	if (now - last_graph_ >= cfg_graph_interval_) {
+		*last_graph_ = now;
+		generate_graphs();
+	}
+	set_cancel_state(old_state);
 }
 
-/** Generate all graphs. */
+/** Generate all graphs.
+ * Wakes up the graph worker to render the graphs. If it is still busy
+ * rendering from the last request, the request is skipped.
+ */
 void
 RRDThread::generate_graphs()
 {
-	ScopedRWLock lock(graphs_.rwlock(), ScopedRWLock::LOCK_READ);
+	if (graph_worker_->waiting()) {
+		graph_worker_->wakeup();
+	} else {
+		logger->log_debug(name(), "%s still busy, skipping", graph_worker_->name());
+	}
+}
 
-	std::vector<fawkes::RRDGraphDefinition *>::iterator g;
-	for (g = graphs_.begin(); g != graphs_.end(); ++g) {
-		size_t       argc = 0;
-		const char **argv = (*g)->get_argv(argc);
+/** Write all pending updates now. */
+void
+RRDThread::flush_updates()
+{
+	UpdateQueue updates;
+	queue_mutex_->lock();
+	updates.swap(queue_);
+	queue_length_ = 0;
+	queue_mutex_->unlock();
+	write_updates(updates);
+}
 
-		//logger->log_debug(name(), "rrd_graph arguments:");
-		//for (size_t j = 0; j < argc; ++j) {
-		//  logger->log_debug(name(), "  %zu: %s", j, argv[j]);
-		//}
+/** Write updates to RRD files.
+ * @param updates updates to write, one update call per file
+ */
+void
+RRDThread::write_updates(UpdateQueue &updates)
+{
+	for (auto &u : updates) {
+		size_t      rrd_argc = u.second.size();
+		const char *rrd_argv[rrd_argc];
+		size_t      i = 0;
+		for (const std::string &data : u.second) {
+			rrd_argv[i++] = data.c_str();
+		}
 
 		rrd_clear_error();
-		rrd_info_t *i = rrd_graph_v(argc, (char **)argv);
-		if (i == NULL) {
-			throw Exception("Creating graph %s (for RRD %s) failed: %s",
-			                (*g)->get_name(),
-			                (*g)->get_rrd_def()->get_name(),
-			                rrd_get_error());
+		if (rrd_update_r(u.first.c_str(), NULL, i, rrd_argv) == -1) {
+			logger->log_warn(name(), "Failed to update %s: %s", u.first.c_str(), rrd_get_error());
+
+			// RRD stops at the first rejected value, all values up to and
+			// including the last update time have been written or can no
+			// longer be. Write the remaining values one by one. The last
+			// update time is reported in full seconds, compare the same.
+			time_t       last_update = rrd_last_r(u.first.c_str());
+			unsigned int num_lost    = 0;
+			for (const std::string &data : u.second) {
+				char * ts_end;
+				double ts = strtod(data.c_str(), &ts_end);
+				if (ts_end != data.c_str() && *ts_end == ':' && (time_t)ts <= last_update) {
+					continue;
+				}
+				const char *single_argv[1] = {data.c_str()};
+				rrd_clear_error();
+				if (rrd_update_r(u.first.c_str(), NULL, 1, single_argv) == -1) {
+					logger->log_debug(name(), "Dropping '%s': %s", data.c_str(), rrd_get_error());
+					num_lost += 1;
+				}
+			}
+			if (num_lost > 0) {
+				logger->log_warn(name(),
+				                 "%u more of %zu updates to %s failed",
+				                 num_lost,
+				                 u.second.size(),
+				                 u.first.c_str());
+			}
 		}
-		rrd_info_free(i);
 	}
 }
 
@@ -154,6 +296,7 @@ RRDThread::add_rrd(RRDDefinition *rrd_def)
 		//}
 
 		// Create RRD file
+		MutexLocker rrd_lock(rrd_mutex_);
 		rrd_clear_error();
 		if (rrd_create(i, (char **)rrd_argv) == -1) {
 			throw Exception("Creating RRD %s failed: %s", rrd_def->get_name(), rrd_get_error());
@@ -239,26 +382,28 @@ RRDThread::add_data(const char *rrd_name, const char *format, ...)
 			}
 			va_end(arg);
 
-			// filename data
-			size_t      rrd_argc = 3;
-			const char *rrd_argv[rrd_argc];
-			size_t      i = 0;
-			rrd_argv[i++] = "update";
-			rrd_argv[i++] = rrd_def->get_filename();
-			rrd_argv[i++] = data;
-
-			//logger->log_debug(name(), "rrd_update arguments:");
-			//for (size_t j = 0; j < i; ++j) {
-			//  logger->log_debug(name(), "  %zu: %s", j, rrd_argv[j]);
-			//}
-
-			rrd_clear_error();
-			if (rrd_update(i, (char **)rrd_argv) == -1) {
-				free(data);
-				throw Exception("Failed to update RRD %s: %s", rrd_name, rrd_get_error());
+			// N means now, which would be the time of writing the update,
+			// replace it by the current time to keep the time of adding
+			std::string update;
+			if (strncmp(data, "N:", 2) == 0) {
+				Time now(clock);
+				char ts[32];
+				snprintf(ts, sizeof(ts), "%ld.%06ld", now.get_sec(), now.get_usec());
+				update = std::string(ts) + (data + 1);
+			} else {
+				update = data;
 			}
-
 			free(data);
+
+			MutexLocker queue_lock(queue_mutex_);
+			if (queue_length_ >= cfg_queue_size_) {
+				num_dropped_ += 1;
+				return;
+			}
+			queue_[rrd_def->get_filename()].push_back(update);
+			if (++queue_length_ >= cfg_queue_size_ / 2) {
+				queue_waitcond_->wake_all();
+			}
 			return;
 		}
 	}
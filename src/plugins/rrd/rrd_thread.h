@@ -31,7 +31,18 @@
 #include <core/utils/rwlock_vector.h>
 #include <plugins/rrd/aspect/rrd_inifin.h>
 #include <plugins/rrd/aspect/rrd_manager.h>
-#include <utils/time/wait.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+class Mutex;
+class Time;
+class WaitCondition;
+} // namespace fawkes
+
+class RRDGraphWorker;
 
 class RRDThread : public fawkes::Thread,
                   public fawkes::LoggingAspect,
@@ -46,6 +57,7 @@ public:
 
 	virtual void init();
 	virtual void loop();
+	virtual bool prepare_finalize_user();
 	virtual void finalize();
 
 	// for RRDManager
@@ -59,6 +71,7 @@ public:
 	virtual const fawkes::RWLockVector<fawkes::RRDGraphDefinition *> &get_graphs() const;
 
 	void generate_graphs();
+	void flush_updates();
 
 	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
 protected:
@@ -68,14 +81,32 @@ protected:
 		Thread::run();
 	}
 
+private:
+	/// @cond INTERNALS
+	typedef std::map<std::string, std::vector<std::string>> UpdateQueue;
+	/// @endcond
+
+	void write_updates(UpdateQueue &updates);
+
 private:
 	fawkes::RRDAspectIniFin rrd_aspect_inifin_;
 
 	fawkes::RWLockVector<fawkes::RRDDefinition *>      rrds_;
 	fawkes::RWLockVector<fawkes::RRDGraphDefinition *> graphs_;
 
-	fawkes::TimeWait *time_wait_;
-	float             cfg_graph_interval_;
+	float        cfg_graph_interval_;
+	float        cfg_flush_interval_;
+	unsigned int cfg_queue_size_;
+
+	fawkes::Mutex *        queue_mutex_;
+	fawkes::WaitCondition *queue_waitcond_;
+	UpdateQueue            queue_;
+	unsigned int           queue_length_;
+	unsigned int           num_dropped_;
+
+	fawkes::Mutex * rrd_mutex_;
+	fawkes::Time *  last_graph_;
+	RRDGraphWorker *graph_worker_;
 };
 
 #endif
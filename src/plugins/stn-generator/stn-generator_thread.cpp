@@ -102,9 +102,10 @@ StnGeneratorThread::loop()
 	pddl_problem.assign((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
 	stn_->read_initial_state(pddl_problem);
 
-	auto cursor = robot_memory->query(from_json("{plan:1}"), cfg_plan_collection_);
-	for (auto doc : cursor) {
-		array::view actions = doc["actions"].get_array();
+	auto plans = robot_memory->query_cached(from_json("{plan:1}"), cfg_plan_collection_);
+	for (auto &plan : *plans) {
+		bsoncxx::document::view doc     = plan.view();
+		array::view             actions = doc["actions"].get_array();
 		for (auto &a : actions) {
 			std::string args;
 			bool        first      = true;
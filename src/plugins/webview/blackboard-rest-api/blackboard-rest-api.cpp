@@ -21,6 +21,8 @@
 
 #include "blackboard-rest-api.h"
 
+#include "stream_reply.h"
+
 #include <core/threading/mutex_locker.h>
 #include <interface/interface.h>
 #include <interface/message.h>
@@ -28,6 +30,8 @@
 #include <utils/time/wait.h>
 #include <webview/rest_api_manager.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <set>
 
 using namespace fawkes;
@@ -38,8 +42,11 @@ using namespace fawkes;
  */
 
 /** Constructor. */
-BlackboardRestApi::BlackboardRestApi() : Thread("BlackboardRestApi", Thread::OPMODE_WAITFORWAKEUP)
+BlackboardRestApi::BlackboardRestApi()
+: Thread("BlackboardRestApi", Thread::OPMODE_CONTINUOUS),
+  streams_(std::make_shared<BlackboardStreamWebReply::Registry>())
 {
+	set_prepfin_conc_loop(true);
 }
 
 /** Destructor. */
@@ -50,14 +57,47 @@ BlackboardRestApi::~BlackboardRestApi()
 void
 BlackboardRestApi::init()
 {
+	cfg_cache_idle_time_ = 30.;
+	try {
+		cfg_cache_idle_time_ = config->get_float("/webview/blackboard/cache-idle-time");
+	} catch (Exception &e) {
+	} // ignored, use default
+
+	cfg_stream_max_rate_           = 10.;
+	cfg_stream_keepalive_interval_ = 10.;
+	cfg_stream_max_clients_        = 4;
+	try {
+		cfg_stream_max_rate_ = config->get_float("/webview/blackboard/stream/max-rate");
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		cfg_stream_keepalive_interval_ =
+		  config->get_float("/webview/blackboard/stream/keepalive-interval");
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		cfg_stream_max_clients_ = config->get_uint("/webview/blackboard/stream/max-clients");
+	} catch (Exception &e) {
+	} // ignored, use default
+
 	rest_api_ = new WebviewRestApi("blackboard", logger);
 	rest_api_->add_handler<WebviewRestArray<::InterfaceInfo>>(
 	  WebRequest::METHOD_GET, "/interfaces", std::bind(&BlackboardRestApi::cb_list_interfaces, this));
-	rest_api_->add_handler<InterfaceData>(WebRequest::METHOD_GET,
-	                                      "/interfaces/{type}/{id+}/data",
-	                                      std::bind(&BlackboardRestApi::cb_get_interface_data,
-	                                                this,
-	                                                std::placeholders::_1));
+	rest_api_->add_handler(WebRequest::METHOD_GET,
+	                       "/interfaces/stream",
+	                       std::bind(&BlackboardRestApi::cb_stream_interfaces_data,
+	                                 this,
+	                                 std::placeholders::_1));
+	rest_api_->add_handler(WebRequest::METHOD_GET,
+	                       "/interfaces/data",
+	                       std::bind(&BlackboardRestApi::cb_get_interfaces_data,
+	                                 this,
+	                                 std::placeholders::_1));
+	rest_api_->add_handler(WebRequest::METHOD_GET,
+	                       "/interfaces/{type}/{id+}/data",
+	                       std::bind(&BlackboardRestApi::cb_get_interface_data,
+	                                 this,
+	                                 std::placeholders::_1));
 	rest_api_->add_handler<::InterfaceInfo>(WebRequest::METHOD_GET,
 	                                        "/interfaces/{type}/{id+}",
 	                                        std::bind(&BlackboardRestApi::cb_get_interface_info,
@@ -74,11 +114,57 @@ BlackboardRestApi::finalize()
 {
 	webview_rest_api_manager->unregister_api(rest_api_);
 	delete rest_api_;
+
+	// end open streams, they are deleted by the web server afterwards. They
+	// run code of this plugin, hence wait for all of them before unloading.
+	// Streams never block in the web server, they end promptly.
+	MutexLocker streams_lock(&streams_->mutex);
+	for (auto s : streams_->streams) {
+		s->terminate();
+	}
+	while (!streams_->streams.empty()) {
+		if (!streams_->waitcond.reltimed_wait(5, 0) && !streams_->streams.empty()) {
+			logger->log_warn(name(),
+			                 "Waiting for %zu streams to close on finalize",
+			                 streams_->streams.size());
+		}
+	}
+	streams_lock.unlock();
+
+	MutexLocker lock(&cache_mutex_);
+	for (auto &c : iface_cache_) {
+		blackboard->close(c.second.iface);
+	}
+	iface_cache_.clear();
 }
 
 void
 BlackboardRestApi::loop()
 {
+	// do not get cancelled while holding the lock or closing interfaces
+	CancelState old_cancel_state;
+	set_cancel_state(CANCEL_DISABLED, &old_cancel_state);
+
+	cache_mutex_.lock();
+	expire_cached_interfaces();
+	cache_mutex_.unlock();
+
+	// streams are suspended while waiting, resume those with delayed events
+	// or a pending keep-alive
+	streams_->mutex.lock();
+	for (auto s : streams_->streams) {
+		s->resume_if_due();
+	}
+	streams_->mutex.unlock();
+
+	set_cancel_state(old_cancel_state);
+
+	// wake up often enough to honor the maximum stream rate
+	long int wait_usec = 1000000;
+	if (cfg_stream_max_rate_ > 1.) {
+		wait_usec = (long int)(1000000. / cfg_stream_max_rate_);
+	}
+	TimeWait::wait(wait_usec);
 }
 
 std::vector<std::shared_ptr<InterfaceFieldType>>
@@ -282,11 +368,93 @@ BlackboardRestApi::cb_get_interface_info(WebviewRestParams &params)
 	return gen_interface_info(ifls->front());
 }
 
-InterfaceData
+/** Get cached reading instance of an interface.
+ * Opens the interface if it is not yet cached. Must be called with
+ * the cache mutex locked.
+ * @param type interface type
+ * @param id interface ID
+ * @return cache entry
+ */
+BlackboardRestApi::CachedInterface &
+BlackboardRestApi::cached_interface(const std::string &type, const std::string &id)
+{
+	std::string uid = type + "::" + id;
+
+	auto c = iface_cache_.find(uid);
+	if (c == iface_cache_.end()) {
+		std::unique_ptr<InterfaceInfoList> ifls{blackboard->list(type.c_str(), id.c_str())};
+		if (ifls->size() == 0) {
+			throw WebviewRestException(WebReply::HTTP_NOT_FOUND,
+			                           "Interface %s::%s: is currently not available",
+			                           type.c_str(),
+			                           id.c_str());
+		}
+
+		CachedInterface ci;
+		try {
+			ci.iface = blackboard->open_for_reading(type.c_str(), id.c_str());
+		} catch (Exception &e) {
+			throw WebviewRestException(WebReply::HTTP_NOT_FOUND,
+			                           "Failed to open %s::%s: %s",
+			                           type.c_str(),
+			                           id.c_str(),
+			                           e.what_no_backtrace());
+		}
+		c = iface_cache_.insert(std::make_pair(uid, ci)).first;
+	}
+	c->second.last_access = Time(clock);
+	return c->second;
+}
+
+/** Update cached interface data.
+ * The data is only copied and serialized again if the interface data
+ * or its readers and writer have changed.
+ * @param ci cache entry to update
+ */
+void
+BlackboardRestApi::refresh_cached_interface(CachedInterface &ci)
+{
+	bool changed = ci.iface->read_if_changed();
+
+	std::hash<std::string> hash;
+	size_t                 owners_hash = ci.iface->has_writer() ? hash(ci.iface->writer()) : 0;
+	for (const auto &r : ci.iface->readers()) {
+		owners_hash = owners_hash * 31 + hash(r);
+	}
+
+	const Time *t = ci.iface->timestamp();
+	char        etag[64];
+	snprintf(etag, sizeof(etag), "\"%lx.%lx-%zx\"", t->get_sec(), t->get_usec(), owners_hash);
+
+	if (changed || ci.json.empty() || ci.etag != etag) {
+		ci.etag = etag;
+		ci.json = gen_interface_data(ci.iface, false).to_json(false);
+	}
+}
+
+/** Close cached interfaces which have not been accessed recently.
+ * Interfaces without a writer are closed as well such that they can
+ * vanish from the blackboard. Must be called with the cache mutex locked.
+ */
+void
+BlackboardRestApi::expire_cached_interfaces()
+{
+	Time now(clock);
+	for (auto c = iface_cache_.begin(); c != iface_cache_.end();) {
+		if ((now - c->second.last_access).in_sec() > cfg_cache_idle_time_
+		    || !c->second.iface->has_writer()) {
+			blackboard->close(c->second.iface);
+			c = iface_cache_.erase(c);
+		} else {
+			++c;
+		}
+	}
+}
+
+std::unique_ptr<WebReply>
 BlackboardRestApi::cb_get_interface_data(WebviewRestParams &params)
 {
 	bool pretty = params.has_query_arg("pretty");
-	params.set_pretty_json(pretty);
 
 	if (params.path_arg("type").find_first_of("*?") != std::string::npos) {
 		throw WebviewRestException(WebReply::HTTP_BAD_REQUEST, "Type may not contain any of [*?].");
@@ -295,40 +463,136 @@ BlackboardRestApi::cb_get_interface_data(WebviewRestParams &params)
 		throw WebviewRestException(WebReply::HTTP_BAD_REQUEST, "ID may not contain any of [*?].");
 	}
 
-	std::unique_ptr<InterfaceInfoList> ifls{
-	  blackboard->list(params.path_arg("type").c_str(), params.path_arg("id").c_str())};
-	if (ifls->size() == 0) {
-		throw WebviewRestException(WebReply::HTTP_NOT_FOUND,
-		                           "Interface %s::%s: is currently not available",
-		                           params.path_arg("type").c_str(),
-		                           params.path_arg("id").c_str());
-	}
+	MutexLocker lock(&cache_mutex_);
 
-	Interface *iface = nullptr;
+	CachedInterface &ci = cached_interface(params.path_arg("type"), params.path_arg("id"));
 	try {
-		iface =
-		  blackboard->open_for_reading(params.path_arg("type").c_str(), params.path_arg("id").c_str());
-		iface->read();
+		refresh_cached_interface(ci);
 	} catch (Exception &e) {
+		blackboard->close(ci.iface);
+		iface_cache_.erase(params.path_arg("type") + "::" + params.path_arg("id"));
 		throw WebviewRestException(WebReply::HTTP_NOT_FOUND,
-		                           "Failed to open %s::%s: %s",
+		                           "Failed to read %s:%s: %s",
 		                           params.path_arg("type").c_str(),
 		                           params.path_arg("id").c_str(),
 		                           e.what_no_backtrace());
 	}
 
+	std::unique_ptr<WebviewRestReply> reply;
+	if (params.header("If-None-Match").find(ci.etag) != std::string::npos) {
+		reply = std::make_unique<WebviewRestReply>(WebReply::HTTP_NOT_MODIFIED);
+	} else if (pretty) {
+		reply = std::make_unique<WebviewRestReply>(WebReply::HTTP_OK,
+		                                           gen_interface_data(ci.iface, true).to_json(true));
+	} else {
+		reply = std::make_unique<WebviewRestReply>(WebReply::HTTP_OK, ci.json);
+	}
+	reply->add_header("ETag", ci.etag);
+	return reply;
+}
+
+std::unique_ptr<WebReply>
+BlackboardRestApi::cb_get_interfaces_data(WebviewRestParams &params)
+{
+	bool        pretty       = params.has_query_arg("pretty");
+	std::string type_pattern = params.has_query_arg("type") ? params.query_arg("type") : "*";
+	std::string id_pattern   = params.has_query_arg("id") ? params.query_arg("id") : "*";
+
+	// Every matched interface is cached individually, wildcard reads share
+	// the entries with single reads. The cache is bounded by the number of
+	// interfaces in the blackboard and idle entries are expired in loop().
+	MutexLocker                    lock(&cache_mutex_);
+	std::vector<CachedInterface *> cached;
+	std::string                    etags;
+
+	std::unique_ptr<InterfaceInfoList> ifls{
+	  blackboard->list(type_pattern.c_str(), id_pattern.c_str())};
+
+	for (const auto &ii : *ifls) {
+		try {
+			CachedInterface &ci = cached_interface(ii.type(), ii.id());
+			try {
+				refresh_cached_interface(ci);
+			} catch (Exception &e) {
+				blackboard->close(ci.iface);
+				iface_cache_.erase(std::string(ii.type()) + "::" + ii.id());
+				continue;
+			}
+			cached.push_back(&ci);
+			etags += ci.etag;
+		} catch (Exception &e) {
+			// interface vanished in the meantime, skip
+		}
+	}
+
+	char etag[32];
+	snprintf(etag, sizeof(etag), "\"%zx\"", std::hash<std::string>()(etags));
+
+	std::unique_ptr<WebviewRestReply> reply;
+	if (params.header("If-None-Match").find(etag) != std::string::npos) {
+		reply = std::make_unique<WebviewRestReply>(WebReply::HTTP_NOT_MODIFIED);
+	} else if (pretty) {
+		WebviewRestArray<InterfaceData> rv;
+		for (const auto &ci : cached) {
+			rv.push_back(gen_interface_data(ci->iface, true));
+		}
+		reply = std::make_unique<WebviewRestReply>(WebReply::HTTP_OK, rv.to_json(true));
+	} else {
+		std::string json = "[";
+		for (size_t i = 0; i < cached.size(); ++i) {
+			if (i > 0)
+				json += ",";
+			json += cached[i]->json;
+		}
+		json += "]";
+		reply = std::make_unique<WebviewRestReply>(WebReply::HTTP_OK, json);
+	}
+	reply->add_header("ETag", etag);
+	return reply;
+}
+
+std::unique_ptr<WebReply>
+BlackboardRestApi::cb_stream_interfaces_data(WebviewRestParams &params)
+{
+	std::string type_pattern = params.has_query_arg("type") ? params.query_arg("type") : "*";
+	std::string id_pattern   = params.has_query_arg("id") ? params.query_arg("id") : "*";
+
+	float max_rate = cfg_stream_max_rate_;
+	if (params.has_query_arg("rate")) {
+		try {
+			max_rate = std::min(max_rate, std::stof(params.query_arg("rate")));
+		} catch (std::exception &e) {
+			throw WebviewRestException(WebReply::HTTP_BAD_REQUEST, "Invalid rate");
+		}
+	}
+
+	// hold the lock until the stream is registered to enforce the limit
+	MutexLocker lock(&streams_->mutex);
+	if (streams_->streams.size() >= cfg_stream_max_clients_) {
+		throw WebviewRestException(WebReply::HTTP_SERVICE_UNAVAILABLE,
+		                           "Maximum number of streams (%u) reached",
+		                           cfg_stream_max_clients_);
+	}
+
+	std::list<Interface *> interfaces;
 	try {
-		InterfaceData d{gen_interface_data(iface, pretty)};
-		blackboard->close(iface);
-		return d;
+		interfaces = blackboard->open_multiple_for_reading(type_pattern.c_str(), id_pattern.c_str());
 	} catch (Exception &e) {
-		blackboard->close(iface);
 		throw WebviewRestException(WebReply::HTTP_NOT_FOUND,
-		                           "Failed to read %s:%s: %s",
-		                           params.path_arg("type").c_str(),
-		                           params.path_arg("id").c_str(),
+		                           "Failed to open interfaces: %s",
 		                           e.what_no_backtrace());
 	}
+	if (interfaces.empty()) {
+		throw WebviewRestException(WebReply::HTTP_NOT_FOUND,
+		                           "No interfaces match %s::%s",
+		                           type_pattern.c_str(),
+		                           id_pattern.c_str());
+	}
+
+	auto stream = std::make_unique<BlackboardStreamWebReply>(
+	  streams_, blackboard, interfaces, max_rate, cfg_stream_keepalive_interval_);
+	streams_->streams.insert(stream.get());
+	return stream;
 }
 
 std::string
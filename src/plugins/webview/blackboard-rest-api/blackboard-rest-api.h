@@ -24,23 +24,30 @@
 #include "model/BlackboardGraph.h"
 #include "model/InterfaceData.h"
 #include "model/InterfaceInfo.h"
+#include "stream_reply.h"
 
 #include <aspect/blackboard.h>
 #include <aspect/clock.h>
+#include <aspect/configurable.h>
 #include <aspect/logging.h>
 #include <aspect/webview.h>
+#include <core/threading/mutex.h>
 #include <core/threading/thread.h>
 #include <interface/field_iterator.h>
 #include <interface/interface_info.h>
+#include <utils/time/time.h>
 #include <webview/rest_api.h>
 #include <webview/rest_array.h>
 
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <utility>
 
 class BlackboardRestApi : public fawkes::Thread,
                           public fawkes::ClockAspect,
+                          public fawkes::ConfigurableAspect,
                           public fawkes::LoggingAspect,
                           public fawkes::BlackBoardAspect,
                           public fawkes::WebviewAspect
@@ -58,7 +65,9 @@ private:
 
 	InterfaceInfo cb_get_interface_info(fawkes::WebviewRestParams &params);
 
-	InterfaceData cb_get_interface_data(fawkes::WebviewRestParams &params);
+	std::unique_ptr<fawkes::WebReply> cb_get_interface_data(fawkes::WebviewRestParams &params);
+	std::unique_ptr<fawkes::WebReply> cb_get_interfaces_data(fawkes::WebviewRestParams &params);
+	std::unique_ptr<fawkes::WebReply> cb_stream_interfaces_data(fawkes::WebviewRestParams &params);
 
 	BlackboardGraph cb_get_graph();
 
@@ -70,9 +79,32 @@ private:
 
 	std::string generate_graph(const std::string &for_owner = "");
 
+	/// @cond INTERNAL
+	typedef struct
+	{
+		fawkes::Interface *iface;
+		fawkes::Time       last_access;
+		std::string        etag;
+		std::string        json;
+	} CachedInterface;
+	/// @endcond
+
+	CachedInterface &cached_interface(const std::string &type, const std::string &id);
+	void             refresh_cached_interface(CachedInterface &ci);
+	void             expire_cached_interfaces();
+
 private:
 	fawkes::WebviewRestApi *rest_api_;
 
+	float                                  cfg_cache_idle_time_;
+	fawkes::Mutex                          cache_mutex_;
+	std::map<std::string, CachedInterface> iface_cache_;
+
+	float                                               cfg_stream_max_rate_;
+	float                                               cfg_stream_keepalive_interval_;
+	unsigned int                                        cfg_stream_max_clients_;
+	std::shared_ptr<BlackboardStreamWebReply::Registry> streams_;
+
 	std::map<std::string,
 	         std::pair<std::vector<std::shared_ptr<InterfaceFieldType>>,
 	                   std::vector<std::shared_ptr<InterfaceMessageType>>>>
@@ -0,0 +1,254 @@
+/***************************************************************************
+ *  stream_reply.cpp - Server-sent events stream of blackboard data
+ *
+ *  Created: Sat Oct 17 16:12:08 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "stream_reply.h"
+
+#include <blackboard/blackboard.h>
+#include <core/threading/mutex_locker.h>
+#include <interface/codec.h>
+#include <interface/interface.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace fawkes;
+
+/** @class BlackboardStreamWebReply "stream_reply.h"
+ * Stream of blackboard interface data as server-sent events.
+ * The reply registers a data listener for the given interfaces and
+ * sends an event whenever one of them has changed. The first event for
+ * an interface contains all fields, later events only those fields whose
+ * value has changed (delta encoding). Changes are coalesced such that
+ * at most the configured number of event batches per second is sent.
+ * If nothing changed for some time, a comment is sent as keep-alive,
+ * which also detects closed connections.
+ * While there is nothing to send the connection is suspended, such that
+ * no web server thread is blocked. It is resumed by the data listener or,
+ * for delayed events and keep-alives, by resume_if_due().
+ * @author agent
+ */
+
+/** Constructor.
+ * @param registry registry of open streams, the stream removes itself
+ * from the registry on destruction
+ * @param blackboard blackboard to register the listener with
+ * @param interfaces interfaces to stream, opened for reading. The reply
+ * takes ownership and closes them on destruction.
+ * @param max_rate maximum number of event batches per second
+ * @param keepalive_interval time in seconds after which a keep-alive
+ * comment is sent if no data has changed
+ */
+BlackboardStreamWebReply::BlackboardStreamWebReply(std::shared_ptr<Registry>     registry,
+                                                   BlackBoard *                  blackboard,
+                                                   const std::list<Interface *> &interfaces,
+                                                   float                         max_rate,
+                                                   float                         keepalive_interval)
+: DynamicWebReply(WebReply::HTTP_OK),
+  BlackBoardInterfaceListener("BlackboardStreamWebReply"),
+  registry_(registry),
+  blackboard_(blackboard),
+  interfaces_(interfaces),
+  min_interval_(max_rate > 0. ? 1. / max_rate : 0.),
+  keepalive_interval_(keepalive_interval),
+  terminate_(false),
+  suspended_(false),
+  pending_pos_(0)
+{
+	mutex_ = new Mutex();
+
+	add_header("Content-type", "text/event-stream");
+	add_header("Cache-Control", "no-cache");
+
+	for (Interface *i : interfaces_) {
+		bbil_add_data_interface(i);
+		// send full state of all interfaces first
+		dirty_.insert(i);
+	}
+	blackboard_->register_listener(this, BlackBoard::BBIL_FLAG_DATA);
+	last_send_.set_time(0, 0);
+}
+
+/** Destructor. */
+BlackboardStreamWebReply::~BlackboardStreamWebReply()
+{
+	// deregister first, the REST API may call resume_if_due() until then,
+	// and keep the lock until done such that finalize waits for us
+	MutexLocker lock(&registry_->mutex);
+	registry_->streams.erase(this);
+
+	blackboard_->unregister_listener(this);
+	for (Interface *i : interfaces_) {
+		blackboard_->close(i);
+	}
+	delete mutex_;
+
+	registry_->waitcond.wake_all();
+}
+
+size_t
+BlackboardStreamWebReply::size()
+{
+	return -1;
+}
+
+/** Terminate the stream.
+ * The stream is ended the next time the web server asks for data, a
+ * suspended connection is resumed for that.
+ */
+void
+BlackboardStreamWebReply::terminate()
+{
+	MutexLocker lock(mutex_);
+	terminate_ = true;
+	if (suspended_) {
+		suspended_ = false;
+		resume();
+	}
+}
+
+/** Resume the connection if data or a keep-alive is due.
+ * Events delayed by the rate limit and keep-alives are not triggered by
+ * the data listener. This must therefore be called periodically, at
+ * least at the maximum event rate.
+ */
+void
+BlackboardStreamWebReply::resume_if_due()
+{
+	Time        now;
+	MutexLocker lock(mutex_);
+	if (suspended_ && due(now)) {
+		suspended_ = false;
+		resume();
+	}
+}
+
+/** Check if anything is to be sent.
+ * Must be called with the mutex locked.
+ * @param now current time
+ * @return true if the stream is to be terminated, a delayed event may be
+ * sent, or a keep-alive is due
+ */
+bool
+BlackboardStreamWebReply::due(const Time &now) const
+{
+	double since_send = now - &last_send_;
+	return terminate_ || (!dirty_.empty() && since_send >= min_interval_)
+	       || (since_send >= keepalive_interval_);
+}
+
+void
+BlackboardStreamWebReply::bb_interface_data_changed(Interface *interface) throw()
+{
+	// called in the writer's context, only mark and resume
+	Time        now;
+	MutexLocker lock(mutex_);
+	dirty_.insert(interface);
+	if (suspended_ && due(now)) {
+		suspended_ = false;
+		resume();
+	}
+}
+
+std::string
+BlackboardStreamWebReply::gen_event(Interface *iface)
+{
+	// the data chunk sent last, changed fields are found by comparing to it
+	std::string &last = last_values_[iface];
+	bool         full = last.empty();
+
+	std::string data;
+	if (full) {
+		InterfaceCodec::encode_json(iface, data);
+	} else {
+		InterfaceCodec::encode_json(iface, last.data(), data);
+		if (data == "{}")
+			return "";
+	}
+	last.assign((const char *)iface->datachunk(), iface->datasize());
+
+	rapidjson::StringBuffer                    buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	writer.StartObject();
+	writer.Key("type");
+	writer.String(iface->type());
+	writer.Key("id");
+	writer.String(iface->id());
+	writer.Key("timestamp");
+	writer.String(iface->timestamp()->str());
+	writer.Key("full");
+	writer.Bool(full);
+	writer.Key("data");
+	writer.RawValue(data.data(), data.size(), rapidjson::kObjectType);
+	writer.EndObject();
+
+	return std::string("event: data\ndata: ") + buffer.GetString() + "\n\n";
+}
+
+size_t
+BlackboardStreamWebReply::next_chunk(size_t pos, char *buffer, size_t buf_max_size)
+{
+	if (buf_max_size == 0)
+		return 0;
+
+	while (pending_pos_ >= pending_.size()) {
+		pending_.clear();
+		pending_pos_ = 0;
+
+		// never block here, this would stall the web server thread
+		Time now;
+		mutex_->lock();
+		if (terminate_) {
+			mutex_->unlock();
+			return (size_t)-1;
+		}
+		if (!due(now)) {
+			suspended_ = true;
+			suspend();
+			mutex_->unlock();
+			return 0;
+		}
+		std::set<Interface *> dirty;
+		if (now - &last_send_ >= min_interval_) {
+			dirty.swap(dirty_);
+		}
+		last_send_ = now;
+		mutex_->unlock();
+
+		if (dirty.empty()) {
+			pending_ = ": keep-alive\n\n";
+		} else {
+			for (Interface *i : dirty) {
+				try {
+					i->read();
+					pending_ += gen_event(i);
+				} catch (Exception &e) {
+					// interface invalid, ignore, will be closed with the stream
+				}
+			}
+		}
+	}
+
+	size_t n = std::min(pending_.size() - pending_pos_, buf_max_size);
+	memcpy(buffer, pending_.data() + pending_pos_, n);
+	pending_pos_ += n;
+	return n;
+}
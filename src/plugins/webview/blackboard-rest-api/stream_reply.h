@@ -0,0 +1,101 @@
+/***************************************************************************
+ *  stream_reply.h - Server-sent events stream of blackboard data
+ *
+ *  Created: Sat Oct 17 16:12:08 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_WEBVIEW_BLACKBOARD_REST_API_STREAM_REPLY_H_
+#define _PLUGINS_WEBVIEW_BLACKBOARD_REST_API_STREAM_REPLY_H_
+
+#include <blackboard/interface_listener.h>
+#include <utils/time/time.h>
+#include <webview/reply.h>
+
+#include <core/threading/mutex.h>
+#include <core/threading/wait_condition.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace fawkes {
+class BlackBoard;
+class Interface;
+} // namespace fawkes
+
+class BlackboardStreamWebReply : public fawkes::DynamicWebReply,
+                                 public fawkes::BlackBoardInterfaceListener
+{
+public:
+	/** Set of open streams.
+	 * Shared between the REST API and its streams, such that a stream which
+	 * outlives the REST API can still deregister itself safely.
+	 */
+	class Registry
+	{
+	public:
+		/** Constructor. */
+		Registry() : waitcond(&mutex)
+		{
+		}
+
+		fawkes::Mutex                        mutex;    ///< protects streams
+		fawkes::WaitCondition                waitcond; ///< signaled when a stream is closed
+		std::set<BlackboardStreamWebReply *> streams;  ///< currently open streams
+	};
+
+	BlackboardStreamWebReply(std::shared_ptr<Registry>             registry,
+	                         fawkes::BlackBoard *                  blackboard,
+	                         const std::list<fawkes::Interface *> &interfaces,
+	                         float                                 max_rate,
+	                         float                                 keepalive_interval);
+	virtual ~BlackboardStreamWebReply();
+
+	virtual size_t size();
+	virtual size_t next_chunk(size_t pos, char *buffer, size_t buf_max_size);
+
+	virtual void bb_interface_data_changed(fawkes::Interface *interface) throw();
+
+	void terminate();
+	void resume_if_due();
+
+private:
+	std::string gen_event(fawkes::Interface *iface);
+	bool        due(const fawkes::Time &now) const;
+
+private:
+	std::shared_ptr<Registry>      registry_;
+	fawkes::BlackBoard *           blackboard_;
+	std::list<fawkes::Interface *> interfaces_;
+	float                          min_interval_;
+	float                          keepalive_interval_;
+
+	fawkes::Mutex *               mutex_;
+	std::set<fawkes::Interface *> dirty_;
+	bool                          terminate_;
+	bool                          suspended_;
+
+	std::map<fawkes::Interface *, std::string> last_values_;
+
+	fawkes::Time last_send_;
+	std::string  pending_;
+	size_t       pending_pos_;
+};
+
+#endif
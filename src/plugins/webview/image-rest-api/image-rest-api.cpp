@@ -24,9 +24,13 @@
 #include "jpeg_stream_producer.h"
 #include "mjpeg_reply.h"
 
+#include <core/threading/mutex_locker.h>
 #include <fvutils/ipc/shm_image.h>
+#include <utils/time/wait.h>
 #include <webview/rest_api_manager.h>
 
+#include <cstdio>
+
 using namespace fawkes;
 using namespace firevision;
 
@@ -36,8 +40,9 @@ using namespace firevision;
  */
 
 /** Constructor. */
-ImageRestApi::ImageRestApi() : Thread("ImageRestApi", Thread::OPMODE_WAITFORWAKEUP)
+ImageRestApi::ImageRestApi() : Thread("ImageRestApi", Thread::OPMODE_CONTINUOUS)
 {
+	set_prepfin_conc_loop(true);
 }
 
 /** Destructor. */
@@ -48,6 +53,23 @@ ImageRestApi::~ImageRestApi()
 void
 ImageRestApi::init()
 {
+	cfg_max_streams_ = 8;
+	try {
+		cfg_max_streams_ = config->get_uint("/webview/images/max-streams");
+	} catch (Exception &e) {
+	} // ignored, use default
+	cfg_idle_time_ = 30.;
+	try {
+		cfg_idle_time_ = config->get_float("/webview/images/stream-idle-time");
+	} catch (Exception &e) {
+	} // ignored, use default
+	cfg_stats_interval_ = 60.;
+	try {
+		cfg_stats_interval_ = config->get_float("/webview/images/statistics-interval");
+	} catch (Exception &e) {
+	} // ignored, use default
+	last_stats_.stamp();
+
 	rest_api_ = new WebviewRestApi("images", logger);
 	rest_api_->add_handler<WebviewRestArray<ImageInfo>>(
 	  WebRequest::METHOD_GET, "/?", std::bind(&ImageRestApi::cb_list_images, this));
@@ -62,8 +84,9 @@ ImageRestApi::finalize()
 {
 	webview_rest_api_manager->unregister_api(rest_api_);
 	delete rest_api_;
+	MutexLocker lock(&streams_mutex_);
 	for (auto &s : streams_) {
-		thread_collector->remove(&*s.second);
+		thread_collector->remove(&*s.second.producer);
 	}
 	streams_.clear();
 }
@@ -71,6 +94,68 @@ ImageRestApi::finalize()
 void
 ImageRestApi::loop()
 {
+	// do not get cancelled while holding the lock or removing producers
+	CancelState old_cancel_state;
+	set_cancel_state(CANCEL_DISABLED, &old_cancel_state);
+
+	streams_mutex_.lock();
+	reap_streams(cfg_idle_time_);
+	if (cfg_stats_interval_ > 0.) {
+		Time now(clock);
+		if (now - &last_stats_ >= cfg_stats_interval_) {
+			log_statistics();
+			last_stats_ = now;
+		}
+	}
+	streams_mutex_.unlock();
+
+	set_cancel_state(old_cancel_state);
+	TimeWait::wait(1000000);
+}
+
+/** Remove producers nobody used for some time.
+ * A producer is in use while a reply holds a reference to it. Producers
+ * are keyed by parameters chosen by the client, therefore they must be
+ * removed once no longer used. Must be called with streams_mutex_ locked.
+ * @param idle_time time in seconds a producer must have been unused to
+ * be removed, zero to remove all currently unused producers
+ */
+void
+ImageRestApi::reap_streams(float idle_time)
+{
+	Time now(clock);
+	for (auto s = streams_.begin(); s != streams_.end();) {
+		if (s->second.producer.use_count() > 1) {
+			s->second.last_use = now;
+			++s;
+		} else if (now - &s->second.last_use >= idle_time) {
+			logger->log_debug(name(), "Removing idle stream %s", s->first.c_str());
+			thread_collector->remove(&*s->second.producer);
+			s = streams_.erase(s);
+		} else {
+			++s;
+		}
+	}
+}
+
+/** Log statistics of all stream producers.
+ * Must be called with streams_mutex_ locked.
+ */
+void
+ImageRestApi::log_statistics()
+{
+	for (auto &s : streams_) {
+		WebviewJpegStreamProducer::Statistics stats = s.second.producer->statistics();
+		if (stats.num_subscribers == 0 && stats.fps == 0.)
+			continue;
+		logger->log_info(name(),
+		                 "Stream %s: %.1f fps, %.1f ms CPU/frame, %u subscribers, %u dropped",
+		                 s.first.c_str(),
+		                 stats.fps,
+		                 stats.cpu_per_frame,
+		                 stats.num_subscribers,
+		                 stats.num_dropped);
+	}
 }
 
 WebviewRestArray<ImageInfo>
@@ -96,58 +181,90 @@ ImageRestApi::cb_list_images()
 	return rv;
 }
 
+/** Get stream producer for an image.
+ * Producers are shared among all clients requesting the same image with
+ * the same quality and scale, such that each frame is encoded only once.
+ * @param image_id ID of the shared memory image buffer
+ * @param quality JPEG quality, 0 to use the configured value
+ * @param scale scale factor in the range (0, 1]
+ * @return stream producer or NULL if the image cannot be opened
+ * @exception WebviewRestException thrown if the maximum number of
+ * streams has been reached
+ */
 std::shared_ptr<fawkes::WebviewJpegStreamProducer>
-ImageRestApi::get_stream(const std::string &image_id)
+ImageRestApi::get_stream(const std::string &image_id, unsigned int quality, float scale)
 {
-	if (streams_.find(image_id) == streams_.end()) {
-		try {
-			std::string  cfg_prefix = "/webview/images/" + image_id + "/";
-			unsigned int quality    = 80;
-			float        fps        = 15;
-			bool         vflip      = false;
-			// Read default values if set
-			try {
-				quality = config->get_uint("/webview/images/default/jpeg-quality");
-			} catch (Exception &e) {
-			} // ignored, use default
-			try {
-				fps = config->get_float("/webview/images/default/mjpeg-fps");
-			} catch (Exception &e) {
-			} // ignored, use default
-			try {
-				vflip = config->get_bool("/webview/images/default/jpeg-vflip");
-			} catch (Exception &e) {
-			} // ignored, use default
-			// Set camera-specific values
-			try {
-				quality = config->get_uint((cfg_prefix + "jpeg-quality").c_str());
-			} catch (Exception &e) {
-			} // ignored, use default
-			try {
-				fps = config->get_float((cfg_prefix + "mjpeg-fps").c_str());
-			} catch (Exception &e) {
-			} // ignored, use default
-			try {
-				vflip = config->get_bool((cfg_prefix + "jpeg-vflip").c_str());
-			} catch (Exception &e) {
-			} // ignored, use default
-
-			auto stream = std::make_shared<WebviewJpegStreamProducer>(image_id, quality, fps, vflip);
-
-			thread_collector->add(&*stream);
-
-			streams_[image_id] = stream;
-		} catch (Exception &e) {
-			logger->log_warn("ImageRestApi",
-			                 "Failed to open buffer '%s',"
-			                 " exception follows",
-			                 image_id.c_str());
-			logger->log_warn("ImageRestApi", e);
-			return NULL;
+	std::string  cfg_prefix  = "/webview/images/" + image_id + "/";
+	unsigned int cfg_quality = 80;
+	float        fps         = 15;
+	bool         vflip       = false;
+	// Read default values if set
+	try {
+		cfg_quality = config->get_uint("/webview/images/default/jpeg-quality");
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		fps = config->get_float("/webview/images/default/mjpeg-fps");
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		vflip = config->get_bool("/webview/images/default/jpeg-vflip");
+	} catch (Exception &e) {
+	} // ignored, use default
+	// Set camera-specific values
+	try {
+		cfg_quality = config->get_uint((cfg_prefix + "jpeg-quality").c_str());
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		fps = config->get_float((cfg_prefix + "mjpeg-fps").c_str());
+	} catch (Exception &e) {
+	} // ignored, use default
+	try {
+		vflip = config->get_bool((cfg_prefix + "jpeg-vflip").c_str());
+	} catch (Exception &e) {
+	} // ignored, use default
+
+	if (quality == 0)
+		quality = cfg_quality;
+
+	char key_suffix[32];
+	snprintf(key_suffix, sizeof(key_suffix), "|%u|%.3f", quality, scale);
+	std::string key = image_id + key_suffix;
+
+	MutexLocker lock(&streams_mutex_);
+	auto        s = streams_.find(key);
+	if (s != streams_.end()) {
+		s->second.last_use.stamp();
+		return s->second.producer;
+	}
+
+	if (streams_.size() >= cfg_max_streams_) {
+		reap_streams(0.);
+		if (streams_.size() >= cfg_max_streams_) {
+			throw WebviewRestException(WebReply::HTTP_SERVICE_UNAVAILABLE,
+			                           "Maximum number of %u image streams reached",
+			                           cfg_max_streams_);
 		}
 	}
 
-	return streams_[image_id];
+	try {
+		auto stream = std::make_shared<WebviewJpegStreamProducer>(image_id, quality, fps, vflip, scale);
+
+		thread_collector->add(&*stream);
+
+		StreamEntry &entry = streams_[key];
+		entry.producer     = stream;
+		entry.last_use.stamp();
+		return stream;
+	} catch (Exception &e) {
+		logger->log_warn("ImageRestApi",
+		                 "Failed to open buffer '%s',"
+		                 " exception follows",
+		                 image_id.c_str());
+		logger->log_warn("ImageRestApi", e);
+		return NULL;
+	}
 }
 
 std::unique_ptr<WebReply>
@@ -162,7 +279,36 @@ ImageRestApi::cb_get_image(WebviewRestParams &params)
 	std::string image_id   = image.substr(0, last_dot);
 	std::string image_type = image.substr(last_dot + 1);
 
-	std::shared_ptr<WebviewJpegStreamProducer> stream = get_stream(image_id);
+	unsigned int quality = 0;
+	if (params.has_query_arg("quality")) {
+		try {
+			quality = std::stoul(params.query_arg("quality"));
+		} catch (std::exception &e) {
+		} // handled below
+		if (quality < 1 || quality > 100) {
+			return std::make_unique<StaticWebReply>(WebReply::HTTP_BAD_REQUEST,
+			                                        "Quality must be in the range [1, 100]");
+		}
+	}
+	float scale = 1.0;
+	if (params.has_query_arg("scale")) {
+		try {
+			scale = std::stof(params.query_arg("scale"));
+		} catch (std::exception &e) {
+			scale = 0.;
+		}
+		if (scale <= 0. || scale > 1.) {
+			return std::make_unique<StaticWebReply>(WebReply::HTTP_BAD_REQUEST,
+			                                        "Scale must be in the range (0, 1]");
+		}
+	}
+
+	std::shared_ptr<WebviewJpegStreamProducer> stream;
+	try {
+		stream = get_stream(image_id, quality, scale);
+	} catch (WebviewRestException &e) {
+		return std::make_unique<StaticWebReply>(e.code(), e.what_no_backtrace());
+	}
 	if (!stream) {
 		return std::make_unique<StaticWebReply>(WebReply::HTTP_NOT_FOUND, "Stream not found");
 	}
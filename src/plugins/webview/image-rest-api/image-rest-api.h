@@ -29,7 +29,9 @@
 #include <aspect/logging.h>
 #include <aspect/thread_producer.h>
 #include <aspect/webview.h>
+#include <core/threading/mutex.h>
 #include <core/threading/thread.h>
+#include <utils/time/time.h>
 #include <webview/rest_api.h>
 #include <webview/rest_array.h>
 
@@ -60,11 +62,30 @@ public:
 private:
 	WebviewRestArray<ImageInfo> cb_list_images();
 
-	std::shared_ptr<fawkes::WebviewJpegStreamProducer> get_stream(const std::string &image_id);
+	std::shared_ptr<fawkes::WebviewJpegStreamProducer>
+	get_stream(const std::string &image_id, unsigned int quality, float scale);
 
 	std::unique_ptr<fawkes::WebReply> cb_get_image(fawkes::WebviewRestParams &params);
 
+	void reap_streams(float idle_time);
+	void log_statistics();
+
 private:
-	fawkes::WebviewRestApi *                                                  rest_api_;
-	std::map<std::string, std::shared_ptr<fawkes::WebviewJpegStreamProducer>> streams_;
+	/// @cond INTERNAL
+	struct StreamEntry
+	{
+		std::shared_ptr<fawkes::WebviewJpegStreamProducer> producer;
+		fawkes::Time                                       last_use;
+	};
+	/// @endcond
+
+	fawkes::WebviewRestApi *rest_api_;
+
+	unsigned int cfg_max_streams_;
+	float        cfg_idle_time_;
+	float        cfg_stats_interval_;
+	fawkes::Time last_stats_;
+
+	fawkes::Mutex                      streams_mutex_;
+	std::map<std::string, StreamEntry> streams_;
 };
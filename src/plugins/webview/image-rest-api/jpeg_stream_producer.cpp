@@ -27,9 +27,12 @@
 #include <fvcams/shmem.h>
 #include <fvutils/color/conversions.h>
 #include <fvutils/compression/jpeg_compressor.h>
+#include <fvutils/scalers/lossy.h>
+#include <utils/time/time.h>
 #include <utils/time/wait.h>
 
 #include <cstdlib>
+#include <ctime>
 
 using namespace firevision;
 
@@ -57,9 +60,12 @@ WebviewJpegStreamProducer::Buffer::~Buffer()
 /** @class WebviewJpegStreamProducer::Subscriber "jpeg_stream_producer.h"
  * JPEG stream subscriber.
  *
- * @fn void WebviewJpegStreamProducer::Subscriber::handle_buffer(std::shared_ptr<Buffer> buffer) throw() = 0
+ * @fn bool WebviewJpegStreamProducer::Subscriber::handle_buffer(std::shared_ptr<Buffer> buffer) = 0
  * Notification if a new buffer is available.
+ * Subscribers which are slower than the producer only keep the newest
+ * buffer and drop older ones that have not been sent, yet.
  * @param buffer new buffer
+ * @return true if a previous buffer has been dropped, false otherwise
  */
 
 /** Destructor. */
@@ -71,7 +77,8 @@ WebviewJpegStreamProducer::Subscriber::~Subscriber()
  * JPEG stream producer.
  * This class takes an image ID and some parameters and then creates a stream
  * of JPEG buffers that is either passed to subscribers or can be queried
- * using the wait_for_next_frame() method.
+ * using the wait_for_next_frame() method. Each frame is encoded only
+ * once and shared among all subscribers.
  * @author Tim Niemueller
  */
 
@@ -80,24 +87,29 @@ WebviewJpegStreamProducer::Subscriber::~Subscriber()
  * @param quality JPEG quality value, depends on used compressor (system default)
  * @param fps frames per second to achieve
  * @param vflip true to enable vertical flipping, false to disable
+ * @param scale scale factor in the range (0, 1] to downscale images before
+ * compressing them
  */
 WebviewJpegStreamProducer::WebviewJpegStreamProducer(const std::string &image_id,
                                                      unsigned int       quality,
                                                      float              fps,
-                                                     bool               vflip)
+                                                     bool               vflip,
+                                                     float              scale)
 : Thread("WebviewJpegStreamProducer", Thread::OPMODE_WAITFORWAKEUP)
 {
 	set_coalesce_wakeups(true);
 	set_prepfin_conc_loop(true);
-	set_name("WebviewJpegStreamProducer[%s]", image_id.c_str());
+	set_name("WebviewJpegStreamProducer[%s|q%u|s%.2f]", image_id.c_str(), quality, scale);
 
 	last_buf_mutex_    = new Mutex();
 	last_buf_waitcond_ = new WaitCondition(last_buf_mutex_);
+	stats_mutex_       = new Mutex();
 
 	quality_  = quality;
 	image_id_ = image_id;
 	fps_      = fps;
 	vflip_    = vflip;
+	scale_    = scale;
 }
 
 /** Destructor. */
@@ -105,6 +117,7 @@ WebviewJpegStreamProducer::~WebviewJpegStreamProducer()
 {
 	delete last_buf_mutex_;
 	delete last_buf_waitcond_;
+	delete stats_mutex_;
 }
 
 /** Add a subscriber.
@@ -147,21 +160,87 @@ WebviewJpegStreamProducer::wait_for_next_frame()
 	return last_buf_;
 }
 
+/** Get stream statistics.
+ * The statistics are updated about every ten seconds while there are
+ * subscribers.
+ * @return current statistics
+ */
+WebviewJpegStreamProducer::Statistics
+WebviewJpegStreamProducer::statistics()
+{
+	MutexLocker lock(stats_mutex_);
+	return stats_;
+}
+
 void
 WebviewJpegStreamProducer::init()
 {
-	cam_  = new SharedMemoryCamera(image_id_.c_str(), /* deep copy */ false);
+	cam_ = new SharedMemoryCamera(image_id_.c_str(), /* deep copy */ false);
+
+	in_buffer_ = malloc_buffer(YUV422_PLANAR, cam_->pixel_width(), cam_->pixel_height());
+
+	unsigned int width  = cam_->pixel_width();
+	unsigned int height = cam_->pixel_height();
+
+	scaler_        = NULL;
+	scaled_buffer_ = NULL;
+	if (scale_ > 0. && scale_ < 1.) {
+		scaler_ = new LossyScaler();
+		scaler_->set_original_dimensions(width, height);
+		scaler_->set_scale_factor(scale_);
+		width          = scaler_->needed_scaled_width();
+		height         = scaler_->needed_scaled_height();
+		scaled_buffer_ = malloc_buffer(YUV422_PLANAR, width, height);
+		scaler_->set_original_buffer(in_buffer_);
+		scaler_->set_scaled_buffer(scaled_buffer_);
+	}
+
 	jpeg_ = new JpegImageCompressor(quality_);
-	jpeg_->set_image_dimensions(cam_->pixel_width(), cam_->pixel_height());
+	jpeg_->set_image_dimensions(width, height);
 	jpeg_->set_compression_destination(ImageCompressor::COMP_DEST_MEM);
 	if (jpeg_->supports_vflip())
 		jpeg_->set_vflip(vflip_);
-
-	in_buffer_ = malloc_buffer(YUV422_PLANAR, cam_->pixel_width(), cam_->pixel_height());
-	jpeg_->set_image_buffer(YUV422_PLANAR, in_buffer_);
+	jpeg_->set_image_buffer(YUV422_PLANAR, scaler_ ? scaled_buffer_ : in_buffer_);
 
 	long int loop_time = (long int)roundf((1. / fps_) * 1000000.);
 	timewait_          = new TimeWait(clock, loop_time);
+
+	stats_.fps             = 0.;
+	stats_.cpu_per_frame   = 0.;
+	stats_.num_subscribers = 0;
+	stats_.num_dropped     = 0;
+	stats_frames_          = 0;
+	stats_cpu_time_        = 0.;
+	stats_start_           = new Time(clock);
+}
+
+void
+WebviewJpegStreamProducer::update_statistics(double       cpu_time,
+                                             unsigned int num_subscribers,
+                                             unsigned int num_dropped)
+{
+	stats_frames_ += 1;
+	stats_cpu_time_ += cpu_time;
+
+	MutexLocker lock(stats_mutex_);
+	stats_.num_subscribers = num_subscribers;
+	stats_.num_dropped += num_dropped;
+
+	Time   now(clock);
+	double period = now - stats_start_;
+	if (period >= 10. || (num_subscribers == 0 && period > 0.)) {
+		stats_.fps           = stats_frames_ / period;
+		stats_.cpu_per_frame = stats_cpu_time_ / stats_frames_ * 1000.;
+		logger->log_debug(name(),
+		                  "%.1f fps, %.2f ms CPU per frame, %u subscribers, %u frames dropped",
+		                  stats_.fps,
+		                  stats_.cpu_per_frame,
+		                  stats_.num_subscribers,
+		                  stats_.num_dropped);
+		stats_frames_   = 0;
+		stats_cpu_time_ = 0.;
+		*stats_start_   = now;
+	}
 }
 
 void
@@ -177,6 +256,9 @@ WebviewJpegStreamProducer::loop()
 	unsigned char *buffer = (unsigned char *)malloc(size);
 	jpeg_->set_destination_buffer(buffer, size);
 
+	struct timespec cpu_start, cpu_end;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+
 	cam_->lock_for_read();
 	cam_->capture();
 	firevision::convert(cam_->colorspace(),
@@ -185,24 +267,29 @@ WebviewJpegStreamProducer::loop()
 	                    in_buffer_,
 	                    cam_->pixel_width(),
 	                    cam_->pixel_height());
-	jpeg_->compress();
 	cam_->dispose_buffer();
 	cam_->unlock();
+	if (scaler_)
+		scaler_->scale();
+	jpeg_->compress();
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+	double cpu_time =
+	  (cpu_end.tv_sec - cpu_start.tv_sec) + (cpu_end.tv_nsec - cpu_start.tv_nsec) / 1000000000.;
 
 	std::shared_ptr<Buffer> shared_buf = std::make_shared<Buffer>(buffer, jpeg_->compressed_size());
+	unsigned int            num_dropped = 0;
 	subs_.lock();
-#if (__GNUC__ * 10000 + __GNUC_MINOR__ * 100) > 40600
 	for (auto &s : subs_) {
-#else
-	fawkes::LockList<Subscriber *>::iterator si;
-	for (si = subs_.begin(); si != subs_.end(); ++si) {
-		Subscriber *s = *si;
-#endif
-		s->handle_buffer(shared_buf);
+		if (s->handle_buffer(shared_buf))
+			num_dropped += 1;
 	}
-	bool go_on = !subs_.empty();
+	unsigned int num_subscribers = subs_.size();
+	bool         go_on           = !subs_.empty();
 	subs_.unlock();
 
+	update_statistics(cpu_time, num_subscribers, num_dropped);
+
 	last_buf_mutex_->lock();
 	last_buf_ = shared_buf;
 	last_buf_waitcond_->wake_all();
@@ -220,7 +307,10 @@ WebviewJpegStreamProducer::finalize()
 	delete jpeg_;
 	delete cam_;
 	delete timewait_;
+	delete scaler_;
+	delete stats_start_;
 	free(in_buffer_);
+	free(scaled_buffer_);
 }
 
 } // end namespace fawkes
@@ -23,6 +23,7 @@
 #define _PLUGINS_WEBVIEW_JPEG_STREAM_PRODUCER_H_
 
 #include <aspect/clock.h>
+#include <aspect/logging.h>
 #include <core/threading/thread.h>
 #include <core/utils/lock_list.h>
 
@@ -32,15 +33,19 @@
 namespace firevision {
 class SharedMemoryCamera;
 class JpegImageCompressor;
+class Scaler;
 } // namespace firevision
 
 namespace fawkes {
 
+class Time;
 class TimeWait;
 class Mutex;
 class WaitCondition;
 
-class WebviewJpegStreamProducer : public fawkes::Thread, public fawkes::ClockAspect
+class WebviewJpegStreamProducer : public fawkes::Thread,
+                                  public fawkes::ClockAspect,
+                                  public fawkes::LoggingAspect
 {
 public:
 	class Buffer
@@ -74,30 +79,48 @@ public:
 	{
 	public:
 		virtual ~Subscriber();
-		virtual void handle_buffer(std::shared_ptr<Buffer> buffer) = 0;
+		virtual bool handle_buffer(std::shared_ptr<Buffer> buffer) = 0;
 	};
 
+	/** Stream statistics. */
+	typedef struct
+	{
+		float        fps;             ///< frames per second produced
+		float        cpu_per_frame;   ///< CPU time in ms to produce a frame
+		unsigned int num_subscribers; ///< number of current subscribers
+		unsigned int num_dropped;     ///< frames dropped for slow subscribers
+	} Statistics;
+
 public:
 	WebviewJpegStreamProducer(const std::string &image_id,
 	                          unsigned int       quality,
 	                          float              fps,
-	                          bool               vflip);
+	                          bool               vflip,
+	                          float              scale = 1.0);
 	virtual ~WebviewJpegStreamProducer();
 
 	void                    add_subscriber(Subscriber *subscriber);
 	void                    remove_subscriber(Subscriber *subscriber);
 	std::shared_ptr<Buffer> wait_for_next_frame();
+	Statistics              statistics();
 
 	virtual void init();
 	virtual void loop();
 	virtual void finalize();
 
+private:
+	void update_statistics(double cpu_time, unsigned int num_subscribers, unsigned int num_dropped);
+
 private:
 	std::string    image_id_;
 	unsigned int   quality_;
 	float          fps_;
 	bool           vflip_;
+	float          scale_;
 	unsigned char *in_buffer_;
+	unsigned char *scaled_buffer_;
+
+	firevision::Scaler *scaler_;
 
 	TimeWait *timewait_;
 
@@ -108,6 +131,12 @@ private:
 	std::shared_ptr<Buffer> last_buf_;
 	fawkes::Mutex *         last_buf_mutex_;
 	fawkes::WaitCondition * last_buf_waitcond_;
+
+	fawkes::Mutex *stats_mutex_;
+	Statistics     stats_;
+	unsigned int   stats_frames_;
+	double         stats_cpu_time_;
+	fawkes::Time * stats_start_;
 };
 
 } // end namespace fawkes
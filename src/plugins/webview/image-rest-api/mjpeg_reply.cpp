@@ -104,13 +104,16 @@ DynamicMJPEGStreamWebReply::size()
 	return -1;
 }
 
-void
+bool
 DynamicMJPEGStreamWebReply::handle_buffer(std::shared_ptr<WebviewJpegStreamProducer::Buffer> buffer)
 {
 	next_buffer_mutex_->lock();
+	// a buffer which has not been picked up yet is dropped
+	bool dropped = (bool)next_buffer_;
 	next_buffer_ = buffer;
 	next_buffer_waitcond_->wake_all();
 	next_buffer_mutex_->unlock();
+	return dropped;
 }
 
 size_t
@@ -142,6 +145,7 @@ DynamicMJPEGStreamWebReply::next_chunk(size_t pos, char *buffer, size_t buf_max_
 		}
 		size_t header_len = strlen(header);
 		memcpy(buffer, header, header_len);
+		free(header);
 		buffer += header_len;
 		buf_max_size -= header_len;
 		written += header_len;
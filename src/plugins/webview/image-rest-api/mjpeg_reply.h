@@ -45,7 +45,7 @@ public:
 	virtual size_t size();
 	virtual size_t next_chunk(size_t pos, char *buffer, size_t buf_max_size);
 
-	virtual void handle_buffer(std::shared_ptr<WebviewJpegStreamProducer::Buffer> buffer);
+	virtual bool handle_buffer(std::shared_ptr<WebviewJpegStreamProducer::Buffer> buffer);
 
 private:
 	std::shared_ptr<WebviewJpegStreamProducer> stream_producer_;